@@ -21,8 +21,82 @@ namespace std {
    %template(vectorf) vector<float>;
    %template(vectord) vector<double>;
    %template(vectorc) vector<std::complex<double>>;
+   %template(vectors) vector<std::string>;
 };
 
+/*
+ * Flat arrays of Kernel::gates, as (pointer, size) pairs. A C-contiguous
+ * buffer of the right element type (e.g. a numpy array of dtype uint64 for
+ * size_t, or float64 for double) is used in place; any other sequence of
+ * numbers (including buffers of other element types) is copied. Signed
+ * integer buffers are copied too, so that a negative number raises an
+ * OverflowError instead of wrapping to a huge size_t. None is an empty array.
+ */
+%define FLAT_ARRAY_TYPEMAPS(TYPE, FORMATS, CONVERT)
+%typemap(in) (const TYPE *ARRAY, size_t SIZE) (Py_buffer view, int have_view = 0, std::vector<TYPE> copy) {
+    $1 = nullptr;
+    $2 = 0;
+    if ($input != Py_None) {
+        if (PyObject_CheckBuffer($input) && PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+            const char *format = view.format ? view.format : "B";
+            char code = format[strlen(format) - 1];
+            if (view.itemsize == sizeof(TYPE) && strchr(FORMATS, code) != nullptr) {
+                have_view = 1;
+                $1 = static_cast<const TYPE *>(view.buf);
+                $2 = view.len / view.itemsize;
+            } else {
+                PyBuffer_Release(&view);
+            }
+        } else {
+            PyErr_Clear();
+        }
+        if (!have_view) {
+            PyObject *seq = PySequence_Fast($input, "expected a sequence or buffer of numbers");
+            if (!seq) SWIG_fail;
+            Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+            copy.reserve(n);
+            for (Py_ssize_t i = 0; i < n; i++) {
+                TYPE value = CONVERT(PySequence_Fast_GET_ITEM(seq, i));
+                if (PyErr_Occurred()) {
+                    Py_DECREF(seq);
+                    SWIG_fail;
+                }
+                copy.push_back(value);
+            }
+            Py_DECREF(seq);
+            $1 = copy.data();
+            $2 = copy.size();
+        }
+    }
+}
+%typemap(freearg) (const TYPE *ARRAY, size_t SIZE) {
+    if (have_view$argnum) PyBuffer_Release(&view$argnum);
+}
+%enddef
+
+%{
+#include <cstring>
+
+// a Python integer (or anything with __index__, like a numpy integer) as size_t
+static size_t flat_array_size_t(PyObject *obj) {
+    PyObject *index = PyNumber_Index(obj);
+    if (!index) return 0;
+    size_t value = PyLong_AsSize_t(index);
+    Py_DECREF(index);
+    return value;
+}
+%}
+
+FLAT_ARRAY_TYPEMAPS(size_t, "LQN", flat_array_size_t)
+FLAT_ARRAY_TYPEMAPS(double, "d", PyFloat_AsDouble)
+
+%apply (const size_t *ARRAY, size_t SIZE) {
+    (const size_t *ids, size_t ids_size),
+    (const size_t *qubit_counts, size_t qubit_counts_size),
+    (const size_t *qubits, size_t qubits_size)
+};
+%apply (const double *ARRAY, size_t SIZE) { (const double *angles, size_t angles_size) };
+
 %{
 #include "openql_i.h"
 %}
@@ -589,6 +663,26 @@ arg7 : []
 
 
 
+%feature("docstring") Kernel::gates
+""" adds many gates to kernel at once; the result is the same as that of
+calling gate(names[ids[i]], qubits of gate i, 0, angles[i]) for each gate i
+in turn, but much faster. The arrays can be lists or numpy arrays.
+
+Parameters
+----------
+arg1 : [str]
+    list of the names of the gates
+arg2 : []
+    for each gate, the index of its name in arg1
+arg3 : []
+    for each gate, its number of qubits
+arg4 : []
+    the qubits of all gates, one gate after the other
+arg5 : []
+    for each gate, its angle of rotation; may be empty (or None) for all 0.0
+"""
+
+
 %feature("docstring") Kernel::gate
 """ adds unitary to kernel.
 
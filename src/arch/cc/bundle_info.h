@@ -34,7 +34,7 @@ public:	// vars
 #endif
 #if OPT_PRAGMA
 	// pragma 'gates'
-	const Json *pragma = nullptr;
+	const settings_cc::tPragma *pragma = nullptr;
 #endif
 }; // information for an instrument group (of channels), for a single instruction
 // FIXME: rename tInstrInfo, store gate as annotation, move to class cc:IR, together with customGate(), bundleStart(), bundleFinish()?
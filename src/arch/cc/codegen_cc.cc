@@ -22,11 +22,12 @@ namespace ql {
 | Generic
 \************************************************************************/
 
-void codegen_cc::init(const quantum_platform &platform)
+void codegen_cc::init(const quantum_platform &platform, utils::OutSink &codeSink)
 {
     // NB: a new eqasm_backend_cc is instantiated per call to compile, and
     // as a result also a codegen_cc, so we don't need to cleanup
     this->platform = &platform;
+    this->codeSink = &codeSink;
     settings.loadBackendSettings(platform);
 
     runOnce = "yes" == options::get("backend_cc_run_once");
@@ -44,30 +45,21 @@ void codegen_cc::init(const quantum_platform &platform)
 #if OPT_FEEDBACK
     // iterate over instruments
     for(size_t instrIdx=0; instrIdx<settings.getInstrumentsSize(); instrIdx++) {
-        const settings_cc::tInstrumentControl ic = settings.getInstrumentControl(instrIdx);
-        if(QL_JSON_EXISTS(ic.controlMode, "result_bits")) {  // this instrument mode produces results (i.e. it is a measurement device)
+        const settings_cc::tInstrumentControl &ic = settings.getInstrumentControl(instrIdx);
+        if(ic.hasResultBits) {  // this instrument mode produces results (i.e. it is a measurement device)
             QL_IOUT("instrument '" << ic.ii.instrumentName << "' (index " << instrIdx << ") is used for feedback");
         }
     }
 #endif
 }
 
-std::string codegen_cc::getProgram()
-{
-#if OPT_FEEDBACK
-	return codeSection.str() + dp.getDatapathSection();
-#else
-    return codeSection.str();
-#endif
-}
-
-std::string codegen_cc::getMap()
+void codegen_cc::writeMap(utils::OutSink &sink)
 {
     Json map;
 
     map["note"] = "generated by OpenQL CC backend version " CC_BACKEND_VERSION_STRING;
     map["codeword_table"] = codewordTable;
-    return QL_SS2S(std::setw(4) << map << std::endl);
+    sink.stream() << std::setw(4) << map << "\n";
 }
 
 
@@ -81,7 +73,7 @@ void codegen_cc::programStart(const std::string &progName)
 
 	dp.programStart();
 
-    vcd.programStart(platform->qubit_number, platform->cycle_time, MAX_GROUPS, settings);
+    vcd.programStart(progName, platform->qubit_number, platform->cycle_time, MAX_GROUPS, settings);
 }
 
 
@@ -90,22 +82,27 @@ void codegen_cc::programFinish(const std::string &progName)
 	emitProgramFinish();
 
 	dp.programFinish();
+#if OPT_FEEDBACK
+	codeSink->stream() << dp.getDatapathSection();     // NB: the datapath section follows the code section
+#endif
 
-    vcd.programFinish(progName);
+    vcd.programFinish();
 }
 
 /************************************************************************\
 | 'Kernel' level functions
 \************************************************************************/
 
-void codegen_cc::kernelStart()
+void codegen_cc::kernelStart(const std::string &kernelName)
 {
     zero(lastEndCycle);       // FIXME: actually, bundle.startCycle starts counting at 1
+
+    vcd.kernelStart(kernelName);
 }
 
 void codegen_cc::kernelFinish(const std::string &kernelName, size_t durationInCycles)
 {
-    vcd.kernelFinish(kernelName, durationInCycles);
+    vcd.kernelFinish(durationInCycles);
 }
 
 /************************************************************************\
@@ -135,7 +132,7 @@ void codegen_cc::bundleStart(const std::string &cmnt)
 	bundleInfo.clear();
     BundleInfo empty;
     for(size_t instrIdx=0; instrIdx<settings.getInstrumentsSize(); instrIdx++) {
-        const settings_cc::tInstrumentControl ic = settings.getInstrumentControl(instrIdx);
+        const settings_cc::tInstrumentControl &ic = settings.getInstrumentControl(instrIdx);
         bundleInfo.emplace_back(
         	ic.controlModeGroupCnt,   	// one BundleInfo per group in the control mode selected for instrument
 			empty  						// empty BundleInfo
@@ -143,6 +140,7 @@ void codegen_cc::bundleStart(const std::string &cmnt)
     }
 
 	// generate source code comments
+    bundleComment = cmnt;
     comment(cmnt);
     dp.comment(cmnt, verboseCode);		// FIXME: comment is not fully appropriate, but at least allows matching with .CODE section
 }
@@ -182,7 +180,7 @@ static tCalcGroupDigOut calcGroupDigOut(size_t instrIdx, size_t group, size_t nr
 	}
 
 	// get number of control bits for group
-	const Json &groupControlBits = ic.controlMode["control_bits"][controlModeGroup];    // NB: tests above guarantee existence
+	const Vec<int> &groupControlBits = ic.controlBits[controlModeGroup];    // NB: tests above guarantee existence
 	QL_DOUT(
 		"instrumentName=" << ic.ii.instrumentName
 		<< ", slot=" << ic.ii.slot
@@ -194,7 +192,7 @@ static tCalcGroupDigOut calcGroupDigOut(size_t instrIdx, size_t group, size_t nr
 
 	// calculate digital output for group
 	if(nrGroupControlBits == 1) {       // single bit, implying this is a mask (not code word)
-		ret.groupDigOut |= 1<<(int)groupControlBits[0];     // NB: we assume the mask is active high, which is correct for VSM and UHF-QC
+		ret.groupDigOut |= 1<<groupControlBits[0];     // NB: we assume the mask is active high, which is correct for VSM and UHF-QC
 		// FIXME: check controlModeGroup vs group
 	} else if(nrGroupControlBits > 1) {                 // > 1 bit, implying code word
 #if OPT_VECTOR_MODE
@@ -217,7 +215,7 @@ static tCalcGroupDigOut calcGroupDigOut(size_t instrIdx, size_t group, size_t nr
 		// convert codeword to digOut
 		for(size_t idx=0; idx<nrGroupControlBits; idx++) {
 			int codeWordBit = nrGroupControlBits-1-idx;    // NB: groupControlBits defines MSB..LSB
-			if(codeword & (1<<codeWordBit)) ret.groupDigOut |= 1<<(int)groupControlBits[idx];
+			if(codeword & (1<<codeWordBit)) ret.groupDigOut |= 1<<groupControlBits[idx];
 		}
 
 		ret.comment = QL_SS2S(
@@ -236,19 +234,19 @@ static tCalcGroupDigOut calcGroupDigOut(size_t instrIdx, size_t group, size_t nr
 	}
 
 	// add trigger to digOut
-	size_t nrTriggerBits = ic.controlMode["trigger_bits"].size();
+	size_t nrTriggerBits = ic.triggerBits.size();
 	if(nrTriggerBits == 0) {                                    // no trigger
 		// do nothing
 	} else if(nrTriggerBits == 1) {                             // single trigger for all groups (NB: will possibly assigned multiple times)
-		ret.groupDigOut |= 1 << (int)ic.controlMode["trigger_bits"][0];
+		ret.groupDigOut |= 1 << ic.triggerBits[0];
 #if 1	// FIXME: hotfix for QWG, implement properly
 	} else if(nrTriggerBits == 2) {
-        ret.groupDigOut |= 1 << (int)ic.controlMode["trigger_bits"][0];
-        ret.groupDigOut |= 1 << (int)ic.controlMode["trigger_bits"][1];
+        ret.groupDigOut |= 1 << ic.triggerBits[0];
+        ret.groupDigOut |= 1 << ic.triggerBits[1];
 #endif
 #if 1   // FIXME: trigger per group
 	} else if(nrTriggerBits == nrGroups) {                      // trigger per group
-		ret.groupDigOut |= 1 << (int)ic.controlMode["trigger_bits"][group];
+		ret.groupDigOut |= 1 << ic.triggerBits[group];
 #endif
 	} else {
 		QL_JSON_FATAL(
@@ -271,7 +269,7 @@ codegen_cc::tCodeGenMap codegen_cc::collectCodeGenInfo(size_t startCycle, size_t
     // iterate over instruments
     for(size_t instrIdx=0; instrIdx<settings.getInstrumentsSize(); instrIdx++) {
     	// get control info from instrument settings
-        const settings_cc::tInstrumentControl ic = settings.getInstrumentControl(instrIdx);
+        const settings_cc::tInstrumentControl &ic = settings.getInstrumentControl(instrIdx);
         if(ic.ii.slot >= MAX_SLOTS) {
             QL_JSON_FATAL(
             	"illegal slot " << ic.ii.slot
@@ -389,6 +387,9 @@ codegen_cc::tCodeGenMap codegen_cc::collectCodeGenInfo(size_t startCycle, size_t
 // bundleFinish: see 'strategy' above
 void codegen_cc::bundleFinish(size_t startCycle, size_t durationInCycles, bool isLastBundle)
 {
+	// VCD changes before this bundle are final
+	vcd.flushBefore(startCycle);
+
 	// collect info for all instruments
 	tCodeGenMap codeGenMap = collectCodeGenInfo(startCycle, durationInCycles);
 
@@ -480,7 +481,9 @@ void codegen_cc::customGate(
 
     vcd.customGate(iname, operands, startCycle, durationInCycles);
 
-    bool isReadout = settings.isReadout(iname);    	//  determine whether this is a readout instruction
+    // get the (compiled) instruction definition
+    const settings_cc::tInstructionInfo &instructionInfo = settings.getInstructionInfo(iname);
+    bool isReadout = instructionInfo.isReadout;    	//  determine whether this is a readout instruction
 
     // generate comment
     if(isReadout) {
@@ -490,14 +493,9 @@ void codegen_cc::customGate(
         comment(std::string(" # gate '") + qasm(iname, operands, breg_operands) + "'");
     }
 
-    // find instruction (gate definition)
-    const Json &instruction = platform->find_instruction(iname);
-    // find signal vector definition for instruction
-    settings_cc::tSignalDef sd = settings.findSignalDefinition(instruction, iname);
-
     // scatter signals defined for instruction (e.g. several operands and/or types) to instruments & groups
-    for(size_t s=0; s<sd.signal.size(); s++) {
-        tCalcSignalValue csv = calcSignalValue(sd, s, operands, iname);
+    for(const settings_cc::tSignalDef &sd : instructionInfo.signals) {
+        tCalcSignalValue csv = calcSignalValue(sd, operands, iname);
 
         // store signal value, checking for conflicts
         BundleInfo *bi = &bundleInfo[csv.si.instrIdx][csv.si.group];       	// shorthand
@@ -505,15 +503,15 @@ void codegen_cc::customGate(
 			if(bi->signalValue.empty()) {                                   // signal not yet used
 				bi->signalValue = csv.signalValueString;
 #if OPT_SUPPORT_STATIC_CODEWORDS
-				// FIXME: this does not only provide support, but findStaticCodewordOverride() currently actually requires static codewords
-				bi->staticCodewordOverride = ql::settings_cc::findStaticCodewordOverride(instruction, csv.operandIdx, iname); // NB: function return -1 means 'no override'
+				// NB: found by settings_cc::findStaticCodewordOverride() when compiling the instruction
+				bi->staticCodewordOverride = sd.staticCodewordOverride;
 #endif
 			} else if(bi->signalValue == csv.signalValueString) {           // signal unchanged
 				// do nothing
 			} else {
 				showCodeSoFar();
 				QL_FATAL(
-					"Signal conflict on instrument='" << csv.si.ic.ii.instrumentName
+					"Signal conflict on instrument='" << csv.si.ic->ii.instrumentName
 					<< "', group=" << csv.si.group
 					<< ", between '" << bi->signalValue
 					<< "' and '" << csv.signalValueString << "'"
@@ -557,7 +555,7 @@ void codegen_cc::customGate(
 			}
 
 			// store operands
-			if(settings.getReadoutMode(iname)=="feedback") {
+			if(instructionInfo.readoutMode=="feedback") {
 				bi->isMeasFeedback = true;
 				bi->operands = operands;
 //            	bi->creg_operands = creg_operands;	// NB: will be empty because of checks performed earlier
@@ -579,14 +577,13 @@ void codegen_cc::customGate(
     }   // for(signal)
 
 #if OPT_PRAGMA
-	const Json *pragma = settings.getPragma(iname);
-	if(pragma) {
+	if(instructionInfo.isPragma) {
 		for(std::vector<BundleInfo> &vbi : bundleInfo) {
-			// FIXME: for now we just store the JSON of the pragma statement in bundleInfo[*][0]
+			// FIXME: for now we just store the pragma statement in bundleInfo[*][0]
 			if(vbi[0].pragma) {
 				QL_FATAL("Bundle contains more than one gate with 'pragma' key");	// FIXME: provide context
 			}
-			vbi[0].pragma = pragma;
+			vbi[0].pragma = &instructionInfo.pragma;
 
 			// store operands
 			vbi[0].operands = operands;
@@ -669,17 +666,19 @@ void codegen_cc::comment(const std::string &c)
 
 // FIXME: assure space between fields!
 // FIXME: make comment output depend on verboseCode
+// NB: lines are terminated with "\n" instead of std::endl, so the code sink is not flushed for every line
 
 void codegen_cc::emit(const std::string &labelOrComment, const std::string &instr)
 {
+    std::ostream &code = codeSink->stream();
     if(labelOrComment.length()==0) {  					// no label
-        codeSection << "        " << instr << std::endl;
+        code << "        " << instr << "\n";
     } else if(labelOrComment.length()<8) {              // label fits before instr
-        codeSection << std::setw(8) << labelOrComment << instr << std::endl;
+        code << std::setw(8) << labelOrComment << instr << "\n";
     } else if(instr.length()==0) {                      // no instr
-        codeSection << labelOrComment << std::endl;
+        code << labelOrComment << "\n";
     } else {
-        codeSection << labelOrComment << std::endl << "        " << instr << std::endl;
+        code << labelOrComment << "\n" << "        " << instr << "\n";
     }
 }
 
@@ -688,7 +687,7 @@ void codegen_cc::emit(const std::string &labelOrComment, const std::string &inst
 // @param   comment     	must include leading "#"
 void codegen_cc::emit(const std::string &labelOrSel, const std::string &instr, const std::string &ops, const std::string &comment)
 {
-    codeSection << std::setw(16) << labelOrSel << std::setw(16) << instr << std::setw(24) << ops << comment << std::endl;
+    codeSink->stream() << std::setw(16) << labelOrSel << std::setw(16) << instr << std::setw(24) << ops << comment << "\n";
 }
 
 void codegen_cc::emit(int sel, const std::string &instr, const std::string &ops, const std::string &comment)
@@ -703,12 +702,13 @@ void codegen_cc::emit(int sel, const std::string &instr, const std::string &ops,
 void codegen_cc::emitProgramStart(const std::string &progName)
 {
     // emit program header
-    codeSection << std::left;    // assumed by emit()
-    codeSection << "# Program: '" << progName << "'" << std::endl;   // NB: put on top so it shows up in internal CC logging
-    codeSection << "# CC_BACKEND_VERSION " << CC_BACKEND_VERSION_STRING << std::endl;
-    codeSection << "# OPENQL_VERSION " << OPENQL_VERSION_STRING << std::endl;
-    codeSection << "# Note:    generated by OpenQL Central Controller backend" << std::endl;
-    codeSection << "#" << std::endl;
+    std::ostream &code = codeSink->stream();
+    code << std::left;    // assumed by emit()
+    code << "# Program: '" << progName << "'" << "\n";   // NB: put on top so it shows up in internal CC logging
+    code << "# CC_BACKEND_VERSION " << CC_BACKEND_VERSION_STRING << "\n";
+    code << "# OPENQL_VERSION " << OPENQL_VERSION_STRING << "\n";
+    code << "# Note:    generated by OpenQL Central Controller backend" << "\n";
+    code << "#" << "\n";
 
 #if OPT_FEEDBACK
     emit(".CODE");   // start .CODE section
@@ -822,14 +822,14 @@ void codegen_cc::emitOutput(const tCondGateMap &condGateMap, int32_t digOut, uns
 	lastEndCycle[instrIdx] = startCycle + instrMaxDurationInCycles;
 }
 
-void codegen_cc::emitPragma(const Json &pragma, int pragmaSmBit, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName)
+void codegen_cc::emitPragma(const settings_cc::tPragma &pragma, int pragmaSmBit, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName)
 {
 	if(startCycle > lastEndCycle[instrIdx]) {	// i.e. if(!instrHasOutput)
 		emitPadToCycle(instrIdx, startCycle, slot, instrumentName);
 	}
 
 	// FIXME: the only pragma possible is "break" for now
-	int pragmaBreakVal = json_get<int>(pragma, "break", "pragma of unknown instruction");		// FIXME: we don't know which instruction we're dealing with, so better move
+	int pragmaBreakVal = pragma.breakVal;
 	unsigned int smAddr = pragmaSmBit/32;	// 'seq_cl_sm' is addressable in 32 bit words
 	unsigned int mask = 1 << (pragmaSmBit%32);
 	std::string label = pragmaForLabel+"_end";		// FIXME: must match label set in forEnd(), assumes we are actually inside a for loop
@@ -889,17 +889,17 @@ void codegen_cc::emitPadToCycle(size_t instrIdx, size_t startCycle, int slot, co
 }
 
 
-// compute signalValueString, and some meta information, for sd[s] (i.e. one of the signals in the JSON definition of an instruction)
-codegen_cc::tCalcSignalValue codegen_cc::calcSignalValue(const settings_cc::tSignalDef &sd, size_t s, const Vec<UInt> &operands, const std::string &iname)
+// compute signalValueString, and some meta information, for sd (i.e. one of the signals in the JSON definition of an instruction)
+codegen_cc::tCalcSignalValue codegen_cc::calcSignalValue(const settings_cc::tSignalDef &sd, const Vec<UInt> &operands, const std::string &iname)
 {   tCalcSignalValue ret;
-    std::string signalSPath = QL_SS2S(sd.path<<"["<<s<<"]");                   // for JSON error reporting
+    const std::string &signalSPath = sd.path;                                  // for JSON error reporting
 
 	/************************************************************************\
 	| get signal properties, mapping operand index to qubit
 	\************************************************************************/
 
     // get the operand index & qubit to work on
-    ret.operandIdx = json_get<unsigned int>(sd.signal[s], "operand_idx", signalSPath);
+    ret.operandIdx = sd.operandIdx;
     if(ret.operandIdx >= operands.size()) {
         QL_JSON_FATAL(
         	"instruction '" << iname
@@ -910,40 +910,31 @@ codegen_cc::tCalcSignalValue codegen_cc::calcSignalValue(const settings_cc::tSig
     }
     UInt qubit = operands[ret.operandIdx];
 
-    // get signal value
-    const Json instructionSignalValue = json_get<const Json>(sd.signal[s], "value", signalSPath);   // NB: json_get<const Json&> unavailable
-    std::string sv = QL_SS2S(instructionSignalValue);   // serialize/stream instructionSignalValue into std::string
-
-	// get instruction signal type (e.g. "mw", "flux", etc)
-    // NB: instructionSignalType is different from "instruction/type" provided by find_instruction_type, although some identical strings are used). NB: that key is no longer used by the 'core' of OpenQL
-    std::string instructionSignalType = json_get<std::string>(sd.signal[s], "type", signalSPath);
-
 	/************************************************************************\
 	| map signal type for qubit to instrument & group
 	\************************************************************************/
 
     // find signalInfo, i.e. perform the mapping
-    ret.si = settings.findSignalInfoForQubit(instructionSignalType, qubit);
+    ret.si = settings.findSignalInfoForQubit(sd, qubit);
 
-	if(instructionSignalValue.size() == 0) {	// allow empty signal
+	if(sd.valueSize == 0) {	// allow empty signal
 		ret.signalValueString = "";
 	} else {
 		// verify signal dimensions
-		size_t channelsPergroup = ret.si.ic.controlModeGroupSize;
-		if(instructionSignalValue.size() != channelsPergroup) {
+		size_t channelsPergroup = ret.si.ic->controlModeGroupSize;
+		if(sd.valueSize != channelsPergroup) {
 			QL_JSON_FATAL(
 				"signal dimension mismatch on instruction '" << iname
-				<< "' : control mode '" << ret.si.ic.refControlMode
+				<< "' : control mode '" << ret.si.ic->refControlMode
 				<< "' requires " <<  channelsPergroup
 				<< " signals, but signal '" << signalSPath+"/value"
-				<< "' provides " << instructionSignalValue.size()
+				<< "' provides " << sd.valueSize
 			);
 		}
 
-		// expand macros
-		sv = replace_all(sv, "\"", "");   // get rid of quotes
-		sv = replace_all(sv, "{gateName}", iname);
-		sv = replace_all(sv, "{instrumentName}", ret.si.ic.ii.instrumentName);
+		// expand macros (NB: quotes and {gateName} were already handled when compiling the instruction)
+		std::string sv = sd.value;
+		sv = replace_all(sv, "{instrumentName}", ret.si.ic->ii.instrumentName);
 		sv = replace_all(sv, "{instrumentGroup}", std::to_string(ret.si.group));
 		// FIXME: allow using all qubits involved (in same signalType?, or refer to signal: qubitOfSignal[n]), e.g. qubit[0], qubit[1], qubit[2]
 		sv = replace_all(sv, "{qubit}", std::to_string(qubit));
@@ -953,8 +944,8 @@ codegen_cc::tCalcSignalValue codegen_cc::calcSignalValue(const settings_cc::tSig
 	}
 
     comment(QL_SS2S(
-    	"  # slot=" << ret.si.ic.ii.slot
-		<< ", instrument='" << ret.si.ic.ii.instrumentName << "'"
+    	"  # slot=" << ret.si.ic->ii.slot
+		<< ", instrument='" << ret.si.ic->ii.instrumentName << "'"
 		<< ", group=" << ret.si.group
 		<< "': signalValue='" << ret.signalValueString << "'"
 	));
@@ -17,6 +17,7 @@
 #include "platform.h"
 #include "utils/vec.h"
 #include "utils/json.h"
+#include "utils/sink.h"
 
 #include <string>
 #include <cstddef>  // for size_t etc.
@@ -32,14 +33,13 @@ public: //  functions
     ~codegen_cc() = default;
 
     // Generic
-    void init(const quantum_platform &platform);
-    std::string getProgram();                           // return the CC source code that was created
-    std::string getMap();                               // return a map of codeword assignments, useful for configuring AWGs
+    void init(const quantum_platform &platform, utils::OutSink &codeSink);    // the CC source code is streamed into codeSink
+    void writeMap(utils::OutSink &sink);                // write a map of codeword assignments, useful for configuring AWGs
 
     // Compile support
     void programStart(const std::string &progName);
     void programFinish(const std::string &progName);
-    void kernelStart();
+    void kernelStart(const std::string &kernelName);
     void kernelFinish(const std::string &kernelName, size_t durationInCycles);
     void bundleStart(const std::string &cmnt);
     void bundleFinish(size_t startCycle, size_t durationInCycles, bool isLastBundle);
@@ -78,7 +78,7 @@ private:    // types
 		tCondGateMap condGateMap;
 #endif
 #if OPT_PRAGMA
-		const Json *pragma;
+		const settings_cc::tPragma *pragma;
 		int pragmaSmBit;
 #endif
 		// info copied from tInstrumentInfo
@@ -109,7 +109,7 @@ private:    // vars
 
 	// codegen state, program scope
 	Json codewordTable;                                  		// codewords versus signals per instrument group
-	std::stringstream codeSection;                              // the code generated
+	utils::OutSink *codeSink;                                   // receives the code generated
 
 	// codegen state, kernel scope FIXME: create class
     unsigned int lastEndCycle[MAX_INSTRS];                      // vector[instrIdx], maintain where we got per slot
@@ -119,6 +119,7 @@ private:    // vars
 
 	// codegen state, bundle scope
     std::vector<std::vector<BundleInfo>> bundleInfo;           	// matrix[instrIdx][group]
+    std::string bundleComment;                                  // comment of current bundle, to locate errors in the code
 
 
 private:    // funcs
@@ -128,17 +129,20 @@ private:    // funcs
 	void emit(int sel, const std::string &instr, const std::string &ops, const std::string &comment="");
 
     // code generation helpers
-	void showCodeSoFar() { QL_EOUT("Code so far:\n" << codeSection.str()); }     // provide context to help finding reason. FIXME: limit # lines
+	void showCodeSoFar() {     // provide context to help finding reason
+        codeSink->stream().flush();
+        QL_EOUT("Code so far was written to " << codeSink->describe() << "; it ends in the code of bundle: " << bundleComment);
+    }
     void emitProgramStart(const std::string &progName);
     void emitProgramFinish();
 	void emitFeedback(const tFeedbackMap &feedbackMap, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName);
 	void emitOutput(const tCondGateMap &condGateMap, int32_t digOut, unsigned int instrMaxDurationInCycles, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName);
-	void emitPragma(const Json &pragma, int pragmaSmBit, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName);
+	void emitPragma(const settings_cc::tPragma &pragma, int pragmaSmBit, size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName);
     void emitPadToCycle(size_t instrIdx, size_t startCycle, int slot, const std::string &instrumentName);
 
     // generic helpers
 	tCodeGenMap collectCodeGenInfo(size_t startCycle, size_t durationInCycles);
-    tCalcSignalValue calcSignalValue(const settings_cc::tSignalDef &sd, size_t s, const Vec<UInt> &operands, const std::string &iname);
+    tCalcSignalValue calcSignalValue(const settings_cc::tSignalDef &sd, const Vec<UInt> &operands, const std::string &iname);
 #if !OPT_SUPPORT_STATIC_CODEWORDS
     uint32_t assignCodeword(const std::string &instrumentName, int instrIdx, int group);
 #endif
@@ -24,7 +24,7 @@
 #include "options_cc.h"
 
 #include <utils/str.h>
-#include <utils/filesystem.h>
+#include <utils/sink.h>
 #include <options.h>
 #include <platform.h>
 #include <ir.h>
@@ -63,9 +63,14 @@ void eqasm_backend_cc::compile(quantum_program *program, const quantum_platform
 {
     QL_DOUT("Compiling " << program->kernels.size() << " kernels to generate Central Controller program ... ");
 
+    // the program is streamed to file while it is generated
+    std::string file_name(options::get("output_dir") + "/" + program->unique_name + ".vq1asm");
+    QL_IOUT("Writing Central Controller program to " << file_name);
+    utils::FileSink programSink(file_name);
+
     // init
     loadHwSettings(platform);
-    codegen.init(platform);
+    codegen.init(platform, programSink);
     bundleIdx = 0;
 
     // generate program header
@@ -87,7 +92,7 @@ void eqasm_backend_cc::compile(quantum_program *program, const quantum_platform
         circuit &circuit = kernel.c;
         if (!circuit.empty()) {
             ir::bundles_t bundles = ir::bundler(circuit, platform.cycle_time);
-            codegen.kernelStart();
+            codegen.kernelStart(kernel.name);
             codegenBundles(bundles, platform);
             codegen.kernelFinish(kernel.name, bundles.back().start_cycle+bundles.back().duration_in_cycles);
         } else {
@@ -98,18 +103,16 @@ void eqasm_backend_cc::compile(quantum_program *program, const quantum_platform
     }
 
     codegen.programFinish(program->unique_name);
-
-    // write program to file
-    std::string file_name(options::get("output_dir") + "/" + program->unique_name + ".vq1asm");
-    QL_IOUT("Writing Central Controller program to " << file_name);
-    utils::OutFile(file_name).write(codegen.getProgram());
+    programSink.close();
 
     // write instrument map to file (unless we were using input file)
     std::string map_input_file = options::get("backend_cc_map_input_file");
     if(map_input_file != "") {
         std::string file_name_map(options::get("output_dir") + "/" + program->unique_name + ".map");
         QL_IOUT("Writing instrument map to " << file_name_map);
-        utils::OutFile(file_name_map).write(codegen.getMap());
+        utils::FileSink mapSink(file_name_map);
+        codegen.writeMap(mapSink);
+        mapSink.close();
     }
 
     QL_DOUT("Compiling Central Controller program [Done]");
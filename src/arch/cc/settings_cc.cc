@@ -30,6 +30,15 @@ void settings_cc::loadBackendSettings(const quantum_platform &platform)
     QL_JSON_ASSERT(jsonBackendSettings, "signals", "eqasm_backend_cc");
     jsonSignals = &jsonBackendSettings["signals"];
 
+    // compile the instrument configuration into a table, so the per bundle code generation does not access the JSON
+    instrumentControls.clear();
+    for(size_t instrIdx=0; instrIdx<jsonInstruments->size(); instrIdx++) {
+        instrumentControls.push_back(compileInstrumentControl(instrIdx));
+    }
+    instructionInfos.clear();
+    signalTypeIdxs.clear();
+    signalInfos.clear();
+
 #if 0   // FIXME: print some info, which also helps detecting errors early on
     // read instrument definitions
     // FIXME: the following requires json>v3.1.0: (NB: we now moved to 3.9!) for(auto& id : jsonInstrumentDefinitions->items()) {
@@ -60,53 +69,14 @@ void settings_cc::loadBackendSettings(const quantum_platform &platform)
 #endif
 }
 
-// NB: assumes prior test for isReadout()==true
-std::string settings_cc::getReadoutMode(const std::string &iname)
+// get the information from the JSON definition of an instruction, compiling it on first use
+const settings_cc::tInstructionInfo &settings_cc::getInstructionInfo(const std::string &iname)
 {
-	const Json &instruction = platform->find_instruction(iname);
-    std::string instructionPath = "instructions/"+iname;
-    QL_JSON_ASSERT(instruction, "cc", instructionPath);
-    return json_get<std::string>(instruction["cc"], "readout_mode", instructionPath);
-}
-
-// determine whether this is a readout instruction
-bool settings_cc::isReadout(const std::string &iname)
-{
-#if 1	// new semantics
-	const Json &instruction = platform->find_instruction(iname);
-    std::string instructionPath = "instructions/"+iname;
-    QL_JSON_ASSERT(instruction, "cc", instructionPath);
-    return QL_JSON_EXISTS(instruction["cc"], "readout_mode");
-#else
-	/*
-		NB: we only use the instruction_type "readout" and don't care about the rest
-		because the terms "mw" and "flux" don't fully cover gate functionality. It
-		would be nice if custom gates could mimic gate_type_t
-	*/
-	// FIXME: it seems that key "instruction/type" is no longer used by the 'core' of OpenQL, so we need a better criterion
-	// FIXME: must not trigger in "prepz", which has type "readout" in (some?) configuration files (with empty signal though)
-	// FIXME: gate semantics should be handled at the OpenQL core
-	return "readout" == platform->find_instruction_type(iname);
-#endif
-}
-
-
-bool settings_cc::isPragma(const std::string &iname)
-{
-	return getPragma(iname) != nullptr;
-}
-
-
-const Json *settings_cc::getPragma(const std::string &iname)
-{
-	const Json &instruction = platform->find_instruction(iname);
-    std::string instructionPath = "instructions/"+iname;
-    QL_JSON_ASSERT(instruction, "cc", instructionPath);
-    if(QL_JSON_EXISTS(instruction["cc"], "pragma")) {
-    	return &instruction["cc"]["pragma"];
-    } else {
-		return nullptr;
+    auto it = instructionInfos.find(iname);
+    if(it == instructionInfos.end()) {
+        it = instructionInfos.emplace(iname, compileInstructionInfo(iname)).first;
     }
+    return it->second;
 }
 
 
@@ -117,37 +87,92 @@ int settings_cc::getReadoutWait()
 }
 
 
-// find JSON signal definition for instruction, either inline or via 'ref_signal'
-settings_cc::tSignalDef settings_cc::findSignalDefinition(const Json &instruction, const std::string &iname) const
+// compile the information from the JSON definition of an instruction, finding its signal definition either inline or via 'ref_signal'
+settings_cc::tInstructionInfo settings_cc::compileInstructionInfo(const std::string &iname)
 {
-    tSignalDef ret;
+    tInstructionInfo ret;
 
+	const Json &instruction = platform->find_instruction(iname);
     std::string instructionPath = "instructions/"+iname;
     QL_JSON_ASSERT(instruction, "cc", instructionPath);
-    if (QL_JSON_EXISTS(instruction["cc"], "ref_signal")) {                      // optional syntax: "ref_signal"
-        std::string refSignal = instruction["cc"]["ref_signal"];
-        ret.signal = (*jsonSignals)[refSignal];                                 // poor man's JSON pointer
-        if(ret.signal.empty()) {
+    const Json &cc = instruction["cc"];
+
+    // determine whether this is a readout instruction
+    ret.isReadout = QL_JSON_EXISTS(cc, "readout_mode");
+    if(ret.isReadout) {
+        ret.readoutMode = json_get<std::string>(cc, "readout_mode", instructionPath);
+    }
+
+    ret.isPragma = QL_JSON_EXISTS(cc, "pragma");
+    if(ret.isPragma) {
+        // FIXME: the only pragma possible is "break" for now
+        ret.pragma.breakVal = json_get<int>(cc["pragma"], "break", instructionPath+"/cc/pragma");
+    }
+
+    // find signal definition
+    Json signal;
+    std::string signalPath;
+    if (QL_JSON_EXISTS(cc, "ref_signal")) {                                     // optional syntax: "ref_signal"
+        std::string refSignal = cc["ref_signal"];
+        if(QL_JSON_EXISTS(*jsonSignals, refSignal)) {
+            signal = (*jsonSignals)[refSignal];                                 // poor man's JSON pointer
+        }
+        if(signal.empty()) {
             QL_JSON_FATAL(
             	"instruction '" << iname
             	<< "': ref_signal '" << refSignal
             	<< "' does not resolve"
 			);
         }
-        ret.path = "signals/"+refSignal;
+        signalPath = "signals/"+refSignal;
     } else {                                                                    // alternative syntax: "signal"
-        ret.signal = json_get<Json>(instruction["cc"], "signal", instructionPath + "/cc");
-        QL_DOUT("signal for '" << instruction << "': " << ret.signal);
-        ret.path = instructionPath+"/cc/signal";
+        signal = json_get<Json>(cc, "signal", instructionPath + "/cc");
+        QL_DOUT("signal for '" << instruction << "': " << signal);
+        signalPath = instructionPath+"/cc/signal";
+    }
+
+    // compile the signals
+    for(size_t s=0; s<signal.size(); s++) {
+        tSignalDef sd;
+        sd.path = QL_SS2S(signalPath<<"["<<s<<"]");                             // for JSON error reporting
+
+        // get the operand index to work on
+        sd.operandIdx = json_get<unsigned int>(signal[s], "operand_idx", sd.path);
+
+        // get signal value
+        const Json instructionSignalValue = json_get<const Json>(signal[s], "value", sd.path);   // NB: json_get<const Json&> unavailable
+        sd.valueSize = instructionSignalValue.size();
+        sd.value = QL_SS2S(instructionSignalValue);                             // serialize/stream instructionSignalValue into std::string
+        sd.value = replace_all(sd.value, "\"", "");                             // get rid of quotes
+        sd.value = replace_all(sd.value, "{gateName}", iname);                  // NB: other macros depend on the qubit, and are expanded by the code generator
+
+        // get instruction signal type (e.g. "mw", "flux", etc)
+        // NB: instructionSignalType is different from "instruction/type" provided by find_instruction_type, although some identical strings are used). NB: that key is no longer used by the 'core' of OpenQL
+        sd.type = json_get<std::string>(signal[s], "type", sd.path);
+        auto it = signalTypeIdxs.find(sd.type);
+        if(it == signalTypeIdxs.end()) {
+            it = signalTypeIdxs.emplace(sd.type, signalInfos.size()).first;
+            signalInfos.emplace_back();
+        }
+        sd.signalTypeIdx = it->second;
+
+        sd.staticCodewordOverride = NO_STATIC_CODEWORD_OVERRIDE;
+#if OPT_SUPPORT_STATIC_CODEWORDS
+        if(sd.valueSize != 0) {                                                 // empty implies no signal
+            // FIXME: this does not only provide support, but findStaticCodewordOverride() currently actually requires static codewords
+            sd.staticCodewordOverride = findStaticCodewordOverride(instruction, sd.operandIdx, iname);
+        }
+#endif
+        ret.signals.push_back(sd);
     }
     return ret;
 }
 
 
 // collect some configuration info for an instrument
-settings_cc::tInstrumentInfo settings_cc::getInstrumentInfo(size_t instrIdx) const
+settings_cc::tInstrumentInfo settings_cc::compileInstrumentInfo(size_t instrIdx) const
 {
-    tInstrumentInfo ret = {0};
+    tInstrumentInfo ret;
 
     std::string instrumentPath = QL_SS2S("instruments[" << instrIdx << "]");    // for JSON error reporting
     if(instrIdx >= jsonInstruments->size()) {
@@ -166,42 +191,70 @@ settings_cc::tInstrumentInfo settings_cc::getInstrumentInfo(size_t instrIdx) con
     // optional key 'instruments[]/force_cond_gates_on', can be used to always enable AWG if gate execution is controlled by VSM
     if(QL_JSON_EXISTS(*ret.instrument, "force_cond_gates_on")) {
         ret.forceCondGatesOn = json_get<bool>(*ret.instrument, "force_cond_gates_on", ret.instrumentName+"/force_cond_gates_on"); // key will exist, but type may be wrong
+    } else {
+        ret.forceCondGatesOn = false;
     }
 #endif
 
+    ret.signalType = json_get<std::string>(*ret.instrument, "signal_type", ret.instrumentName);
+    const Json qubits = json_get<const Json>(*ret.instrument, "qubits", ret.instrumentName);   // NB: json_get<const Json&> unavailable
+    for(size_t group=0; group<qubits.size(); group++) {
+        ret.qubits.emplace_back(qubits[group].begin(), qubits[group].end());
+    }
+
     return ret;
 }
 
 
-settings_cc::tInstrumentControl settings_cc::getInstrumentControl(size_t instrIdx) const
+// collect the control mode info for an instrument
+settings_cc::tInstrumentControl settings_cc::compileInstrumentControl(size_t instrIdx) const
 {
     tInstrumentControl ret;
 
-    ret.ii = getInstrumentInfo(instrIdx);
+    ret.ii = compileInstrumentInfo(instrIdx);
 
     // get control mode reference for for instrument
     ret.refControlMode = json_get<std::string>(*ret.ii.instrument, "ref_control_mode", ret.ii.instrumentName);
 
     // get control mode definition for our instrument
-    ret.controlMode = json_get<const Json>(*jsonControlModes, ret.refControlMode, "control_modes");
+    QL_JSON_ASSERT(*jsonControlModes, ret.refControlMode, "control_modes");
+    const Json &controlMode = (*jsonControlModes)[ret.refControlMode];
+
+    // get control bits per group, trigger bits and result bits per group (NB: empty on missing key)
+    if(QL_JSON_EXISTS(controlMode, "control_bits")) {
+        for(const Json &groupControlBits : controlMode["control_bits"]) {
+            ret.controlBits.emplace_back(groupControlBits.begin(), groupControlBits.end());
+        }
+    }
+    if(QL_JSON_EXISTS(controlMode, "trigger_bits")) {
+        const Json &triggerBits = controlMode["trigger_bits"];
+        ret.triggerBits.assign(triggerBits.begin(), triggerBits.end());
+    }
+    ret.hasResultBits = QL_JSON_EXISTS(controlMode, "result_bits");    // this instrument mode produces results (i.e. it is a measurement device)
+    if(ret.hasResultBits) {
+        for(const Json &groupResultBits : controlMode["result_bits"]) {
+            ret.resultBits.emplace_back(groupResultBits.begin(), groupResultBits.end());
+        }
+    }
 
-    // how many groups of control bits does the control mode specify (NB: 0 on missing key)
-    ret.controlModeGroupCnt = ret.controlMode["control_bits"].size();
+    // how many groups of control bits does the control mode specify
+    ret.controlModeGroupCnt = ret.controlBits.size();
 
 
 
     // get instrument definition reference for for instrument
     std::string refInstrumentDefinition = json_get<std::string>(*ret.ii.instrument, "ref_instrument_definition", ret.ii.instrumentName);
     // get instrument definition for our instrument
-    const Json instrumentDefinition = json_get<const Json>(*jsonInstrumentDefinitions, refInstrumentDefinition, "instrument_definitions");
+    QL_JSON_ASSERT(*jsonInstrumentDefinitions, refInstrumentDefinition, "instrument_definitions");
+    const Json &instrumentDefinition = (*jsonInstrumentDefinitions)[refInstrumentDefinition];
 
     // get number of channels of instrument
     int channels = json_get<int>(instrumentDefinition, "channels", refInstrumentDefinition);
     // calculate groups size (#channels) of control mode
-    ret.controlModeGroupSize = channels / ret.controlModeGroupCnt;  // FIXME: handle 0 div, and rounding
+    ret.controlModeGroupSize = ret.controlModeGroupCnt ? channels / ret.controlModeGroupCnt : 0;  // FIXME: handle rounding
 
     // verify that group size is allowed
-    const Json controlGroupSizes = json_get<const Json>(instrumentDefinition, "control_group_sizes", refInstrumentDefinition);
+    QL_JSON_ASSERT(instrumentDefinition, "control_group_sizes", refInstrumentDefinition);
     // FIXME: find channels
 
     // FIXME: unfinished: find channels
@@ -215,17 +268,16 @@ int settings_cc::getResultBit(const tInstrumentControl &ic, int group)
 {
 	// FIXME: test similar to settings_cc::getInstrumentControl, move
 	// check existence of key 'result_bits'
-	if (!QL_JSON_EXISTS(ic.controlMode, "result_bits")) {    	// this instrument mode produces results (i.e. it is a measurement device)
+	if (!ic.hasResultBits) {    	// this instrument mode produces results (i.e. it is a measurement device)
 		QL_JSON_FATAL("readout requested on instrument '" << ic.ii.instrumentName << "', but key '" << ic.refControlMode << "/result_bits is not present");
 	}
 
 	// check existence of key 'result_bits[group]'
-	const Json &groupResultBits = ic.controlMode["result_bits"][group];
-	size_t nrGroupResultBits = groupResultBits.size();
+	size_t nrGroupResultBits = (size_t)group < ic.resultBits.size() ? ic.resultBits[group].size() : 0;
 	if (nrGroupResultBits != 1) {                     		// single bit (NB: per group)
 		QL_JSON_FATAL("key '" << ic.refControlMode << "/result_bits[" << group << "] must have 1 bit instead of " << nrGroupResultBits);
 	}
-	return (int) groupResultBits[0];        				// bit on digital interface. NB: we assume the result is active high, which is correct for UHF-QC
+	return ic.resultBits[group][0];        				// bit on digital interface. NB: we assume the result is active high, which is correct for UHF-QC
 }
 
 
@@ -233,19 +285,25 @@ int settings_cc::getResultBit(const tInstrumentControl &ic, int group)
 // NB: this implies that we map signal *vectors* to groups, i.e. it is not possible to map individual channels
 // Conceptually, this is were we map an abstract signal definition, eg: {"flux", q3} (which may also be
 // interpreted as port "q3.flux") onto an instrument & group
-settings_cc::tSignalInfo settings_cc::findSignalInfoForQubit(const std::string &instructionSignalType, size_t qubit) const
+// The result is remembered in signalInfos, so the search is only performed once for every signal type and qubit
+const settings_cc::tSignalInfo &settings_cc::findSignalInfoForQubit(const tSignalDef &sd, size_t qubit)
 {
-    tSignalInfo ret;
+    Vec<tSignalInfo> &signalInfosOfType = signalInfos[sd.signalTypeIdx];
+    if(qubit < signalInfosOfType.size() && signalInfosOfType[qubit].ic) {
+        return signalInfosOfType[qubit];
+    }
+
+    const std::string &instructionSignalType = sd.type;
+    tSignalInfo ret = {nullptr, -1, -1};
     bool signalTypeFound = false;
     bool qubitFound = false;
 
     // iterate over instruments
-    for(size_t instrIdx=0; instrIdx<jsonInstruments->size() && !qubitFound; instrIdx++) {
-        tInstrumentControl ic = getInstrumentControl(instrIdx);
-        std::string instrumentSignalType = json_get<std::string>(*ic.ii.instrument, "signal_type", ic.ii.instrumentName);
-        if(instrumentSignalType == instructionSignalType) {
+    for(size_t instrIdx=0; instrIdx<instrumentControls.size() && !qubitFound; instrIdx++) {
+        const tInstrumentControl &ic = instrumentControls[instrIdx];
+        if(ic.ii.signalType == instructionSignalType) {
             signalTypeFound = true;
-            const Json qubits = json_get<const Json>(*ic.ii.instrument, "qubits", ic.ii.instrumentName);   // NB: json_get<const json&> unavailable
+            const Vec<Vec<int>> &qubits = ic.ii.qubits;
 
             // verify group size: qubits vs. control mode
             size_t qubitGroupCnt = qubits.size();                                  // NB: JSON key qubits is a 'matrix' of [groups*qubits]
@@ -261,7 +319,7 @@ settings_cc::tSignalInfo settings_cc::findSignalInfoForQubit(const std::string &
             // anyone connected to qubit?
             for(size_t group=0; group<qubitGroupCnt && !qubitFound; group++) {
                 for(size_t idx=0; idx<qubits[group].size() && !qubitFound; idx++) {
-                    if(qubits[group][idx] == qubit) {
+                    if(qubits[group][idx] >= 0 && (size_t)qubits[group][idx] == qubit) {
                         qubitFound = true;                                      // also: stop searching
 
                         QL_DOUT(
@@ -271,7 +329,7 @@ settings_cc::tSignalInfo settings_cc::findSignalInfoForQubit(const std::string &
 							<< "' group " << group
 						);
 
-                        ret.ic = ic;
+                        ret.ic = &ic;
                         ret.instrIdx = instrIdx;
                         ret.group = group;
                     }
@@ -286,7 +344,11 @@ settings_cc::tSignalInfo settings_cc::findSignalInfoForQubit(const std::string &
         QL_JSON_FATAL("No instruments found driving qubit " << qubit << " for signal type '" << instructionSignalType << "'");
     }
 
-    return ret;
+    if(qubit >= signalInfosOfType.size()) {
+        signalInfosOfType.resize(qubit+1, tSignalInfo{nullptr, -1, -1});
+    }
+    signalInfosOfType[qubit] = ret;
+    return signalInfosOfType[qubit];
 }
 
 /************************************************************************\
@@ -11,6 +11,10 @@
 #include "options_cc.h"
 #include "platform.h"
 #include "utils/json.h"
+#include "utils/vec.h"
+
+#include <map>
+#include <string>
 
 namespace ql {
 
@@ -20,9 +24,26 @@ class settings_cc
 {
 public: // types
     typedef struct {
-        Json signal;         		// a copy of the signal node found
         std::string path;           // path of the node, for reporting purposes
-    } tSignalDef;
+        unsigned int operandIdx;    // key 'operand_idx'
+        std::string type;           // key 'type', e.g. "mw", "flux"
+        size_t signalTypeIdx;       // index of type in the signal type table
+        size_t valueSize;           // number of elements of key 'value', 0 implies no signal
+        std::string value;          // key 'value' serialized, without quotes and with {gateName} expanded
+        int staticCodewordOverride; // key 'static_codeword_override' for operandIdx, if value is not empty
+    } tSignalDef;                   // one element of the signal vector of an instruction
+
+    typedef struct {
+        int breakVal;               // key 'break'
+    } tPragma;                      // information from key 'instructions/<iname>/cc/pragma'
+
+    typedef struct {
+        bool isReadout;             // key 'cc/readout_mode' exists
+        std::string readoutMode;    // key 'cc/readout_mode'
+        bool isPragma;              // key 'cc/pragma' exists
+        tPragma pragma;
+        Vec<tSignalDef> signals;    // key 'cc/signal', or key 'signals/<ref_signal>'
+    } tInstructionInfo;             // information from key 'instructions/<iname>/cc'
 
     typedef struct {
         const Json *instrument;
@@ -31,18 +52,23 @@ public: // types
 #if OPT_FEEDBACK
         bool forceCondGatesOn;      // optional key 'instruments[]/force_cond_gates_on', can be used to always enable AWG if gate execution is controlled by VSM
 #endif
+        std::string signalType;     // key 'instruments[]/signal_type'
+        Vec<Vec<int>> qubits;   // key 'instruments[]/qubits', a 'matrix' of [groups*qubits]
     } tInstrumentInfo;              // information from key 'instruments'
 
     typedef struct {
         tInstrumentInfo ii;
         std::string refControlMode;
-        Json controlMode;    // FIXME: pointer
         size_t controlModeGroupCnt; // number of groups in key 'control_bits' of effective control mode
         size_t controlModeGroupSize;// the size (#channels) of the effective control mode group
+        Vec<Vec<int>> controlBits;  // key 'control_bits' of effective control mode, per group
+        Vec<int> triggerBits;               // key 'trigger_bits' of effective control mode
+        bool hasResultBits;                         // key 'result_bits' of effective control mode exists
+        Vec<Vec<int>> resultBits;   // key 'result_bits' of effective control mode, per group
     } tInstrumentControl;           // information from key 'instruments/ref_control_mode'
 
     typedef struct {
-        tInstrumentControl ic;
+        const tInstrumentControl *ic;
         int instrIdx;               // the index into JSON "eqasm_backend_cc/instruments" that provides the signal
         int group;                  // the group of channels within the instrument that provides the signal
     } tSignalInfo;
@@ -54,24 +80,23 @@ public: // functions
     ~settings_cc() = default;
 
     void loadBackendSettings(const quantum_platform &platform);
-	std::string getReadoutMode(const std::string &iname);
-	bool isReadout(const std::string &iname);
-	bool isPragma(const std::string &iname);
-	const Json *getPragma(const std::string &iname);
+	const tInstructionInfo &getInstructionInfo(const std::string &iname);
 	int getReadoutWait();
-	tSignalDef findSignalDefinition(const Json &instruction, const std::string &iname) const;
-    tInstrumentInfo getInstrumentInfo(size_t instrIdx) const;
-    tInstrumentControl getInstrumentControl(size_t instrIdx) const;
+    const tInstrumentControl &getInstrumentControl(size_t instrIdx) const { return instrumentControls[instrIdx]; }
 	static int getResultBit(const tInstrumentControl &ic, int group) ;
 
-    // find instrument/group providing instructionSignalType for qubit
-    tSignalInfo findSignalInfoForQubit(const std::string &instructionSignalType, size_t qubit) const;
+    // find instrument/group providing the signal type of signal definition sd for qubit
+    const tSignalInfo &findSignalInfoForQubit(const tSignalDef &sd, size_t qubit);
 
     static int findStaticCodewordOverride(const Json &instruction, size_t operandIdx, const std::string &iname);
 
     // 'getters'
-    const Json &getInstrumentAtIdx(size_t instrIdx) const { return (*jsonInstruments)[instrIdx]; }
-    size_t getInstrumentsSize() const { return jsonInstruments->size(); }
+    size_t getInstrumentsSize() const { return instrumentControls.size(); }
+
+private:    // funcs
+    tInstrumentInfo compileInstrumentInfo(size_t instrIdx) const;
+    tInstrumentControl compileInstrumentControl(size_t instrIdx) const;
+    tInstructionInfo compileInstructionInfo(const std::string &iname);
 
 private:    // vars
 	const quantum_platform *platform;                           // remind platform
@@ -79,6 +104,12 @@ private:    // vars
     const Json *jsonControlModes;
     const Json *jsonInstruments;
     const Json *jsonSignals;
+
+    // tables compiled from the JSON, so code generation does not need to access it
+    Vec<tInstrumentControl> instrumentControls;         // vector[instrIdx]
+    std::map<std::string, tInstructionInfo> instructionInfos;   // compiled on first use of instruction
+    std::map<std::string, size_t> signalTypeIdxs;               // index of signal type in signalInfos
+    Vec<Vec<tSignalInfo>> signalInfos;          // matrix[signalTypeIdx][qubit], computed on first use
 }; // class
 
 } // namespace ql
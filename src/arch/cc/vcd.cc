@@ -11,21 +11,27 @@
 
 #include "vcd.h"
 
+#include "utils/exception.h"
+#include "utils/logger.h"
+
 #include <iostream>
 
 namespace ql {
 
-void Vcd::start()
+// NB: the VCD is written to out as it is generated, with lines terminated by
+// "\n" instead of std::endl, so out is not flushed for every line
+void Vcd::start(std::ostream &out)
 {
-    vcd << "$date today $end" << std::endl;
-    vcd << "$timescale 1 ns $end" << std::endl;
+    this->out = &out;
+    out << "$date today $end" << "\n";
+    out << "$timescale 1 ns $end" << "\n";
 }
 
 
 void Vcd::scope(tScopeType type, const std::string &name)
 {
     // FIXME: handle type
-    vcd << "$scope " << "module" << " " << name << " $end" << std::endl;
+    *out << "$scope " << "module" << " " << name << " $end" << "\n";
 }
 
 
@@ -34,38 +40,60 @@ int Vcd::registerVar(const std::string &name, tVarType type, tScopeType scope)
     // FIXME: incomplete
     const int width = 20;
 
-    vcd << "$var string " << width << " " << lastId << " " << name << " $end" << std::endl;
+    *out << "$var string " << width << " " << lastId << " " << name << " $end" << "\n";
 
     return lastId++;
 }
 
 void Vcd::upscope()
 {
-    vcd << "$upscope $end" << std::endl;
+    *out << "$upscope $end" << "\n";
+}
+
+
+void Vcd::flush(int timestamp)
+{
+    endDefinitions();
+    writeChanges(timestampMap.lower_bound(timestamp));
+    if(timestamp > flushedUntil) flushedUntil = timestamp;
 }
 
 
 void Vcd::finish()
 {
-    vcd << "$enddefinitions $end" << std::endl;
+    endDefinitions();
+    writeChanges(timestampMap.end());
+}
 
-    for(auto &t: timestampMap) {
-        vcd << "#" << t.first << std::endl;      // timestamp
-        for(auto &v: t.second) {
-            vcd << "s" << v.second.strVal << " " << v.first << std::endl;
-        }
+
+void Vcd::endDefinitions()
+{
+    if(!definitionsEnded) {
+        *out << "$enddefinitions $end" << "\n";
+        definitionsEnded = true;
     }
 }
 
 
-std::string Vcd::getVcd()
+// write and forget the changes before end
+void Vcd::writeChanges(tTimestampMap::iterator end)
 {
-    return vcd.str();
+    for(auto it = timestampMap.begin(); it != end; ++it) {
+        *out << "#" << it->first << "\n";      // timestamp
+        for(auto &v: it->second) {
+            *out << "s" << v.second.strVal << " " << v.first << "\n";
+        }
+    }
+    timestampMap.erase(timestampMap.begin(), end);
 }
 
 
 void Vcd::change(int var, int timestamp, const std::string &value)
 {
+    if(timestamp < flushedUntil) {
+        QL_FATAL("VCD change at time " << timestamp << " after changes up to time " << flushedUntil << " have been written");
+    }
+
     auto tsIt = timestampMap.find(timestamp);
     if(tsIt != timestampMap.end()) {    // timestamp found
         tVarChangeMap &vcm = tsIt->second;
@@ -9,7 +9,7 @@
 #pragma once
 
 #include <string>
-#include <sstream>
+#include <ostream>
 #include <map>
 
 namespace ql {
@@ -20,14 +20,14 @@ public:
     typedef enum { ST_MODULE } tScopeType;
 
 public:
-    void start();
+    void start(std::ostream &out);                      // NB: out must remain valid until finish()
     void scope(tScopeType type, const std::string &name);
     int registerVar(const std::string &name, tVarType type, tScopeType scope=ST_MODULE);
     void upscope();
     void change(int var, int timestamp, const std::string &value);
     void change(int var, int timestamp, int value);
+    void flush(int timestamp);                          // write the changes before timestamp, which may no longer be changed
     void finish();
-    std::string getVcd();
 
 private:
     typedef struct {
@@ -37,10 +37,16 @@ private:
     typedef std::map<int, tValue> tVarChangeMap;        // map variable 'id' to 'tValue'
     typedef std::map<int, tVarChangeMap> tTimestampMap; // map 'timestamp' to variables
 
+private:
+    void endDefinitions();
+    void writeChanges(tTimestampMap::iterator end);
+
 private:
     int lastId;
+    int flushedUntil = 0;                               // changes before this timestamp have been written
+    bool definitionsEnded = false;
     tTimestampMap timestampMap;
-    std::stringstream vcd;
+    std::ostream *out = nullptr;
 };
 
 } // namespace ql
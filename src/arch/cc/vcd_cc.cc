@@ -8,18 +8,22 @@
 
 #include "vcd_cc.h"
 #include "options.h"
-#include "utils/filesystem.h"
 
 namespace ql {
 
 // NB: parameters qubitNumber and cycleTime originate from OpenQL variable 'platform'
-void vcd_cc::programStart(size_t qubitNumber, int cycleTime, int maxGroups, const settings_cc &settings)
+void vcd_cc::programStart(const std::string &progName, size_t qubitNumber, int cycleTime, int maxGroups, const settings_cc &settings)
 {
     this->cycleTime = cycleTime;
     kernelStartTime = 0;
 
+    // open output file
+    std::string file_name(options::get("output_dir") + "/" + progName + ".vcd");
+    QL_IOUT("Writing Value Change Dump to " << file_name);
+    sink.emplace(file_name);
+
     // define header
-    vcd.start();
+    vcd.start(sink->stream());
 
     // define kernel variable
     vcd.scope(vcd.ST_MODULE, "kernel");
@@ -40,11 +44,9 @@ void vcd_cc::programStart(size_t qubitNumber, int cycleTime, int maxGroups, cons
     vcd.scope(vcd.ST_MODULE, "sd.signal");
     vcdVarSignal.assign(instrsUsed, std::vector<int>(maxGroups, {0}));
     for(size_t instrIdx=0; instrIdx<instrsUsed; instrIdx++) {
-        const utils::Json &instrument = settings.getInstrumentAtIdx(instrIdx);         // NB: always exists
-        std::string instrumentPath = QL_SS2S("instruments[" << instrIdx << "]");       // for JSON error reporting
-        std::string instrumentName = utils::json_get<std::string>(instrument, "name", instrumentPath);
-        const utils::Json qubits = utils::json_get<const utils::Json>(instrument, "qubits", instrumentPath);
-        for(size_t group=0; group<qubits.size(); group++) {
+        const settings_cc::tInstrumentInfo &ii = settings.getInstrumentControl(instrIdx).ii;
+        const std::string &instrumentName = ii.instrumentName;
+        for(size_t group=0; group<ii.qubits.size(); group++) {
             std::string name = instrumentName+"-"+std::to_string(group);
             vcdVarSignal[instrIdx][group] = vcd.registerVar(name, Vcd::VT_STRING);
         }
@@ -55,37 +57,44 @@ void vcd_cc::programStart(size_t qubitNumber, int cycleTime, int maxGroups, cons
     vcd.scope(vcd.ST_MODULE, "codewords");
     vcdVarCodeword.resize(qubitNumber);
     for(size_t instrIdx=0; instrIdx<instrsUsed; instrIdx++) {
-        const utils::Json &instrument = settings.getInstrumentAtIdx(instrIdx);         // NB: always exists
-        std::string instrumentPath = QL_SS2S("instruments[" << instrIdx << "]");       // for JSON error reporting
-        std::string instrumentName = utils::json_get<std::string>(instrument, "name", instrumentPath);
+        const std::string &instrumentName = settings.getInstrumentControl(instrIdx).ii.instrumentName;
         vcdVarCodeword[instrIdx] = vcd.registerVar(instrumentName, Vcd::VT_STRING);
     }
     vcd.upscope();
 }
 
 
-void vcd_cc::programFinish(const std::string &progName)
+void vcd_cc::programFinish()
 {
-    // generate VCD
+    // write remaining changes
     vcd.finish();
+    sink->close();
+}
 
-    // write VCD to file
-    std::string file_name(options::get("output_dir") + "/" + progName + ".vcd");
-    QL_IOUT("Writing Value Change Dump to " << file_name);
-    utils::OutFile(file_name).write(vcd.getVcd());
+
+void vcd_cc::kernelStart(const std::string &kernelName)
+{
+    vcd.change(vcdVarKernel, kernelStartTime, kernelName);          // start of kernel
 }
 
 
-void vcd_cc::kernelFinish(const std::string &kernelName, size_t durationInCycles)
+void vcd_cc::kernelFinish(size_t durationInCycles)
 {
     // NB: timing starts anew for every kernel
     unsigned int durationInNs = durationInCycles*cycleTime;
-    vcd.change(vcdVarKernel, kernelStartTime, kernelName);          // start of kernel
     vcd.change(vcdVarKernel, kernelStartTime + durationInNs, "");   // end of kernel
     kernelStartTime += durationInNs;
 }
 
 
+// NB: bundles are processed in order of startCycle, and no changes are made
+// before the start of the current bundle, so earlier changes can be written
+void vcd_cc::flushBefore(size_t startCycle)
+{
+    vcd.flush(kernelStartTime + startCycle*cycleTime);
+}
+
+
 void vcd_cc::bundleFinishGroup(size_t startCycle, unsigned int durationInCycles, uint32_t groupDigOut, const std::string &signalValue, int instrIdx, int group)
 {
     // generate signal output for group
@@ -11,6 +11,8 @@
 #include "vcd.h"
 #include "settings_cc.h"
 #include "utils/vec.h"
+#include "utils/opt.h"
+#include "utils/sink.h"
 
 namespace ql {
 
@@ -20,14 +22,17 @@ public:     // funcs
     vcd_cc() = default;
     ~vcd_cc() = default;
 
-    void programStart(size_t qubitNumber, int cycleTime, int maxGroups, const settings_cc &settings);
-    void programFinish(const std::string &progName);
-    void kernelFinish(const std::string &kernelName, size_t durationInCycles);
+    void programStart(const std::string &progName, size_t qubitNumber, int cycleTime, int maxGroups, const settings_cc &settings);
+    void programFinish();
+    void kernelStart(const std::string &kernelName);
+    void kernelFinish(size_t durationInCycles);
+    void flushBefore(size_t startCycle);
     void bundleFinishGroup(size_t startCycle, unsigned int durationInCycles, uint32_t groupDigOut, const std::string &signalValue, int instrIdx, int group);
     void bundleFinish(size_t startCycle, uint32_t digOut, size_t maxDurationInCycles, int instrIdx);
     void customGate(const std::string &iname, const utils::Vec<utils::UInt> &qops, size_t startCycle, size_t durationInCycles);
 
 private:    // vars
+    utils::Opt<utils::FileSink> sink;                       // the VCD is streamed to file while it is generated
     Vcd vcd;
     int cycleTime;
     unsigned int kernelStartTime;
@@ -11,176 +11,340 @@
 #include "buffer_insertion.h"
 #include "qsoverlay.h"
 #include "utils/filesystem.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 namespace arch {
 
 using namespace utils;
 
-UInt CurrSRegCount;
-UInt CurrTRegCount;
+// no register, or no further use
+static const UInt NONE = std::numeric_limits<UInt>::max();
+
+MaskRegisterFile::MaskRegisterFile(
+    const Str &instr,
+    const Str &prefix,
+    UInt size
+) :
+    instr(instr),
+    prefix(prefix),
+    size(size)
+{}
+
+UInt MaskRegisterFile::addMask(const Str &operand_text) {
+    operands.push_back(operand_text);
+    return operands.size() - 1;
+}
 
-Mask::Mask(const qubit_set_t &qs) : squbits(qs) {
-    if (CurrSRegCount < MAX_S_REG) {
-        regNo = CurrSRegCount++;
-        regName = "s" + to_string(regNo);
-    } else {
-        QL_COUT(" !!!! Handle cases requiring more registers");
+void MaskRegisterFile::addKernel() {
+    uses.emplace_back();
+}
+
+void MaskRegisterFile::addUse(UInt bundle, UInt mask) {
+    auto &kernel_uses = uses.back();
+    for (auto it = kernel_uses.rbegin(); it != kernel_uses.rend() && it->bundle == bundle; ++it) {
+        if (it->mask == mask) {
+            return;
+        }
     }
+    kernel_uses.push_back({bundle, mask, NONE});
 }
 
-Mask::Mask(const Str &rn, const qubit_set_t &qs) : regName(rn), squbits(qs) {
-    if (CurrSRegCount < MAX_S_REG) {
-        regNo = CurrSRegCount++;
-    } else {
-        QL_COUT(" !!!! Handle cases requiring more registers");
+void MaskRegisterFile::allocate() {
+    UInt nmasks = operands.size();
+    resident = Vec<UInt>(nmasks, NONE);
+    reloads = Vec<Map<Int, Str>>(uses.size());
+
+    // masks are added in order of first use, so when they all fit, the
+    // register of a mask is simply its index
+    if (nmasks <= size) {
+        for (UInt mask = 0; mask < nmasks; ++mask) {
+            resident[mask] = mask;
+        }
+        for (auto &kernel_uses : uses) {
+            for (auto &use : kernel_uses) {
+                use.reg = use.mask;
+            }
+        }
+        return;
+    }
+
+    // count the uses of each mask, and the number of masks a bundle needs at
+    // the same time
+    Vec<UInt> count(nmasks, 0);
+    UInt demand = 0;
+    for (const auto &kernel_uses : uses) {
+        UInt bundle_start = 0;
+        for (UInt i = 0; i < kernel_uses.size(); ++i) {
+            if (kernel_uses[i].bundle != kernel_uses[bundle_start].bundle) {
+                bundle_start = i;
+            }
+            demand = std::max(demand, i - bundle_start + 1);
+            count[kernel_uses[i].mask]++;
+        }
+    }
+    if (demand > size) {
+        QL_FATAL("a bundle needs " << demand << " different " << instr << " masks, but there are only "
+                 << size << " " << prefix << " registers");
+    }
+
+    // the most used masks get a register of their own, set in the prologue;
+    // the remaining registers are shared by the others
+    Vec<UInt> used;
+    for (UInt mask = 0; mask < nmasks; ++mask) {
+        if (count[mask] > 0) {
+            used.push_back(mask);
+        }
+    }
+    std::stable_sort(used.begin(), used.end(), [&count](UInt a, UInt b) {
+        return count[a] > count[b];
+    });
+    UInt nresident = used.size() <= size ? used.size() : size - demand;
+    for (UInt i = 0; i < nresident; ++i) {
+        resident[used[i]] = 0;
+    }
+    UInt reg = 0;
+    for (UInt mask = 0; mask < nmasks; ++mask) {
+        if (resident[mask] != NONE) {
+            resident[mask] = reg++;
+        }
+    }
+    QL_DOUT("allocated " << nresident << " resident " << instr << " masks out of " << used.size());
+
+    for (UInt kernel = 0; kernel < uses.size(); ++kernel) {
+        allocateKernel(kernel, nresident);
     }
 }
 
-Mask::Mask(const qubit_pair_set_t &qps) : dqubits(qps) {
-    if (CurrTRegCount < MAX_T_REG) {
-        regNo = CurrTRegCount++;
-        regName = "t" + to_string(regNo);
-    } else {
-        QL_COUT(" !!!! Handle cases requiring more registers");
+void MaskRegisterFile::allocateKernel(UInt kernel, UInt first_dynamic) {
+    auto &kernel_uses = uses[kernel];
+    UInt nuses = kernel_uses.size();
+
+    // for each use, the bundle of the next use of the same mask
+    Vec<UInt> next_use(nuses, NONE);
+    Map<UInt, UInt> upcoming;
+    for (UInt i = nuses; i-- > 0; ) {
+        auto it = upcoming.find(kernel_uses[i].mask);
+        if (it != upcoming.end()) {
+            next_use[i] = it->second;
+        }
+        upcoming.set(kernel_uses[i].mask) = kernel_uses[i].bundle;
+    }
+
+    // state of the shared registers; nothing is known about them at the
+    // start of a kernel
+    UInt ndynamic = size - first_dynamic;
+    Vec<UInt> held(ndynamic, NONE);         // mask in the register
+    Vec<UInt> held_next_use(ndynamic, NONE); // bundle that uses that mask next
+    Vec<Int> last_use(ndynamic, -1);         // last bundle that used the register
+
+    UInt bundle_start = 0;
+    while (bundle_start < nuses) {
+        Int bundle = kernel_uses[bundle_start].bundle;
+        UInt bundle_end = bundle_start;
+        while (bundle_end < nuses && (Int)kernel_uses[bundle_end].bundle == bundle) {
+            bundle_end++;
+        }
+
+        // first the masks that are in a register already, so that those
+        // are not evicted by the others of the bundle
+        for (UInt i = bundle_start; i < bundle_end; ++i) {
+            auto &use = kernel_uses[i];
+            if (resident[use.mask] != NONE) {
+                use.reg = resident[use.mask];
+                continue;
+            }
+            for (UInt r = 0; r < ndynamic; ++r) {
+                if (held[r] == use.mask) {
+                    use.reg = first_dynamic + r;
+                    held_next_use[r] = next_use[i];
+                    last_use[r] = bundle;
+                    break;
+                }
+            }
+        }
+
+        // then load the others, into an empty register or else into the one
+        // whose mask is used furthest in the future; the reload is placed
+        // right after the bundle that used the register last
+        for (UInt i = bundle_start; i < bundle_end; ++i) {
+            auto &use = kernel_uses[i];
+            if (use.reg != NONE) {
+                continue;
+            }
+            UInt victim = NONE;
+            for (UInt r = 0; r < ndynamic; ++r) {
+                if (held[r] == NONE) {
+                    victim = r;
+                    break;
+                }
+                if (last_use[r] != bundle && (victim == NONE || held_next_use[r] > held_next_use[victim])) {
+                    victim = r;
+                }
+            }
+            QL_ASSERT(victim != NONE);
+            use.reg = first_dynamic + victim;
+            reloads[kernel].set(last_use[victim]) +=
+                "    " + instr + " " + prefix + to_string(use.reg) + ", " + operands[use.mask] + "\n";
+            held[victim] = use.mask;
+            held_next_use[victim] = next_use[i];
+            last_use[victim] = bundle;
+        }
+
+        bundle_start = bundle_end;
+    }
+}
+
+Str MaskRegisterFile::getRegName(UInt kernel, UInt bundle, UInt mask) const {
+    const auto &kernel_uses = uses[kernel];
+    auto it = std::lower_bound(
+        kernel_uses.begin(), kernel_uses.end(), bundle,
+        [](const Use &use, UInt b) { return use.bundle < b; }
+    );
+    for (; it != kernel_uses.end() && it->bundle == bundle; ++it) {
+        if (it->mask == mask) {
+            return prefix + to_string(it->reg);
+        }
     }
+    QL_FATAL("no " << prefix << " register allocated for mask " << operands[mask] << " in bundle " << bundle);
 }
 
-MaskManager::MaskManager() {
+void MaskRegisterFile::writeMaskInstructions(StrStrm &ss) const {
+    Vec<UInt> reg2mask(size, NONE);
+    for (UInt mask = 0; mask < resident.size(); ++mask) {
+        if (resident[mask] != NONE) {
+            reg2mask[resident[mask]] = mask;
+        }
+    }
+    for (UInt r = 0; r < size; ++r) {
+        if (reg2mask[r] != NONE) {
+            ss << instr << " " << prefix << r << ", " << operands[reg2mask[r]] << " " << std::endl;
+        }
+    }
+}
+
+void MaskRegisterFile::writeReloadInstructions(StrStrm &ss, UInt kernel, Int bundle) const {
+    auto it = reloads[kernel].find(bundle);
+    if (it != reloads[kernel].end()) {
+        ss << it->second;
+    }
+}
+
+MaskManager::MaskManager() :
+    sregs("smis", "s", MAX_S_REG),
+    tregs("smit", "t", MAX_T_REG)
+{
     // add pre-defined smis
     for (UInt i = 0; i < 7; ++i) {
         qubit_set_t qs;
         qs.push_back(i);
-        Mask m(qs);
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
+        getMask(qs);
     }
 
     // add some common single qubit masks
     {
         qubit_set_t qs;
         for(auto i=0; i<7; i++) qs.push_back(i);
-        Mask m(qs); // TODO add proper support for:  Mask m(qs, "all_qubits");
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
+        getMask(qs); // TODO add proper support for:  Mask m(qs, "all_qubits");
     }
 
     {
         qubit_set_t qs;
         qs.push_back(0); qs.push_back(1); qs.push_back(5); qs.push_back(6);
-        Mask m(qs); // TODO add proper support for:  Mask m(qs, "data_qubits");
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
+        getMask(qs); // TODO add proper support for:  Mask m(qs, "data_qubits");
     }
 
     {
         qubit_set_t qs;
         qs.push_back(2); qs.push_back(3); qs.push_back(4);
-        Mask m(qs); // TODO add proper support for:  Mask m(qs, "ancilla_qubits");
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
+        getMask(qs); // TODO add proper support for:  Mask m(qs, "ancilla_qubits");
     }
-
-    // qubit_pair_set_t pre_defined_edges = { {2,0}, {0,3}, {3,1}, {1,4}, {2,5}, {5,3}, {3,6}, {6,4},
-    //                                {0,2}, {3,0}, {1,3}, {4,1}, {5,2}, {3,5}, {6,3}, {4,6} };
-    // // add smit
-    // for(auto & p : pre_defined_edges)
-    // {
-    //     qubit_pair_set_t qps;
-    //     qps.push_back(p);
-    //     Mask m(qps);
-    //     QPS2Mask[qps] = m;
-    //     TReg2Mask[m.regNo] = m;
-    // }
-
 }
 
-MaskManager::~MaskManager() {
-    CurrSRegCount=0;
-    CurrTRegCount=0;
-}
-
-UInt MaskManager::getRegNo(qubit_set_t &qs) {
+UInt MaskManager::getMask(qubit_set_t &qs) {
     // sort qubit operands to avoid variation in order
     sort(qs.begin(), qs.end());
 
     auto it = QS2Mask.find(qs);
-    if (it == QS2Mask.end()) {
-        Mask m(qs);
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
+    if (it != QS2Mask.end()) {
+        return it->second;
     }
-    return QS2Mask.at(qs).regNo;
+    StrStrm operands;
+    operands << "{";
+    for (auto q = qs.begin(); q != qs.end(); ++q) {
+        operands << *q;
+        if (std::next(q) != qs.end()) {
+            operands << ", ";
+        }
+    }
+    operands << "}";
+    UInt mask = sregs.addMask(operands.str());
+    QS2Mask.set(qs) = mask;
+    return mask;
 }
 
-UInt MaskManager::getRegNo(qubit_pair_set_t &qps) {
+UInt MaskManager::getMask(qubit_pair_set_t &qps) {
     // sort qubit operands pair to avoid variation in order
     sort(qps.begin(), qps.end());
 
     auto it = QPS2Mask.find(qps);
-    if (it == QPS2Mask.end()) {
-        Mask m(qps);
-        QPS2Mask.set(qps) = m;
-        TReg2Mask.set(m.regNo) = m;
+    if (it != QPS2Mask.end()) {
+        return it->second;
     }
-    return QPS2Mask.at(qps).regNo;
+    StrStrm operands;
+    operands << "{";
+    for (auto p = qps.begin(); p != qps.end(); ++p) {
+        operands << "(" << p->first << ", " << p->second << ")";
+        if (std::next(p) != qps.end()) {
+            operands << ", ";
+        }
+    }
+    operands << "}";
+    UInt mask = tregs.addMask(operands.str());
+    QPS2Mask.set(qps) = mask;
+    return mask;
 }
 
-Str MaskManager::getRegName(qubit_set_t &qs) {
-    // sort qubit operands to avoid variation in order
-    sort(qs.begin(), qs.end());
+void MaskManager::addKernel() {
+    sregs.addKernel();
+    tregs.addKernel();
+}
 
-    auto it = QS2Mask.find(qs);
-    if (it == QS2Mask.end()) {
-        Mask m(qs);
-        QS2Mask.set(qs) = m;
-        SReg2Mask.set(m.regNo) = m;
-    }
-    return QS2Mask.at(qs).regName;
+void MaskManager::addUse(UInt bundle, qubit_set_t &qs) {
+    sregs.addUse(bundle, getMask(qs));
 }
 
-Str MaskManager::getRegName(qubit_pair_set_t &qps) {
-    // sort qubit operands pair to avoid variation in order
-    sort(qps.begin(), qps.end());
+void MaskManager::addUse(UInt bundle, qubit_pair_set_t &qps) {
+    tregs.addUse(bundle, getMask(qps));
+}
 
-    auto it = QPS2Mask.find(qps);
-    if (it == QPS2Mask.end()) {
-        Mask m(qps);
-        QPS2Mask.set(qps) = m;
-        TReg2Mask.set(m.regNo) = m;
-    }
-    return QPS2Mask.at(qps).regName;
+void MaskManager::allocate() {
+    sregs.allocate();
+    tregs.allocate();
 }
 
-Str MaskManager::getMaskInstructions() {
-    StrStrm ssmasks;
-    for (UInt r = 0; r < CurrSRegCount; ++r) {
-        auto &m = SReg2Mask.at(r);
-        ssmasks << "smis " << m.regName << ", {";
-        for (auto it = m.squbits.begin(); it != m.squbits.end(); ++it) {
-            ssmasks << *it;
-            if (std::next(it) != m.squbits.end()) {
-                ssmasks << ", ";
-            }
-        }
-        ssmasks << "} " << std::endl;
-    }
+Str MaskManager::getRegName(UInt kernel, UInt bundle, qubit_set_t &qs) {
+    return sregs.getRegName(kernel, bundle, getMask(qs));
+}
 
-    for (UInt r = 0; r < CurrTRegCount; ++r) {
-        auto &m = TReg2Mask.at(r);
-        ssmasks << "smit " << m.regName << ", {";
-        for (auto it = m.dqubits.begin(); it != m.dqubits.end(); ++it) {
-            ssmasks << "(" << it->first << ", " << it->second << ")";
-            if (std::next(it) != m.dqubits.end()) {
-                ssmasks << ", ";
-            }
-        }
-        ssmasks << "} " << std::endl;
-    }
+Str MaskManager::getRegName(UInt kernel, UInt bundle, qubit_pair_set_t &qps) {
+    return tregs.getRegName(kernel, bundle, getMask(qps));
+}
 
+Str MaskManager::getMaskInstructions() const {
+    StrStrm ssmasks;
+    sregs.writeMaskInstructions(ssmasks);
+    tregs.writeMaskInstructions(ssmasks);
     return ssmasks.str();
 }
 
+Str MaskManager::getReloadInstructions(UInt kernel, Int bundle) const {
+    StrStrm ssreloads;
+    sregs.writeReloadInstructions(ssreloads, kernel, bundle);
+    tregs.writeReloadInstructions(ssreloads, kernel, bundle);
+    return ssreloads.str();
+}
+
 classical_cc::classical_cc(
     const Str &operation,
     const Vec<UInt> &opers,
@@ -230,25 +394,24 @@ classical_cc::classical_cc(
     QL_DOUT("adding classical_cc [DONE]");
 }
 
-instruction_t classical_cc::qasm() const {
-    Str iopers;
-    Int sz = creg_operands.size();
-    for (Int i = 0; i < sz; ++i) {
-        if (i == sz - 1) {
-            iopers += " r" + to_string(creg_operands[i]);
-        } else {
-            iopers += " r" + to_string(creg_operands[i]) + ",";
-        }
+void classical_cc::format_qasm(Str &buffer) const {
+    if (name == "fmr") {
+        buffer += name;
+        buffer += " r";
+        append_uint(buffer, creg_operands[0]);
+        buffer += ", q";
+        append_uint(buffer, operands[0]);
+        return;
     }
 
+    buffer += name;
+    for (UInt i = 0; i < creg_operands.size(); ++i) {
+        buffer += (i == 0) ? " r" : ", r";
+        append_uint(buffer, creg_operands[i]);
+    }
     if (name == "ldi") {
-        iopers += ", " + to_string(int_operand);
-        return "ldi" + iopers;
-    } else if (name == "fmr") {
-        return name + " r" + to_string(creg_operands[0]) +
-               ", q" + to_string(operands[0]);
-    } else {
-        return name + iopers;
+        buffer += ", ";
+        append_int(buffer, int_operand);
     }
 }
 
@@ -313,8 +476,8 @@ Str get_cc_light_instruction_name(
     const quantum_platform &platform
 ) {
     Str cc_light_instr_name;
-    auto it = platform.instruction_map.find(id);
-    if (it != platform.instruction_map.end()) {
+    auto it = platform.instruction_map->find(id);
+    if (it != platform.instruction_map->end()) {
         custom_gate* g = it->second;
         cc_light_instr_name = g->arch_operation_name;
         if (cc_light_instr_name.empty()) {
@@ -327,13 +490,12 @@ Str get_cc_light_instruction_name(
     return cc_light_instr_name;
 }
 
-Str ir2qisa(
+// bundles the circuit of a kernel, such that the instructions of each section
+// of a bundle can be combined into one SIMD instruction
+ir::bundles_t ir2bundles(
     quantum_kernel &kernel,
-    const quantum_platform &platform,
-    MaskManager &gMaskManager
+    const quantum_platform &platform
 ) {
-    QL_IOUT("Generating CC-Light QISA");
-
     ir::bundles_t bundles1;
     QL_ASSERT(kernel.cycles_valid);
     bundles1 = ir::bundler(kernel.c, platform.cycle_time);
@@ -414,6 +576,62 @@ Str ir2qisa(
         );
     }
 
+    return bundles2;
+}
+
+// collects the operands of the instructions of a section into the mask of the
+// SIMD they will become; returns the number of operands of each instruction,
+// or 0 when the section needs no mask
+static UInt get_section_mask(
+    const ir::section_t &section,
+    qubit_set_t &squbits,
+    qubit_pair_set_t &dqubits
+) {
+    auto itype = section.front()->type();
+    if (itype == __classical_gate__ || itype == __nop_gate__) {
+        return 0;
+    }
+    auto nOperands = section.front()->operands.size();
+    for (auto ins : section) {
+        if (nOperands == 1) {
+            squbits.push_back(ins->operands[0]);
+        } else if (nOperands == 2) {
+            dqubits.push_back(qubit_pair_t(ins->operands[0], ins->operands[1]));
+        } else {
+            throw Exception("Error : only 1 and 2 operand instructions are supported by cc light masks !", false);
+        }
+    }
+    return nOperands;
+}
+
+// adds the masks used by the bundles of a kernel to the mask manager, for
+// allocation before any qisa is generated
+void add_mask_uses(const ir::bundles_t &bundles, MaskManager &mask_manager) {
+    mask_manager.addKernel();
+    UInt bundle_index = 0;
+    for (const ir::bundle_t &abundle : bundles) {
+        for (const auto &sec : abundle.parallel_sections) {
+            qubit_set_t squbits;
+            qubit_pair_set_t dqubits;
+            auto nOperands = get_section_mask(sec, squbits, dqubits);
+            if (nOperands == 1) {
+                mask_manager.addUse(bundle_index, squbits);
+            } else if (nOperands == 2) {
+                mask_manager.addUse(bundle_index, dqubits);
+            }
+        }
+        bundle_index++;
+    }
+}
+
+Str ir2qisa(
+    const ir::bundles_t &bundles,
+    const quantum_platform &platform,
+    MaskManager &mask_manager,
+    UInt kernel_index
+) {
+    QL_IOUT("Generating CC-Light QISA");
+
     // And now generate qisa
     // each section of a bundle will become a SIMD (all operations in a section are the same, see above)
     // for the operands of the SIMD, a mask will be used
@@ -421,7 +639,9 @@ Str ir2qisa(
     // kernel prologue (start label) and epilogue are generated by the caller or ir2qisa
     StrStrm ssqisa;   // output qisa in here
     UInt curr_cycle = 0; // first instruction should be with pre-interval 1, 'bs 1' FIXME HvS start in cycle 0
-    for (ir::bundle_t &abundle : bundles2) {
+    UInt bundle_index = 0;
+    ssqisa << mask_manager.getReloadInstructions(kernel_index, -1);
+    for (const ir::bundle_t &abundle : bundles) {
         Str iname;
         StrStrm sspre, ssinst;
         auto bcycle = abundle.start_cycle;
@@ -447,30 +667,14 @@ Str ir2qisa(
             } else {
                 QL_DOUT("get cclight instr name for : " << iname);
                 Str cc_light_instr_name = get_cc_light_instruction_name(iname, platform);
-                auto nOperands = ((*firstInsIt)->operands).size();
                 if (itype == __nop_gate__) {
                     ssinst << cc_light_instr_name;
                 } else {
-                    for (auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt) {
-                        if (nOperands == 1) {
-                            auto &op = (*insIt)->operands[0];
-                            squbits.push_back(op);
-                        } else if (nOperands == 2) {
-                            auto &op1 = (*insIt)->operands[0];
-                            auto &op2 = (*insIt)->operands[1];
-                            dqubits.push_back(qubit_pair_t(op1, op2));
-                        } else {
-                            throw Exception("Error : only 1 and 2 operand instructions are supported by cc light masks !", false);
-                        }
-                    }
-
                     Str rname;
-                    if (nOperands == 1) {
-                        rname = gMaskManager.getRegName(squbits);
-                    } else if (nOperands == 2) {
-                        rname = gMaskManager.getRegName(dqubits);
+                    if (get_section_mask(*secIt, squbits, dqubits) == 1) {
+                        rname = mask_manager.getRegName(kernel_index, bundle_index, squbits);
                     } else {
-                        throw Exception("Error : only 1 and 2 operand instructions are supported by cc light masks !", false);
+                        rname = mask_manager.getRegName(kernel_index, bundle_index, dqubits);
                     }
 
                     ssinst << cc_light_instr_name << " " << rname;
@@ -503,10 +707,12 @@ Str ir2qisa(
             // ssqisa << sspre.str() << ssinst.str() << "\t\t# @" << bcycle << std::endl;
             ssqisa << sspre.str() << ssinst.str() << std::endl;
         }
+        ssqisa << mask_manager.getReloadInstructions(kernel_index, bundle_index);
         curr_cycle+=delta;
+        bundle_index++;
     }
 
-    auto & lastBundle = bundles2.back();
+    auto & lastBundle = bundles.back();
     Int lbduration = lastBundle.duration_in_cycles;
     if (lbduration > 1) {
         ssqisa << "    qwait " << lbduration << std::endl;
@@ -610,9 +816,9 @@ void cc_light_eqasm_compiler::ccl_decompose_pre_schedule(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    for (auto &kernel : programp->kernels) {
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
         ccl_decompose_pre_schedule_kernel(kernel, platform);
-    }
+    });
 
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
@@ -626,23 +832,24 @@ void cc_light_eqasm_compiler::ccl_decompose_post_schedule(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    for (auto &kernel : programp->kernels) {
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
         QL_IOUT("Decomposing meta-instructions kernel after post-scheduling: " << kernel.name);
         if (!kernel.c.empty()) {
             QL_ASSERT(kernel.cycles_valid);
             ir::bundles_t bundles = ir::bundler(kernel.c, platform.cycle_time);
-            ccl_decompose_post_schedule_bundles(bundles, platform);
+            ccl_decompose_post_schedule_bundles(bundles, platform, *kernel.arena);
             kernel.c = ir::circuiter(bundles);
             QL_ASSERT(kernel.cycles_valid);
         }
-    }
+    });
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
 }
 
 void cc_light_eqasm_compiler::ccl_decompose_post_schedule_bundles(
     ir::bundles_t &bundles_dst,
-    const quantum_platform &platform
+    const quantum_platform &platform,
+    Arena &arena
 ) {
     auto bundles_src = bundles_dst;
 
@@ -698,8 +905,8 @@ void cc_light_eqasm_compiler::ccl_decompose_post_schedule_bundles(
                     Str operation_type{};
                     UInt nOperands = ((*ins_src_it)->operands).size();
                     if (nOperands == 2) {
-                        auto it = platform.instruction_map.find(id);
-                        if (it != platform.instruction_map.end()) {
+                        auto it = platform.instruction_map->find(id);
+                        if (it != platform.instruction_map->end()) {
                             if (platform.instruction_settings[id].count("type") > 0) {
                                 operation_type = platform.instruction_settings[id]["type"].get<Str>();
                             }
@@ -719,7 +926,7 @@ void cc_light_eqasm_compiler::ccl_decompose_post_schedule_bundles(
                                 QL_DOUT("add the following sqf gates for edge: " << edge_no << ":");
                                 for (auto &q : edge_detunes_qubits.get(edge_no)) {
                                     QL_DOUT("sqf q" << q);
-                                    custom_gate *g = new custom_gate("sqf q"+to_string(q));
+                                    custom_gate *g = arena.make<custom_gate>("sqf q"+to_string(q));
                                     g->operands.push_back(q);
 
                                     ir::section_t asec;
@@ -751,15 +958,16 @@ void cc_light_eqasm_compiler::map(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    mapper::Mapper mapper;  // virgin mapper creation; for role of Init functions, see comment at top of mapper.h
-    mapper.Init(&platform); // platform specifies number of real qubits, i.e. locations for virtual qubits
-
     auto rf = ReportFile(programp, "out", passname);
 
-    UInt total_swaps = 0;        // for reporting, data is mapper specific
-    UInt total_moves = 0;        // for reporting, data is mapper specific
-    Real total_timetaken = 0.0;  // total over kernels of time taken by mapper
-    for (auto &kernel : programp->kernels) {
+    // per kernel statistics, collected while the kernels are mapped, possibly in parallel,
+    // and reported afterwards in kernel order
+    UInt nkernels = programp->kernels.size();
+    Vec<Str> kernel_stats(nkernels);
+    Vec<UInt> kernel_swaps(nkernels);
+    Vec<UInt> kernel_moves(nkernels);
+    Vec<Real> kernel_timetaken(nkernels);
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt k) {
         QL_IOUT("Mapping kernel: " << kernel.name);
 
         // compute timetaken, start interval timer here
@@ -767,11 +975,13 @@ void cc_light_eqasm_compiler::map(
         using namespace std::chrono;
         high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
+        // each kernel gets its own mapper so that kernels can be mapped in parallel,
+        // and so that a seeded random tie break doesn't depend on the order of mapping the kernels
+        mapper::Mapper mapper;  // virgin mapper creation; for role of Init functions, see comment at top of mapper.h
+        mapper.Init(&platform); // platform specifies number of real qubits, i.e. locations for virtual qubits
         mapper.Map(kernel);
         // kernel.qubit_count starts off as number of virtual qubits, i.e. highest indexed qubit minus 1
         // kernel.qubit_count is updated by Map to highest index of real qubits used minus -1
-        programp->qubit_count = platform.qubit_number;
-        // program.qubit_count is updated to platform.qubit_number
 
         // computing timetaken, stop interval timer
         high_resolution_clock::time_point t2 = high_resolution_clock::now();
@@ -783,18 +993,38 @@ void cc_light_eqasm_compiler::map(
         ss << "# ----- swaps added: " << mapper.nswapsadded << std::endl;
         ss << "# ----- of which moves added: " << mapper.nmovesadded << std::endl;
         ss << "# ----- virt2real map before mapper:" << mapper.v2r_in << std::endl;
+        if (!mapper.ipresult.empty()) {
+            ss << "# ----- initial placement: " << mapper.ipresult;
+            if (mapper.ipresult != "failed" && mapper.ipresult != "timedout") {
+                ss << " with cost " << mapper.ipcost;
+            }
+            ss << ", time taken: " << mapper.iptimetaken << std::endl;
+        }
         ss << "# ----- virt2real map after initial placement:" << mapper.v2r_ip << std::endl;
         ss << "# ----- virt2real map after mapper:" << mapper.v2r_out << std::endl;
         ss << "# ----- realqubit states before mapper:" << mapper.rs_in << std::endl;
         ss << "# ----- realqubit states after mapper:" << mapper.rs_out << std::endl;
         ss << "# ----- time taken: " << timetaken << std::endl;
-        rf << ss.str();
 
-        total_swaps += mapper.nswapsadded;
-        total_moves += mapper.nmovesadded;
-        total_timetaken += timetaken;
+        kernel_stats[k] = ss.str();
+        kernel_swaps[k] = mapper.nswapsadded;
+        kernel_moves[k] = mapper.nmovesadded;
+        kernel_timetaken[k] = timetaken;
+    });
+    programp->qubit_count = platform.qubit_number;
+    // program.qubit_count is updated to platform.qubit_number
+
+    UInt total_swaps = 0;        // for reporting, data is mapper specific
+    UInt total_moves = 0;        // for reporting, data is mapper specific
+    Real total_timetaken = 0.0;  // total over kernels of time taken by mapper
+    for (UInt k = 0; k < nkernels; k++) {
+        rf << kernel_stats[k];
+
+        total_swaps += kernel_swaps[k];
+        total_moves += kernel_moves[k];
+        total_timetaken += kernel_timetaken[k];
 
-        *mapStatistics += ss.str();
+        *mapStatistics += kernel_stats[k];
     }
     StrStrm ss;
     report_totals_statistics(ss, programp->kernels, platform, "# ");
@@ -883,6 +1113,9 @@ void cc_light_eqasm_compiler::compile(quantum_program *programp, const quantum_p
     using namespace std::chrono;
     high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
+    // the kernel-local passes below share one pool of threads when compile_threads > 1
+    ParallelKernelsScope parallel_kernels;
+
     // see comment with definition
     // could also be in back-end constructor, or even be deleted
     ccl_prep_code_generation(programp, platform, "ccl_prep_code_generation");
@@ -973,29 +1206,29 @@ void cc_light_eqasm_compiler::ccl_decompose_pre_schedule_kernel(
                 (iname == "not") || (iname == "nop")
             ) {
                 // decomp_ckt.push_back(ins);
-                decomp_ckt.push_back(new classical_cc(iname, icopers));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>(iname, icopers));
                 QL_DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
             } else if (
                 (iname == "eq") || (iname == "ne") || (iname == "lt") ||
                 (iname == "gt") || (iname == "le") || (iname == "ge")
             ) {
-                decomp_ckt.push_back(new classical_cc("cmp", {icopers[1], icopers[2]}));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("cmp", Vec<UInt>{icopers[1], icopers[2]}));
                 QL_DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
-                decomp_ckt.push_back(new classical_cc("nop", {}));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("nop", Vec<UInt>{}));
                 QL_DOUT("                                      " << decomp_ckt.back()->qasm());
-                decomp_ckt.push_back(new classical_cc("fbr_"+iname, {icopers[0]}));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("fbr_"+iname, Vec<UInt>{icopers[0]}));
                 QL_DOUT("                                      " << decomp_ckt.back()->qasm());
             } else if (iname == "mov") {
                 // r28 is used as temp, TODO use creg properly to create temporary
-                decomp_ckt.push_back(new classical_cc("ldi", {28}, 0));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("ldi", Vec<UInt>{28}, 0));
                 QL_DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
-                decomp_ckt.push_back(new classical_cc("add", {icopers[0], icopers[1], 28}));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("add", Vec<UInt>{icopers[0], icopers[1], 28}));
                 QL_DOUT("                                      " << decomp_ckt.back()->qasm());
             } else if (iname == "ldi") {
                 // auto imval = ((classical_cc*)ins)->int_operand;
                 auto imval = ((classical*)ins)->int_operand;
                 QL_DOUT("    classical instruction decomposed: imval=" << imval);
-                decomp_ckt.push_back(new classical_cc("ldi", {icopers[0]}, imval));
+                decomp_ckt.push_back(kernel.arena->make<classical_cc>("ldi", Vec<UInt>{icopers[0]}, imval));
                 QL_DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
             } else {
                 QL_EOUT("Unknown decomposition of classical operation '" << iname << "' with '" << icopers_count << "' operands!");
@@ -1024,7 +1257,7 @@ void cc_light_eqasm_compiler::ccl_decompose_pre_schedule_kernel(
                         auto &coperands = ins->creg_operands;
                         if (!coperands.empty()) {
                             auto cop = coperands[0];
-                            decomp_ckt.push_back(new classical_cc("fmr", {cop, qop}));
+                            decomp_ckt.push_back(kernel.arena->make<classical_cc>("fmr", Vec<UInt>{cop, qop}));
                         } else {
                             // WOUT("Unknown classical operand for measure/readout operation: '" << iname <<
                             //     ". This will soon be depricated in favour of measure instruction with fmr" <<
@@ -1054,14 +1287,27 @@ void cc_light_eqasm_compiler::qisa_code_generation(
     const Str &passname
 ) {
     (void)passname;
+    // the mask registers of all kernels are allocated before generating code,
+    // since a mask is set up before its first use
     MaskManager mask_manager;
+    Vec<ir::bundles_t> kernel_bundles;
+    for (auto &kernel : programp->kernels) {
+        kernel_bundles.emplace_back();
+        if (!kernel.c.empty()) {
+            kernel_bundles.back() = ir2bundles(kernel, platform);
+        }
+        add_mask_uses(kernel_bundles.back(), mask_manager);
+    }
+    mask_manager.allocate();
+
     StrStrm ssqisa, sskernels_qisa;
     sskernels_qisa << "start:" << std::endl;
-    for (auto &kernel : programp->kernels) {
+    for (UInt k = 0; k < programp->kernels.size(); ++k) {
+        auto &kernel = programp->kernels[k];
         sskernels_qisa << std::endl << kernel.name << ":" << std::endl;
         sskernels_qisa << get_qisa_prologue(kernel);
         if (!kernel.c.empty()) {
-            sskernels_qisa << ir2qisa(kernel, platform, mask_manager);
+            sskernels_qisa << ir2qisa(kernel_bundles[k], platform, mask_manager, k);
         }
         sskernels_qisa << get_qisa_epilogue(kernel);
     }
@@ -28,38 +28,79 @@ typedef utils::Vec<qubit_pair_t> qubit_pair_set_t;
 const utils::UInt MAX_S_REG = 32;
 const utils::UInt MAX_T_REG = 64;
 
-QL_GLOBAL extern utils::UInt CurrSRegCount;
-QL_GLOBAL extern utils::UInt CurrTRegCount;
+/**
+ * One of the two mask register files of CC-light: S registers, holding
+ * sets of qubits, and T registers, holding sets of qubit pairs. A mask is
+ * identified by an index assigned by the MaskManager, and is described by
+ * the operand text of the smis/smit instruction that sets it.
+ */
+class MaskRegisterFile {
+private:
+    // a use of a mask by a section of a bundle
+    struct Use {
+        utils::UInt bundle;
+        utils::UInt mask;
+        utils::UInt reg;
+    };
+
+    utils::Str instr;                                   // smis or smit
+    utils::Str prefix;                                  // s or t
+    utils::UInt size;                                   // number of registers
+    utils::Vec<utils::Str> operands;                    // per mask, operand text of instr
+    utils::Vec<utils::Vec<Use>> uses;                   // per kernel, uses in program order
+    utils::Vec<utils::UInt> resident;                   // per mask, register set in the prologue or NONE
+    utils::Vec<utils::Map<utils::Int, utils::Str>> reloads;   // per kernel, reloads after bundle (-1: at start)
+
+    void allocateKernel(utils::UInt kernel, utils::UInt first_dynamic);
 
-class Mask {
 public:
-    utils::UInt regNo = 0;
-    utils::Str regName;
-    qubit_set_t squbits;
-    qubit_pair_set_t dqubits;
-
-    Mask() = default;
-    explicit Mask(const qubit_set_t &qs);
-    Mask(const utils::Str &rn, const qubit_set_t &qs);
-    explicit Mask(const qubit_pair_set_t &qps);
+    MaskRegisterFile(const utils::Str &instr, const utils::Str &prefix, utils::UInt size);
+    utils::UInt addMask(const utils::Str &operand_text);
+    void addKernel();
+    void addUse(utils::UInt bundle, utils::UInt mask);
+    void allocate();
+    utils::Str getRegName(utils::UInt kernel, utils::UInt bundle, utils::UInt mask) const;
+    void writeMaskInstructions(utils::StrStrm &ss) const;
+    void writeReloadInstructions(utils::StrStrm &ss, utils::UInt kernel, utils::Int bundle) const;
 };
 
+/**
+ * Allocates the mask registers used by the SIMD instructions of a program.
+ *
+ * All mask uses are added first, kernel by kernel and bundle by bundle, after
+ * which allocate() assigns registers to them. When all masks fit in the
+ * register file, each gets its own register, set once by the smis/smit
+ * instructions of the program prologue. Otherwise, the most used masks are
+ * set in the prologue like that, and the others share the remaining
+ * registers: a register is reloaded for its next mask right after the last
+ * bundle that used its previous one, evicting the mask that is needed
+ * furthest in the future (live ranges are computed per kernel). These reloads
+ * are not bundles, so they cost no cycles. The shared registers are not
+ * assumed to survive kernel boundaries, since control may enter a kernel
+ * from more than one place.
+ *
+ * All state is local to the instance, so each compilation has its own.
+ */
 class MaskManager {
 private:
-    utils::Map<utils::UInt,Mask> SReg2Mask;
-    utils::Map<qubit_set_t,Mask> QS2Mask;
+    MaskRegisterFile sregs;
+    MaskRegisterFile tregs;
+    utils::Map<qubit_set_t, utils::UInt> QS2Mask;
+    utils::Map<qubit_pair_set_t, utils::UInt> QPS2Mask;
 
-    utils::Map<utils::UInt,Mask> TReg2Mask;
-    utils::Map<qubit_pair_set_t,Mask> QPS2Mask;
+    utils::UInt getMask(qubit_set_t &qs);
+    utils::UInt getMask(qubit_pair_set_t &qps);
 
 public:
     MaskManager();
-    ~MaskManager();
-    utils::UInt getRegNo(qubit_set_t &qs);
-    utils::UInt getRegNo(qubit_pair_set_t &qps);
-    utils::Str getRegName(qubit_set_t &qs);
-    utils::Str getRegName(qubit_pair_set_t &qps);
-    utils::Str getMaskInstructions();
+    void addKernel();
+    void addUse(utils::UInt bundle, qubit_set_t &qs);
+    void addUse(utils::UInt bundle, qubit_pair_set_t &qps);
+    void allocate();
+    utils::Str getRegName(utils::UInt kernel, utils::UInt bundle, qubit_set_t &qs);
+    utils::Str getRegName(utils::UInt kernel, utils::UInt bundle, qubit_pair_set_t &qps);
+    utils::Str getMaskInstructions() const;
+    utils::Str getReloadInstructions(utils::UInt kernel, utils::Int bundle) const;
 };
 
 class classical_cc : public gate {
@@ -67,7 +108,7 @@ public:
     cmat_t m;
     // utils::Int imm_value;
     classical_cc(const utils::Str &operation, const utils::Vec<utils::UInt> &opers, utils::Int ivalue = 0);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -78,7 +119,14 @@ utils::Str classical_instruction2qisa(classical_cc *classical_in);
 // FIXME HvS attribute of gate or just in json? Generalization to arch_operation_name is unnecessary
 utils::Str get_cc_light_instruction_name(const utils::Str &id, const quantum_platform &platform);
 
-utils::Str ir2qisa(quantum_kernel &kernel, const quantum_platform &platform, MaskManager &gMaskManager);
+ir::bundles_t ir2bundles(quantum_kernel &kernel, const quantum_platform &platform);
+void add_mask_uses(const ir::bundles_t &bundles, MaskManager &mask_manager);
+utils::Str ir2qisa(
+    const ir::bundles_t &bundles,
+    const quantum_platform &platform,
+    MaskManager &mask_manager,
+    utils::UInt kernel_index
+);
 
 /**
  * cclight eqasm compiler
@@ -97,7 +145,7 @@ public:
 
     void ccl_decompose_pre_schedule(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
     void ccl_decompose_post_schedule(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname);
-    static void ccl_decompose_post_schedule_bundles(ir::bundles_t &bundles_dst, const quantum_platform &platform);
+    static void ccl_decompose_post_schedule_bundles(ir::bundles_t &bundles_dst, const quantum_platform &platform, utils::Arena &arena);
     static void map(quantum_program *programp, const quantum_platform &platform, const utils::Str &passname, utils::Str *mapStatistics);
 
     // cc_light_instr is needed by some cc_light backend passes and by cc_light resource_management:
@@ -4,6 +4,8 @@
 
 #include "arch/cc_light/cc_light_resource_manager.h"
 
+#include <mutex>
+
 namespace ql {
 namespace arch {
 
@@ -36,11 +38,183 @@ Str ccl_get_operation_name(gate *ins, const quantum_platform &platform) {
     return operation_name;
 }
 
+ccl_operation_table_t::ccl_operation_table_t(const quantum_platform &platform) {
+    Map<Str, UInt> name_ids;    // operation name -> name_id
+    for (auto it = platform.instruction_settings.cbegin(); it != platform.instruction_settings.cend(); ++it) {
+        auto &settings = it.value();
+        Str operation_type("cc_light_type");
+        if (settings.count("type") > 0 && !settings["type"].is_null()) {
+            operation_type = settings["type"].get<Str>();
+        }
+        Str operation_name(it.key());
+        if (settings.count("cc_light_instr") > 0 && !settings["cc_light_instr"].is_null()) {
+            operation_name = settings["cc_light_instr"].get<Str>();
+        }
+
+        ccl_operation_t op;
+        if (operation_type == "mw") {
+            op.type = ccl_operation_mw;
+        } else if (operation_type == "flux") {
+            op.type = ccl_operation_flux;
+        } else if (operation_type == "readout") {
+            op.type = ccl_operation_readout;
+        } else {
+            op.type = ccl_operation_other;
+        }
+        auto nit = name_ids.find(operation_name);
+        if (nit == name_ids.end()) {
+            op.name_id = name_ids.size() + 1;
+            name_ids.set(operation_name) = op.name_id;
+        } else {
+            op.name_id = nit->second;
+        }
+        operations.set(it.key()) = op;
+    }
+
+    // index the operations of the instructions of the platform by their instruction_id;
+    // the ids of those of one configuration are consecutive, see hardware_configuration::load
+    instruction_map = platform.instruction_map;
+    first_instruction_id = NO_INSTRUCTION;
+    UInt last_instruction_id = 0;
+    for (auto &it : *instruction_map) {
+        first_instruction_id = min(first_instruction_id, it.second->instruction_id);
+        last_instruction_id = max(last_instruction_id, it.second->instruction_id);
+    }
+    if (first_instruction_id <= last_instruction_id) {
+        by_instruction_id.resize(last_instruction_id - first_instruction_id + 1, nullptr);
+        for (auto &it : *instruction_map) {
+            auto oit = operations.find(it.second->name);
+            if (oit != operations.end()) {
+                by_instruction_id[it.second->instruction_id - first_instruction_id] = &oit->second;
+            }
+        }
+    }
+}
+
+// Resource managers are made for every scheduler and mapper pass, while the table only depends on the configuration;
+// so the tables are cached for the lifetime of the process, keyed by the platform's instruction map,
+// which is shared by all platforms loaded from the same configuration (see load_configuration in platform.cc)
+// and kept alive by the table, so that its address is not reused.
+ccl_operation_table_ptr_t ccl_operation_table_t::of(const quantum_platform &platform) {
+    static std::mutex mutex;
+    static Map<const instruction_map_t*, ccl_operation_table_ptr_t> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(platform.instruction_map.get());
+    if (it != cache.end()) {
+        return it->second;
+    }
+    ccl_operation_table_ptr_t optable(new ccl_operation_table_t(platform));
+    cache.set(platform.instruction_map.get()) = optable;
+    return optable;
+}
+
+const ccl_operation_t &ccl_operation_table_t::get_by_name(gate *ins, const quantum_platform &platform) const {
+    auto it = operations.find(ins->name);
+    if (it == operations.end()) {
+        QL_JSON_ASSERT(platform.instruction_settings, ins->name, ins->name);
+        QL_FATAL("no operation found for instruction: " << ins->name);
+    }
+    return it->second;
+}
+
+ccl_resource_t::ccl_resource_t(
+    const Str &n,
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
+) :
+    resource_t(n, dir),
+    optable(optable)
+{
+}
+
+Bool ccl_resource_t::available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    return available_op(op_start_cycle, ins, optable->get(ins, platform), ccl_get_operation_duration(ins, platform));
+}
+
+void ccl_resource_t::reserve(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    reserve_op(op_start_cycle, ins, optable->get(ins, platform), ccl_get_operation_duration(ins, platform));
+}
+
+UInt ccl_resource_t::next_available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    return next_available_op(op_start_cycle, ins, optable->get(ins, platform), ccl_get_operation_duration(ins, platform));
+}
+
+// latest start cycle of an operation of the given duration to complete at or before the given cycle;
+// there is none when the duration is longer, and then 0 is returned
+static UInt start_before(UInt cycle, UInt operation_duration) {
+    return (cycle >= operation_duration ? cycle - operation_duration : 0);
+}
+
+// next cycle from op_start_cycle on in the scheduling direction at which an operation can start
+// on a unit that is busy from fromcycle to tocycle with another operation (same_operation false)
+// or with the same one (same_operation true), which it can join but then not start before fromcycle
+// (forward) or complete after tocycle (backward); see the qwgs and detuned_qubits resources
+static UInt next_free_cycle(
+    scheduling_direction_t direction,
+    UInt op_start_cycle,
+    UInt operation_duration,
+    UInt fromcycle,
+    UInt tocycle,
+    Bool same_operation
+) {
+    UInt cycle = op_start_cycle;
+    if (forward_scheduling == direction) {
+        cycle = max(cycle, fromcycle);
+        if (!same_operation) {
+            cycle = max(cycle, tocycle);
+        }
+    } else {
+        cycle = min(cycle, start_before(tocycle, operation_duration));
+        if (!same_operation) {
+            cycle = min(cycle, start_before(fromcycle, operation_duration));
+        }
+    }
+    return cycle;
+}
+
+// initialize the qubit pair to edge table from the json description; this is a constant table
+Vec<UInt> ccl_resource_t::get_qubits2edge(const quantum_platform &platform, UInt &qubit_count) {
+    qubit_count = platform.qubit_number;
+    for (auto &anedge : platform.topology["edges"]) {
+        UInt s = anedge["src"];
+        UInt d = anedge["dst"];
+        qubit_count = max(qubit_count, max(s, d) + 1);
+    }
+
+    Vec<UInt> qubits2edge(qubit_count * qubit_count, NO_RESOURCE);
+    for (auto &anedge : platform.topology["edges"]) {
+        UInt s = anedge["src"];
+        UInt d = anedge["dst"];
+        UInt e = anedge["id"];
+
+        if (qubits2edge[s * qubit_count + d] != NO_RESOURCE) {
+            QL_EOUT("re-defining edge " << s << "->" << d << " !");
+            throw Exception("[x] Error : re-defining edge !", false);
+        } else {
+            qubits2edge[s * qubit_count + d] = e;
+        }
+    }
+    return qubits2edge;
+}
+
 ccl_qubit_resource_t::ccl_qubit_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
 ) :
-    resource_t("qubits", dir)
+    ccl_resource_t("qubits", dir, optable)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
@@ -60,14 +234,12 @@ ccl_qubit_resource_t *ccl_qubit_resource_t::clone() && {
     return new ccl_qubit_resource_t(std::move(*this));
 }
 
-Bool ccl_qubit_resource_t::available(
+Bool ccl_qubit_resource_t::available_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-    Str operation_type = ccl_get_operation_type(ins, platform);
-
     for (auto q : ins->operands) {
         if (forward_scheduling == direction) {
             QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qubit: " << q << " is busy till cycle : " << state[q]);
@@ -87,25 +259,43 @@ Bool ccl_qubit_resource_t::available(
     return true;
 }
 
-void ccl_qubit_resource_t::reserve(
+void ccl_qubit_resource_t::reserve_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
 
     for (auto q : ins->operands) {
+        undo_log.save(state[q]);
         state[q] = (forward_scheduling == direction ?  op_start_cycle + operation_duration : op_start_cycle );
         QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qubit: " << q << " reserved till/from cycle: " << state[q]);
     }
 }
 
+UInt ccl_qubit_resource_t::next_available_op(
+    UInt op_start_cycle,
+    gate *ins,
+    const ccl_operation_t &op,
+    UInt operation_duration
+) {
+    UInt cycle = op_start_cycle;
+    for (auto q : ins->operands) {
+        if (forward_scheduling == direction) {
+            cycle = max(cycle, state[q]);
+        } else {
+            cycle = min(cycle, start_before(state[q], operation_duration));
+        }
+    }
+    return cycle;
+}
+
 ccl_qwg_resource_t::ccl_qwg_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
 ) :
-    resource_t("qwgs", dir)
+    ccl_resource_t("qwgs", dir, optable)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
@@ -116,15 +306,20 @@ ccl_qwg_resource_t::ccl_qwg_resource_t(
     for (UInt i = 0; i < count; i++) {
         fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        operations[i] = "";
+        operations[i] = 0;
     }
+    qubit2qwg.resize(platform.qubit_number, NO_RESOURCE);
     auto & constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.cbegin(); it != constraints.cend(); ++it) {
         // COUT(it.key() << " : " << it.value() );
         UInt qwgNo = stoi( it.key() );
         auto & connected_qubits = it.value();
-        for (auto &q : connected_qubits) {
-            qubit2qwg.set(q) = qwgNo;
+        for (auto &jq : connected_qubits) {
+            UInt q = jq;
+            if (q >= qubit2qwg.size()) {
+                qubit2qwg.resize(q + 1, NO_RESOURCE);
+            }
+            qubit2qwg[q] = qwgNo;
         }
     }
 }
@@ -139,31 +334,32 @@ ccl_qwg_resource_t *ccl_qwg_resource_t::clone() && {
     return new ccl_qwg_resource_t(std::move(*this));
 }
 
-Bool ccl_qwg_resource_t::available(
+Bool ccl_qwg_resource_t::available_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    Str operation_name = ccl_get_operation_name(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_mw = (operation_type == "mw");
+    Bool is_mw = (op.type == ccl_operation_mw);
     if (is_mw) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qubit2qwg.at(q) << " is busy from cycle: " << fromcycle[qubit2qwg.at(q)] << " to cycle: " << tocycle[qubit2qwg.at(q)] << " for operation: " << operations[qubit2qwg.at(q)]);
+            UInt qwg = qubit2qwg.at(q);
+            if (qwg == NO_RESOURCE) {
+                QL_FATAL("qubit " << q << " of operation " << ins->name << " is not connected to a " << name << " resource");
+            }
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qwg << " is busy from cycle: " << fromcycle[qwg] << " to cycle: " << tocycle[qwg] << " for operation: " << operations[qwg]);
             if (direction == forward_scheduling) {
                 if (
-                    op_start_cycle < fromcycle[qubit2qwg.at(q)]
-                    || (op_start_cycle < tocycle[qubit2qwg.at(q)] && operations[qubit2qwg.at(q)] != operation_name)
+                    op_start_cycle < fromcycle[qwg]
+                    || (op_start_cycle < tocycle[qwg] && operations[qwg] != op.name_id)
                 ) {
                     QL_DOUT("    " << name << " resource busy ...");
                     return false;
                 }
             } else {
                 if (
-                    op_start_cycle + operation_duration > tocycle[qubit2qwg.at(q)]
-                    || ( op_start_cycle + operation_duration > fromcycle[qubit2qwg.at(q)] && operations[qubit2qwg.at(q)] != operation_name)
+                    op_start_cycle + operation_duration > tocycle[qwg]
+                    || ( op_start_cycle + operation_duration > fromcycle[qwg] && operations[qwg] != op.name_id)
                 ) {
                     QL_DOUT("    " << name << " resource busy ...");
                     return false;
@@ -175,45 +371,66 @@ Bool ccl_qwg_resource_t::available(
     return true;
 }
 
-void ccl_qwg_resource_t::reserve(
+void ccl_qwg_resource_t::reserve_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    Str operation_name = ccl_get_operation_name(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_mw = operation_type == "mw";
+    Bool is_mw = (op.type == ccl_operation_mw);
     if (is_mw) {
         for (auto q : ins->operands) {
+            UInt qwg = qubit2qwg.at(q);
+            undo_log.save(fromcycle[qwg]);
+            undo_log.save(tocycle[qwg]);
+            undo_log.save(operations[qwg]);
             if (direction == forward_scheduling) {
-                if (operations[qubit2qwg.at(q)] == operation_name) {
-                    tocycle[qubit2qwg.at(q)] = max(tocycle[qubit2qwg.at(q)], op_start_cycle + operation_duration);
+                if (operations[qwg] == op.name_id) {
+                    tocycle[qwg] = max(tocycle[qwg], op_start_cycle + operation_duration);
                 } else {
-                    fromcycle[qubit2qwg.at(q)] = op_start_cycle;
-                    tocycle[qubit2qwg.at(q)] = op_start_cycle + operation_duration;
-                    operations[qubit2qwg.at(q)] = operation_name;
+                    fromcycle[qwg] = op_start_cycle;
+                    tocycle[qwg] = op_start_cycle + operation_duration;
+                    operations[qwg] = op.name_id;
                 }
             } else {
-                if (operations[qubit2qwg.at(q)] == operation_name) {
-                    fromcycle[qubit2qwg.at(q)] = min(fromcycle[qubit2qwg.at(q)], op_start_cycle);
+                if (operations[qwg] == op.name_id) {
+                    fromcycle[qwg] = min(fromcycle[qwg], op_start_cycle);
                 } else {
-                    fromcycle[qubit2qwg.at(q)] = op_start_cycle;
-                    tocycle[qubit2qwg.at(q)] = op_start_cycle + operation_duration;
-                    operations[qubit2qwg.at(q)] = operation_name;
+                    fromcycle[qwg] = op_start_cycle;
+                    tocycle[qwg] = op_start_cycle + operation_duration;
+                    operations[qwg] = op.name_id;
                 }
             }
-            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qubit2qwg.at(q) << " reserved from cycle: " << fromcycle[qubit2qwg.at(q)] << " to cycle: " << tocycle[qubit2qwg.at(q)] << " for operation: " << operations[qubit2qwg.at(q)]);
+            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qwg << " reserved from cycle: " << fromcycle[qwg] << " to cycle: " << tocycle[qwg] << " for operation: " << operations[qwg]);
+        }
+    }
+}
+
+UInt ccl_qwg_resource_t::next_available_op(
+    UInt op_start_cycle,
+    gate *ins,
+    const ccl_operation_t &op,
+    UInt operation_duration
+) {
+    UInt cycle = op_start_cycle;
+    if (op.type == ccl_operation_mw) {
+        for (auto q : ins->operands) {
+            UInt qwg = qubit2qwg.at(q);
+            if (qwg == NO_RESOURCE) {
+                continue;       // reported by available_op
+            }
+            cycle = next_free_cycle(direction, cycle, operation_duration, fromcycle[qwg], tocycle[qwg], operations[qwg] == op.name_id);
         }
     }
+    return cycle;
 }
 
 ccl_meas_resource_t::ccl_meas_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
 ) :
-    resource_t("meas_units", dir)
+    ccl_resource_t("meas_units", dir, optable)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
@@ -224,13 +441,18 @@ ccl_meas_resource_t::ccl_meas_resource_t(
         fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
     }
+    qubit2meas.resize(platform.qubit_number, NO_RESOURCE);
     auto &constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.begin(); it != constraints.end(); ++it) {
         // COUT(it.key() << " : " << it.value());
         UInt measUnitNo = stoi( it.key() );
         auto & connected_qubits = it.value();
-        for (auto &q : connected_qubits) {
-            qubit2meas.set(q) = measUnitNo;
+        for (auto &jq : connected_qubits) {
+            UInt q = jq;
+            if (q >= qubit2meas.size()) {
+                qubit2meas.resize(q + 1, NO_RESOURCE);
+            }
+            qubit2meas[q] = measUnitNo;
         }
     }
 }
@@ -245,32 +467,34 @@ ccl_meas_resource_t *ccl_meas_resource_t::clone() && {
     return new ccl_meas_resource_t(std::move(*this));
 }
 
-Bool ccl_meas_resource_t::available(
+Bool ccl_meas_resource_t::available_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_measure = (operation_type == "readout");
+    Bool is_measure = (op.type == ccl_operation_readout);
     if (is_measure) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << qubit2meas.at(q) << " is busy from cycle: " << fromcycle[qubit2meas.at(q)] << " to cycle: " << tocycle[qubit2meas.at(q)] );
+            UInt meas = qubit2meas.at(q);
+            if (meas == NO_RESOURCE) {
+                QL_FATAL("qubit " << q << " of operation " << ins->name << " is not connected to a " << name << " resource");
+            }
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << meas << " is busy from cycle: " << fromcycle[meas] << " to cycle: " << tocycle[meas] );
             if (direction == forward_scheduling) {
-                if (op_start_cycle != fromcycle[qubit2meas.at(q)]) {
+                if (op_start_cycle != fromcycle[meas]) {
                     // If current measurement on same measurement-unit does not start in the
                     // same cycle, then it should wait for current measurement to finish
-                    if (op_start_cycle < tocycle[qubit2meas.at(q)]) {
+                    if (op_start_cycle < tocycle[meas]) {
                         QL_DOUT("    " << name << " resource busy ...");
                         return false;
                     }
                 }
             } else {
-                if (op_start_cycle != fromcycle[qubit2meas.at(q)]) {
+                if (op_start_cycle != fromcycle[meas]) {
                     // If current measurement on same measurement-unit does not start in the
                     // same cycle, then it should wait until it would finish at start of or earlier than current measurement
-                    if (op_start_cycle + operation_duration > fromcycle[qubit2meas.at(q)]) {
+                    if (op_start_cycle + operation_duration > fromcycle[meas]) {
                         QL_DOUT("    " << name << " resource busy ...");
                         return false;
                     }
@@ -282,29 +506,64 @@ Bool ccl_meas_resource_t::available(
     return true;
 }
 
-void ccl_meas_resource_t::reserve(
+void ccl_meas_resource_t::reserve_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
-
-    Bool is_measure = (operation_type == "readout");
+    Bool is_measure = (op.type == ccl_operation_readout);
     if (is_measure) {
         for (auto q : ins->operands) {
-            fromcycle[qubit2meas.at(q)] = op_start_cycle;
-            tocycle[qubit2meas.at(q)] = op_start_cycle + operation_duration;
-            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << qubit2meas.at(q) << " reserved from cycle: " << fromcycle[qubit2meas.at(q)] << " to cycle: " << tocycle[qubit2meas.at(q)]);
+            UInt meas = qubit2meas.at(q);
+            undo_log.save(fromcycle[meas]);
+            undo_log.save(tocycle[meas]);
+            fromcycle[meas] = op_start_cycle;
+            tocycle[meas] = op_start_cycle + operation_duration;
+            QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << meas << " reserved from cycle: " << fromcycle[meas] << " to cycle: " << tocycle[meas]);
         }
     }
 }
 
+// a measurement can start together with the current one on its measurement unit, or when that has completed,
+// so the next cycle at which it may be available is the earliest (forward) or latest (backward) of these
+UInt ccl_meas_resource_t::next_available_op(
+    UInt op_start_cycle,
+    gate *ins,
+    const ccl_operation_t &op,
+    UInt operation_duration
+) {
+    UInt cycle = op_start_cycle;
+    if (op.type == ccl_operation_readout) {
+        for (auto q : ins->operands) {
+            UInt meas = qubit2meas.at(q);
+            if (meas == NO_RESOURCE) {
+                continue;       // reported by available_op
+            }
+            if (direction == forward_scheduling) {
+                UInt first = max(op_start_cycle, tocycle[meas]);
+                if (fromcycle[meas] >= op_start_cycle) {
+                    first = min(first, fromcycle[meas]);
+                }
+                cycle = max(cycle, first);
+            } else {
+                UInt first = min(op_start_cycle, start_before(fromcycle[meas], operation_duration));
+                if (fromcycle[meas] <= op_start_cycle) {
+                    first = max(first, fromcycle[meas]);
+                }
+                cycle = min(cycle, first);
+            }
+        }
+    }
+    return cycle;
+}
+
 ccl_edge_resource_t::ccl_edge_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
 ) :
-    resource_t("edges", dir)
+    ccl_resource_t("edges", dir, optable)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
@@ -314,28 +573,20 @@ ccl_edge_resource_t::ccl_edge_resource_t(
         state[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
     }
 
-    for (auto &anedge : platform.topology["edges"]) {
-        UInt s = anedge["src"];
-        UInt d = anedge["dst"];
-        UInt e = anedge["id"];
-
-        qubits_pair_t aqpair(s,d);
-        auto it = qubits2edge.find(aqpair);
-        if (it != qubits2edge.end()) {
-            QL_EOUT("re-defining edge " << s << "->" << d << " !");
-            throw Exception("[x] Error : re-defining edge !", false);
-        } else {
-            qubits2edge.set(aqpair) = e;
-        }
-    }
+    qubits2edge = get_qubits2edge(platform, qubit_count);
 
+    edge2edges.resize(count);
     auto &constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.cbegin(); it != constraints.cend(); ++it) {
         // COUT(it.key() << " : " << it.value() << "\n");
         UInt edgeNo = stoi( it.key() );
         auto &connected_edges = it.value();
-        for (auto &e : connected_edges) {
-            edge2edges.set(e).push_back(edgeNo);
+        for (auto &je : connected_edges) {
+            UInt e = je;
+            if (e >= edge2edges.size()) {
+                edge2edges.resize(e + 1);
+            }
+            edge2edges[e].push_back(edgeNo);
         }
     }
 }
@@ -350,16 +601,13 @@ ccl_edge_resource_t *ccl_edge_resource_t::clone() && {
     return new ccl_edge_resource_t(std::move(*this));
 }
 
-Bool ccl_edge_resource_t::available(
+Bool ccl_edge_resource_t::available_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = (operation_type == "flux");
+    Bool is_flux = (op.type == ccl_operation_flux);
     if (is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
@@ -368,25 +616,33 @@ Bool ccl_edge_resource_t::available(
         } else if (nopers == 2) {
             auto q0 = ins->operands[0];
             auto q1 = ins->operands[1];
-            qubits_pair_t aqpair(q0, q1);
-            auto it = qubits2edge.find(aqpair);
-            if (it != qubits2edge.end()) {
-                auto edge_no = qubits2edge.at(aqpair);
-
+            UInt edge_no = (q0 < qubit_count && q1 < qubit_count) ? qubits2edge[q0 * qubit_count + q1] : NO_RESOURCE;
+            if (edge_no != NO_RESOURCE) {
                 QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " is busy till/from cycle : " << state[edge_no] << " for operation: " << ins->name);
 
-                Vec<UInt> edges2check(edge2edges.get(edge_no));
-                edges2check.push_back(edge_no);
-                for (auto &e : edges2check) {
-                    if (direction == forward_scheduling) {
-                        if (op_start_cycle < state[e]) {
-                            QL_DOUT("    " << name << " resource busy ...");
-                            return false;
-                        }
-                    } else {
-                        if (op_start_cycle + operation_duration > state[e]) {
-                            QL_DOUT("    " << name << " resource busy ...");
-                            return false;
+                if (direction == forward_scheduling) {
+                    if (op_start_cycle < state[edge_no]) {
+                        QL_DOUT("    " << name << " resource busy ...");
+                        return false;
+                    }
+                } else {
+                    if (op_start_cycle + operation_duration > state[edge_no]) {
+                        QL_DOUT("    " << name << " resource busy ...");
+                        return false;
+                    }
+                }
+                if (edge_no < edge2edges.size()) {
+                    for (auto e : edge2edges[edge_no]) {
+                        if (direction == forward_scheduling) {
+                            if (op_start_cycle < state[e]) {
+                                QL_DOUT("    " << name << " resource busy ...");
+                                return false;
+                            }
+                        } else {
+                            if (op_start_cycle + operation_duration > state[e]) {
+                                QL_DOUT("    " << name << " resource busy ...");
+                                return false;
+                            }
                         }
                     }
                 }
@@ -401,16 +657,13 @@ Bool ccl_edge_resource_t::available(
     return true;
 }
 
-void ccl_edge_resource_t::reserve(
+void ccl_edge_resource_t::reserve_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt operation_duration = ccl_get_operation_duration(ins, platform);
-
-    auto gname = ins->name;
-    Bool is_flux = (operation_type == "flux");
+    Bool is_flux = (op.type == ccl_operation_flux);
     if (is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
@@ -418,17 +671,14 @@ void ccl_edge_resource_t::reserve(
         } else if (nopers == 2) {
             auto q0 = ins->operands[0];
             auto q1 = ins->operands[1];
-            qubits_pair_t aqpair(q0, q1);
-            auto edge_no = qubits2edge.at(aqpair);
-            if (direction == forward_scheduling) {
-                state[edge_no] = op_start_cycle + operation_duration;
-                for (auto &e : edge2edges.get(edge_no)) {
-                    state[e] = op_start_cycle + operation_duration;
-                }
-            } else {
-                state[edge_no] = op_start_cycle;
-                for (auto &e : edge2edges.get(edge_no)) {
-                    state[e] = op_start_cycle;
+            UInt edge_no = qubits2edge.at(q0 * qubit_count + q1);
+            UInt edge_state = (direction == forward_scheduling ? op_start_cycle + operation_duration : op_start_cycle);
+            undo_log.save(state[edge_no]);
+            state[edge_no] = edge_state;
+            if (edge_no < edge2edges.size()) {
+                for (auto e : edge2edges[edge_no]) {
+                    undo_log.save(state[e]);
+                    state[e] = edge_state;
                 }
             }
             QL_DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " reserved till cycle: " << state[ edge_no ] << " for operation: " << ins->name);
@@ -438,11 +688,43 @@ void ccl_edge_resource_t::reserve(
     }
 }
 
+UInt ccl_edge_resource_t::next_available_op(
+    UInt op_start_cycle,
+    gate *ins,
+    const ccl_operation_t &op,
+    UInt operation_duration
+) {
+    UInt cycle = op_start_cycle;
+    if (op.type == ccl_operation_flux && ins->operands.size() == 2) {
+        auto q0 = ins->operands[0];
+        auto q1 = ins->operands[1];
+        UInt edge_no = (q0 < qubit_count && q1 < qubit_count) ? qubits2edge[q0 * qubit_count + q1] : NO_RESOURCE;
+        if (edge_no == NO_RESOURCE) {
+            return cycle;       // reported by available_op
+        }
+        auto wait_for = [&](UInt e) {
+            if (direction == forward_scheduling) {
+                cycle = max(cycle, state[e]);
+            } else {
+                cycle = min(cycle, start_before(state[e], operation_duration));
+            }
+        };
+        wait_for(edge_no);
+        if (edge_no < edge2edges.size()) {
+            for (auto e : edge2edges[edge_no]) {
+                wait_for(e);
+            }
+        }
+    }
+    return cycle;
+}
+
 ccl_detuned_qubits_resource_t::ccl_detuned_qubits_resource_t(
     const quantum_platform &platform,
-    scheduling_direction_t dir
+    scheduling_direction_t dir,
+    const ccl_operation_table_ptr_t &optable
 ) :
-    resource_t("detuned_qubits", dir)
+    ccl_resource_t("detuned_qubits", dir, optable)
 {
     // DOUT("... creating " << name << " resource");
     count = platform.resources[name]["count"];
@@ -454,33 +736,23 @@ ccl_detuned_qubits_resource_t::ccl_detuned_qubits_resource_t(
     for (UInt i = 0; i < count; i++) {
         fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        operations[i] = "";
+        operations[i] = ccl_operation_none;
     }
 
-    // initialize qubitpair2edge map from json description; this is a constant map
-    for (auto &anedge : platform.topology["edges"]) {
-        UInt s = anedge["src"];
-        UInt d = anedge["dst"];
-        UInt e = anedge["id"];
-
-        qubits_pair_t aqpair(s,d);
-        auto it = qubitpair2edge.find(aqpair);
-        if (it != qubitpair2edge.end()) {
-            QL_EOUT("re-defining edge " << s << "->" << d << " !");
-            throw Exception("[x] Error : re-defining edge !", false);
-        } else {
-            qubitpair2edge.set(aqpair) = e;
-        }
-    }
+    // initialize qubitpair2edge table from json description; this is a constant table
+    qubitpair2edge = get_qubits2edge(platform, qubit_count);
 
-    // initialize edge_detunes_qubits map from json description; this is a constant map
+    // initialize edge_detunes_qubits table from json description; this is a constant table
     auto &constraints = platform.resources[name]["connection_map"];
     for (auto it = constraints.cbegin(); it != constraints.cend(); ++it) {
         // COUT(it.key() << " : " << it.value() << "\n");
         UInt edgeNo = stoi( it.key() );
         auto & detuned_qubits = it.value();
+        if (edgeNo >= edge_detunes_qubits.size()) {
+            edge_detunes_qubits.resize(edgeNo + 1);
+        }
         for (auto & q : detuned_qubits) {
-            edge_detunes_qubits.set(edgeNo).push_back(q);
+            edge_detunes_qubits[edgeNo].push_back(q);
         }
     }
 }
@@ -497,16 +769,14 @@ ccl_detuned_qubits_resource_t *ccl_detuned_qubits_resource_t::clone() && {
 
 // When a two-qubit flux gate, check whether the qubits it would detune are not busy with a rotation.
 // When a one-qubit rotation, check whether the qubit is not detuned (busy with a flux gate).
-Bool ccl_detuned_qubits_resource_t::available(
+Bool ccl_detuned_qubits_resource_t::available_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
 
-    auto gname = ins->name;
-    Bool is_flux = operation_type == "flux";
+    Bool is_flux = (op.type == ccl_operation_flux);
     if (is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
@@ -515,17 +785,17 @@ Bool ccl_detuned_qubits_resource_t::available(
         } else if (nopers == 2) {
             auto q0 = ins->operands[0];
             auto q1 = ins->operands[1];
-            qubits_pair_t aqpair(q0, q1);
-            auto it = qubitpair2edge.find(aqpair);
-            if (it != qubitpair2edge.end()) {
-                auto edge_no = qubitpair2edge.at(aqpair);
-
-                for (auto &q : edge_detunes_qubits.get(edge_no)) {
-                    QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+            UInt edge_no = (q0 < qubit_count && q1 < qubit_count) ? qubitpair2edge[q0 * qubit_count + q1] : NO_RESOURCE;
+            if (edge_no != NO_RESOURCE) {
+                if (edge_no >= edge_detunes_qubits.size()) {
+                    return true;        // edge doesn't detune any qubit
+                }
+                for (auto q : edge_detunes_qubits[edge_no]) {
+                    QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << op.type);
                     if (direction == forward_scheduling) {
                         if (
                             op_start_cycle < fromcycle[q]
-                            || ( op_start_cycle < tocycle[q] && operations[q] != operation_type)
+                            || ( op_start_cycle < tocycle[q] && operations[q] != op.type)
                         ) {
                             QL_DOUT("    " << name << " resource busy for a two-qubit gate...");
                             return false;
@@ -533,7 +803,7 @@ Bool ccl_detuned_qubits_resource_t::available(
                     } else {
                         if (
                             op_start_cycle + operation_duration > tocycle[q]
-                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type)
+                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != op.type)
                         ) {
                             QL_DOUT("    " << name << " resource busy for a two-qubit gate...");
                             return false;
@@ -549,16 +819,16 @@ Bool ccl_detuned_qubits_resource_t::available(
         }
     }
 
-    Bool is_mw = operation_type == "mw";
+    Bool is_mw = (op.type == ccl_operation_mw);
     if (is_mw) {
         for (auto q : ins->operands) {
-            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+            QL_DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << op.type);
             if (direction == forward_scheduling) {
                 if (op_start_cycle < fromcycle[q]) {
                     QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " < fromcycle[" << q << "] " << fromcycle[q] );
                     return false;
                 }
-                if (op_start_cycle < tocycle[q] && operations[q] != operation_type) {
+                if (op_start_cycle < tocycle[q] && operations[q] != op.type) {
                     QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " < tocycle[" << q << "] " << tocycle[q] );
                     return false;
                 }
@@ -567,7 +837,7 @@ Bool ccl_detuned_qubits_resource_t::available(
                     QL_DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " + duration > tocycle[" << q << "] " << tocycle[q] );
                     return false;
                 }
-                if (op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type) {
+                if (op_start_cycle + operation_duration > fromcycle[q] && operations[q] != op.type) {
                     QL_DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " + duration > fromcycle[" << q << "] " << fromcycle[q] );
                     return false;
                 }
@@ -580,16 +850,14 @@ Bool ccl_detuned_qubits_resource_t::available(
 
 // A two-qubit flux gate must set the qubits it would detune to detuned, busy with a flux gate.
 // A one-qubit rotation gate must set its operand qubit to busy, busy with a rotation.
-void ccl_detuned_qubits_resource_t::reserve(
+void ccl_detuned_qubits_resource_t::reserve_op(
     UInt op_start_cycle,
     gate *ins,
-    const quantum_platform &platform
+    const ccl_operation_t &op,
+    UInt operation_duration
 ) {
-    Str operation_type = ccl_get_operation_type(ins, platform);
-    UInt      operation_duration = ccl_get_operation_duration(ins, platform);
 
-    auto gname = ins->name;
-    Bool is_flux = operation_type == "flux";
+    Bool is_flux = (op.type == ccl_operation_flux);
     if (is_flux) {
         auto nopers = ins->operands.size();
         if (nopers == 1) {
@@ -597,28 +865,33 @@ void ccl_detuned_qubits_resource_t::reserve(
         } else if (nopers == 2) {
             auto q0 = ins->operands[0];
             auto q1 = ins->operands[1];
-            qubits_pair_t aqpair(q0, q1);
-            auto edge_no = qubitpair2edge.at(aqpair);
+            UInt edge_no = qubitpair2edge.at(q0 * qubit_count + q1);
+            if (edge_no >= edge_detunes_qubits.size()) {
+                return;                 // edge doesn't detune any qubit
+            }
 
-            for (auto &q : edge_detunes_qubits.get(edge_no)) {
+            for (auto q : edge_detunes_qubits[edge_no]) {
+                undo_log.save(fromcycle[q]);
+                undo_log.save(tocycle[q]);
+                undo_log.save(operations[q]);
                 if (direction == forward_scheduling) {
-                    if (operations[q] == operation_type) {
+                    if (operations[q] == op.type) {
                         tocycle[q] = max(tocycle[q], op_start_cycle + operation_duration);
                         QL_DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                     } else {
                         fromcycle[q] = op_start_cycle;
                         tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
+                        operations[q] = op.type;
                         QL_DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                     }
                 } else {
-                    if (operations[q] == operation_type) {
+                    if (operations[q] == op.type) {
                         fromcycle[q] = min(fromcycle[q], op_start_cycle);
                         QL_DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                     } else {
                         fromcycle[q] = op_start_cycle;
                         tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
+                        operations[q] = op.type;
                         QL_DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                     }
                 }
@@ -628,27 +901,30 @@ void ccl_detuned_qubits_resource_t::reserve(
             QL_FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
         }
     }
-    Bool is_mw = operation_type == "mw";
+    Bool is_mw = (op.type == ccl_operation_mw);
     if (is_mw) {
         for (auto q : ins->operands) {
+            undo_log.save(fromcycle[q]);
+            undo_log.save(tocycle[q]);
+            undo_log.save(operations[q]);
             if (direction == forward_scheduling) {
-                if (operations[q] == operation_type) {
+                if (operations[q] == op.type) {
                     tocycle[q] = max(tocycle[q], op_start_cycle + operation_duration);
                     QL_DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                 } else {
                     fromcycle[q] = op_start_cycle;
                     tocycle[q] = op_start_cycle + operation_duration;
-                    operations[q] = operation_type;
+                    operations[q] = op.type;
                     QL_DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                 }
             } else {
-                if (operations[q] == operation_type) {
+                if (operations[q] == op.type) {
                     fromcycle[q] = min(fromcycle[q], op_start_cycle);
                     QL_DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                 } else {
                     fromcycle[q] = op_start_cycle;
                     tocycle[q] = op_start_cycle + operation_duration;
-                    operations[q] = operation_type;
+                    operations[q] = op.type;
                     QL_DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                 }
             }
@@ -657,6 +933,32 @@ void ccl_detuned_qubits_resource_t::reserve(
     }
 }
 
+UInt ccl_detuned_qubits_resource_t::next_available_op(
+    UInt op_start_cycle,
+    gate *ins,
+    const ccl_operation_t &op,
+    UInt operation_duration
+) {
+    UInt cycle = op_start_cycle;
+    if (op.type == ccl_operation_flux && ins->operands.size() == 2) {
+        auto q0 = ins->operands[0];
+        auto q1 = ins->operands[1];
+        UInt edge_no = (q0 < qubit_count && q1 < qubit_count) ? qubitpair2edge[q0 * qubit_count + q1] : NO_RESOURCE;
+        if (edge_no == NO_RESOURCE || edge_no >= edge_detunes_qubits.size()) {
+            return cycle;       // edge doesn't detune any qubit, or reported by available_op
+        }
+        for (auto q : edge_detunes_qubits[edge_no]) {
+            cycle = next_free_cycle(direction, cycle, operation_duration, fromcycle[q], tocycle[q], operations[q] == op.type);
+        }
+    }
+    if (op.type == ccl_operation_mw) {
+        for (auto q : ins->operands) {
+            cycle = next_free_cycle(direction, cycle, operation_duration, fromcycle[q], tocycle[q], operations[q] == op.type);
+        }
+    }
+    return cycle;
+}
+
 // Allocate those resources that were specified in the config file.
 // Those that are not specified, are not allocatd, so are not used in scheduling/mapping.
 // The resource names tested below correspond to the names of the resources sections in the config file.
@@ -664,7 +966,8 @@ cc_light_resource_manager_t::cc_light_resource_manager_t(
     const quantum_platform &platform,
     scheduling_direction_t dir
 ) :
-    platform_resource_manager_t(platform, dir)
+    platform_resource_manager_t(platform, dir),
+    optable(ccl_operation_table_t::of(platform))
 {
     QL_DOUT("Constructing (platform,dir) parameterized platform_resource_manager_t");
     QL_DOUT("New one for direction " << dir << " with no of resources : " << platform.resources.size() );
@@ -674,19 +977,19 @@ cc_light_resource_manager_t::cc_light_resource_manager_t(
 
         // DOUT("... about to create " << n << " resource");
         if (n == "qubits") {
-            resource_t * ares = new ccl_qubit_resource_t(platform, dir);
+            resource_t * ares = new ccl_qubit_resource_t(platform, dir, optable);
             resource_ptrs.push_back( ares );
         } else if (n == "qwgs") {
-            resource_t * ares = new ccl_qwg_resource_t(platform, dir);
+            resource_t * ares = new ccl_qwg_resource_t(platform, dir, optable);
             resource_ptrs.push_back( ares );
         } else if (n == "meas_units") {
-            resource_t * ares = new ccl_meas_resource_t(platform, dir);
+            resource_t * ares = new ccl_meas_resource_t(platform, dir, optable);
             resource_ptrs.push_back( ares );
         } else if (n == "edges") {
-            resource_t * ares = new ccl_edge_resource_t(platform, dir);
+            resource_t * ares = new ccl_edge_resource_t(platform, dir, optable);
             resource_ptrs.push_back( ares );
         } else if (n == "detuned_qubits") {
-            resource_t * ares = new ccl_detuned_qubits_resource_t(platform, dir);
+            resource_t * ares = new ccl_detuned_qubits_resource_t(platform, dir, optable);
             resource_ptrs.push_back( ares );
         } else {
             QL_FATAL("Error : Un-modelled resource, i.e. resource not supported by implementation: '" << n << "'");
@@ -705,5 +1008,47 @@ cc_light_resource_manager_t *cc_light_resource_manager_t::clone() && {
     return new cc_light_resource_manager_t(std::move(*this));
 }
 
+Bool cc_light_resource_manager_t::available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    const ccl_operation_t &op = optable->get(ins, platform);
+    UInt operation_duration = ccl_get_operation_duration(ins, platform);
+    for (auto rptr : resource_ptrs) {
+        if (!static_cast<ccl_resource_t*>(rptr)->available_op(op_start_cycle, ins, op, operation_duration)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void cc_light_resource_manager_t::reserve(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    const ccl_operation_t &op = optable->get(ins, platform);
+    UInt operation_duration = ccl_get_operation_duration(ins, platform);
+    for (auto rptr : resource_ptrs) {
+        static_cast<ccl_resource_t*>(rptr)->reserve_op(op_start_cycle, ins, op, operation_duration);
+    }
+}
+
+UInt cc_light_resource_manager_t::next_available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    const ccl_operation_t &op = optable->get(ins, platform);
+    UInt operation_duration = ccl_get_operation_duration(ins, platform);
+    UInt cycle = op_start_cycle;
+    for (auto rptr : resource_ptrs) {
+        UInt rcycle = static_cast<ccl_resource_t*>(rptr)->next_available_op(op_start_cycle, ins, op, operation_duration);
+        cycle = (forward_scheduling == rptr->direction ? max(cycle, rcycle) : min(cycle, rcycle));
+    }
+    return cycle;
+}
+
 } // namespace arch
 } // namespace ql
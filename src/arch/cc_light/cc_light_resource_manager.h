@@ -5,10 +5,12 @@
 #pragma once
 
 #include <fstream>
+#include <memory>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/pair.h"
 #include "utils/vec.h"
+#include "utils/map.h"
 #include "utils/json.h"
 #include "resource_manager.h"
 
@@ -29,30 +31,112 @@ utils::Str ccl_get_operation_type(gate *ins, const quantum_platform &platform);
 // operation name is used to know which operations are the same when one qwg steers several qubits using the vsm
 utils::Str ccl_get_operation_name(gate *ins, const quantum_platform &platform);
 
+// the operation types above, as distinguished by the resources
+typedef enum {
+    ccl_operation_none = 0,         // initial state of a resource, no operation seen yet
+    ccl_operation_mw,
+    ccl_operation_flux,
+    ccl_operation_readout,
+    ccl_operation_other
+} ccl_operation_type_t;
+
+// operation type and name of a gate, resolved to integers;
+// gates with the same operation name have the same name_id; name_id 0 is not used (initial resource state)
+class ccl_operation_t {
+public:
+    ccl_operation_type_t type;
+    utils::UInt name_id;
+};
+
+class ccl_operation_table_t;
+typedef std::shared_ptr<const ccl_operation_table_t> ccl_operation_table_ptr_t;
+
+// Operation type and name of each instruction in the platform's instruction_settings,
+// resolved from the configuration file once per loaded configuration;
+// it is shared read-only by all resource managers of the platforms of that configuration,
+// by their resources and by all their clones,
+// so that the availability checks in the inner loop of scheduler and mapper don't have to access json.
+// The operation of a gate made from an instruction of the platform is found by its instruction_id,
+// that of any other gate (e.g. one made by a backend by name) by its name.
+class ccl_operation_table_t {
+public:
+    explicit ccl_operation_table_t(const quantum_platform &platform);
+
+    // the table of the configuration of the platform, made on first use
+    static ccl_operation_table_ptr_t of(const quantum_platform &platform);
+
+    // operation of the instruction of the gate; fatal when the instruction is not in instruction_settings
+    const ccl_operation_t &get(gate *ins, const quantum_platform &platform) const {
+        utils::UInt index = ins->instruction_id - first_instruction_id;
+        if (index < by_instruction_id.size() && by_instruction_id[index] != nullptr) {
+            return *by_instruction_id[index];
+        }
+        return get_by_name(ins, platform);
+    }
+
+private:
+    const ccl_operation_t &get_by_name(gate *ins, const quantum_platform &platform) const;
+
+    std::shared_ptr<const instruction_map_t> instruction_map;   // the instructions indexed below, kept alive as key of the cache in of()
+    utils::Map<utils::Str, ccl_operation_t> operations;         // instruction name -> operation
+    utils::UInt first_instruction_id;                           // lowest instruction_id of the instructions of instruction_map
+    utils::Vec<const ccl_operation_t*> by_instruction_id;       // instruction_id - first_instruction_id -> operation, or nullptr when none
+};
+
+
+// ============ base of the cc_light resources
+// the generic available, reserve and next_available resolve the gate's operation
+// and then call available_op, reserve_op and next_available_op,
+// the cc_light resource manager resolves the operation only once for all its resources and calls those directly
+class ccl_resource_t : public resource_t {
+public:
+    ccl_resource_t(const utils::Str &n, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
+
+    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::UInt next_available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+
+    // operation_duration is in cycles, see ccl_get_operation_duration
+    virtual utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) = 0;
+    virtual void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) = 0;
+    virtual utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) = 0;
+
+protected:
+    ccl_operation_table_ptr_t optable;
+
+    // qubit pair to edge helper table from the grid configuration, as dense (qubit_count x qubit_count) matrix;
+    // used by the edge and detuned_qubits resources
+    static utils::Vec<utils::UInt> get_qubits2edge(const quantum_platform &platform, utils::UInt &qubit_count);
+};
+
 
 // ============ classes of resources that _may_ appear in a configuration file
 // these are a superset of those allocated by the cc_light_resource_manager_t constructor below
+// the constant tables describing the configuration (qubit2qwg, qubits2edge, etc.) are dense vectors
+// in which the entries that the configuration file doesn't define are NO_RESOURCE
+const utils::UInt NO_RESOURCE = utils::MAX;
 
 // Each qubit can be used by only one gate at a time.
-class ccl_qubit_resource_t : public resource_t {
+class ccl_qubit_resource_t : public ccl_resource_t {
 public:
     // fwd: qubit q is busy till cycle=state[q], i.e. all cycles < state[q] it is busy, i.e. start_cycle must be >= state[q]
     // bwd: qubit q is busy from cycle=state[q], i.e. all cycles >= state[q] it is busy, i.e. start_cycle+duration must be <= state[q]
     utils::Vec<utils::UInt> state;
 
-    ccl_qubit_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
+    ccl_qubit_resource_t(const quantum_platform &platform, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
 
     ccl_qubit_resource_t *clone() const & override;
     ccl_qubit_resource_t *clone() && override;
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
 };
 
 // Single-qubit rotation gates (instructions of 'mw' type) are controlled by qwgs.
 // Each qwg controls a private set of qubits.
 // A qwg can control multiple qubits at the same time, but only when they perform the same gate and start at the same time.
-class ccl_qwg_resource_t : public resource_t {
+class ccl_qwg_resource_t : public ccl_resource_t {
 public:
     utils::Vec<utils::UInt> fromcycle;          // qwg is busy from cycle==fromcycle[qwg], inclusive
     utils::Vec<utils::UInt> tocycle;            // qwg is busy to cycle==tocycle[qwg], not inclusive
@@ -62,34 +146,36 @@ public:
     // but a new y must wait until the last x has finished;
     // the bug was that a new x was always ok (so also when starting earlier than cycle i)
 
-    utils::Vec<utils::Str> operations;    // with operation_name==operations[qwg]
-    utils::Map<utils::UInt,utils::UInt> qubit2qwg;      // on qwg==qubit2qwg[q]
+    utils::Vec<utils::UInt> operations;         // with operation name_id==operations[qwg]
+    utils::Vec<utils::UInt> qubit2qwg;          // on qwg==qubit2qwg[q]
 
-    ccl_qwg_resource_t(const quantum_platform & platform, scheduling_direction_t dir);
+    ccl_qwg_resource_t(const quantum_platform &platform, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
 
     ccl_qwg_resource_t *clone() const & override;
     ccl_qwg_resource_t *clone() && override;
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
 };
 
 // Single-qubit measurements (instructions of 'readout' type) are controlled by measurement units.
 // Each one controls a private set of qubits.
 // A measurement unit can control multiple qubits at the same time, but only when they start at the same time.
-class ccl_meas_resource_t : public resource_t {
+class ccl_meas_resource_t : public ccl_resource_t {
 public:
     utils::Vec<utils::UInt> fromcycle;  // last measurement start cycle
     utils::Vec<utils::UInt> tocycle;    // is busy till cycle
-    utils::Map<utils::UInt,utils::UInt> qubit2meas;
+    utils::Vec<utils::UInt> qubit2meas;         // meas unit==qubit2meas[q]
 
-    ccl_meas_resource_t(const quantum_platform & platform, scheduling_direction_t dir);
+    ccl_meas_resource_t(const quantum_platform &platform, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
 
     ccl_meas_resource_t *clone() const & override;
     ccl_meas_resource_t *clone() && override;
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
 };
 
 // Two-qubit flux gates only operate on neighboring qubits, i.e. qubits connected by an edge.
@@ -101,23 +187,23 @@ public:
 // A parked qubit cannot engage in any gate, so also not a two-qubit gate.
 // As a consequence, for each edge executing a two-qubit gate,
 // certain other edges cannot execute a two-qubit gate in parallel.
-class ccl_edge_resource_t : public resource_t
-{
+class ccl_edge_resource_t : public ccl_resource_t {
 public:
     // fwd: edge is busy till cycle=state[edge], i.e. all cycles < state[edge] it is busy, i.e. start_cycle must be >= state[edge]
     // bwd: edge is busy from cycle=state[edge], i.e. all cycles >= state[edge] it is busy, i.e. start_cycle+duration must be <= state[edge]
     utils::Vec<utils::UInt> state;                          // machine state recording the cycles that given edge is free/busy
-    typedef utils::Pair<utils::UInt, utils::UInt> qubits_pair_t;
-    utils::Map<qubits_pair_t, utils::UInt> qubits2edge;      // constant helper table to find edge between a pair of qubits
-    utils::Map<utils::UInt, utils::Vec<utils::UInt>> edge2edges;  // constant "edges" table from configuration file
+    utils::UInt qubit_count;
+    utils::Vec<utils::UInt> qubits2edge;                    // constant helper table to find edge between a pair of qubits: qubits2edge[q0*qubit_count+q1]
+    utils::Vec<utils::Vec<utils::UInt>> edge2edges;         // constant "edges" table from configuration file
 
-    ccl_edge_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
+    ccl_edge_resource_t(const quantum_platform &platform, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
 
     ccl_edge_resource_t *clone() const & override;
     ccl_edge_resource_t *clone() && override;
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate * ins, const quantum_platform & platform) override;
+    utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
 };
 
 // A two-qubit flux gate lowers the frequency of its source qubit to get near the freq of its target qubit.
@@ -142,23 +228,24 @@ public:
 // so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than fromcycle[q],
 // since till that cycle is was likely to be busy with "mw", which doesn't allow a "flux" in parallel. Similar for backward scheduling.
 // The other members contain internal copies of the resource description and grid configuration of the json file.
-class ccl_detuned_qubits_resource_t : public resource_t {
+class ccl_detuned_qubits_resource_t : public ccl_resource_t {
 public:
     utils::Vec<utils::UInt> fromcycle;                              // qubit q is busy from cycle fromcycle[q]
     utils::Vec<utils::UInt> tocycle;                                // till cycle tocycle[q]
-    utils::Vec<utils::Str> operations;                        // with an operation of operation_type==operations[q]
+    utils::Vec<ccl_operation_type_t> operations;                    // with an operation of operation_type==operations[q]
 
-    typedef utils::Pair<utils::UInt, utils::UInt> qubits_pair_t;
-    utils::Map<qubits_pair_t, utils::UInt> qubitpair2edge;           // map: pair of qubits to edge (from grid configuration)
-    utils::Map<utils::UInt, utils::Vec<utils::UInt>> edge_detunes_qubits; // map: edge to vector of qubits that edge detunes (resource desc.)
+    utils::UInt qubit_count;
+    utils::Vec<utils::UInt> qubitpair2edge;                         // pair of qubits to edge (from grid configuration): qubitpair2edge[q0*qubit_count+q1]
+    utils::Vec<utils::Vec<utils::UInt>> edge_detunes_qubits;        // edge to vector of qubits that edge detunes (resource desc.)
 
-    ccl_detuned_qubits_resource_t(const quantum_platform &platform, scheduling_direction_t dir);
+    ccl_detuned_qubits_resource_t(const quantum_platform &platform, scheduling_direction_t dir, const ccl_operation_table_ptr_t &optable);
 
     ccl_detuned_qubits_resource_t *clone() const & override;
     ccl_detuned_qubits_resource_t *clone() && override;
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::Bool available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    void reserve_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
+    utils::UInt next_available_op(utils::UInt op_start_cycle, gate *ins, const ccl_operation_t &op, utils::UInt operation_duration) override;
 };
 
 // ============ platform specific resource_manager matching config file resources sections with resource classes above
@@ -176,6 +263,14 @@ public:
 
     cc_light_resource_manager_t *clone() const & override;
     cc_light_resource_manager_t *clone() && override;
+
+    // resolve the gate's operation once and check/reserve it for all resources
+    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+    utils::UInt next_available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) override;
+
+private:
+    ccl_operation_table_ptr_t optable;
 };
 
 } // namespace arch
@@ -22,6 +22,7 @@
 #include "circuit.h"
 #include "ir.h"
 #include "report.h"
+#include "parallel_kernels.h"
 
 #include "buffer_insertion.h"
 
@@ -108,9 +109,9 @@ void insert_buffer_delays(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    for (auto &kernel : programp->kernels) {
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
         insert_buffer_delays_kernel(kernel, platform);
-    }
+    });
 
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
@@ -184,21 +184,15 @@ classical::classical(const Str &operation) {
     }
 }
 
-instruction_t classical::qasm() const {
-    Str iopers;
-    Int sz = creg_operands.size();
-    for (Int i = 0; i < sz; ++i) {
-        if (i == sz - 1) {
-            iopers += " r" + to_string(creg_operands[i]);
-        } else {
-            iopers += " r" + to_string(creg_operands[i]) + ",";
-        }
+void classical::format_qasm(Str &buffer) const {
+    buffer += name;
+    for (UInt i = 0; i < creg_operands.size(); ++i) {
+        buffer += (i == 0) ? " r" : ", r";
+        append_uint(buffer, creg_operands[i]);
     }
-
     if (name == "ldi") {
-        return "ldi" + iopers + ", " + to_string(int_operand);
-    } else {
-        return name + iopers;
+        buffer += ", ";
+        append_int(buffer, int_operand);
     }
 }
 
@@ -80,7 +80,7 @@ public:
 
     classical(const creg &dest, const operation &oper);
     classical(const utils::Str &operation);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -9,6 +9,7 @@
 #include "report.h"
 #include "kernel.h"
 #include "options.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
@@ -290,10 +291,10 @@ void clifford_optimize(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    Clifford cliff;
-    for (auto &kernel : programp->kernels) {
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
+        Clifford cliff;
         cliff.clifford_optimize_kernel(kernel, platform, passname);
-    }
+    });
 
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
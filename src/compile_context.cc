@@ -0,0 +1,31 @@
+/** \file
+ * Per-compilation state, which keeps concurrent compilations apart.
+ */
+
+#include "compile_context.h"
+
+namespace ql {
+
+namespace {
+
+// context that is current on this thread
+thread_local CompileContext *current_context = nullptr;
+
+} // anonymous namespace
+
+CompileContext::CompileContext() : option_table(options::snapshot()) {
+}
+
+CompileContext *CompileContext::current() {
+    return current_context;
+}
+
+CompileContext::Scope::Scope(CompileContext *context) : previous(current_context) {
+    current_context = context;
+}
+
+CompileContext::Scope::~Scope() {
+    current_context = previous;
+}
+
+} // namespace ql
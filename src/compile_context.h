@@ -0,0 +1,81 @@
+/** \file
+ * Per-compilation state, which keeps concurrent compilations apart.
+ *
+ * \see compile_context.cc
+ */
+
+#pragma once
+
+#include <memory>
+#include "utils/num.h"
+#include "utils/thread_pool.h"
+#include "options.h"
+
+namespace ql {
+
+/**
+ * The state of a single compilation: its own copy of the options (and with
+ * that, its own output directory), and the pool over which it distributes its
+ * kernels.
+ *
+ * quantum_program::compile() and quantum_compiler::compile() create a context
+ * and make it current on the calling thread for the duration of the
+ * compilation. options::get() and options::set() operate on the options of the
+ * current context, so option changes made by passes stay within their
+ * compilation, and compilations running concurrently on different threads
+ * don't see each other's options. Threads that work for a compilation make its
+ * context current as well.
+ *
+ * A context can also be made current by the user, to give a thread options of
+ * its own: compilations started from that thread start from a copy of those.
+ */
+class CompileContext {
+public:
+
+    /**
+     * Creates a context with a copy of the options of the calling thread, i.e.
+     * those of its current context, or else the global options.
+     */
+    CompileContext();
+
+    CompileContext(const CompileContext &) = delete;
+    CompileContext &operator=(const CompileContext &) = delete;
+
+    /**
+     * Returns the context that is current on the calling thread, or nullptr
+     * if there is none.
+     */
+    static CompileContext *current();
+
+    /**
+     * While an object of this class exists, the given context is current on
+     * the thread that created it; the previous one is restored afterwards.
+     */
+    class Scope {
+    public:
+        explicit Scope(CompileContext *context);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        CompileContext *previous;
+    };
+
+    /**
+     * The options of this compilation.
+     */
+    std::shared_ptr<options::Options> option_table;
+
+    /**
+     * The pool of the outermost open ParallelKernelsScope if it has more than
+     * one worker, and whether for_each_kernel() is distributing kernels over
+     * it.
+     */
+    utils::ThreadPool *kernel_pool = nullptr;
+    utils::Bool distributing_kernels = false;
+
+};
+
+} // namespace ql
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include "options.h"
+#include "compile_context.h"
 
 namespace ql {
 
@@ -26,6 +27,11 @@ quantum_compiler::quantum_compiler(const Str &n) : name(n) {
  */
 void quantum_compiler::compile(quantum_program *program) {
     QL_DOUT("Compiler compiles program ");
+
+    // the passes work on this compilation's own copy of the options
+    CompileContext context;
+    CompileContext::Scope scope(&context);
+
     passManager->compile(program);
 }
 
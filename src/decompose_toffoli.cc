@@ -7,6 +7,7 @@
 #include "kernel.h"
 #include "decompose_toffoli.h"
 #include "options.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
@@ -30,6 +31,7 @@ static void decompose_toffoli_kernel(
             toff_kernel.instruction_map = kernel.instruction_map;
             toff_kernel.qubit_count = kernel.qubit_count;
             toff_kernel.cycle_time = kernel.cycle_time;
+            toff_kernel.arena = kernel.arena;
             toff_kernel.condition = g->condition;
             toff_kernel.cond_operands = g->cond_operands;
 
@@ -64,9 +66,9 @@ void decompose_toffoli(
     auto tdopt = options::get("decompose_toffoli");
     if (tdopt == "AM" || tdopt == "NC") {
         QL_IOUT("Decomposing Toffoli ...");
-        for (auto &kernel : programp->kernels) {
+        for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
             decompose_toffoli_kernel(kernel, platform);
-        }
+        });
     } else if (tdopt == "no") {
         QL_IOUT("Not Decomposing Toffoli ...");
     } else {
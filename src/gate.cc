@@ -17,30 +17,85 @@ Bool gate::is_conditional() const {
 }
 
 instruction_t gate::cond_qasm() const {
+    instruction_t buffer;
+    append_cond_qasm(buffer);
+    return buffer;
+}
+
+void gate::append_cond_qasm(Str &buffer) const {
     QL_ASSERT(gate::is_valid_cond(condition, cond_operands));
+    const char *prefix = "";    // up to the first operand
+    const char *infix = "";     // between the operands
+    const char *suffix = "";    // after the last operand
     switch (condition) {
         case cond_always:
-            return "";
+            return;
         case cond_never:
-            return instruction_t("cond(0) ");
+            buffer += "cond(0) ";
+            return;
         case cond_unary:
-            return instruction_t("cond(b[" + to_string(cond_operands[0]) + "]) ");
+            prefix = "cond(b["; suffix = "]) ";
+            break;
         case cond_not:
-            return instruction_t("cond(!b[" + to_string(cond_operands[0]) + "]) ");
+            prefix = "cond(!b["; suffix = "]) ";
+            break;
         case cond_and:
-            return instruction_t("cond(b[" + to_string(cond_operands[0]) + "]&&b[" + to_string(cond_operands[1]) + ") ");
+            prefix = "cond(b["; infix = "]&&b["; suffix = ") ";
+            break;
         case cond_nand:
-            return instruction_t("cond(!(b[" + to_string(cond_operands[0]) + "]&&b[" + to_string(cond_operands[1]) + ")) ");
+            prefix = "cond(!(b["; infix = "]&&b["; suffix = ")) ";
+            break;
         case cond_or:
-            return instruction_t("cond(b[" + to_string(cond_operands[0]) + "]||b[" + to_string(cond_operands[1]) + ") ");
+            prefix = "cond(b["; infix = "]||b["; suffix = ") ";
+            break;
         case cond_nor:
-            return instruction_t("cond(!(b[" + to_string(cond_operands[0]) + "]||b[" + to_string(cond_operands[1]) + ")) ");
+            prefix = "cond(!(b["; infix = "]||b["; suffix = ")) ";
+            break;
         case cond_xor:
-            return instruction_t("cond(b[" + to_string(cond_operands[0]) + "]^^b[" + to_string(cond_operands[1]) + ") ");
+            prefix = "cond(b["; infix = "]^^b["; suffix = ") ";
+            break;
         case cond_nxor:
-            return instruction_t("cond(!(b[" + to_string(cond_operands[0]) + "]^^b[" + to_string(cond_operands[1]) + ")) ");
+            prefix = "cond(!(b["; infix = "]^^b["; suffix = ")) ";
+            break;
+    }
+    buffer += prefix;
+    append_uint(buffer, cond_operands[0]);
+    if (cond_operands.size() == 2) {
+        buffer += infix;
+        append_uint(buffer, cond_operands[1]);
+    }
+    buffer += suffix;
+}
+
+/**
+ * Returns the gate in qasm layout.
+ */
+instruction_t gate::qasm() const {
+    instruction_t buffer;
+    format_qasm(buffer);
+    return buffer;
+}
+
+/**
+ * Appends the gate in qasm layout to buffer, without creating temporary
+ * strings; writers use this with a reused line buffer.
+ */
+void gate::append_qasm(Str &buffer) const {
+    format_qasm(buffer);
+}
+
+/**
+ * Appends the condition, the given gate name and the first num_qubits qubit
+ * operands in qasm layout, i.e. "<cond>name q[a],q[b]", to buffer.
+ */
+void gate::append_qubits_qasm(Str &buffer, const char *gate_name, UInt num_qubits) const {
+    append_cond_qasm(buffer);
+    buffer += gate_name;
+    for (UInt i = 0; i < num_qubits; i++) {
+        buffer += (i == 0) ? " q[" : ",q[";
+        append_uint(buffer, operands[i]);
+        buffer += "]";
     }
-    return "";
 }
 
 Bool gate::is_valid_cond(cond_type_t condition, const Vec<UInt> &cond_operands) {
@@ -68,8 +123,8 @@ identity::identity(UInt q) : m(identity_c) {
     operands.push_back(q);
 }
 
-instruction_t identity::qasm() const {
-    return instruction_t(cond_qasm() + "i q[" + to_string(operands[0]) + "]");
+void identity::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "i", 1);
 }
 
 gate_type_t identity::type() const {
@@ -86,8 +141,8 @@ hadamard::hadamard(UInt q) : m(hadamard_c) {
     operands.push_back(q);
 }
 
-instruction_t hadamard::qasm() const {
-    return instruction_t(cond_qasm() + "h q[" + to_string(operands[0]) + "]");
+void hadamard::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "h", 1);
 }
 
 gate_type_t hadamard::type() const {
@@ -104,8 +159,8 @@ phase::phase(UInt q) : m(phase_c) {
     operands.push_back(q);
 }
 
-instruction_t phase::qasm() const {
-    return instruction_t(cond_qasm() + "s q[" + to_string(operands[0]) + "]");
+void phase::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "s", 1);
 }
 
 gate_type_t phase::type() const {
@@ -125,8 +180,8 @@ phasedag::phasedag(UInt q) : m(phasedag_c) {
     operands.push_back(q);
 }
 
-instruction_t phasedag::qasm() const {
-    return instruction_t(cond_qasm() + "sdag q[" + to_string(operands[0]) + "]");
+void phasedag::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "sdag", 1);
 }
 
 gate_type_t phasedag::type() const {
@@ -148,8 +203,10 @@ rx::rx(UInt q, double theta) {
     m(1,1) = cos(angle/2);
 }
 
-instruction_t rx::qasm() const {
-    return instruction_t(cond_qasm() + "rx q[" + to_string(operands[0]) + "], " + to_string(angle));
+void rx::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "rx", 1);
+    buffer += ", ";
+    append_real(buffer, angle);
 }
 
 gate_type_t rx::type() const {
@@ -171,8 +228,10 @@ ry::ry(UInt q, double theta) {
     m(1,1) = cos(angle/2);
 }
 
-instruction_t ry::qasm() const {
-    return instruction_t(cond_qasm() + "ry q[" + to_string(operands[0]) + "], " + to_string(angle));
+void ry::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "ry", 1);
+    buffer += ", ";
+    append_real(buffer, angle);
 }
 
 gate_type_t ry::type() const {
@@ -194,8 +253,10 @@ rz::rz(UInt q, double theta) {
     m(1,1) = Complex(cos(angle/2), sin(angle/2));
 }
 
-instruction_t rz::qasm() const {
-    return instruction_t(cond_qasm() + "rz q[" + to_string(operands[0]) + "], " + to_string(angle));
+void rz::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "rz", 1);
+    buffer += ", ";
+    append_real(buffer, angle);
 }
 
 gate_type_t rz::type() const {
@@ -212,8 +273,8 @@ t::t(UInt q) : m(t_c) {
     operands.push_back(q);
 }
 
-instruction_t t::qasm() const {
-    return instruction_t(cond_qasm() + "t q[" + to_string(operands[0]) + "]");
+void t::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "t", 1);
 }
 
 gate_type_t t::type() const {
@@ -230,8 +291,8 @@ tdag::tdag(UInt q) : m(tdag_c) {
     operands.push_back(q);
 }
 
-instruction_t tdag::qasm() const {
-    return instruction_t(cond_qasm() + "tdag q[" + to_string(operands[0]) + "]");
+void tdag::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "tdag", 1);
 }
 
 gate_type_t tdag::type() const {
@@ -248,8 +309,8 @@ pauli_x::pauli_x(UInt q) : m(pauli_x_c) {
     operands.push_back(q);
 }
 
-instruction_t pauli_x::qasm() const {
-    return instruction_t(cond_qasm() + "x q[" + to_string(operands[0]) + "]");
+void pauli_x::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "x", 1);
 }
 
 gate_type_t pauli_x::type() const {
@@ -266,8 +327,8 @@ pauli_y::pauli_y(UInt q) : m(pauli_y_c) {
     operands.push_back(q);
 }
 
-instruction_t pauli_y::qasm() const {
-    return instruction_t(cond_qasm() + "y q[" + to_string(operands[0]) + "]");
+void pauli_y::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "y", 1);
 }
 
 gate_type_t pauli_y::type() const {
@@ -284,8 +345,8 @@ pauli_z::pauli_z(UInt q) : m(pauli_z_c) {
     operands.push_back(q);
 }
 
-instruction_t pauli_z::qasm() const {
-    return instruction_t(cond_qasm() + "z q[" + to_string(operands[0]) + "]");
+void pauli_z::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "z", 1);
 }
 
 gate_type_t pauli_z::type() const {
@@ -302,8 +363,8 @@ rx90::rx90(UInt q) : m(rx90_c) {
     operands.push_back(q);
 }
 
-instruction_t rx90::qasm() const {
-    return instruction_t(cond_qasm() + "x90 q[" + to_string(operands[0]) + "]");
+void rx90::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "x90", 1);
 }
 
 gate_type_t rx90::type() const {
@@ -320,8 +381,8 @@ mrx90::mrx90(UInt q) : m(mrx90_c) {
     operands.push_back(q);
 }
 
-instruction_t mrx90::qasm() const {
-    return instruction_t(cond_qasm() + "mx90 q[" + to_string(operands[0]) + "]");
+void mrx90::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "mx90", 1);
 }
 
 gate_type_t mrx90::type() const {
@@ -338,8 +399,8 @@ rx180::rx180(UInt q) : m(rx180_c) {
     operands.push_back(q);
 }
 
-instruction_t rx180::qasm() const {
-    return instruction_t(cond_qasm() + "x180 q[" + to_string(operands[0]) + "]");
+void rx180::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "x180", 1);
 }
 
 gate_type_t rx180::type() const {
@@ -356,8 +417,8 @@ ry90::ry90(UInt q) : m(ry90_c) {
     operands.push_back(q);
 }
 
-instruction_t ry90::qasm() const {
-    return instruction_t(cond_qasm() + "y90 q[" + to_string(operands[0]) + "]");
+void ry90::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "y90", 1);
 }
 
 gate_type_t ry90::type() const {
@@ -374,8 +435,8 @@ mry90::mry90(UInt q) : m(mry90_c) {
     operands.push_back(q);
 }
 
-instruction_t mry90::qasm() const {
-    return instruction_t(cond_qasm() + "my90 q[" + to_string(operands[0]) + "]");
+void mry90::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "my90", 1);
 }
 
 gate_type_t mry90::type() const {
@@ -392,8 +453,8 @@ ry180::ry180(UInt q) : m(ry180_c) {
     operands.push_back(q);
 }
 
-instruction_t ry180::qasm() const {
-    return instruction_t(cond_qasm() + "y180 q[" + to_string(operands[0]) + "]");
+void ry180::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "y180", 1);
 }
 
 gate_type_t ry180::type() const {
@@ -417,15 +478,15 @@ measure::measure(UInt q, UInt c) : m(identity_c) {
     creg_operands.push_back(c);
 }
 
-instruction_t measure::qasm() const {
-    StrStrm ss;
-    ss << "measure ";
-    ss << "q[" << operands[0] << "]";
+void measure::format_qasm(Str &buffer) const {
+    buffer += "measure q[";
+    append_uint(buffer, operands[0]);
+    buffer += "]";
     if (!creg_operands.empty()) {
-        ss << ", r[" << creg_operands[0] << "]";
+        buffer += ", r[";
+        append_uint(buffer, creg_operands[0]);
+        buffer += "]";
     }
-
-    return instruction_t(ss.str());
 }
 
 gate_type_t measure::type() const {
@@ -442,8 +503,8 @@ prepz::prepz(UInt q) : m(identity_c) {
     operands.push_back(q);
 }
 
-instruction_t prepz::qasm() const {
-    return instruction_t(cond_qasm() + "prep_z q[" + to_string(operands[0]) +"]");
+void prepz::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "prep_z", 1);
 }
 
 gate_type_t prepz::type() const {
@@ -461,9 +522,8 @@ cnot::cnot(UInt q1, UInt q2) : m(cnot_c) {
     operands.push_back(q2);
 }
 
-instruction_t cnot::qasm() const {
-    return instruction_t(cond_qasm() + "cnot q[" + to_string(operands[0]) + "]"
-                         + ",q[" + to_string(operands[1]) + "]");
+void cnot::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "cnot", 2);
 }
 
 gate_type_t cnot::type() const {
@@ -481,9 +541,8 @@ cphase::cphase(UInt q1, UInt q2) : m(cphase_c) {
     operands.push_back(q2);
 }
 
-instruction_t cphase::qasm() const {
-    return instruction_t(cond_qasm() + "cz q[" + to_string(operands[0]) + "]"
-                         + ",q[" + to_string(operands[1]) + "]");
+void cphase::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "cz", 2);
 }
 
 gate_type_t cphase::type() const {
@@ -502,10 +561,8 @@ toffoli::toffoli(UInt q1, UInt q2, UInt q3) : m(toffoli_c) {
     operands.push_back(q3);
 }
 
-instruction_t toffoli::qasm() const {
-    return instruction_t(cond_qasm() + "toffoli q[" + to_string(operands[0]) + "]"
-                         + ",q[" + to_string(operands[1]) + "]"
-                         + ",q[" + to_string(operands[2]) + "]");
+void toffoli::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "toffoli", 3);
 }
 
 gate_type_t toffoli::type() const {
@@ -521,8 +578,8 @@ nop::nop() : m(nop_c) {
     duration = 20;
 }
 
-instruction_t nop::qasm() const {
-    return instruction_t("nop");
+void nop::format_qasm(Str &buffer) const {
+    buffer += "nop";
 }
 
 gate_type_t nop::type() const {
@@ -540,9 +597,8 @@ swap::swap(UInt q1, UInt q2) : m(swap_c) {
     operands.push_back(q2);
 }
 
-instruction_t swap::qasm() const {
-    return instruction_t(cond_qasm() + "swap q[" + to_string(operands[0]) + "]"
-                         + ",q[" + to_string(operands[1]) + "]");
+void swap::format_qasm(Str &buffer) const {
+    append_qubits_qasm(buffer, "swap", 2);
 }
 
 gate_type_t swap::type() const {
@@ -566,8 +622,9 @@ wait::wait(Vec<UInt> qubits, UInt d, UInt dc) : m(nop_c) {
     }
 }
 
-instruction_t wait::qasm() const {
-    return instruction_t("wait " + to_string(duration_in_cycles));
+void wait::format_qasm(Str &buffer) const {
+    buffer += "wait ";
+    append_uint(buffer, duration_in_cycles);
 }
 
 gate_type_t wait::type() const {
@@ -583,8 +640,8 @@ SOURCE::SOURCE() : m(nop_c) {
     duration = 1;
 }
 
-instruction_t SOURCE::qasm() const {
-    return instruction_t("SOURCE");
+void SOURCE::format_qasm(Str &buffer) const {
+    buffer += "SOURCE";
 }
 
 gate_type_t SOURCE::type() const {
@@ -600,8 +657,8 @@ SINK::SINK() : m(nop_c) {
     duration = 1;
 }
 
-instruction_t SINK::qasm() const {
-    return instruction_t("SINK");
+void SINK::format_qasm(Str &buffer) const {
+    buffer += "SINK";
 }
 
 gate_type_t SINK::type() const {
@@ -617,8 +674,8 @@ display::display() : m(nop_c) {
     duration = 0;
 }
 
-instruction_t display::qasm() const {
-    return instruction_t("display");
+void display::format_qasm(Str &buffer) const {
+    buffer += "display";
 }
 
 gate_type_t display::type() const {
@@ -643,6 +700,7 @@ custom_gate::custom_gate(const custom_gate &g) {
     creg_operands = g.creg_operands;
     // int_operand = g.int_operand; FIXME
     duration = g.duration;
+    instruction_id = g.instruction_id;
     // angle = g.angle; FIXME
     // cycle = g.cycle; FIXME
     m.m[0] = g.m.m[0];
@@ -730,46 +788,34 @@ void custom_gate::print_info() const {
     QL_PRINTLN("    |- matrix   : [" << m.m[0] << ", " << m.m[1] << ", " << m.m[2] << ", " << m.m[3] << "]");
 }
 
-instruction_t custom_gate::qasm() const {
-    StrStrm ss;
+void custom_gate::format_qasm(Str &buffer) const {
     UInt p = name.find(' ');
-    Str gate_name = name.substr(0, p);
-    ss << cond_qasm();
-    if (operands.empty()) {
-        ss << gate_name;
-    } else if (operands.size() == 1) {
-        ss << gate_name << " q[" << operands[0] << "]";
-    } else {
-        ss << gate_name << " q[" << operands[0] << "]";
-        for (UInt i = 1; i < operands.size(); i++) {
-            ss << ",q[" << operands[i] << "]";
-        }
+    UInt gate_name_length = (p == Str::npos) ? name.length() : p;
+    append_cond_qasm(buffer);
+    buffer.append(name, 0, gate_name_length);
+    for (UInt i = 0; i < operands.size(); i++) {
+        buffer += (i == 0) ? " q[" : ",q[";
+        append_uint(buffer, operands[i]);
+        buffer += "]";
     }
 
     // deal with custom gates with argument, such as angle
-    if (gate_name == "rx" || gate_name == "ry" || gate_name == "rz") {	// FIXME: implicitly defining semantics here
-        ss << ", " << angle;
+    if (gate_name_length == 2 && name[0] == 'r' && (name[1] == 'x' || name[1] == 'y' || name[1] == 'z')) {	// FIXME: implicitly defining semantics here
+        buffer += ", ";
+        append_real(buffer, angle);
     }
 
-    if (creg_operands.size() == 1) {
-        ss << ", r[" << creg_operands[0] << "]";
-    } else if (creg_operands.size() > 1) {
-        ss << ", r[" << creg_operands[0] << "]";
-        for (size_t i = 1; i < creg_operands.size(); i++) {
-            ss << ", r[" << creg_operands[i] << "]";
-        }
+    for (UInt i = 0; i < creg_operands.size(); i++) {
+        buffer += ", r[";
+        append_uint(buffer, creg_operands[i]);
+        buffer += "]";
     }
 
-    if (breg_operands.size() == 1) {
-        ss << ", b[" << breg_operands[0] << "]";
-    } else if (breg_operands.size() > 1) {
-        ss << ", b[" << breg_operands[0] << "]";
-        for (size_t i = 1; i < breg_operands.size(); i++) {
-            ss << ", b[" << breg_operands[i] << "]";
-        }
+    for (UInt i = 0; i < breg_operands.size(); i++) {
+        buffer += ", b[";
+        append_uint(buffer, breg_operands[i]);
+        buffer += "]";
     }
-
-    return instruction_t(ss.str());
 }
 
 gate_type_t custom_gate::type() const {
@@ -793,12 +839,11 @@ composite_gate::composite_gate(const Str &name, const Vec<gate*> &seq) : custom_
     }
 }
 
-instruction_t composite_gate::qasm() const {
-    StrStrm instr;
+void composite_gate::format_qasm(Str &buffer) const {
     for (gate * g : gs) {
-        instr << g->qasm() << std::endl;
+        g->append_qasm(buffer);
+        buffer += "\n";
     }
-    return instruction_t(instr.str());
 }
 
 gate_type_t composite_gate::type() const {
@@ -180,6 +180,7 @@ typedef enum e_cond_type {
 } cond_type_t;
 
 const utils::UInt MAX_CYCLE = utils::MAX;
+const utils::UInt NO_INSTRUCTION = utils::MAX;
 
 /**
  * gate interface
@@ -196,14 +197,21 @@ public:
     utils::UInt duration = 0;
     utils::Real angle = 0.0;                      // for arbitrary rotations
     utils::UInt cycle = MAX_CYCLE;                // cycle after scheduling; MAX_CYCLE indicates undefined
+    utils::UInt instruction_id = NO_INSTRUCTION;  // id of the platform instruction this gate was made from, see hardware_configuration::load
     virtual ~gate() = default;
-    virtual instruction_t qasm() const = 0;
+    instruction_t qasm() const;                   // returns the gate in qasm layout
+    void append_qasm(utils::Str &buffer) const;   // appends the gate in qasm layout to buffer
+    virtual void format_qasm(utils::Str &buffer) const = 0;   // formats the gate in qasm layout into buffer
     virtual gate_type_t   type() const = 0;
     virtual cmat_t        mat()  const = 0;  // to do : change cmat_t type to avoid stack smashing on 2 qubits gate operations
     utils::Str visual_type = ""; // holds the visualization type of this gate that will be linked to a specific configuration in the visualizer
     utils::Bool is_conditional() const;           // whether gate has condition that is NOT cond_always
     instruction_t cond_qasm() const;              // returns the condition expression in qasm layout
+    void append_cond_qasm(utils::Str &buffer) const;  // appends the condition expression in qasm layout to buffer
     static utils::Bool is_valid_cond(cond_type_t condition, const utils::Vec<utils::UInt> &cond_operands);
+
+protected:
+    void append_qubits_qasm(utils::Str &buffer, const char *gate_name, utils::UInt num_qubits) const;
 };
 
 
@@ -216,7 +224,7 @@ class identity : public gate {
 public:
     cmat_t m;
     explicit identity(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -225,7 +233,7 @@ class hadamard : public gate {
 public:
     cmat_t m;
     explicit hadamard(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -234,7 +242,7 @@ class phase : public gate {
 public:
     cmat_t m;
     explicit phase(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -243,7 +251,7 @@ class phasedag : public gate {
 public:
     cmat_t m;
     explicit phasedag(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -252,7 +260,7 @@ class rx : public gate {
 public:
     cmat_t m;
     rx(utils::UInt q, utils::Real theta);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -261,7 +269,7 @@ class ry : public gate {
 public:
     cmat_t m;
     ry(utils::UInt q, utils::Real theta);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -270,7 +278,7 @@ class rz : public gate {
 public:
     cmat_t m;
     rz(utils::UInt q, utils::Real theta);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -279,7 +287,7 @@ class t : public gate {
 public:
     cmat_t m;
     explicit t(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -288,7 +296,7 @@ class tdag : public gate {
 public:
     cmat_t m;
     explicit tdag(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -297,7 +305,7 @@ class pauli_x : public gate {
 public:
     cmat_t m;
     explicit pauli_x(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -306,7 +314,7 @@ class pauli_y : public gate {
 public:
     cmat_t m;
     explicit pauli_y(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -315,7 +323,7 @@ class pauli_z : public gate {
 public:
     cmat_t m;
     explicit pauli_z(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -324,7 +332,7 @@ class rx90 : public gate {
 public:
     cmat_t m;
     explicit rx90(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -333,7 +341,7 @@ class mrx90 : public gate {
 public:
     cmat_t m;
     explicit mrx90(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -342,7 +350,7 @@ class rx180 : public gate {
 public:
     cmat_t m;
     explicit rx180(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -351,7 +359,7 @@ class ry90 : public gate {
 public:
     cmat_t m;
     explicit ry90(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -360,7 +368,7 @@ class mry90 : public gate {
 public:
     cmat_t m;
     explicit mry90(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -369,7 +377,7 @@ class ry180 : public gate {
 public:
     cmat_t m;
     explicit ry180(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -379,7 +387,7 @@ public:
     cmat_t m;
     explicit measure(utils::UInt q);
     measure(utils::UInt q, utils::UInt c);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -388,7 +396,7 @@ class prepz : public gate {
 public:
     cmat_t m;
     explicit prepz(utils::UInt q);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -397,7 +405,7 @@ class cnot : public gate {
 public:
     cmat_t m;
     cnot(utils::UInt q1, utils::UInt q2);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -406,7 +414,7 @@ class cphase : public gate {
 public:
     cmat_t m;
     cphase(utils::UInt q1, utils::UInt q2);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -415,7 +423,7 @@ class toffoli : public gate {
 public:
     cmat_t m;
     toffoli(utils::UInt q1, utils::UInt q2, utils::UInt q3);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -424,7 +432,7 @@ class nop : public gate {
 public:
     cmat_t m;
     nop();
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -433,7 +441,7 @@ class swap : public gate {
 public:
     cmat_t m;
     swap(utils::UInt q1, utils::UInt q2);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -448,7 +456,7 @@ public:
     utils::UInt duration_in_cycles;
 
     wait(utils::Vec<utils::UInt> qubits, utils::UInt d, utils::UInt dc);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -457,7 +465,7 @@ class SOURCE : public gate {
 public:
     cmat_t m;
     SOURCE();
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -466,7 +474,7 @@ class SINK : public gate {
 public:
     cmat_t m;
     SINK();
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -475,7 +483,7 @@ class display : public gate {
 public:
     cmat_t m;
     display();
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -490,7 +498,7 @@ public:
     static utils::UInt qubit_id(const utils::Str &qubit);
     void load(nlohmann::json &instr);
     void print_info() const;
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
@@ -501,7 +509,7 @@ public:
     utils::Vec<gate *> gs;
     explicit composite_gate(const utils::Str &name);
     composite_gate(const utils::Str &name, const utils::Vec<gate*> &seq);
-    instruction_t qasm() const override;
+    void format_qasm(utils::Str &buffer) const override;
     gate_type_t type() const override;
     cmat_t mat() const override;
 };
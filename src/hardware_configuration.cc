@@ -4,6 +4,7 @@
 
 #include "hardware_configuration.h"
 
+#include <atomic>
 #include <regex>
 
 namespace ql {
@@ -209,6 +210,16 @@ void hardware_configuration::load(
             instruction_map.set(comp_ins) = new composite_gate(comp_ins, gs);
         }
     }
+
+    // number the instructions, so that backends can resolve the instruction
+    // of a gate made from one (see custom_gate's copy constructor) to their
+    // settings by index instead of by name; the ids are unique in the process,
+    // so an id never matches an instruction of another configuration
+    static std::atomic<UInt> next_instruction_id(0);
+    UInt instruction_id = next_instruction_id.fetch_add(instruction_map.size());
+    for (auto &it : instruction_map) {
+        it.second->instruction_id = instruction_id++;
+    }
 }
 
 } // namespace ql
@@ -12,8 +12,7 @@ InteractionMatrix::InteractionMatrix(const circuit &ckt, UInt nqubits) {
     Size = nqubits;
     Matrix.resize(Size, Vec<UInt>(Size, 0));
     for (auto ins : ckt) {
-        Str insName = ins->qasm();
-        if (insName.find("cnot") != Str::npos) {
+        if (ins->name.find("cnot") != Str::npos) {
             // for now the interaction matrix only for cnot
             auto operands = ins->operands;
             if (operands.size() == 2) {
@@ -84,6 +84,94 @@ Str qasm(const bundles_t &bundles) {
     return ssqasm.str();
 }
 
+/**
+ * Returns whether the bundler ignores the given gate.
+ */
+static Bool is_ignored_by_bundler(const gate *gp) {
+    return gp->type() == gate_type_t::__wait_gate__ ||    // FIXME HvS: wait must be written as well
+           gp->type() == gate_type_t::__dummy_gate__;
+}
+
+/**
+ * Write the bundled-qasm external representation of the circuit with valid
+ * cycle information to the given stream. The gates of each cycle are written
+ * as soon as they have been found in the circuit, without creating bundles
+ * first; the output is the same as that of qasm(bundler(circ, cycle_time)).
+ *
+ * scans the circuit once, bundle by bundle; for each bundle, the gates in its
+ * cycle are first counted (to know whether braces are needed) and then written
+ */
+void write_qasm(std::ostream &out, const circuit &circ, UInt cycle_time) {
+    UInt curr_cycle=1;        // FIXME HvS prefer to start at 0; also see depgraph creation
+    Str skipgate = "wait";
+    if (options::get("issue_skip_319") == "yes") {
+        skipgate = "skip";
+    }
+
+    UInt bundle_cycle = 0;    // cycle of the last bundle, as in bundler
+    UInt bundle_duration = 0; // duration in cycles of the last bundle
+    Bool have_bundle = false;
+    Str line;                 // the line of the current bundle, reused to avoid allocations
+    auto gate_it = circ.begin();
+    while (true) {
+        while (gate_it != circ.end() && is_ignored_by_bundler(*gate_it)) {
+            ++gate_it;
+        }
+        if (gate_it == circ.end()) {
+            break;
+        }
+        UInt st_cycle = (*gate_it)->cycle;
+        if (st_cycle < bundle_cycle) {
+            QL_FATAL("Error: circuit not ordered by cycle value");
+        }
+
+        // find the end of the bundle at st_cycle, its number of gates and its duration
+        UInt ngates = 0;
+        UInt duration_in_cycles = 0;
+        auto bundle_end = gate_it;
+        for (; bundle_end != circ.end(); ++bundle_end) {
+            if (is_ignored_by_bundler(*bundle_end)) {
+                continue;
+            }
+            if ((*bundle_end)->cycle != st_cycle) {
+                break;
+            }
+            ngates++;
+            duration_in_cycles = max(duration_in_cycles, ((*bundle_end)->duration+cycle_time-1)/cycle_time);
+        }
+
+        auto delta = st_cycle - curr_cycle;
+        if (delta > 1) {
+            out << "    " << skipgate << " " << delta - 1 << "\n";
+        }
+        line = "    ";
+        if (ngates > 1) line += "{ ";
+        auto isfirst = 1;
+        for (; gate_it != bundle_end; ++gate_it) {
+            if (is_ignored_by_bundler(*gate_it)) {
+                continue;
+            }
+            if (isfirst == 0) {
+                line += " | ";
+            }
+            (*gate_it)->append_qasm(line);
+            isfirst = 0;
+        }
+        if (ngates > 1) line += " }";
+        curr_cycle+=delta;
+        line += "\n";
+        out << line;
+
+        bundle_cycle = st_cycle;
+        bundle_duration = duration_in_cycles;
+        have_bundle = true;
+    }
+
+    if (have_bundle && bundle_duration > 1) {
+        out << "    " << skipgate << " " << bundle_duration - 1 << "\n";
+    }
+}
+
 /**
  * Create a bundled internal representation from the circuit with valid cycle
  * information.
@@ -109,9 +197,7 @@ bundles_t bundler(const circuit &circ, UInt cycle_time) {
 
     for (auto &gp : circ) {
         QL_DOUT(". adding gate(@" << gp->cycle << ")  " << gp->qasm());
-        if (gp->type() == gate_type_t::__wait_gate__ ||    // FIXME HvS: wait must be written as well
-            gp->type() == gate_type_t::__dummy_gate__
-        ) {
+        if (is_ignored_by_bundler(gp)) {
             QL_DOUT("... ignoring: " << gp->qasm());
             continue;
         }
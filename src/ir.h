@@ -10,6 +10,8 @@
 #include "gate.h"
 #include "circuit.h"
 
+#include <ostream>
+
 namespace ql {
 namespace ir {
 
@@ -36,6 +38,14 @@ circuit circuiter(const bundles_t &bundles);
  */
 utils::Str qasm(const bundles_t &bundles);
 
+/**
+ * Write the bundled-qasm external representation of the circuit with valid
+ * cycle information to the given stream. The gates of each cycle are written
+ * as soon as they have been found in the circuit, without creating bundles
+ * first; the output is the same as that of qasm(bundler(circ, cycle_time)).
+ */
+void write_qasm(std::ostream &out, const circuit &circ, utils::UInt cycle_time);
+
 /**
  * Create a bundled internal representation from the circuit with valid cycle
  * information.
@@ -13,6 +13,8 @@
 #include "utils/json.h"
 #include "utils/str.h"
 #include "utils/vec.h"
+#include "utils/map.h"
+#include "utils/pair.h"
 #include "options.h"
 #include "gate.h"
 #include "classical.h"
@@ -25,7 +27,9 @@ namespace ql {
 using namespace utils;
 
 quantum_kernel::quantum_kernel(const Str &name) :
-    name(name), iterations(1), type(kernel_type_t::STATIC)
+    name(name), iterations(1), type(kernel_type_t::STATIC),
+    instruction_map(std::make_shared<const instruction_map_t>()),
+    arena(std::make_shared<utils::Arena>())
 {
     condition = cond_always;
 }
@@ -42,7 +46,8 @@ quantum_kernel::quantum_kernel(
     qubit_count(qcount),
     creg_count(ccount),
     breg_count(bcount),
-    type(kernel_type_t::STATIC)
+    type(kernel_type_t::STATIC),
+    arena(std::make_shared<utils::Arena>())
 {
     instruction_map = platform.instruction_map;
     cycle_time = platform.cycle_time;
@@ -73,7 +78,7 @@ void quantum_kernel::set_kernel_type(kernel_type_t typ) {
 Str quantum_kernel::get_gates_definition() const {
     StrStrm ss;
 
-    for (auto i = instruction_map.begin(); i != instruction_map.end(); i++) {
+    for (auto i = instruction_map->begin(); i != instruction_map->end(); i++) {
         ss << i->first << std::endl;
     }
     return ss.str();
@@ -108,21 +113,21 @@ void quantum_kernel::h(UInt qubit) {
 }
 
 void quantum_kernel::rx(UInt qubit, Real angle) {
-    c.push_back(new ql::rx(qubit,angle));
+    c.push_back(arena->make<ql::rx>(qubit,angle));
     c.back()->condition = condition;
     c.back()->cond_operands = cond_operands;;
     cycles_valid = false;
 }
 
 void quantum_kernel::ry(UInt qubit, Real angle) {
-    c.push_back(new ql::ry(qubit,angle));
+    c.push_back(arena->make<ql::ry>(qubit,angle));
     c.back()->condition = condition;
     c.back()->cond_operands = cond_operands;;
     cycles_valid = false;
 }
 
 void quantum_kernel::rz(UInt qubit, Real angle) {
-    c.push_back(new ql::rz(qubit,angle));
+    c.push_back(arena->make<ql::rz>(qubit,angle));
     c.back()->condition = condition;
     c.back()->cond_operands = cond_operands;;
     cycles_valid = false;
@@ -206,7 +211,7 @@ void quantum_kernel::cphase(UInt qubit1, UInt qubit2) {
 
 void quantum_kernel::toffoli(UInt qubit1, UInt qubit2, UInt qubit3) {
     // TODO add custom gate check if needed
-    c.push_back(new ql::toffoli(qubit1, qubit2, qubit3));
+    c.push_back(arena->make<ql::toffoli>(qubit1, qubit2, qubit3));
     c.back()->condition = condition;
     c.back()->cond_operands = cond_operands;;
     cycles_valid = false;
@@ -221,7 +226,7 @@ void quantum_kernel::wait(const Vec<UInt> &qubits, UInt duration) {
 }
 
 void quantum_kernel::display() {
-    c.push_back(new ql::display());
+    c.push_back(arena->make<ql::display>());
     cycles_valid = false;
 }
 
@@ -371,80 +376,80 @@ Bool quantum_kernel::add_default_gate_if_available(
     }
 
     if (gname == "identity" || gname == "i") {
-        c.push_back(new ql::identity(qubits[0]));
+        c.push_back(arena->make<ql::identity>(qubits[0]));
         result = true;
     } else if (gname == "hadamard" || gname == "h") {
-        c.push_back(new ql::hadamard(qubits[0]));
+        c.push_back(arena->make<ql::hadamard>(qubits[0]));
         result = true;
     } else if (gname == "pauli_x" || gname == "x") {
-        c.push_back(new pauli_x(qubits[0]));
+        c.push_back(arena->make<pauli_x>(qubits[0]));
         result = true;
     } else if( gname == "pauli_y" || gname == "y") {
-        c.push_back(new pauli_y(qubits[0]));
+        c.push_back(arena->make<pauli_y>(qubits[0]));
         result = true;
     } else if (gname == "pauli_z" || gname == "z") {
-        c.push_back(new pauli_z(qubits[0]));
+        c.push_back(arena->make<pauli_z>(qubits[0]));
         result = true;
     } else if (gname == "s" || gname == "phase") {
-        c.push_back(new phase(qubits[0]));
+        c.push_back(arena->make<phase>(qubits[0]));
         result = true;
     } else if (gname == "sdag" || gname == "phasedag") {
-        c.push_back(new phasedag(qubits[0]));
+        c.push_back(arena->make<phasedag>(qubits[0]));
         result = true;
     } else if (gname == "t") {
-        c.push_back(new ql::t(qubits[0]));
+        c.push_back(arena->make<ql::t>(qubits[0]));
         result = true;
     } else if (gname == "tdag") {
-        c.push_back(new ql::tdag(qubits[0]));
+        c.push_back(arena->make<ql::tdag>(qubits[0]));
         result = true;
     } else if (gname == "rx") {
-        c.push_back(new ql::rx(qubits[0], angle));
+        c.push_back(arena->make<ql::rx>(qubits[0], angle));
         result = true;
     } else if (gname == "ry") {
-        c.push_back(new ql::ry(qubits[0], angle));
+        c.push_back(arena->make<ql::ry>(qubits[0], angle));
         result = true;
     } else if( gname == "rz") {
-        c.push_back(new ql::rz(qubits[0], angle));
+        c.push_back(arena->make<ql::rz>(qubits[0], angle));
         result = true;
     } else if (gname == "rx90") {
-        c.push_back(new ql::rx90(qubits[0]));
+        c.push_back(arena->make<ql::rx90>(qubits[0]));
         result = true;
     } else if (gname == "mrx90") {
-        c.push_back(new ql::mrx90(qubits[0]));
+        c.push_back(arena->make<ql::mrx90>(qubits[0]));
         result = true;
     } else if (gname == "rx180") {
-        c.push_back(new ql::rx180(qubits[0]));
+        c.push_back(arena->make<ql::rx180>(qubits[0]));
         result = true;
     } else if (gname == "ry90") {
-        c.push_back(new ql::ry90(qubits[0]));
+        c.push_back(arena->make<ql::ry90>(qubits[0]));
         result = true;
     } else if (gname == "mry90") {
-        c.push_back(new ql::mry90(qubits[0]));
+        c.push_back(arena->make<ql::mry90>(qubits[0]));
         result = true;
     } else if (gname == "ry180") {
-        c.push_back(new ql::ry180(qubits[0]));
+        c.push_back(arena->make<ql::ry180>(qubits[0]));
         result = true;
     } else if (gname == "measure") {
         if (cregs.empty()) {
-            c.push_back(new ql::measure(qubits[0]));
+            c.push_back(arena->make<ql::measure>(qubits[0]));
         } else {
-            c.push_back(new ql::measure(qubits[0], cregs[0]));
+            c.push_back(arena->make<ql::measure>(qubits[0], cregs[0]));
         }
         result = true;
     } else if (gname == "prepz") {
-        c.push_back(new ql::prepz(qubits[0]));
+        c.push_back(arena->make<ql::prepz>(qubits[0]));
         result = true;
     } else if (gname == "cnot") {
-        c.push_back(new ql::cnot(qubits[0], qubits[1]));
+        c.push_back(arena->make<ql::cnot>(qubits[0], qubits[1]));
         result = true;
     } else if (gname == "cz" || gname == "cphase") {
-        c.push_back(new ql::cphase(qubits[0], qubits[1]) );
+        c.push_back(arena->make<ql::cphase>(qubits[0], qubits[1]) );
         result = true;
     } else if (gname == "toffoli") {
-        c.push_back(new ql::toffoli(qubits[0], qubits[1], qubits[2]));
+        c.push_back(arena->make<ql::toffoli>(qubits[0], qubits[1], qubits[2]));
         result = true;
     } else if (gname == "swap") {
-        c.push_back(new ql::swap(qubits[0], qubits[1]));
+        c.push_back(arena->make<ql::swap>(qubits[0], qubits[1]));
         result = true;
     } else if (gname == "barrier") {
         /*
@@ -456,9 +461,9 @@ Bool quantum_kernel::add_default_gate_if_available(
             for (UInt q = 0; q < qubit_count; q++) {
                 all_qubits.push_back(q);
             }
-            c.push_back(new ql::wait(all_qubits, 0, 0));
+            c.push_back(arena->make<ql::wait>(all_qubits, 0, 0));
         } else {
-            c.push_back(new ql::wait(qubits, 0, 0));
+            c.push_back(arena->make<ql::wait>(qubits, 0, 0));
         }
         result = true;
     } else if (gname == "wait") {
@@ -472,9 +477,9 @@ Bool quantum_kernel::add_default_gate_if_available(
             for (UInt q = 0; q < qubit_count; q++) {
                 all_qubits.push_back(q);
             }
-            c.push_back(new ql::wait(all_qubits, duration, duration_in_cycles));
+            c.push_back(arena->make<ql::wait>(all_qubits, duration, duration_in_cycles));
         } else {
-            c.push_back(new ql::wait(qubits, duration, duration_in_cycles));
+            c.push_back(arena->make<ql::wait>(qubits, duration, duration_in_cycles));
         }
         result = true;
     } else {
@@ -528,16 +533,32 @@ Bool quantum_kernel::add_custom_gate_if_available(
 
     // first check if a specialized custom gate is available
     // a specialized custom gate is of the form: "cz q0 q3"
-    instruction_map_t::iterator it = instruction_map.find(instr);
-    if (it == instruction_map.end()) {
-        it = instruction_map.find(gname);
+    auto it = instruction_map->find(instr);
+    if (it == instruction_map->end()) {
+        it = instruction_map->find(gname);
     }
-    if (it == instruction_map.end()) {
+    if (it == instruction_map->end()) {
         QL_DOUT("custom gate not added for " << gname);
         return false;
     }
 
-    custom_gate *g = new custom_gate(*(it->second));
+    add_custom_gate(*(it->second), qubits, cregs, duration, angle, bregs, gcond, gcondregs);
+    QL_DOUT("custom gate added for " << gname);
+    return true;
+}
+
+// add a custom gate as defined by the given gate definition to the circuit
+void quantum_kernel::add_custom_gate(
+    const custom_gate &definition,
+    const Vec<UInt> &qubits,
+    const Vec<UInt> &cregs,
+    UInt duration,
+    Real angle,
+    const Vec<UInt> &bregs,
+    cond_type_t gcond,
+    const Vec<UInt> &gcondregs
+) {
+    custom_gate *g = arena->make<custom_gate>(definition);
     for (auto qubit : qubits) {
         g->operands.push_back(qubit);
     }
@@ -554,10 +575,7 @@ Bool quantum_kernel::add_custom_gate_if_available(
     g->condition = gcond;
     g->cond_operands = gcondregs;
     c.push_back(g);
-
-    QL_DOUT("custom gate added for " << gname);
     cycles_valid = false;
-    return true;
 }
 
 // FIXME: move to class composite_gate?
@@ -572,8 +590,8 @@ void quantum_kernel::get_decomposed_ins(
     for (auto &agate : sub_gates) {
         Str &sub_ins = agate->name;
         QL_DOUT("  sub ins: " << sub_ins);
-        auto it = instruction_map.find(sub_ins);
-        if (it != instruction_map.end()) {
+        auto it = instruction_map->find(sub_ins);
+        if (it != instruction_map->end()) {
             sub_instructions.push_back(sub_ins);
         } else {
             throw Exception("[x] error : kernel::gate() : gate decomposition not available for '" + sub_ins + "'' in the target platform !", false);
@@ -610,8 +628,8 @@ Bool quantum_kernel::add_spec_decomposed_gate_if_available(
     QL_DOUT("specialized instruction name: " << instr_parameterized);
 
     // find the name
-    auto it = instruction_map.find(instr_parameterized);
-    if (it != instruction_map.end()) {
+    auto it = instruction_map->find(instr_parameterized);
+    if (it != instruction_map->end()) {
         // check gate type
         QL_DOUT("specialized composite gate found for " << instr_parameterized);
         composite_gate * gptr = (composite_gate *)(it->second);
@@ -706,8 +724,8 @@ Bool quantum_kernel::add_param_decomposed_gate_if_available(
     QL_DOUT("parameterized instruction name: " << instr_parameterized);
 
     // check for composite ins
-    auto it = instruction_map.find(instr_parameterized);
-    if (it != instruction_map.end()) {
+    auto it = instruction_map->find(instr_parameterized);
+    if (it != instruction_map->end()) {
         QL_DOUT("parameterized gate found for " << instr_parameterized);
         composite_gate * gptr = (composite_gate *)(it->second);
         if (gptr->type() == __composite_gate__) {
@@ -997,6 +1015,162 @@ Bool quantum_kernel::gate_nonfatal(
     return added;
 }
 
+/**
+ * batch gate creation, for creating large circuits fast
+ *
+ * each distinct gate name and number of qubits (and for names with specialized definitions,
+ * each distinct gate name and list of qubits) is resolved once, following the same order of checks as gate_nonfatal;
+ * when this finds a custom or default gate, its gates are added directly as such;
+ * when it finds a composite gate, or no definition at all, and for wait and barrier,
+ * the gates are created by gate() itself
+ */
+void quantum_kernel::gates(
+    const Vec<Str> &gnames,
+    const UInt *ids,
+    const UInt *nqubits,
+    UInt count,
+    const UInt *qubits,
+    UInt qubits_size,
+    const Real *angles
+) {
+    QL_DOUT("gates: " << count << " gates with " << gnames.size() << " distinct names");
+
+    // check the arrays before adding any gate
+    // (the operands of each gate are checked against those left, so that a huge number of qubits can't wrap the sum)
+    UInt total = 0;
+    for (UInt i = 0; i < count; i++) {
+        if (ids[i] >= gnames.size()) {
+            QL_FATAL("Gate name index " << ids[i] << " of gate " << i << " out of range of the " << gnames.size() << " gate names");
+        }
+        if (nqubits[i] > qubits_size - total) {
+            QL_FATAL("Number of qubit operands " << qubits_size << " is less than the sum of the numbers of qubits of the gates (" << nqubits[i] << " for gate " << i << " after " << total << ")");
+        }
+        total += nqubits[i];
+    }
+    if (total != qubits_size) {
+        QL_FATAL("Number of qubit operands " << qubits_size << " doesn't match the sum of the numbers of qubits of the gates (" << total << ")");
+    }
+
+    // how the gates of a name and qubits are added
+    enum class resolution_t { GENERAL, CUSTOM, DEFAULT };
+    struct resolved_t {
+        resolution_t resolution;
+        const custom_gate *definition;
+    };
+    Vec<Str> lnames;
+    Vec<Bool> specialized;
+    for (auto &gname : gnames) {
+        Str lname = to_lower(gname);
+        Str prefix = lname + " q";
+        auto it = instruction_map->lower_bound(prefix);
+        specialized.push_back(it != instruction_map->end() && it->first.compare(0, prefix.size(), prefix) == 0);
+        lnames.push_back(lname);
+    }
+    Bool use_default_gates = (options::get("use_default_gates") == "yes");
+    auto resolve = [&](UInt id, const Vec<UInt> &gqubits) {
+        const Str &lname = lnames[id];
+        if (lname == "wait" || lname == "barrier") {
+            return resolved_t{resolution_t::GENERAL, nullptr};
+        }
+        Str instr_specialized = "";
+        Str instr_parameterized = "";
+        for (UInt i = 0; i < gqubits.size(); i++) {
+            if (i > 0) {
+                instr_specialized += ",";
+                instr_parameterized += ",";
+            }
+            instr_specialized += "q" + to_string(gqubits[i]);
+            instr_parameterized += "%" + to_string(i);
+        }
+        auto spec = instruction_map->find(lname + " " + instr_specialized);
+        if (spec != instruction_map->end() && spec->second->type() == __composite_gate__) {
+            return resolved_t{resolution_t::GENERAL, nullptr};
+        }
+        auto it = instruction_map->find(lname + " " + instr_parameterized);
+        if (it != instruction_map->end() && it->second->type() == __composite_gate__) {
+            return resolved_t{resolution_t::GENERAL, nullptr};
+        }
+        if (spec != instruction_map->end()) {
+            return resolved_t{resolution_t::CUSTOM, spec->second};
+        }
+        it = instruction_map->find(lname);
+        if (it != instruction_map->end()) {
+            return resolved_t{resolution_t::CUSTOM, it->second};
+        }
+        if (use_default_gates) {
+            return resolved_t{resolution_t::DEFAULT, nullptr};
+        }
+        return resolved_t{resolution_t::GENERAL, nullptr};
+    };
+
+    // resolutions by name index, number of qubits, and for specialized names, the qubits
+    utils::Map<Vec<UInt>, resolved_t> resolutions;
+    Vec<UInt> key;
+
+    // the kernel's preset condition, imposed on all gates as gate_nonfatal does
+    Vec<UInt> condregs;
+    if (condition != cond_always) {
+        condregs = cond_operands;
+    }
+
+    c.reserve(c.size() + count);
+    Vec<UInt> lqubits;
+    Vec<UInt> lcregs;
+    Vec<UInt> lbregs;
+    const UInt *q = qubits;
+    for (UInt i = 0; i < count; i++) {
+        UInt id = ids[i];
+        UInt n = nqubits[i];
+        Real angle = (angles == nullptr ? 0.0 : angles[i]);
+        lqubits.assign(q, q + n);
+        q += n;
+
+        key.assign({id, n});
+        if (specialized[id]) {
+            key.insert(key.end(), lqubits.begin(), lqubits.end());
+        }
+        auto rit = resolutions.find(key);
+        if (rit == resolutions.end()) {
+            resolutions.set(key) = resolve(id, lqubits);
+            rit = resolutions.find(key);
+        }
+        const resolved_t &resolved = rit->second;
+        if (resolved.resolution == resolution_t::GENERAL) {
+            gate(gnames[id], lqubits, {}, 0, angle);
+            continue;
+        }
+
+        for (auto qno : lqubits) {
+            if (qno >= qubit_count) {
+                QL_FATAL("Number of qubits in platform: " << to_string(qubit_count) << ", specified qubit numbers out of range for gate: '" << gnames[id] << "' with qubits " << lqubits);
+            }
+        }
+        lcregs.clear();
+        lbregs.clear();
+        UInt duration = 0;
+        cond_type_t gcond = condition;
+        gate_add_implicits(gnames[id], lqubits, lcregs, duration, angle, lbregs, gcond, condregs);
+        if (resolved.resolution == resolution_t::CUSTOM) {
+            add_custom_gate(*resolved.definition, lqubits, lcregs, duration, angle, lbregs, gcond, condregs);
+        } else if (!add_default_gate_if_available(lnames[id], lqubits, lcregs, duration, angle, lbregs, gcond, condregs)) {
+            QL_FATAL("Unknown gate '" << gnames[id] << "' with qubits " << lqubits);
+        }
+    }
+}
+
+void quantum_kernel::gates(
+    const Vec<Str> &gnames,
+    const Vec<UInt> &ids,
+    const Vec<UInt> &nqubits,
+    const Vec<UInt> &qubits,
+    const Vec<Real> &angles
+) {
+    if (ids.size() != nqubits.size() || (!angles.empty() && angles.size() != ids.size())) {
+        QL_FATAL("Numbers of gate name indices (" << ids.size() << "), numbers of qubits (" << nqubits.size() << ") and angles (" << angles.size() << ") of gates differ");
+    }
+    gates(gnames, ids.data(), nqubits.data(), ids.size(), qubits.data(), qubits.size(), angles.empty() ? nullptr : angles.data());
+}
+
 // to add unitary to kernel
 void quantum_kernel::gate(
     const unitary &u,
@@ -1090,9 +1264,9 @@ Int quantum_kernel::recursiveRelationsForUnitaryDecomposition(
     } else { //n=1
         // DOUT("Adding the zyz decomposition gates at index: "<< i);
         // zyz gates happen on the only qubit in the list.
-        c.push_back(new ql::rz(qubits.back(), u.instructionlist[i]));
-        c.push_back(new ql::ry(qubits.back(), u.instructionlist[i + 1]));
-        c.push_back(new ql::rz(qubits.back(), u.instructionlist[i + 2]));
+        c.push_back(arena->make<ql::rz>(qubits.back(), u.instructionlist[i]));
+        c.push_back(arena->make<ql::ry>(qubits.back(), u.instructionlist[i + 1]));
+        c.push_back(arena->make<ql::rz>(qubits.back(), u.instructionlist[i + 2]));
         // How many gates this took
         return 3;
     }
@@ -1108,16 +1282,16 @@ void quantum_kernel::multicontrolled_rz(
     // DOUT("Adding a multicontrolled rz-gate at start index " << start_index << ", to " << to_string(qubits, "qubits: "));
     UInt idx;
     //The first one is always controlled from the last to the first qubit.
-    c.push_back(new ql::rz(qubits.back(),-instruction_list[start_index]));
-    c.push_back(new ql::cnot(qubits[0], qubits.back()));
+    c.push_back(arena->make<ql::rz>(qubits.back(),-instruction_list[start_index]));
+    c.push_back(arena->make<ql::cnot>(qubits[0], qubits.back()));
     for (UInt i = 1; i < end_index - start_index; i++) {
         idx = log2(((i)^((i)>>1))^((i+1)^((i+1)>>1)));
-        c.push_back(new ql::rz(qubits.back(),-instruction_list[i+start_index]));
-        c.push_back(new ql::cnot(qubits[idx], qubits.back()));
+        c.push_back(arena->make<ql::rz>(qubits.back(),-instruction_list[i+start_index]));
+        c.push_back(arena->make<ql::cnot>(qubits[idx], qubits.back()));
     }
     // The last one is always controlled from the next qubit to the first qubit
-    c.push_back(new ql::rz(qubits.back(),-instruction_list[end_index]));
-    c.push_back(new ql::cnot(qubits.end()[-2], qubits.back()));
+    c.push_back(arena->make<ql::rz>(qubits.back(),-instruction_list[end_index]));
+    c.push_back(arena->make<ql::cnot>(qubits.end()[-2], qubits.back()));
     cycles_valid = false;
 }
 
@@ -1132,17 +1306,17 @@ void quantum_kernel::multicontrolled_ry(
     UInt idx;
 
     //The first one is always controlled from the last to the first qubit.
-    c.push_back(new ql::ry(qubits.back(),-instruction_list[start_index]));
-    c.push_back(new ql::cnot(qubits[0], qubits.back()));
+    c.push_back(arena->make<ql::ry>(qubits.back(),-instruction_list[start_index]));
+    c.push_back(arena->make<ql::cnot>(qubits[0], qubits.back()));
 
     for (UInt i = 1; i < end_index - start_index; i++) {
         idx = log2(((i)^((i)>>1))^((i+1)^((i+1)>>1)));
-        c.push_back(new ql::ry(qubits.back(),-instruction_list[i+start_index]));
-        c.push_back(new ql::cnot(qubits[idx], qubits.back()));
+        c.push_back(arena->make<ql::ry>(qubits.back(),-instruction_list[i+start_index]));
+        c.push_back(arena->make<ql::cnot>(qubits[idx], qubits.back()));
     }
     // Last one is controlled from the next qubit to the first one.
-    c.push_back(new ql::ry(qubits.back(),-instruction_list[end_index]));
-    c.push_back(new ql::cnot(qubits.end()[-2], qubits.back()));
+    c.push_back(arena->make<ql::ry>(qubits.back(),-instruction_list[end_index]));
+    c.push_back(arena->make<ql::cnot>(qubits.end()[-2], qubits.back()));
     cycles_valid = false;
 }
 
@@ -1199,17 +1373,23 @@ Str quantum_kernel::get_epilogue() const {
     return ss.str();
 }
 
-Str quantum_kernel::qasm() const {
-    StrStrm ss;
-
-    ss << get_prologue();
+void quantum_kernel::write_qasm(std::ostream &os) const {
+    os << get_prologue();
 
+    Str line;
     for (UInt i = 0; i < c.size(); ++i) {
-        ss << "    " << c[i]->qasm() << "\n";
+        line = "    ";
+        c[i]->append_qasm(line);
+        line += "\n";
+        os << line;
     }
 
-    ss << get_epilogue();
+    os << get_epilogue();
+}
 
+Str quantum_kernel::qasm() const {
+    StrStrm ss;
+    write_qasm(ss);
     return  ss.str();
 }
 
@@ -1233,12 +1413,12 @@ void quantum_kernel::classical(const creg &destination, const operation &oper) {
         }
     }
 
-    c.push_back(new ql::classical(destination, oper));
+    c.push_back(arena->make<ql::classical>(destination, oper));
     cycles_valid = false;
 }
 
 void quantum_kernel::classical(const Str &operation) {
-    c.push_back(new ql::classical(operation));
+    c.push_back(arena->make<ql::classical>(operation));
     cycles_valid = false;
 }
 
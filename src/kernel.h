@@ -8,6 +8,7 @@
 #include "utils/str.h"
 #include "utils/vec.h"
 #include "utils/opt.h"
+#include "utils/arena.h"
 #include "gate.h"
 #include "circuit.h"
 #include "classical.h"
@@ -37,9 +38,10 @@ public: // FIXME: should be private
     utils::Bool             cycles_valid; // used in bundler to check if kernel has been scheduled
     utils::Opt<operation>   br_condition;
     utils::UInt             cycle_time;   // FIXME HvS just a copy of platform.cycle_time
-    instruction_map_t       instruction_map;
+    std::shared_ptr<const instruction_map_t> instruction_map; // the platform's, shared
     utils::Vec<utils::UInt> cond_operands;    // see gate interface: condition mode to make new gates conditional
     cond_type_t             condition;        // kernel condition mode is set by gate_preset_condition()
+    std::shared_ptr<utils::Arena> arena;      // owns the gates of c; shared by copies of the kernel, so by the program
 
 public:
     quantum_kernel(const utils::Str &name);
@@ -125,6 +127,18 @@ private:
         const utils::Vec<utils::UInt> &gcondregs = {}
     );
 
+    // add a custom gate as defined by the given gate definition to the circuit
+    void add_custom_gate(
+        const custom_gate &definition,
+        const utils::Vec<utils::UInt> &qubits,
+        const utils::Vec<utils::UInt> &cregs,
+        utils::UInt duration,
+        utils::Real angle,
+        const utils::Vec<utils::UInt> &bregs,
+        cond_type_t gcond,
+        const utils::Vec<utils::UInt> &gcondregs
+    );
+
     // FIXME: move to class composite_gate?
     // return the subinstructions of a composite gate
     // while doing, test whether the subinstructions have a definition (so they cannot be specialized or default ones!)
@@ -191,6 +205,31 @@ public:
     // to add unitary to kernel
     void gate(const unitary &u, const utils::Vec<utils::UInt> &qubits);
 
+    /**
+     * batch gate creation, for creating large circuits fast
+     *
+     * adds count gates; gate i is gnames[ids[i]] on the next nqubits[i] qubits of the flat qubits array,
+     * with angle angles[i] (or 0.0 when angles is nullptr);
+     * the result is identical to that of calling gate(gnames[ids[i]], {its qubits}, {}, 0, angles[i]) for each gate in turn,
+     * but each distinct gate name and number of qubits is resolved to its gate definition only once
+     */
+    void gates(
+        const utils::Vec<utils::Str> &gnames,
+        const utils::UInt *ids,
+        const utils::UInt *nqubits,
+        utils::UInt count,
+        const utils::UInt *qubits,
+        utils::UInt qubits_size,
+        const utils::Real *angles = nullptr
+    );
+    void gates(
+        const utils::Vec<utils::Str> &gnames,
+        const utils::Vec<utils::UInt> &ids,
+        const utils::Vec<utils::UInt> &nqubits,
+        const utils::Vec<utils::UInt> &qubits,
+        const utils::Vec<utils::Real> &angles = {}
+    );
+
     // terminology:
     // - composite/custom/default (in decreasing order of priority during lookup in the gate definition):
     //      - composite gate: a gate definition with subinstructions; when matched, decompose and add the subinstructions
@@ -280,6 +319,7 @@ public:
     // FIXME: create a separate QASM backend?
     utils::Str get_prologue() const;
     utils::Str get_epilogue() const;
+    void write_qasm(std::ostream &os) const;
     utils::Str qasm() const;
 
     void classical(const creg &destination, const operation &oper);
@@ -9,6 +9,7 @@
 #include "kernel.h"
 #include "circuit.h"
 #include "report.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
@@ -72,9 +73,9 @@ void latency_compensation(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    for (UInt k = 0; k < programp->kernels.size(); ++k) {
-        latency_compensation_kernel(programp->kernels[k], platform);
-    }
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
+        latency_compensation_kernel(kernel, platform);
+    });
 
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
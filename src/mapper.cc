@@ -4,11 +4,14 @@
 
 #include "mapper.h"
 
+#include <mutex>
+#include <numeric>
+#include <algorithm>
 #include "utils/filesystem.h"
+#include "compile_context.h"
 
 #ifdef INITIALPLACE
 #include <thread>
-#include <mutex>
 #include <condition_variable>
 #include <lemon/lp.h>
 #endif
@@ -18,6 +21,113 @@ namespace mapper {
 
 using namespace utils;
 
+// mapper options initializer
+// parse the mapper options from the global options once for the whole program
+void MapperOptions::Init() {
+    Str mapperopt = options::get("mapper");
+    if (mapperopt == "base") {
+        mapper = mk_base;
+    } else if (mapperopt == "baserc") {
+        mapper = mk_baserc;
+    } else if (mapperopt == "minextend") {
+        mapper = mk_minextend;
+    } else if (mapperopt == "minextendrc") {
+        mapper = mk_minextendrc;
+    } else if (mapperopt == "maxfidelity") {
+        mapper = mk_maxfidelity;
+    } else if (mapperopt == "sabre") {
+        mapper = mk_sabre;
+    } else {
+        QL_FATAL("Unknown value of mapper option " << mapperopt);
+    }
+    mapper_rc = (mapper == mk_baserc || mapper == mk_minextendrc);
+
+    Str maplookaheadopt = options::get("maplookahead");
+    if (maplookaheadopt == "no") {
+        maplookahead = ml_no;
+    } else if (maplookaheadopt == "1qfirst") {
+        maplookahead = ml_1qfirst;
+    } else if (maplookaheadopt == "noroutingfirst") {
+        maplookahead = ml_noroutingfirst;
+    } else if (maplookaheadopt == "all") {
+        maplookahead = ml_all;
+    } else {
+        QL_FATAL("Unknown value of maplookahead option " << maplookaheadopt);
+    }
+
+    Str mappathselectopt = options::get("mappathselect");
+    if (mappathselectopt == "all") {
+        mappathselect = mp_all;
+    } else if (mappathselectopt == "borders") {
+        mappathselect = mp_borders;
+    } else {
+        QL_FATAL("Unknown value of mapppathselect option " << mappathselectopt);
+    }
+
+    Str mapselectswapsopt = options::get("mapselectswaps");
+    if (mapselectswapsopt == "one") {
+        mapselectswaps = ms_one;
+    } else if (mapselectswapsopt == "all") {
+        mapselectswaps = ms_all;
+    } else if (mapselectswapsopt == "earliest") {
+        mapselectswaps = ms_earliest;
+    } else {
+        QL_FATAL("Unknown value of mapselectswaps option " << mapselectswapsopt);
+    }
+
+    Str mapselectmaxwidthopt = options::get("mapselectmaxwidth");
+    if (mapselectmaxwidthopt == "min") {
+        mapselectmaxwidth = mw_min;
+    } else if (mapselectmaxwidthopt == "minplusone") {
+        mapselectmaxwidth = mw_minplusone;
+    } else if (mapselectmaxwidthopt == "minplushalfmin") {
+        mapselectmaxwidth = mw_minplushalfmin;
+    } else if (mapselectmaxwidthopt == "minplusmin") {
+        mapselectmaxwidth = mw_minplusmin;
+    } else if (mapselectmaxwidthopt == "all") {
+        mapselectmaxwidth = mw_all;
+    } else {
+        QL_FATAL("Unknown value of mapselectmaxwidth option " << mapselectmaxwidthopt);
+    }
+
+    Str mapselectmaxlevelopt = options::get("mapselectmaxlevel");
+    mapselectmaxlevel = (mapselectmaxlevelopt == "inf") ? MAX_CYCLE : parse_int(mapselectmaxlevelopt);
+
+    Str maptiebreakopt = options::get("maptiebreak");
+    if (maptiebreakopt == "first") {
+        maptiebreak = mt_first;
+    } else if (maptiebreakopt == "last") {
+        maptiebreak = mt_last;
+    } else if (maptiebreakopt == "random") {
+        maptiebreak = mt_random;
+    } else if (maptiebreakopt == "critical") {
+        maptiebreak = mt_critical;
+    } else {
+        QL_FATAL("Unknown value of maptiebreak option " << maptiebreakopt);
+    }
+
+    Str mapseedopt = options::get("mapseed");
+    mapseeded = (mapseedopt != "none");
+    mapseed = mapseeded ? parse_uint(mapseedopt) : 0;
+
+    mapthreads = options::get_threads("mapthreads");
+
+    maprecNN2q = (options::get("maprecNN2q") == "yes");
+    mapreverseswap = (options::get("mapreverseswap") == "yes");
+    mapprepinitsstate = (options::get("mapprepinitsstate") == "yes");
+
+    Str mapusemovesopt = options::get("mapusemoves");
+    mapusemoves = (mapusemovesopt != "no");
+    mapusemoves_threshold = (mapusemovesopt == "yes" || mapusemovesopt == "no") ? 0 : parse_int(mapusemovesopt);
+
+    Str mapsabrepassesopt = options::get("mapsabrepasses");
+    Int passes = parse_int(mapsabrepassesopt);
+    if (passes < 0) {
+        QL_FATAL("Value of mapsabrepasses option must be a number of at least 0, not " << mapsabrepassesopt);
+    }
+    mapsabrepasses = passes;
+}
+
 // Grid initializer
 // initialize mapper internal grid maps from configuration
 // this remains constant over multiple kernels on the same platform
@@ -51,7 +161,7 @@ void Grid::Init(const quantum_platform *p) {
     InitXY();
     InitNbs();
     SortNbs();
-    ComputeDist();
+    ComputePaths();
     DPRINTGrid();
 }
 
@@ -73,9 +183,20 @@ Bool Grid::IsInterCoreHop(UInt qs, UInt qt) const {
 // formulae for convex (hole free) topologies with underlying grid and with bidirectional edges:
 //      gf_cross:   max( abs( x[to_realqi] - x[from_realqi] ), abs( y[to_realqi] - y[from_realqi] ))
 //      gf_plus:    abs( x[to_realqi] - x[from_realqi] ) + abs( y[to_realqi] - y[from_realqi] )
-// when the neighbor relation is defined (topology.edges in config file), Floyd-Warshall is used, which currently is always
+// when the neighbor relation is defined (topology.edges in config file), breadth-first search is used, which currently is always
 UInt Grid::Distance(UInt from_realqi, UInt to_realqi) const {
-    return dist[from_realqi][to_realqi];
+    return paths->dist[from_realqi*nq + to_realqi];
+}
+
+// number of neighbors of from_realqi that start a shortest path to to_realqi
+UInt Grid::NextHopCount(UInt from_realqi, UInt to_realqi) const {
+    UInt pair = from_realqi*nq + to_realqi;
+    return paths->hopsbegin[pair+1] - paths->hopsbegin[pair];
+}
+
+// i-th of those neighbors, in the order of nbs[from_realqi] after Normalize
+UInt Grid::NextHop(UInt from_realqi, UInt to_realqi, UInt i) const {
+    return paths->hops[paths->hopsbegin[from_realqi*nq + to_realqi] + i];
 }
 
 // coredistance between two qubits
@@ -167,23 +288,44 @@ void Grid::Normalize(UInt src, neighbors_t &nbl) const {
     // for (auto dn : nbl) { std::cout << dn << " "; } std::cout << std::endl;
 }
 
-// Floyd-Warshall dist[i][j] = shortest distances between all nq qubits i and j
-void Grid::ComputeDist() {
-    // initialize all distances to maximum value, to neighbors to 1, to itself to 0
-    dist.resize(nq); for (UInt i=0; i<nq; i++) dist[i].resize(nq, MAX_CYCLE);
-    for (UInt i = 0; i < nq; i++) {
-        dist[i][i] = 0;
-        for (UInt j : nbs.get(i)) {
-            dist[i][j] = 1;
-        }
+// compute the shortest path tables of this topology, or take them from the cache
+// when another grid already computed them
+//
+// the tables only depend on the number of qubits and on the topology section of the platform,
+// so all kernels and programs compiled for platforms with the same topology share a single copy;
+// the cache is protected by a mutex because kernels may be mapped in parallel
+void Grid::ComputePaths() {
+    static std::mutex cachemutex;
+    static Map<Str, std::shared_ptr<const Paths>> cache;
+
+    Str key = to_string(nq) + ":" + platformp->topology.dump();
+    std::lock_guard<std::mutex> cachelock(cachemutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        QL_DOUT("... shortest path tables taken from cache");
+        paths = it->second;
+        return;
     }
 
-    // find shorter distances by gradually including more qubits (k) in path
-    for (UInt k = 0; k < nq; k++) {
-        for (UInt i = 0; i < nq; i++) {
-            for (UInt j = 0; j < nq; j++) {
-                if (dist[i][j] > dist[i][k] + dist[k][j]) {
-                    dist[i][j] = dist[i][k] + dist[k][j];
+    std::shared_ptr<Paths> p = std::make_shared<Paths>();
+    paths = p;
+
+    // breadth-first search from each qubit i gives the distances from i to all qubits j;
+    // qubits that cannot be reached keep distance MAX_CYCLE
+    p->dist.resize(nq*nq, MAX_CYCLE);
+    Vec<UInt> queue(nq);
+    for (UInt i = 0; i < nq; i++) {
+        UInt *di = &p->dist[i*nq];
+        di[i] = 0;
+        queue[0] = i;
+        UInt head = 0;
+        UInt tail = 1;
+        while (head < tail) {
+            UInt k = queue[head++];
+            for (UInt j : nbs.get(k)) {
+                if (di[j] == MAX_CYCLE) {
+                    di[j] = di[k] + 1;
+                    queue[tail++] = j;
                 }
             }
         }
@@ -192,16 +334,42 @@ void Grid::ComputeDist() {
     for (UInt i = 0; i < nq; i++) {
         for (UInt j = 0; j < nq; j++) {
             if (form == gf_cross) {
-                QL_ASSERT (dist[i][j] == (max(abs(x[i] - x[j]),
+                QL_ASSERT (Distance(i, j) == (max(abs(x[i] - x[j]),
                                                       abs(y[i] - y[j]))));
             } else if (form == gf_plus) {
-                QL_ASSERT (dist[i][j] ==
+                QL_ASSERT (Distance(i, j) ==
                               (abs(x[i] - x[j]) + abs(y[i] - y[j])));
             }
 
         }
     }
 #endif
+
+    // the next hops from i to j are the neighbors n of i with distance(n,j) == distance(i,j)-1;
+    // these form a DAG per target j in which each walk from i to j is a shortest path;
+    // they are stored in nbs order and normalized, as GenShortestPaths needs them
+    p->hopsbegin.resize(nq*nq + 1);
+    for (UInt i = 0; i < nq; i++) {
+        for (UInt j = 0; j < nq; j++) {
+            p->hopsbegin[i*nq + j] = p->hops.size();
+            if (i == j) {
+                continue;
+            }
+            neighbors_t nbl;
+            for (UInt n : nbs.get(i)) {
+                if (Distance(n, j) < Distance(i, j)) {
+                    nbl.push_back(n);
+                }
+            }
+            if (form == gf_xy) {
+                Normalize(i, nbl);
+            }
+            p->hops.insert(p->hops.end(), nbl.begin(), nbl.end());
+        }
+    }
+    p->hopsbegin[nq*nq] = p->hops.size();
+
+    cache.set(key) = paths;
 }
 
 void Grid::DPRINTGrid() const {
@@ -387,6 +555,7 @@ realstate_t Virt2Real::GetRs(UInt q) const {
 }
 
 void Virt2Real::SetRs(UInt q, realstate_t rsvalue) {
+    undo.save(rs[q]);
     rs[q] = rsvalue;
 }
 
@@ -461,6 +630,7 @@ UInt Virt2Real::AllocQubit(UInt v) {
         if (vt >= nq) {
             // real qubit r was not found in v2rMap
             // use it to map v
+            undo.save(v2rMap[v]);
             v2rMap[v] = r;
             QL_ASSERT(rs[r] == rs_wasinited || rs[r] == rs_nostate);
             QL_DOUT("AllocQubit(v=" << v << ") in r=" << r);
@@ -487,6 +657,7 @@ void Virt2Real::Swap(UInt r0, UInt r1) {
         QL_ASSERT(rs[r0] != rs_hasstate);
     } else {
         QL_ASSERT(v0 < nq);
+        undo.save(v2rMap[v0]);
         v2rMap[v0] = r1;
     }
 
@@ -494,15 +665,26 @@ void Virt2Real::Swap(UInt r0, UInt r1) {
         QL_ASSERT(rs[r1] != rs_hasstate);
     } else {
         QL_ASSERT(v1 < nq);
+        undo.save(v2rMap[v1]);
         v2rMap[v1] = r0;
     }
 
+    undo.save(rs[r0]);
+    undo.save(rs[r1]);
     realstate_t ts = rs[r0];
     rs[r0] = rs[r1];
     rs[r1] = ts;
     // DPRINT("... after swap");
 }
 
+void Virt2Real::Checkpoint() {
+    undo.checkpoint();
+}
+
+void Virt2Real::Rollback() {
+    undo.rollback();
+}
+
 void Virt2Real::DPRINTReal(UInt r) const {
     if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
         PrintReal(r);
@@ -620,11 +802,12 @@ FreeCycle::FreeCycle() {
     QL_DOUT("Constructing FreeCycle");
 }
 
-void FreeCycle::Init(const quantum_platform *p, const UInt breg_count) {
+void FreeCycle::Init(const quantum_platform *p, const MapperOptions *o, const UInt breg_count) {
     QL_DOUT("FreeCycle::Init()");
     arch::resource_manager_t lrm(*p, forward_scheduling);   // allocated here and copied below to rm because of platform parameter
     QL_DOUT("... created FreeCycle Init local resource_manager");
     platformp = p;
+    optionsp = o;
     nq = platformp->qubit_number;
     nb = breg_count;
     ct = platformp->cycle_time;
@@ -699,8 +882,7 @@ Bool FreeCycle::IsFirstOperandEarlier(UInt r0, UInt r1) const {
 // will a swap(fr0,fr1) start earlier than a swap(sr0,sr1)?
 // is really a short-cut ignoring config file and perhaps several other details
 Bool FreeCycle::IsFirstSwapEarliest(UInt fr0, UInt fr1, UInt sr0, UInt sr1) const {
-    Str mapreverseswapopt = options::get("mapreverseswap");
-    if (mapreverseswapopt == "yes") {
+    if (optionsp->mapreverseswap) {
         if (fcv[fr0] < fcv[fr1]) {
             UInt  tmp = fr1; fr1 = fr0; fr0 = tmp;
         }
@@ -742,8 +924,7 @@ UInt FreeCycle::StartCycleNoRc(gate *g) const {
 UInt FreeCycle::StartCycle(gate *g) {
     UInt startCycle = StartCycleNoRc(g);
 
-    auto mapopt = options::get("mapper");
-    if (mapopt == "baserc" || mapopt == "minextendrc") {
+    if (optionsp->mapper_rc) {
         UInt baseStartCycle = startCycle;
 
         while (startCycle < MAX_CYCLE) {
@@ -773,9 +954,11 @@ void FreeCycle::AddNoRc(gate *g, UInt startCycle) {
     UInt duration = (g->duration+ct-1)/ct;   // rounded-up unsigned integer division
     UInt freeCycle = startCycle + duration;
     for (auto qreg : g->operands) {
+        undo.save(fcv[qreg]);
         fcv[qreg] = freeCycle;
     }
     for (auto breg : g->breg_operands) {
+        undo.save(fcv[nq+breg]);
         fcv[nq+breg] = freeCycle;
     }
 }
@@ -787,12 +970,21 @@ void FreeCycle::AddNoRc(gate *g, UInt startCycle) {
 void FreeCycle::Add(gate *g, UInt startCycle) {
     AddNoRc(g, startCycle);
 
-    auto mapopt = options::get("mapper");
-    if (mapopt == "baserc" || mapopt == "minextendrc") {
+    if (optionsp->mapper_rc) {
         rm.reserve(startCycle, g, *platformp);
     }
 }
 
+void FreeCycle::Checkpoint() {
+    undo.checkpoint();
+    rm.checkpoint();
+}
+
+void FreeCycle::Rollback() {
+    rm.rollback();
+    undo.rollback();
+}
+
 // explicit Past constructor
 // needed for virgin construction
 Past::Past() {
@@ -800,9 +992,10 @@ Past::Past() {
 }
 
 // past initializer
-void Past::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
+void Past::Init(const quantum_platform *p, const MapperOptions *o, quantum_kernel *k, Grid *g) {
     QL_DOUT("Past::Init");
     platformp = p;
+    optionsp = o;
     kernelp = k;
     gridp = g;
 
@@ -812,13 +1005,41 @@ void Past::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
 
     QL_ASSERT(kernelp->c.empty());   // kernelp->c will be used by new_gate to return newly created gates into
     v2r.Init(nq);               // v2r initializtion until v2r is imported from context
-    fc.Init(platformp, nb);     // fc starts off with all qubits free, is updated after schedule of each gate
+    fc.Init(platformp, optionsp, nb);   // fc starts off with all qubits free, is updated after schedule of each gate
     waitinglg.clear();          // no gates pending to be scheduled in; Add of gate to past entered here
     lg.clear();                 // no gates scheduled yet in this past; after schedule of gate, it gets here
     outlg.clear();              // no gates output yet by flushing from or bypassing this past
     nswapsadded = 0;            // no swaps or moves added yet to this past; AddSwap adds one here
     nmovesadded = 0;            // no moves added yet to this past; AddSwap may add one here
     cycle.clear();              // no gates have cycles assigned in this past; scheduling gate updates this
+    changes.clear();            // no checkpoints open, so no changes to undo
+    changemarks.clear();
+}
+
+// initialize this past as a stand-in for the given past, to evaluate alternatives on in another thread
+void Past::InitFrom(const Past &past, quantum_kernel *k) {
+    QL_DOUT("Past::InitFrom");
+    platformp = past.platformp;
+    optionsp = past.optionsp;
+    kernelp = k;
+    gridp = past.gridp;
+
+    nq = past.nq;
+    nb = past.nb;
+    ct = past.ct;
+
+    QL_ASSERT(kernelp->c.empty());
+    QL_ASSERT(past.changemarks.empty());
+    v2r = past.v2r;             // the mapping and the free cycle map determine the cost of alternatives
+    fc = past.fc;               // deep copy, including the resource manager
+    waitinglg.clear();          // the gate lists don't; gates added are only kept until rolled back
+    lg.clear();
+    outlg.clear();
+    nswapsadded = past.nswapsadded;
+    nmovesadded = past.nmovesadded;
+    cycle.clear();
+    changes.clear();
+    changemarks.clear();
 }
 
 // import Past's v2r from v2r_value
@@ -856,7 +1077,6 @@ void Past::Print(const Str &s) const {
 // the FreeCycle map reflects for each qubit the first free cycle
 // all new gates, now in waitinglist, get such a cycle assigned below, increased gradually, until definitive
 void Past::Schedule() {
-    // the copy includes the resource manager.
     // DOUT("Schedule ...");
 
     while (!waitinglg.empty()) {
@@ -876,16 +1096,24 @@ void Past::Schedule() {
         // and that shouldn't be changed.
         //
         // This search is really a hack to avoid
-        // the construction of a dependence graph and a set of schedulable gates
-        FreeCycle   tryfc = fc;
-        for (auto &trygp : waitinglg) {
-            UInt tryStartCycle = tryfc.StartCycle(trygp);
-            tryfc.Add(trygp, tryStartCycle);
-
-            if (tryStartCycle < startCycle) {
-                startCycle = tryStartCycle;
-                gp = trygp;
+        // the construction of a dependence graph and a set of schedulable gates.
+        // Instead of on a copy, the try is done on fc itself under a checkpoint, and rolled back afterwards;
+        // with a single gate waiting, its start cycle is all that is needed.
+        if (waitinglg.size() == 1) {
+            gp = waitinglg.front();
+            startCycle = fc.StartCycle(gp);
+        } else {
+            fc.Checkpoint();
+            for (auto &trygp : waitinglg) {
+                UInt tryStartCycle = fc.StartCycle(trygp);
+                fc.Add(trygp, tryStartCycle);
+
+                if (tryStartCycle < startCycle) {
+                    startCycle = tryStartCycle;
+                    gp = trygp;
+                }
             }
+            fc.Rollback();
         }
 
         // add this gate to the maps, scheduling the gate (doing the cycle assignment)
@@ -916,6 +1144,13 @@ void Past::Schedule() {
         if (!inserted) {
             lg.push_front(gp);
         }
+        if (!changemarks.empty()) {
+            PastChange pc;
+            pc.kind = pc_schedule;
+            pc.gp = gp;
+            pc.count = 0;
+            changes.push_back(pc);
+        }
 
         // having added it to the main list, remove it from the waiting list
         waitinglg.remove(gp);
@@ -960,6 +1195,49 @@ void Past::Add(gate_p gp) {
     waitinglg.push_back(gp);
 }
 
+// open a checkpoint on the state of this past
+void Past::Checkpoint() {
+    QL_ASSERT(waitinglg.empty());
+    v2r.Checkpoint();
+    fc.Checkpoint();
+    undo.checkpoint();
+    changemarks.push_back(changes.size());
+}
+
+// undo all changes since the most recent checkpoint, and close it
+// the changes to the gate lists are undone in reverse order, so each finds the lists as it left them
+void Past::Rollback() {
+    QL_ASSERT(waitinglg.empty());
+    QL_ASSERT(!changemarks.empty());
+    UInt mark = changemarks.back();
+    changemarks.pop_back();
+    while (changes.size() > mark) {
+        const PastChange &pc = changes.back();
+        if (pc.kind == pc_schedule) {
+            // gp was inserted in lg near the end, so search for it from there
+            auto rigp = lg.rbegin();
+            while (*rigp != pc.gp) {
+                rigp++;
+            }
+            lg.erase(std::next(rigp).base());
+            cycle.erase(pc.gp);
+        } else if (pc.kind == pc_flush) {
+            // lg was empty after the flush, so move the flushed gates from the end of outlg back into it
+            for (UInt i = 0; i < pc.count; i++) {
+                lg.push_front(outlg.back());
+                outlg.pop_back();
+            }
+        } else {
+            QL_ASSERT(pc.kind == pc_bypass);
+            outlg.pop_back();
+        }
+        changes.pop_back();
+    }
+    undo.rollback();
+    fc.Rollback();
+    v2r.Rollback();
+}
+
 // create a new gate with given name and qubits
 // return whether this was successful
 // return the created gate(s) in circ (which is supposed to be empty on entry)
@@ -1029,9 +1307,8 @@ void Past::GenMove(circuit &circ, UInt &r0, UInt &r1) {
 
     // first (optimistically) create the move circuit and add it to circ
     Bool created;
-    auto mapperopt = options::get("mapper");
     if (gridp->IsInterCoreHop(r0, r1)) {
-        if (mapperopt == "maxfidelity") {
+        if (optionsp->mapper == mk_maxfidelity) {
             created = new_gate(circ, "tmove_prim", {r0,r1});    // gates implementing tmove returned in circ
         } else {
             created = new_gate(circ, "tmove_real", {r0,r1});    // gates implementing tmove returned in circ
@@ -1043,7 +1320,7 @@ void Past::GenMove(circuit &circ, UInt &r0, UInt &r1) {
             }
         }
     } else {
-        if (mapperopt == "maxfidelity") {
+        if (optionsp->mapper == mk_maxfidelity) {
             created = new_gate(circ, "move_prim", {r0,r1});    // gates implementing move returned in circ
         } else {
             created = new_gate(circ, "move_real", {r0,r1});    // gates implementing move returned in circ
@@ -1077,13 +1354,7 @@ void Past::GenMove(circuit &circ, UInt &r0, UInt &r1) {
         // when difference in extending circuit after scheduling initcirc+circ or just circ
         // is less equal than threshold cycles (0 would mean scheduling initcirc was for free),
         // commit to it, otherwise abort
-        Int threshold;
-        Str mapusemovesopt = options::get("mapusemoves");
-        if (mapusemovesopt == "yes") {
-            threshold = 0;
-        } else {
-            threshold = atoi(mapusemovesopt.c_str());
-        }
+        Int threshold = optionsp->mapusemoves_threshold;
         if (InsertionCost(initcirc, circ) <= threshold) {
             // so we go for it!
             // circ contains move; it must get the initcirc before it ...
@@ -1128,8 +1399,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
     }
 
     circuit circ;   // current kernel copy, clear circuit
-    Str mapusemovesopt = options::get("mapusemoves");
-    if (mapusemovesopt != "no" && (v2r.GetRs(r0) != rs_hasstate || v2r.GetRs(r1) != rs_hasstate)) {
+    if (optionsp->mapusemoves && (v2r.GetRs(r0) != rs_hasstate || v2r.GetRs(r1) != rs_hasstate)) {
         GenMove(circ, r0, r1);
         created = circ.size()!=0;
         if (created) {
@@ -1137,6 +1407,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
             // move is in circ, optionally with initialization in front of it
             // also rs of its 2nd operand is 'rs_wasinited'
             // note that after swap/move, r0 will be in this state then
+            undo.save(nmovesadded);
             nmovesadded++;                       // for reporting at the end
             QL_DOUT("... move(q" << r0 << ",q" << r1 << ") ...");
         } else {
@@ -1145,8 +1416,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
     }
     if (!created) {
         // no move generated so do swap
-        Str mapreverseswapopt = options::get("mapreverseswap");
-        if (mapreverseswapopt == "yes") {
+        if (optionsp->mapreverseswap) {
             // swap(r0,r1) is about to be generated
             // it is functionally symmetrical,
             // but in the implementation r1 starts 1 cycle earlier than r0 (we should derive this from json file ...)
@@ -1157,9 +1427,8 @@ void Past::AddSwap(UInt r0, UInt r1) {
                 QL_DOUT("... reversed swap to become swap(q" << r0 << ",q" << r1 << ") ...");
             }
         }
-        auto mapperopt = options::get("mapper");
         if (gridp->IsInterCoreHop(r0, r1)) {
-            if (mapperopt == "maxfidelity") {
+            if (optionsp->mapper == mk_maxfidelity) {
                 created = new_gate(circ, "tswap_prim", {r0,r1});    // gates implementing tswap returned in circ
             } else {
                 created = new_gate(circ, "tswap_real", {r0,r1});    // gates implementing tswap returned in circ
@@ -1172,7 +1441,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
             }
             QL_DOUT("... tswap(q" << r0 << ",q" << r1 << ") ...");
         } else {
-            if (mapperopt == "maxfidelity") {
+            if (optionsp->mapper == mk_maxfidelity) {
                 created = new_gate(circ, "swap_prim", {r0,r1});    // gates implementing swap returned in circ
             } else {
                 created = new_gate(circ, "swap_real", {r0,r1});    // gates implementing swap returned in circ
@@ -1186,6 +1455,7 @@ void Past::AddSwap(UInt r0, UInt r1) {
             QL_DOUT("... swap(q" << r0 << ",q" << r1 << ") ...");
         }
     }
+    undo.save(nswapsadded);
     nswapsadded++;                       // for reporting at the end
     for (auto &gp : circ) {
         Add(gp);
@@ -1211,6 +1481,11 @@ UInt Past::MapQubit(UInt v) {
     return r;
 }
 
+// find real qubit index implementing virtual qubit index, UNDEFINED_QUBIT when not yet mapped
+UInt Past::GetReal(UInt v) const {
+    return v2r[v];
+}
+
 void Past::stripname(Str &name) {
     QL_DOUT("stripname(name=" << name << ")");
     UInt p = name.find(" ");
@@ -1256,17 +1531,15 @@ void Past::MakeReal(gate *gp, circuit &circ) {
     Vec<UInt> real_qubits = gp->operands;// starts off as copy of virtual qubits!
     for (auto &qi : real_qubits) {
         qi = MapQubit(qi);          // and now they are real
-        auto mapprepinitsstateopt = options::get("mapprepinitsstate");
-        if (mapprepinitsstateopt == "yes" && (gname == "prepz" || gname == "Prepz")) {
+        if (optionsp->mapprepinitsstate && (gname == "prepz" || gname == "Prepz")) {
             v2r.SetRs(qi, rs_wasinited);
         } else {
             v2r.SetRs(qi, rs_hasstate);
         }
     }
 
-    auto mapperopt = options::get("mapper");
     Str real_gname = gname;
-    if (mapperopt == "maxfidelity") {
+    if (optionsp->mapper == mk_maxfidelity) {
         QL_DOUT("MakeReal: with mapper==maxfidelity generate _prim");
         real_gname.append("_prim");
     } else {
@@ -1351,6 +1624,13 @@ UInt Past::MaxFreeCycle() const {
 // - nonq gates first cause lg to be flushed/cleared to output before the nonq gate is output
 // all gates in outlg are out of view for scheduling/mapping optimization and can be taken out to elsewhere
 void Past::FlushAll() {
+    if (!changemarks.empty() && !lg.empty()) {
+        PastChange pc;
+        pc.kind = pc_flush;
+        pc.gp = nullptr;
+        pc.count = lg.size();
+        changes.push_back(pc);
+    }
     for (auto &gp : lg) {
         outlg.push_back(gp);
     }
@@ -1368,6 +1648,13 @@ void Past::ByPass(gate *gp) {
         FlushAll();
     }
     outlg.push_back(gp);
+    if (!changemarks.empty()) {
+        PastChange pc;
+        pc.kind = pc_bypass;
+        pc.gp = gp;
+        pc.count = 0;
+        changes.push_back(pc);
+    }
 }
 
 // mainPast flushes outlg to parameter oc
@@ -1386,16 +1673,16 @@ Alter::Alter() {
 
 // Alter initializer
 // This should only be called after a virgin construction and not after cloning a path.
-void Alter::Init(const quantum_platform *p, quantum_kernel *k, Grid *g) {
+void Alter::Init(const quantum_platform *p, const MapperOptions *o, quantum_kernel *k, Grid *g) {
     QL_DOUT("Alter::Init(number of qubits=" << p->qubit_number);
     platformp = p;
+    optionsp = o;
     kernelp = k;
     gridp = g;
 
     nq = platformp->qubit_number;
     ct = platformp->cycle_time;
     // total, fromSource and fromTarget start as empty vectors
-    past.Init(platformp, kernelp, gridp);      // initializes past to empty
     didscore = false;                   // will not print score for now
 }
 
@@ -1488,19 +1775,14 @@ void Alter::Print(const Str &s, const List<Alter> &la) {
     }
 }
 
-// add a node to the path in front, extending its length with one
-void Alter::Add2Front(UInt q) {
-    total.insert(total.begin(), q); // hopelessly inefficient
-}
-
 // add to a max of maxnumbertoadd swap gates for the current path to the given past
 // this past can be a path-local one or the main past
 // after having added them, schedule the result into that past
-void Alter::AddSwaps(Past &past, const Str &mapselectswapsopt) const {
+void Alter::AddSwaps(Past &past, mapselectswaps_t mapselectswapsopt) const {
     // DOUT("Addswaps " << mapselectswapsopt);
-    if (mapselectswapsopt == "one" || mapselectswapsopt == "all") {
+    if (mapselectswapsopt == ms_one || mapselectswapsopt == ms_all) {
         UInt  numberadded = 0;
-        UInt  maxnumbertoadd = ("one"==mapselectswapsopt ? 1 : MAX_CYCLE);
+        UInt  maxnumbertoadd = (ms_one == mapselectswapsopt ? 1 : MAX_CYCLE);
 
         UInt  fromSourceQ;
         UInt  toSourceQ;
@@ -1522,7 +1804,7 @@ void Alter::AddSwaps(Past &past, const Str &mapselectswapsopt) const {
             numberadded++;
         }
     } else {
-        QL_ASSERT("earliest" == mapselectswapsopt);
+        QL_ASSERT(ms_earliest == mapselectswapsopt);
         if (fromSource.size() >= 2 && fromTarget.size() >= 2) {
             if (past.IsFirstSwapEarliest(fromSource[0], fromSource[1], fromTarget[0], fromTarget[1])) {
                 past.AddSwap(fromSource[0], fromSource[1]);
@@ -1539,33 +1821,32 @@ void Alter::AddSwaps(Past &past, const Str &mapselectswapsopt) const {
     past.Schedule();
 }
 
-// compute cycle extension of the current alternative in prevPast relative to the given base past
+// compute cycle extension of the current alternative in currPast relative to the given base past
 //
 // Extend can be called in a deep exploration where pasts have been extended
 // each one on top of a previous one, starting from the base past;
 // the currPast here is the last extended one, i.e. on top of which this extension should be done;
-// the basePast is the ultimate base past relative to which the total extension is to be computed.
+// baseFreeCycle is the max free cycle of the ultimate base past relative to which the total extension is to be computed.
 //
-// Do this by adding the swaps described by this alternative
-// to an alternative-local copy of the current past;
-// keep this resulting past in the current alternative (for later use);
+// Do this by adding the swaps described by this alternative to the current past under a checkpoint;
 // compute the total extension of all pasts relative to the base past
-// and store this extension in the alternative's score for later use
-void Alter::Extend(const Past &currPast, const Past &basePast) {
-    // DOUT("... clone past, add swaps, compute overall score and keep it all in current alternative");
-    past = currPast;   // explicitly clone currPast to an alternative-local copy of it, Alter.past
-    // DOUT("... adding swaps to alternative-local past ...");
-    AddSwaps(past, "all");
-    // DOUT("... done adding/scheduling swaps to alternative-local past");
-
-    auto mapperopt = options::get("mapper");
-    if (mapperopt == "maxfidelity") {
+// and store this extension in the alternative's score for later use;
+// then roll the current past back, so that it is unchanged on return
+void Alter::Extend(Past &currPast, UInt baseFreeCycle) {
+    // DOUT("... checkpoint past, add swaps, compute overall score, and roll back past");
+    currPast.Checkpoint();
+    // DOUT("... adding swaps to past ...");
+    AddSwaps(currPast, ms_all);
+    // DOUT("... done adding/scheduling swaps to past");
+
+    if (optionsp->mapper == mk_maxfidelity) {
         QL_FATAL("Mapper option maxfidelity has been disabled");
-        // score = quick_fidelity(past.lg);
+        // score = quick_fidelity(currPast.lg);
     } else {
-        score = past.MaxFreeCycle() - basePast.MaxFreeCycle();
+        score = currPast.MaxFreeCycle() - baseFreeCycle;
     }
     didscore = true;
+    currPast.Rollback();
 }
 
 // split the path
@@ -1629,9 +1910,11 @@ void Alter::Split(const Grid &grid, List<Alter> &resla) const {
 }
 
 // just program wide initialization
-void Future::Init(const quantum_platform *p) {
+void Future::Init(const quantum_platform *p, const MapperOptions *o) {
     // DOUT("Future::Init ...");
     platformp = p;
+    optionsp = o;
+    setcycles = true;
     // DOUT("Future::Init [DONE]");
 }
 
@@ -1641,21 +1924,16 @@ void Future::Init(const quantum_platform *p) {
 void Future::SetCircuit(quantum_kernel &kernel, Scheduler &sched, UInt nq, UInt nc, UInt nb) {
     QL_DOUT("Future::SetCircuit ...");
     schedp = &sched;
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "no") {
+    if (optionsp->maplookahead == ml_no) {
         input_gatepv = kernel.c;                                // copy to free original circuit to allow outputing to
         input_gatepp = input_gatepv.begin();                    // iterator set to start of input circuit copy
     } else {
         schedp->init(kernel.c, *platformp, nq, nc, nb);         // fills schedp->graph (dependence graph) from all of circuit
         // and so also the original circuit can be output to after this
-        for (auto &gp : kernel.c) {
-            scheduled.set(gp) = false;   // none were scheduled
-        }
-        scheduled.set(schedp->instruction[schedp->s]) = false;      // also the dummy nodes not
-        scheduled.set(schedp->instruction[schedp->t]) = false;
-        avlist.clear();
-        avlist.push_back(schedp->s);
+        schedp->init_pending(forward_scheduling, pending);  // none were scheduled, also the dummy nodes not
         schedp->set_remaining(forward_scheduling);          // to know criticality
+        avlist.clear();
+        avlist.insert(schedp->s, schedp->criticality[schedp->s]);
 
         if (options::get("print_dot_graphs") == "yes") {
             Str map_dot;
@@ -1676,8 +1954,7 @@ void Future::SetCircuit(quantum_kernel &kernel, Scheduler &sched, UInt nq, UInt
 // Return whether some non-quantum gate was found
 Bool Future::GetNonQuantumGates(List<gate*> &nonqlg) const {
     nonqlg.clear();
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "no") {
+    if (optionsp->maplookahead == ml_no) {
         gate* gp = *input_gatepp;
         if (circuit::const_iterator(input_gatepp) != input_gatepv.end()) {
             if (
@@ -1689,7 +1966,7 @@ Bool Future::GetNonQuantumGates(List<gate*> &nonqlg) const {
         }
     } else {
         for (auto n : avlist) {
-            gate*  gp = schedp->instruction[n];
+            gate*  gp = schedp->graph.instruction(n);
             if (
                 gp->type() == __classical_gate__
                 || gp->type() == __dummy_gate__
@@ -1705,8 +1982,7 @@ Bool Future::GetNonQuantumGates(List<gate*> &nonqlg) const {
 // Return whether some gate was found
 Bool Future::GetGates(List<gate*> &qlg) const {
     qlg.clear();
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "no") {
+    if (optionsp->maplookahead == ml_no) {
         if (input_gatepp != input_gatepv.end()) {
             gate *gp = *input_gatepp;
             if (gp->operands.size() > 2) {
@@ -1716,7 +1992,7 @@ Bool Future::GetGates(List<gate*> &qlg) const {
         }
     } else {
         for (auto n : avlist) {
-            gate *gp = schedp->instruction[n];
+            gate *gp = schedp->graph.instruction(n);
             if (gp->operands.size() > 2) {
                 QL_FATAL(" gate: " << gp->qasm() << " has more than 2 operand qubits; please decompose such gates first before mapping.");
             }
@@ -1729,19 +2005,61 @@ Bool Future::GetGates(List<gate*> &qlg) const {
 // Indicate that a gate currently in avlist has been mapped, can be taken out of the avlist
 // and its successors can be made available
 void Future::DoneGate(gate *gp) {
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "no") {
+    if (optionsp->maplookahead == ml_no) {
         input_gatepp = std::next(input_gatepp);
     } else {
-        schedp->TakeAvailable(schedp->node.at(gp), avlist, scheduled, forward_scheduling);
+        schedp->TakeAvailable(schedp->graph.node_of(gp), avlist, pending, forward_scheduling, setcycles);
+    }
+}
+
+// Get into ext the first maxsize two-qubit gates that become available
+// when the gates currently in avlist and the gates that become available after them are done,
+// breadth first; this is the extended set of sabre's lookahead
+void Future::GetExtendedSet(UInt maxsize, Vec<gate*> &ext) const {
+    ext.clear();
+    if (optionsp->maplookahead == ml_no) {
+        if (input_gatepp == input_gatepv.end()) {
+            return;
+        }
+        for (auto it = std::next(input_gatepp); it != input_gatepv.end() && ext.size() < maxsize; ++it) {
+            gate *gp = *it;
+            if (gp->type() != __classical_gate__ && gp->type() != __wait_gate__ && gp->operands.size() == 2) {
+                ext.push_back(gp);
+            }
+        }
+        return;
+    }
+
+    // walk the dependence graph from the avlist with private pending counts, only for the nodes visited
+    Map<DepGraph::Node, UInt> left;
+    Vec<DepGraph::Node> visit;
+    for (auto n : avlist) {
+        visit.push_back(n);
+    }
+    for (UInt i = 0; i < visit.size() && ext.size() < maxsize; i++) {
+        for (auto succArc : schedp->graph.out_arcs(visit[i])) {
+            auto succNode = schedp->graph.target(succArc);
+            auto it = left.find(succNode);
+            UInt count = (it == left.end() ? pending[succNode] : it->second) - 1;
+            left.set(succNode) = count;
+            if (count == 0) {
+                gate *gp = schedp->graph.instruction(succNode);
+                if (gp->type() != __classical_gate__ && gp->type() != __wait_gate__ && gp->operands.size() == 2) {
+                    ext.push_back(gp);
+                    if (ext.size() >= maxsize) {
+                        break;
+                    }
+                }
+                visit.push_back(succNode);
+            }
+        }
     }
 }
 
 // Return gp in lag that is most critical (provided lookahead is enabled)
 // This is used in tiebreak, when every other option has failed to make a distinction.
 gate *Future::MostCriticalIn(List<gate*> &lag) const {
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "no") {
+    if (optionsp->maplookahead == ml_no) {
         return lag.front();
     } else {
         return schedp->find_mostcritical(lag);
@@ -1750,6 +2068,8 @@ gate *Future::MostCriticalIn(List<gate*> &lag) const {
 
 #ifdef INITIALPLACE
 using namespace lemon;
+#endif // INITIALPLACE
+
 // =========================================================================================
 // InitialPlace: initial placement solved as an MIP, mixed integer linear program
 // the initial placement is modelled as a Quadratic Assignment Problem
@@ -1794,11 +2114,12 @@ using namespace lemon;
 // 2. option initialplace: an option steerable timeout mechanism around it is implemented, using threads:
 // The solver runs in a subthread which can succeed or be timed out by the main thread waiting for it.
 // When timed out, it can stop the compiler by raising an exception or continue mapping as if it were not called.
-// When INITIALPLACE is not defined, the compiler doesn't contain initial placement support and ignores calls to it;
+// When INITIALPLACE is not defined, the compiler doesn't contain MIP initial placement support and ignores calls to it;
 // then all this: lemon/mip, glpk, thread support is avoided making OpenQL much easier build and run.
 // Otherwise, depending on the initialplace option value, initial placement is attempted before the heuristic.
 // Options values of initialplace:
 //  no      don't run initial placement ('ip')
+//  heuristic run ip by the heuristic placer below instead of the MIP; this is always supported
 //  yes     run ip until the solver is ready
 //  1hx     run ip max for 1 hour; when timed out, stop the compiler
 //  1h      run ip max for 1 hour; when timed out, just use heuristics
@@ -1810,6 +2131,21 @@ using namespace lemon;
 //  10s     run ip max for 10 seconds; when timed out, just use heuristics
 //  1sx     run ip max for 1 second; when timed out, stop the compiler
 //  1s      run ip max for 1 second; when timed out, just use heuristics
+//
+// The time to solve the MIP grows exponentially with the number of qubits;
+// beyond about 17 qubits it doesn't finish in any reasonable time.
+// The heuristic placer minimizes the same objective, z = sum i: sum j: refcount[i][j] * distance(loc[i],loc[j]),
+// in polynomial time and without guarantee of optimality:
+// 1. greedy: the facility with the most two-qubit gates is put in the most central location;
+//    then repeatedly, the facility with the most two-qubit gates with those already placed
+//    is put in the free location that adds least to z
+// 2. simulated annealing, from multiple starts (option initialplacestarts):
+//    the first start is the greedy placement, the others are random placements;
+//    a move puts a facility in another location, swapping it with the facility that is there, if any;
+//    the best placement of all starts is the result
+// The starts run on the pool of threads of the mapper (option mapthreads).
+// Each start has its own random generator, seeded from the mapper's one (so from option mapseed) and its index,
+// so that for a given seed the result doesn't depend on the number of threads.
 
 typedef enum InitialPlaceResults {
     ipr_any,            // any mapping will do because there are no two-qubit gates in the circuit
@@ -1830,8 +2166,15 @@ private:
                                           // remaining attributes are computed per circuit
     UInt                      nfac;       // number of facilities, actually used virtual qubits; index variables i and j
                                           // nfac <= nlocs: e.g. nlocs == 7, but only v2 and v5 are used; nfac then is 2
+    Vec<UInt>                 v2i;        // v2i[virtual qubit index v] -> index of facility i
+    Vec<Vec<UInt>>            refcount;   // refcount[i][j] = count of two-qubit gates between facilities i and j
+
+                                          // only computed and used by the heuristic placer
+    Vec<Vec<UInt>>            dist;       // dist[k][l] = distance between locations k and l
+    Vec<Vec<std::pair<UInt, UInt>>> nbs;  // nbs[i] = list of (j, refcount[i][j] + refcount[j][i]), for those j that are nonzero
 
 public:
+    UInt                      cost;       // value of the objective z for the resulting placement
 
     Str ipr2string(ipr_t ipr) {
         switch (ipr) {
@@ -1852,15 +2195,16 @@ public:
         nvq = p->qubit_number;  // same range; when not, take set from config and create v2i earlier
         // DOUT("... number of real qubits (locations): " << nlocs);
         gridp = g;
+        cost = 0;
         QL_DOUT("Init: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
     }
 
-    // find an initial placement of the virtual qubits for the given circuit
-    // the resulting placement is put in the provided virt2real map
-    // result indicates one of the result indicators (ipr_t, see above)
-    void PlaceBody(circuit &circ, Virt2Real &v2r, ipr_t &result, Real &iptimetaken) {
-        QL_DOUT("InitialPlace.PlaceBody ...");
+private:
 
+    // compute the facilities (nfac, v2i) and the refcount of the placement problem of the given circuit;
+    // returns false when there is nothing to place because any mapping or the current mapping will do,
+    // with result set accordingly
+    Bool Model(circuit &circ, Virt2Real &v2r, ipr_t &result) {
         // check validity of circuit
         for (auto &gp : circ) {
             auto &q = gp->operands;
@@ -1882,7 +2226,7 @@ public:
         QL_DOUT("... compute ipusecount by scanning circuit");
         Vec<UInt>  ipusecount;// ipusecount[v] = count of use of virtual qubit v in current circuit
         ipusecount.resize(nvq,0);       // initially all 0
-        Vec<UInt> v2i;        // v2i[virtual qubit index v] -> index of facility i
+        v2i.clear();
         v2i.resize(nvq,UNDEFINED_QUBIT);// virtual qubit v not used by circuit as gate operand
 
         Int twoqubitcount = 0;
@@ -1911,10 +2255,11 @@ public:
         // anymap = there are no two-qubit gates so any map will do
         // currmap = in the current map, all two-qubit gates are NN so current map will do
         QL_DOUT("... compute refcount by scanning circuit");
-        Vec<Vec<UInt>>  refcount;
+        refcount.clear();
         refcount.resize(nfac); for (UInt i=0; i<nfac; i++) refcount[i].resize(nfac,0);
         Bool anymap = true;    // true when all refcounts are 0
         Bool currmap = true;   // true when in current map all two-qubit gates are NN
+        UInt currcost = 0;     // value of the objective in current map when currmap
 
         twoqubitcount = 0;
         for (auto &gp : circ) {
@@ -1923,6 +2268,7 @@ public:
                 if (prefix == 0 || twoqubitcount < prefix) {
                     anymap = false;
                     refcount[v2i[q[0]]][v2i[q[1]]] += 1;
+                    currcost += 1;
 
                     if (
                         v2r[q[0]] == UNDEFINED_QUBIT
@@ -1940,15 +2286,94 @@ public:
         }
         if (anymap) {
             QL_DOUT("InitialPlace: no two-qubit gates found, so no constraints, and any mapping is ok");
-            QL_DOUT("InitialPlace.PlaceBody [ANY MAPPING IS OK]");
+            QL_DOUT("InitialPlace.Model [ANY MAPPING IS OK]");
             result = ipr_any;
-            iptimetaken = 0.0;
-            return;
+            cost = 0;
+            return false;
         }
         if (currmap) {
             QL_DOUT("InitialPlace: in current map, all two-qubit gates are nearest neighbor, so current map is ok");
-            QL_DOUT("InitialPlace.PlaceBody [CURRENT MAPPING IS OK]");
+            QL_DOUT("InitialPlace.Model [CURRENT MAPPING IS OK]");
             result = ipr_current;
+            cost = currcost;
+            return false;
+        }
+        return true;
+    }
+
+    // value of the objective z for placement loc, loc[i] being the location of facility i
+    UInt Cost(const Vec<UInt> &loc) const {
+        UInt z = 0;
+        for (UInt i = 0; i < nfac; i++) {
+            for (UInt j = 0; j < nfac; j++) {
+                if (refcount[i][j] != 0) {
+                    z += refcount[i][j] * gridp->Distance(loc[i], loc[j]);
+                }
+            }
+        }
+        return z;
+    }
+
+    // put the found placement loc, loc[i] being the location of facility i, in v2r;
+    // use v2i to translate facilities back to original virtual qubit indices
+    // and fill v2r with the found locations for the used virtual qubits;
+    // the unused mapped virtual qubits are mapped to an arbitrary permutation of the remaining locations;
+    // the latter must be updated to generate swaps when mapping multiple kernels
+    void SetMapping(const Vec<UInt> &loc, Virt2Real &v2r) {
+        QL_DOUT("... interpret result and copy to Virt2Real, nvq=" << nvq);
+        for (UInt v = 0; v < nvq; v++) {
+            v2r[v] = UNDEFINED_QUBIT;      // i.e. undefined, i.e. v is not an index of a used virtual qubit
+        }
+        for (UInt v = 0; v < nvq; v++) {
+            if (v2i[v] != UNDEFINED_QUBIT) {
+                v2r[v] = loc[v2i[v]];
+                // v2r.rs[] is not updated because no gates were really mapped yet
+            }
+        }
+
+        auto mapinitone2oneopt = options::get("mapinitone2one");
+        if (mapinitone2oneopt == "yes") {
+            QL_DOUT("... correct location of unused mapped virtual qubits to be an unused location");
+            v2r.DPRINT("... result Virt2Real map of InitialPlace before mapping unused mapped virtual qubits ");
+            // virtual qubits used by this kernel v have got their location k filled in in v2r[v] == k
+            // unused mapped virtual qubits still have location UNDEFINED_QUBIT, fill with the remaining locs
+            // this should be replaced by actually swapping them to there, when mapping multiple kernels
+            for (UInt v = 0; v < nvq; v++) {
+                if (v2r[v] == UNDEFINED_QUBIT) {
+                    // v is unused by this kernel; find an unused location k
+                    UInt k;   // location k that is checked for having been allocated to some virtual qubit w
+                    for (k = 0; k < nlocs; k++) {
+                        UInt w;
+                        for (w = 0; w < nvq; w++) {
+                            if (v2r[w] == k) {
+                                break;
+                            }
+                        }
+                        if (w >= nvq) {
+                            // no w found for which v2r[w] == k
+                            break;     // k is an unused location
+                        }
+                        // k is a used location, so continue with next k to check whether it is hopefully unused
+                    }
+                    QL_ASSERT(k < nlocs);  // when a virtual qubit is not used, there must be a location that is not used
+                    v2r[v] = k;
+                }
+                QL_DOUT("... end loop body over nvq when mapinitone2oneopt");
+            }
+        }
+        v2r.DPRINT("... final result Virt2Real map of InitialPlace");
+    }
+
+#ifdef INITIALPLACE
+public:
+
+    // find an initial placement of the virtual qubits for the given circuit by solving the MIP
+    // the resulting placement is put in the provided virt2real map
+    // result indicates one of the result indicators (ipr_t, see above)
+    void PlaceBody(circuit &circ, Virt2Real &v2r, ipr_t &result, Real &iptimetaken) {
+        QL_DOUT("InitialPlace.PlaceBody ...");
+
+        if (!Model(circ, v2r, result)) {
             iptimetaken = 0.0;
             return;
         }
@@ -2127,14 +2552,14 @@ public:
         QL_DOUT("..2 nvq=" << nvq);
         Mip::SolveExitStatus s;
         QL_DOUT("Just before solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-        QL_DOUT("Just before solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
+        QL_DOUT("Just before solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size());
         QL_DOUT("..2b nvq=" << nvq);
         {
             s = mip.solve();
         }
         QL_DOUT("..3 nvq=" << nvq);
         QL_DOUT("Just after solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-        QL_DOUT("Just after solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
+        QL_DOUT("Just after solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size());
         QL_ASSERT(nvq == nlocs);         // consistency check, mainly to let it crash
 
         // computing iptimetaken, stop interval timer
@@ -2158,71 +2583,22 @@ public:
         // return new mapping as result in v2r
 
         // get the results: x[i][k] == 1 iff facility i is in location k (i.e. real qubit index k)
-        // use v2i to translate facilities back to original virtual qubit indices
-        // and fill v2r with the found locations for the used virtual qubits;
-        // the unused mapped virtual qubits are mapped to an arbitrary permutation of the remaining locations;
-        // the latter must be updated to generate swaps when mapping multiple kernels
         QL_DOUT("..8 nvq=" << nvq);
-        QL_DOUT("... interpret result and copy to Virt2Real, nvq=" << nvq);
-        for (UInt v = 0; v < nvq; v++) {
-            QL_DOUT("... about to set v2r to undefined for v " << v);
-            v2r[v] = UNDEFINED_QUBIT;      // i.e. undefined, i.e. v is not an index of a used virtual qubit
-        }
+        Vec<UInt> loc(nfac, UNDEFINED_QUBIT);
         for (UInt i = 0; i < nfac; i++) {
-            UInt v;   // found virtual qubit index v represented by facility i
-            // use v2i backward to find virtual qubit v represented by facility i
-            QL_DOUT("... about to inspect v2i to get solution and set it in v2r for facility " << i);
-            for (v = 0; v < nvq; v++) {
-                if (v2i[v] == i) {
-                    break;
-                }
-            }
-            QL_ASSERT(v < nvq);  // for each facility there must be a virtual qubit
-            UInt k;   // location to which facility i being virtual qubit index v was allocated
+            UInt k;   // location to which facility i was allocated
             for (k = 0; k < nlocs; k++) {
                 if (mip.sol(x[i][k]) == 1) {
-                    v2r[v] = k;
-                    // v2r.rs[] is not updated because no gates were really mapped yet
+                    loc[i] = k;
                     break;
                 }
             }
             QL_ASSERT(k < nlocs);  // each facility i by definition represents a used qubit so must have got a location
-            QL_DOUT("... end loop body over nfac");
-        }
-
-        auto mapinitone2oneopt = options::get("mapinitone2one");
-        if (mapinitone2oneopt == "yes") {
-            QL_DOUT("... correct location of unused mapped virtual qubits to be an unused location");
-            v2r.DPRINT("... result Virt2Real map of InitialPlace before mapping unused mapped virtual qubits ");
-            // virtual qubits used by this kernel v have got their location k filled in in v2r[v] == k
-            // unused mapped virtual qubits still have location UNDEFINED_QUBIT, fill with the remaining locs
-            // this should be replaced by actually swapping them to there, when mapping multiple kernels
-            for (UInt v = 0; v < nvq; v++) {
-                if (v2r[v] == UNDEFINED_QUBIT) {
-                    // v is unused by this kernel; find an unused location k
-                    UInt k;   // location k that is checked for having been allocated to some virtual qubit w
-                    for (k = 0; k < nlocs; k++) {
-                        UInt w;
-                        for (w = 0; w < nvq; w++) {
-                            if (v2r[w] == k) {
-                                break;
-                            }
-                        }
-                        if (w >= nvq) {
-                            // no w found for which v2r[w] == k
-                            break;     // k is an unused location
-                        }
-                        // k is a used location, so continue with next k to check whether it is hopefully unused
-                    }
-                    QL_ASSERT(k < nlocs);  // when a virtual qubit is not used, there must be a location that is not used
-                    v2r[v] = k;
-                }
-                QL_DOUT("... end loop body over nvq when mapinitone2oneopt");
-            }
         }
-        v2r.DPRINT("... final result Virt2Real map of InitialPlace");
+        SetMapping(loc, v2r);
+        cost = Cost(loc);
         result = ipr_newmap;
-        QL_DOUT("InitialPlace.PlaceBody [SUCCESS, FOUND MAPPING]");
+        QL_DOUT("InitialPlace.PlaceBody [SUCCESS, FOUND MAPPING] cost=" << cost);
     }
 
     // the above PlaceBody is a regular function using circ, and updating v2r and result before it returns;
@@ -2259,9 +2635,12 @@ public:
         }
         iptimetaken = waitseconds;    // pessimistic, in case of timeout, otherwise it is corrected
 
-        // v2r and result are allocated on stack of main thread by some ancestor so be careful with threading
-        std::thread t([&cv, this, &circ, &v2r, &result, &iptimetaken]()
+        // v2r and result are allocated on stack of main thread by some ancestor so be careful with threading;
+        // the subthread reads options, from its own copy of them since it may outlive the compilation on timeout
+        auto context = std::make_shared<CompileContext>();
+        std::thread t([&cv, this, &circ, &v2r, &result, &iptimetaken, context]()
             {
+                CompileContext::Scope scope(context.get());
                 QL_DOUT("InitialPlace.PlaceWrapper subthread about to call PlaceBody");
                 PlaceBody(circ, v2r, result, iptimetaken);
                 QL_DOUT("InitialPlace.PlaceBody returned in subthread; about to signal the main thread");
@@ -2329,31 +2708,267 @@ public:
         }
     }
 
-};  // end class InitialPlace
 #endif // INITIALPLACE
 
+private:
+
+    // greedy placement, loc[i] being the location of facility i:
+    // the facility with the most two-qubit gates with the facilities already placed (then the most in total)
+    // is put in the free location that adds least to the objective (then the most central one)
+    void PlaceGreedy(Vec<UInt> &loc) const {
+        Vec<UInt> weight(nfac, 0);          // weight[i] = number of two-qubit gates of facility i
+        for (UInt i = 0; i < nfac; i++) {
+            for (auto &nb : nbs[i]) {
+                weight[i] += nb.second;
+            }
+        }
+        Vec<UInt> spread(nlocs, 0);         // spread[k] = sum of the distances from location k to all others
+        for (UInt k = 0; k < nlocs; k++) {
+            for (UInt l = 0; l < nlocs; l++) {
+                spread[k] += dist[k][l];
+            }
+        }
+        Vec<UInt> attached(nfac, 0);        // attached[i] = number of two-qubit gates of i with placed facilities
+        Vec<Bool> placed(nfac, false);
+        Vec<Bool> occupied(nlocs, false);
+        loc.assign(nfac, UNDEFINED_QUBIT);
+        for (UInt n = 0; n < nfac; n++) {
+            UInt i = UNDEFINED_QUBIT;
+            for (UInt c = 0; c < nfac; c++) {
+                if (!placed[c] && (
+                    i == UNDEFINED_QUBIT
+                    || attached[c] > attached[i]
+                    || (attached[c] == attached[i] && weight[c] > weight[i])
+                )) {
+                    i = c;
+                }
+            }
+            UInt bestk = UNDEFINED_QUBIT;
+            UInt bestadded = 0;
+            for (UInt k = 0; k < nlocs; k++) {
+                if (occupied[k]) {
+                    continue;
+                }
+                UInt added = 0;
+                for (auto &nb : nbs[i]) {
+                    if (placed[nb.first]) {
+                        added += nb.second * dist[k][loc[nb.first]];
+                    }
+                }
+                if (
+                    bestk == UNDEFINED_QUBIT
+                    || added < bestadded
+                    || (added == bestadded && spread[k] < spread[bestk])
+                ) {
+                    bestk = k;
+                    bestadded = added;
+                }
+            }
+            loc[i] = bestk;
+            placed[i] = true;
+            occupied[bestk] = true;
+            for (auto &nb : nbs[i]) {
+                attached[nb.first] += nb.second;
+            }
+        }
+    }
+
+    // change of the objective when facility i is moved to location k,
+    // with facility j (if not UNDEFINED_QUBIT) that is in k moved to the location of i
+    Int MoveDelta(const Vec<UInt> &loc, UInt i, UInt k, UInt j) const {
+        Int delta = 0;
+        UInt from = loc[i];
+        for (auto &nb : nbs[i]) {
+            if (nb.first != j) {
+                delta += Int(nb.second) * (Int(dist[k][loc[nb.first]]) - Int(dist[from][loc[nb.first]]));
+            }
+        }
+        if (j != UNDEFINED_QUBIT) {
+            for (auto &nb : nbs[j]) {
+                if (nb.first != i) {
+                    delta += Int(nb.second) * (Int(dist[from][loc[nb.first]]) - Int(dist[k][loc[nb.first]]));
+                }
+            }
+        }
+        return delta;
+    }
+
+    // simulated annealing starting from placement loc, drawing from the given random generator;
+    // the best placement found is returned in loc, and its cost as result;
+    // the objective of a placement is at least mincost, i.e. when all two-qubit gates are NN
+    UInt Anneal(Vec<UInt> &loc, std::mt19937 &gen, UInt steps, UInt mincost) const {
+        UInt currcost = Cost(loc);
+        UInt bestcost = currcost;
+        Vec<UInt> bestloc = loc;
+        if (nlocs < 2 || bestcost == mincost) {
+            return bestcost;
+        }
+        Vec<UInt> occupant(nlocs, UNDEFINED_QUBIT);     // occupant[k] = facility in location k
+        for (UInt i = 0; i < nfac; i++) {
+            occupant[loc[i]] = i;
+        }
+
+        // start at a temperature at which an average move that increases the objective is taken half of the times,
+        // and cool down geometrically to one at which an increase by 1 is taken practically never
+        Real uphill = 0.0;
+        UInt nuphill = 0;
+        for (UInt s = 0; s < 100; s++) {
+            UInt i = gen() % nfac;
+            UInt k = gen() % nlocs;
+            if (k != loc[i]) {
+                Int delta = MoveDelta(loc, i, k, occupant[k]);
+                if (delta > 0) {
+                    uphill += delta;
+                    nuphill++;
+                }
+            }
+        }
+        Real tend = 0.05;
+        Real temp = nuphill == 0 ? 1.0 : uphill / nuphill / std::log(2.0);
+        temp = std::max(temp, tend);
+        Real cooling = std::pow(tend / temp, 1.0 / steps);
+        std::uniform_real_distribution<Real> uniform(0.0, 1.0);
+
+        for (UInt s = 0; s < steps; s++, temp *= cooling) {
+            UInt i = gen() % nfac;
+            UInt k = gen() % (nlocs - 1);
+            if (k >= loc[i]) {
+                k++;                                    // any location but the current one of i
+            }
+            UInt j = occupant[k];
+            Int delta = MoveDelta(loc, i, k, j);
+            if (delta > 0 && uniform(gen) >= std::exp(-delta / temp)) {
+                continue;
+            }
+            occupant[loc[i]] = j;
+            if (j != UNDEFINED_QUBIT) {
+                loc[j] = loc[i];
+            }
+            occupant[k] = i;
+            loc[i] = k;
+            currcost += delta;
+            if (currcost < bestcost) {
+                bestcost = currcost;
+                bestloc = loc;
+                if (bestcost == mincost) {
+                    break;
+                }
+            }
+        }
+        loc = bestloc;
+        return bestcost;
+    }
+
+public:
+
+    // find an initial placement of the virtual qubits for the given circuit by the heuristic placer (see above);
+    // the resulting placement is put in the provided virt2real map;
+    // the random generators of the starts are seeded from seed and their index;
+    // the starts are run on pool, if there is one
+    void PlaceHeuristic(
+        circuit &circ,
+        Virt2Real &v2r,
+        ipr_t &result,
+        Real &iptimetaken,
+        UInt seed,
+        ThreadPool *pool
+    ) {
+        QL_DOUT("InitialPlace.PlaceHeuristic ...");
+        using namespace std::chrono;
+        high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+        Str initialplacestartsopt = options::get("initialplacestarts");
+        Int starts = parse_int(initialplacestartsopt);
+        if (starts < 1) {
+            QL_FATAL("Value of initialplacestarts option must be a positive number, not " << initialplacestartsopt);
+        }
+
+        if (!Model(circ, v2r, result)) {
+            iptimetaken = 0.0;
+            return;
+        }
+
+        dist.assign(nlocs, Vec<UInt>(nlocs, 0));
+        for (UInt k = 0; k < nlocs; k++) {
+            for (UInt l = 0; l < nlocs; l++) {
+                dist[k][l] = gridp->Distance(k, l);
+            }
+        }
+        nbs.assign(nfac, Vec<std::pair<UInt, UInt>>());
+        UInt mincost = 0;
+        for (UInt i = 0; i < nfac; i++) {
+            for (UInt j = 0; j < nfac; j++) {
+                if (i != j && refcount[i][j] + refcount[j][i] != 0) {
+                    nbs[i].push_back(std::make_pair(j, refcount[i][j] + refcount[j][i]));
+                }
+                mincost += refcount[i][j];
+            }
+        }
+
+        // the more locations and facilities, the more moves it takes to find a good placement
+        UInt steps = 50 * nlocs * nfac;
+        Vec<UInt> greedyloc;
+        PlaceGreedy(greedyloc);
+        Vec<Vec<UInt>> locs(starts);
+        Vec<UInt> costs(starts);
+        auto anneal = [&](UInt index, UInt worker) {
+            std::mt19937 gen;
+            std::seed_seq seq{seed, index};
+            gen.seed(seq);
+            if (index == 0) {
+                locs[index] = greedyloc;
+            } else {
+                Vec<UInt> perm(nlocs);
+                std::iota(perm.begin(), perm.end(), 0);
+                std::shuffle(perm.begin(), perm.end(), gen);
+                locs[index].assign(perm.begin(), perm.begin() + nfac);
+            }
+            costs[index] = Anneal(locs[index], gen, steps, mincost);
+        };
+        if (pool != nullptr && starts > 1) {
+            pool->parallel_for(starts, anneal);
+        } else {
+            for (Int index = 0; index < starts; index++) {
+                anneal(index, 0);
+            }
+        }
+
+        UInt best = 0;
+        for (Int index = 1; index < starts; index++) {
+            if (costs[index] < costs[best]) {
+                best = index;
+            }
+        }
+        QL_DOUT("InitialPlace.PlaceHeuristic: greedy cost=" << Cost(greedyloc) << " best cost=" << costs[best] << " of start " << best << " of " << starts << ", lower bound=" << mincost);
+        SetMapping(locs[best], v2r);
+        cost = costs[best];
+        result = ipr_newmap;
+
+        high_resolution_clock::time_point t2 = high_resolution_clock::now();
+        duration<Real> time_span = t2 - t1;
+        iptimetaken = time_span.count();
+        QL_DOUT("InitialPlace.PlaceHeuristic [SUCCESS, FOUND MAPPING] cost=" << cost << " iptimetaken=" << iptimetaken << " seconds");
+    }
+
+};  // end class InitialPlace
+
 // Find shortest paths between src and tgt in the grid, bounded by a particular strategy (which);
 // budget is the maximum number of hops allowed in the path from src and is at least distance to tgt;
 // it can be higher when not all hops qualify for doing a two-qubit gate or to find more than just the shortest paths.
-void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, UInt budget, List<Alter> &resla, whichpaths_t which) {
-    List<Alter> genla;    // list that will get the result of a recursive Gen call
-
+//
+// This walks the next hop DAG of the grid depth first, extending path in place;
+// so only for each complete path found an Alter is created, as a copy of proto with that path as total.
+// The paths are found in the same order as when recursively prepending src to all paths from its neighbors.
+void Mapper::GenShortestPaths(const Alter &proto, Vec<UInt> &path, UInt src, UInt tgt, UInt budget, List<Alter> &resla, whichpaths_t which) {
     // DOUT("GenShortestPaths: " << "src=" << src << " tgt=" << tgt << " budget=" << budget << " which=" << which);
-    QL_ASSERT(resla.empty());
+    path.push_back(src);
 
     if (src == tgt) {
-        // found target
-        // create a virgin Alter and initialize it to become an empty path
-        // add src to this path (so that it becomes a distance 0 path with one qubit, src)
-        // and add the Alter to the result list
-        Alter a;
-        a.Init(platformp, kernelp, &grid);
-        a.targetgp = gp;
-        a.Add2Front(src);
-        resla.push_back(a);
-        // a.DPRINT("... empty path after adding to result list");
-        // Alter::DPRINT("... result list after adding empty path", resla);
-        // DOUT("... will return now");
+        // found target; add the completed path as a new Alter to the result list
+        resla.push_back(proto);
+        resla.back().total = path;
+        // resla.back().DPRINT("... path after adding to result list");
+        path.pop_back();
         return;
     }
 
@@ -2364,27 +2979,41 @@ void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, UInt budget, List<Al
     // reduce neighbors nbs to those n continuing a path within budget
     // src=>tgt is distance d, budget>=d is allowed, attempt src->n=>tgt
     // src->n is one hop, budget from n is one less so distance(n,tgt) <= budget-1 (i.e. distance < budget)
-    // when budget==d, this defaults to distance(n,tgt) <= d-1
-    auto nbl = grid.nbs.get(src);
-    nbl.remove_if([this,budget,tgt](const UInt& n) { return grid.Distance(n,tgt) >= budget; });
-
-    // rotate neighbor list nbl such that largest difference between angles of adjacent elements is beyond back()
+    // when budget==d, this defaults to distance(n,tgt) <= d-1, for which the grid has the normalized list ready;
+    // otherwise compute it here and rotate it such that largest difference between angles of adjacent elements is beyond back()
     // this makes only sense when there is an underlying xy grid; when not, which can only be wp_all_shortest
-    grid.Normalize(src, nbl);
-    // subset to those neighbors that continue in direction(s) we want
-    if (which == wp_left_shortest) {
-        nbl.remove_if( [nbl](const UInt& n) { return n != nbl.front(); } );
-    } else if (which == wp_right_shortest) {
-        nbl.remove_if( [nbl](const UInt& n) { return n != nbl.back(); } );
-    } else if (which == wp_leftright_shortest) {
-        nbl.remove_if( [nbl](const UInt& n) { return n != nbl.front() && n != nbl.back(); } );
+    Vec<UInt> nbl;
+    if (budget == d) {
+        UInt nn = grid.NextHopCount(src, tgt);
+        nbl.reserve(nn);
+        for (UInt i = 0; i < nn; i++) {
+            nbl.push_back(grid.NextHop(src, tgt, i));
+        }
+    } else {
+        auto nbll = grid.nbs.get(src);
+        nbll.remove_if([this,budget,tgt](const UInt& n) { return grid.Distance(n,tgt) >= budget; });
+        grid.Normalize(src, nbll);
+        nbl.reserve(nbll.size());
+        for (auto n : nbll) {
+            nbl.push_back(n);
+        }
     }
 
-    // std::cout << "... before iterating, nbl: ";
-    // for (auto dn : nbl) { std::cout << dn << " "; } std::cout << std::endl;
+    // subset to those neighbors that continue in direction(s) we want
+    if (!nbl.empty()) {
+        if (which == wp_left_shortest) {
+            nbl.resize(1);
+        } else if (which == wp_right_shortest) {
+            nbl.front() = nbl.back();
+            nbl.resize(1);
+        } else if (which == wp_leftright_shortest && nbl.size() > 2) {
+            nbl[1] = nbl.back();
+            nbl.resize(2);
+        }
+    }
 
     // for all resulting neighbors, find all continuations of a shortest path
-    for (auto &n : nbl) {
+    for (UInt n : nbl) {
         whichpaths_t newwhich = which;
         // but for each neighbor only look in desired direction, if any
         if (which == wp_leftright_shortest && nbl.size() != 1) {
@@ -2395,16 +3024,9 @@ void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, UInt budget, List<Al
                 newwhich = wp_right_shortest;
             }
         }
-        GenShortestPaths(gp, n, tgt, budget-1, genla, newwhich);  // get list of possible paths in budget-1 from n to tgt in genla
-        resla.splice(resla.end(), genla);           // moves all of genla to resla; makes genla empty
-    }
-    // resla contains all paths starting from a neighbor of src, to tgt
-
-    // add src to front of all to-be-returned paths from src's neighbors to tgt
-    for (auto &a : resla) {
-        // DOUT("... GenShortestPaths, about to add src=" << src << "in front of path");
-        a.Add2Front(src);
+        GenShortestPaths(proto, path, n, tgt, budget-1, resla, newwhich);  // append all paths in budget-1 from n to tgt to resla
     }
+    path.pop_back();
     // DOUT("... GenShortestPaths: returning from call of:" << "src=" << src << " tgt=" << tgt << " budget=" << budget << " which=" << which);
 }
 
@@ -2421,14 +3043,18 @@ void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, UInt budget, List<Al
 void Mapper::GenShortestPaths(gate *gp, UInt src, UInt tgt, List<Alter> &resla) {
     List<Alter> directla;  // list that will hold all not-yet-split Alters directly from src to tgt
 
+    // all Alters start as copies of this virgin one
+    Alter proto;
+    proto.Init(platformp, &mapoptions, kernelp, &grid);
+    proto.targetgp = gp;
+
+    Vec<UInt> path;
     UInt budget = grid.MinHops(src, tgt);
-    Str mappathselectopt = options::get("mappathselect");
-    if (mappathselectopt == "all") {
-        GenShortestPaths(gp, src, tgt, budget, directla, wp_all_shortest);
-    } else if (mappathselectopt == "borders") {
-        GenShortestPaths(gp, src, tgt, budget, directla, wp_leftright_shortest);
+    path.reserve(budget+1);
+    if (mapoptions.mappathselect == mp_all) {
+        GenShortestPaths(proto, path, src, tgt, budget, directla, wp_all_shortest);
     } else {
-        QL_FATAL("Unknown value of mapppathselect option " << mappathselectopt);
+        GenShortestPaths(proto, path, src, tgt, budget, directla, wp_leftright_shortest);
     }
 
     // DOUT("about to split the paths");
@@ -2458,8 +3084,7 @@ void Mapper::GenAltersGate(gate *gp, List<Alter> &la, Past &past) {
 // and return the found variations by appending them to the given list of Alters, la
 // Depending on maplookahead only take first (most critical) gate or take all gates.
 void Mapper::GenAlters(List<gate*> lg, List<Alter> &la, Past &past) {
-    Str maplookaheadopt = options::get("maplookahead");
-    if (maplookaheadopt == "all") {
+    if (mapoptions.maplookahead == ml_all) {
         // create alternatives for each gate in lg
         // DOUT("GenAlters, " << lg.size() << " 2q gates; create an alternative for each");
         for (auto gp : lg) {
@@ -2475,25 +3100,29 @@ void Mapper::GenAlters(List<gate*> lg, List<Alter> &la, Past &past) {
     }
 }
 
-// start the random generator with a seed
-// that is unique to the microsecond
+// start the random generator with the seed given by the mapseed option,
+// or otherwise with a seed that is unique to the microsecond
 void Mapper::RandomInit() {
+    if (mapoptions.mapseeded) {
+        gen.seed(mapoptions.mapseed);
+        return;
+    }
     auto ts = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     // DOUT("Seeding random generator with " << ts );
     gen.seed(ts);
 }
 
 // if the maptiebreak option indicates so,
-// generate a random Int number in range 0..count-1 and use
+// generate a random Int number in range 0..count-1 using gen and use
 // that to index in list of alternatives and to return that one,
 // otherwise return a fixed one (front, back or first most critical one
-Alter Mapper::ChooseAlter(List<Alter> &la, Future &future) {
+Alter Mapper::ChooseAlter(List<Alter> &la, Future &future, std::mt19937 &gen) {
     if (la.size() == 1) {
         return la.front();
     }
 
-    Str maptiebreakopt = options::get("maptiebreak");
-    if (maptiebreakopt == "critical") {
+    maptiebreak_t maptiebreakopt = mapoptions.maptiebreak;
+    if (maptiebreakopt == mt_critical) {
         List<gate*> lag;
         for (auto &a : la) {
             lag.push_back(a.targetgp);
@@ -2509,7 +3138,7 @@ Alter Mapper::ChooseAlter(List<Alter> &la, Future &future) {
         return la.front();
     }
 
-    if (maptiebreakopt == "random") {
+    if (maptiebreakopt == mt_random) {
         Alter res;
         std::uniform_int_distribution<> dis(0, (la.size()-1));
         UInt choice = dis(gen);
@@ -2525,12 +3154,12 @@ Alter Mapper::ChooseAlter(List<Alter> &la, Future &future) {
         return res;
     }
 
-    if (maptiebreakopt == "last") {
+    if (maptiebreakopt == mt_last) {
         // DOUT(" ... took last " << " from 0.." << (la.size()-1));
         return la.back();
     }
 
-    if (maptiebreakopt == "first") {
+    if (maptiebreakopt == mt_first) {
         // DOUT(" ... took first " << " from 0.." << (la.size()-1));
         return la.front();
     }
@@ -2562,8 +3191,7 @@ void Mapper::CommitAlter(Alter &resa, Future &future, Past &past) {
     gate *resgp = resa.targetgp;   // and the 2q target gate then in resgp
     resa.DPRINT("... CommitAlter, alternative to commit, will add swaps and then map target 2q gate");
 
-    Str mapselectswapsopt = options::get("mapselectswaps");
-    resa.AddSwaps(past, mapselectswapsopt);
+    resa.AddSwaps(past, mapoptions.mapselectswaps);
 
     // when only some swaps were added, the resgp might not yet be NN, so recheck
     auto &q = resgp->operands;
@@ -2690,9 +3318,13 @@ Bool Mapper::MapMappableGates(Future &future, Past &past, List<gate*> &lg, Bool
 //   when several remain with equal minimum extension, recurse to reduce this set of remaining ones
 //   - level: level of recursion at which SelectAlter is called: 0 is base, 1 is 1st, etc.
 //   - option mapselectmaxlevel: max level of recursion to use, where inf indicates no maximum
-// - maptiebreak option indicates which one to take when several (still) remain
+//   - baseFreeCycle: max free cycle of the base past (bottom of recursion stack) to compute extensions against
+//   past is the last past (top of recursion stack); it is extended in place to evaluate the alternatives
+//   and rolled back each time, so on return it is unchanged
+// - maptiebreak option indicates which one to take when several (still) remain, drawing from gen when random
+// - at level 0, with option mapthreads > 1, the alternatives are evaluated in parallel, with the same result
 // result is returned in resa
-void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &past, Past &basePast, Int level) {
+void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &past, UInt baseFreeCycle, Int level, std::mt19937 &gen) {
     // la are all alternatives we enter with
     QL_ASSERT(!la.empty());  // so there is always a result Alter
 
@@ -2700,20 +3332,20 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
     List<Alter> bla;       // best alternative subset of gla, suitable to choose result from
 
     QL_DOUT("SelectAlter ENTRY level=" << level << " from " << la.size() << " alternatives");
-    auto mapperopt = options::get("mapper");
-    if (mapperopt == "base" || mapperopt == "baserc") {
+    mapperkind_t mapperopt = mapoptions.mapper;
+    if (mapperopt == mk_base || mapperopt == mk_baserc) {
         Alter::DPRINT("... SelectAlter base (equally good/best) alternatives:", la);
-        resa = ChooseAlter(la, future);
+        resa = ChooseAlter(la, future, gen);
         resa.DPRINT("... the selected Alter is");
         // DOUT("SelectAlter DONE level=" << level << " from " << la.size() << " alternatives");
         return;
     }
-    QL_ASSERT(mapperopt == "minextend" || mapperopt == "minextendrc" || mapperopt == "maxfidelity");
+    QL_ASSERT(mapperopt == mk_minextend || mapperopt == mk_minextendrc || mapperopt == mk_maxfidelity);
 
-    // Compute a.score of each alternative relative to basePast, and sort la on it, minimum first
+    // Compute a.score of each alternative relative to the base past, and sort la on it, minimum first
     for (auto &a : la) {
         a.DPRINT("Considering extension by alternative: ...");
-        a.Extend(past, basePast);           // locally here, past will be cloned and kept in alter
+        a.Extend(past, baseFreeCycle);      // past is extended and rolled back again inside
         // and the extension stored into the a.score
     }
     la.sort([this](const Alter &a1, const Alter &a2) { return a1.score < a2.score; });
@@ -2728,16 +3360,16 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
     gla.remove_if([this,la](const Alter& a) { return a.score != la.front().score; });
     UInt las = la.size();
     UInt glas = gla.size();
-    auto mapselectmaxwidthopt = options::get("mapselectmaxwidth");
-    if ("min" != mapselectmaxwidthopt) {
+    mapselectmaxwidth_t mapselectmaxwidthopt = mapoptions.mapselectmaxwidth;
+    if (mw_min != mapselectmaxwidthopt) {
         UInt keep = 1;
-        if (mapselectmaxwidthopt == "minplusone") {
+        if (mapselectmaxwidthopt == mw_minplusone) {
             keep = glas+1;
-        } else if (mapselectmaxwidthopt == "minplushalfmin") {
+        } else if (mapselectmaxwidthopt == mw_minplushalfmin) {
             keep = glas+glas/2;
-        } else if (mapselectmaxwidthopt == "minplusmin") {
+        } else if (mapselectmaxwidthopt == mw_minplusmin) {
             keep = glas*2;
-        } else if (mapselectmaxwidthopt == "all") {
+        } else if (mapselectmaxwidthopt == mw_all) {
             keep = las;
         } if (keep < las) {
             gla = la;
@@ -2754,8 +3386,7 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
 
     // Prepare for recursion;
     // option mapselectmaxlevel indicates the maximum level of recursion (0 is no recursion)
-    auto mapselectmaxlevelstring = options::get("mapselectmaxlevel");
-    Int mapselectmaxlevel = (mapselectmaxlevelstring == "inf") ? MAX_CYCLE : parse_int(mapselectmaxlevelstring);
+    Int mapselectmaxlevel = mapoptions.mapselectmaxlevel;
 
     // When maxlevel has been reached, stop the recursion, and choose from the best minextend/maxfidelity alternatives
     if (level >= mapselectmaxlevel) {
@@ -2764,7 +3395,7 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
         bla = gla;
         bla.remove_if([this,gla](const Alter& a) { return a.score != gla.front().score; });
         Alter::DPRINT("... SelectAlter reduced to best alternatives to choose result from:", bla);
-        resa = ChooseAlter(bla, future);
+        resa = ChooseAlter(bla, future, gen);
         resa.DPRINT("... the selected Alter (STOPPING RECURSION) is");
         // DOUT("SelectAlter DONE level=" << level << " from " << bla.size() << " best alternatives");
         return;
@@ -2775,7 +3406,7 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
     //
     // For each alternative in gla,
     // lookahead for next non-NN2q gates, and comparing them for their alternative mappings;
-    // the lookahead alternative with the least overall extension (i.e. relative to basePast) is chosen,
+    // the lookahead alternative with the least overall extension (i.e. relative to the base past) is chosen,
     // and the current alternative on top of which it was build
     // is chosen at the current level, unwinding the recursion.
     //
@@ -2785,56 +3416,36 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
     // - end-of-circuit (no non-NN 2q gates remain).
     //
     // When gla.size() == 1, we still want to know its minimum extension, to compare with competitors,
-    // since that is not just a local figure but the extension from basePast;
+    // since that is not just a local figure but the extension from the base past;
     // so indeed with only one alternative we may still go into recursion below.
     // This means that recursion always goes to maxlevel or end-of-circuit.
     // This anomaly may need correction.
     // DOUT("... SelectAlter level=" << level << " entering recursion with " << gla.size() << " good alternatives");
+    //
+    // Each alternative's recursion gets its own random generator, seeded from gen and the alternative's index,
+    // so the alternatives are independent of each other and can be evaluated in any order;
+    // at level 0, past is the main past, and then they are evaluated in parallel when there is a pool of threads,
+    // each thread on its own stand-in for the past (which is made on first use) while the main past is left alone
+    UInt seed = (mapoptions.maptiebreak == mt_random) ? gen() : 0;
+    Vec<Alter*> glp;                        // gla by index
     for (auto &a : gla) {
-        a.DPRINT("... ... considering alternative:");
-        Future future_copy = future;            // copy!
-        Past   past_copy = past;                // copy!
-        CommitAlter(a, future_copy, past_copy);
-        a.DPRINT("... ... committed this alternative first before recursion:");
-
-        Bool    havegates;                  // are there still non-NN 2q gates to map?
-        List<gate*> lg;            // list of non-NN 2q gates taken from avlist, as returned from MapMappableGates
-        Str maplookaheadopt = options::get("maplookahead");
-        Str maprecNN2qopt = options::get("maprecNN2q");
-        // In recursion, look at option maprecNN2q:
-        // - MapMappableGates with alsoNN2q==true is greedy and immediately maps each 1q and NN 2q gate
-        // - MapMappableGates with alsoNN2q==false is not greedy, maps all 1q gates but not the (NN) 2q gates
-        //
-        // when yes and when maplookaheadopt is noroutingfirst or all, let MapMappableGates stop mapping only on nonNN2q
-        // when no, let MapMappableGates stop mapping on any 2q
-        // This creates more clear recursion: one 2q at a time instead of a possible empty set of NN2qs followed by a nonNN2q;
-        // also when a NN2q is found, this is perfect; this is not seen when immediately mapping all NN2qs.
-        // So goal is to prove that maprecNN2q should be no at this place, in the recursion step, but not at level 0!
-        Bool alsoNN2q = (maprecNN2qopt == "yes") && (maplookaheadopt == "noroutingfirst" || maplookaheadopt == "all");
-        havegates = MapMappableGates(future_copy, past_copy, lg, alsoNN2q); // map all easy gates; remainder returned in lg
-
-        if (havegates) {
-            // DOUT("... ... SelectAlter level=" << level << ", committed + mapped easy gates, now facing " << lg.size() << " 2q gates to evaluate next");
-            List<Alter> la;                // list that will hold all variations, as returned by GenAlters
-            GenAlters(lg, la, past_copy);       // gen all possible variations to make gates in lg NN, in current past.v2r mapping
-            // DOUT("... ... SelectAlter level=" << level << ", generated for these 2q gates " << la.size() << " alternatives; RECURSE ... ");
-            Alter resa;                         // result alternative selected and returned by next SelectAlter call
-            SelectAlter(la, resa, future_copy, past_copy, basePast, level+1); // recurse, best in resa ...
-            resa.DPRINT("... ... SelectAlter, generated for these 2q gates ... ; RECURSE DONE; resulting alternative ");
-            a.score = resa.score;               // extension of deep recursion is treated as extension at current level,
-            // by this an alternative started bad may be compensated by deeper alts
-        } else {
-            // DOUT("... ... SelectAlter level=" << level << ", no gates to evaluate next; RECURSION BOTTOM");
-            auto mapperopt = options::get("mapper");
-            if (mapperopt == "maxfidelity") {
-                QL_FATAL("Mapper option maxfidelity has been disabled");
-                // a.score = quick_fidelity(past_copy.lg);
-            } else {
-                a.score = past_copy.MaxFreeCycle() - basePast.MaxFreeCycle();
+        glp.push_back(&a);
+    }
+    if (level == 0 && pool.has_value() && glp.size() > 1) {
+        Vec<UInt> workerinited(pool->size(), 0);
+        auto context = CompileContext::current();
+        pool->parallel_for(glp.size(), [&](UInt index, UInt worker) {
+            CompileContext::Scope scope(context);
+            if (!workerinited[worker]) {
+                workerpasts[worker].InitFrom(past, &workerkernels[worker]);
+                workerinited[worker] = 1;
             }
-            a.DPRINT("... ... SelectAlter, after committing this alternative, mapped easy gates, no gates to evaluate next; RECURSION BOTTOM");
+            EvaluateAlter(*glp[index], index, seed, future, workerpasts[worker], baseFreeCycle, level);
+        });
+    } else {
+        for (UInt index = 0; index < glp.size(); index++) {
+            EvaluateAlter(*glp[index], index, seed, future, past, baseFreeCycle, level);
         }
-        a.DPRINT("... ... DONE considering alternative:");
     }
     // Sort list of good alternatives (gla) on score resulting after recursion
     gla.sort([this](const Alter &a1, const Alter &a2) { return a1.score < a2.score; });
@@ -2845,21 +3456,74 @@ void Mapper::SelectAlter(List<Alter> &la, Alter &resa, Future &future, Past &pas
     bla = gla;
     bla.remove_if([this,gla](const Alter& a) { return a.score != gla.front().score; });
     Alter::DPRINT("... SelectAlter equally best alternatives on return of RECURSION:", bla);
-    resa = ChooseAlter(bla, future);
+    resa = ChooseAlter(bla, future, gen);
     resa.DPRINT("... the selected Alter is");
     // DOUT("... SelectAlter level=" << level << " selecting from " << bla.size() << " equally good alternatives above DONE");
     QL_DOUT("SelectAlter DONE level=" << level << " from " << la.size() << " alternatives");
 }
 
+// evaluate alternative a, number index of the alternatives at this level, by committing it to a copy of future and to past,
+// mapping what then can be mapped, and recursing to select the best of the resulting alternatives;
+// the resulting extension relative to baseFreeCycle is stored in a.score; past is rolled back, so on return it is unchanged;
+// the recursion draws from its own random generator seeded by seed and index, so the result doesn't depend on
+// the order in which the alternatives are evaluated
+void Mapper::EvaluateAlter(Alter &a, UInt index, UInt seed, const Future &future, Past &past, UInt baseFreeCycle, Int level) {
+    a.DPRINT("... ... considering alternative:");
+    Future future_copy = future;            // copy!
+    future_copy.setcycles = false;          // leave the gates alone, the main future sets their cycle
+    past.Checkpoint();                      // instead of a copy, extend past in place and roll it back below
+    CommitAlter(a, future_copy, past);
+    a.DPRINT("... ... committed this alternative first before recursion:");
+
+    Bool    havegates;                  // are there still non-NN 2q gates to map?
+    List<gate*> lg;            // list of non-NN 2q gates taken from avlist, as returned from MapMappableGates
+    // In recursion, look at option maprecNN2q:
+    // - MapMappableGates with alsoNN2q==true is greedy and immediately maps each 1q and NN 2q gate
+    // - MapMappableGates with alsoNN2q==false is not greedy, maps all 1q gates but not the (NN) 2q gates
+    //
+    // when yes and when maplookaheadopt is noroutingfirst or all, let MapMappableGates stop mapping only on nonNN2q
+    // when no, let MapMappableGates stop mapping on any 2q
+    // This creates more clear recursion: one 2q at a time instead of a possible empty set of NN2qs followed by a nonNN2q;
+    // also when a NN2q is found, this is perfect; this is not seen when immediately mapping all NN2qs.
+    // So goal is to prove that maprecNN2q should be no at this place, in the recursion step, but not at level 0!
+    Bool alsoNN2q = mapoptions.maprecNN2q && (mapoptions.maplookahead == ml_noroutingfirst || mapoptions.maplookahead == ml_all);
+    havegates = MapMappableGates(future_copy, past, lg, alsoNN2q); // map all easy gates; remainder returned in lg
+
+    if (havegates) {
+        // DOUT("... ... SelectAlter level=" << level << ", committed + mapped easy gates, now facing " << lg.size() << " 2q gates to evaluate next");
+        List<Alter> la;                // list that will hold all variations, as returned by GenAlters
+        GenAlters(lg, la, past);            // gen all possible variations to make gates in lg NN, in current past.v2r mapping
+        // DOUT("... ... SelectAlter level=" << level << ", generated for these 2q gates " << la.size() << " alternatives; RECURSE ... ");
+        Alter resa;                         // result alternative selected and returned by next SelectAlter call
+        std::mt19937 recgen;                // random generator of this alternative's recursion
+        if (mapoptions.maptiebreak == mt_random) {
+            std::seed_seq seq{seed, index};
+            recgen.seed(seq);
+        }
+        SelectAlter(la, resa, future_copy, past, baseFreeCycle, level+1, recgen); // recurse, best in resa ...
+        resa.DPRINT("... ... SelectAlter, generated for these 2q gates ... ; RECURSE DONE; resulting alternative ");
+        a.score = resa.score;               // extension of deep recursion is treated as extension at current level,
+        // by this an alternative started bad may be compensated by deeper alts
+    } else {
+        // DOUT("... ... SelectAlter level=" << level << ", no gates to evaluate next; RECURSION BOTTOM");
+        if (mapoptions.mapper == mk_maxfidelity) {
+            QL_FATAL("Mapper option maxfidelity has been disabled");
+            // a.score = quick_fidelity(past.lg);
+        } else {
+            a.score = past.MaxFreeCycle() - baseFreeCycle;
+        }
+        a.DPRINT("... ... SelectAlter, after committing this alternative, mapped easy gates, no gates to evaluate next; RECURSION BOTTOM");
+    }
+    past.Rollback();
+    a.DPRINT("... ... DONE considering alternative:");
+}
+
 // Given the states of past and future
 // map all mappable gates and find the non-mappable ones
-// for those evaluate what to do next and do it;
-// during recursion, comparison is done with the base past (bottom of recursion stack),
-// and past is the last past (top of recursion stack) relative to which the mapping is done.
-void Mapper::MapGates(Future &future, Past &past, Past &basePast) {
+// for those evaluate what to do next and do it.
+void Mapper::MapGates(Future &future, Past &past) {
     List<gate*> lg;              // list of non-mappable gates taken from avlist, as returned from MapMappableGates
-    Str maplookaheadopt = options::get("maplookahead");
-    Bool alsoNN2q = (maplookaheadopt == "noroutingfirst" || maplookaheadopt == "all");
+    Bool alsoNN2q = (mapoptions.maplookahead == ml_noroutingfirst || mapoptions.maplookahead == ml_all);
     while (MapMappableGates(future, past, lg, alsoNN2q)) { // returns false when no gates remain
         // all gates in lg are two-qubit quantum gates that cannot be mapped
         // select which one(s) to (partially) route, according to one of the known strategies
@@ -2871,7 +3535,7 @@ void Mapper::MapGates(Future &future, Past &past, Past &basePast) {
 
         // select best one
         Alter resa;
-        SelectAlter(la, resa, future, past, basePast, 0);
+        SelectAlter(la, resa, future, past, past.MaxFreeCycle(), 0, gen);
         // select one according to strategy specified by options; result in resa
 
         // commit to best one
@@ -2880,22 +3544,327 @@ void Mapper::MapGates(Future &future, Past &past, Past &basePast) {
     }
 }
 
+// =========================================================================================
+// sabre: the mapper heuristic of Li, Ding and Xie, "Tackling the Qubit Mapping Problem for NISQ-Era
+// Quantum Devices" (ASPLOS 2019), selected by option mapper=sabre.
+//
+// Instead of evaluating alternative paths of swaps for a single gate by the latency extension they cause,
+// sabre selects one swap at a time, among those of an operand of a gate of the front layer (the non-NN two-qubit
+// gates in avlist) with one of its neighbors; it selects the one that minimizes
+//      max(decay[r0],decay[r1]) * ( sum of distances of front gates / number of front gates
+//                                   + SABRE_EXTENDED_SET_WEIGHT * sum of distances of extended set gates / their number )
+// the extended set being the next SABRE_EXTENDED_SET_SIZE two-qubit gates after the front layer;
+// decay[r] is increased by each swap on r, and reset when a gate becomes NN or after SABRE_DECAY_RESET swaps,
+// so that swaps on different qubits, that can be done in parallel, are preferred.
+// When no front gate became NN after a number of swaps equal to the number of qubits, the most critical front gate
+// is routed along a shortest path as by mapper=base, which guarantees progress.
+//
+// Before mapping, the initial mapping is refined by mapsabrepasses forward and backward passes over the circuit,
+// only routing its two-qubit gates without generating gates: the final mapping of a backward pass over the reversed
+// circuit is a mapping at the start of the circuit in which the gates at the start are close together.
+// The final, forward, pass maps into the past, as the other mapper heuristics do, which schedules the swaps and gates.
+const UInt SABRE_EXTENDED_SET_SIZE = 20;
+const Real SABRE_EXTENDED_SET_WEIGHT = 0.5;
+const Real SABRE_DECAY_DELTA = 0.001;
+const UInt SABRE_DECAY_RESET = 5;
+
+// sabre: select the swap that by sabre's cost function brings the two-qubit gates closest together;
+// front and ext are the operands (real qubits) of the gates of the front layer and of the extended set;
+// the candidates are the swaps of an operand of a front gate with one of its neighbors;
+// decay[r] penalizes swapping real qubit r again; when past is given, a tie is broken
+// in favor of the swap that starts earliest in it; the selected swap is returned in r0 and r1
+void Mapper::SabreSelectSwap(
+    const Vec<Pair<UInt, UInt>> &front,
+    const Vec<Pair<UInt, UInt>> &ext,
+    const Vec<Real> &decay,
+    const Past *past,
+    UInt &r0,
+    UInt &r1
+) const {
+    // distance between real qubits q0 and q1 after swapping real qubits s0 and s1
+    auto distance = [this](UInt q0, UInt q1, UInt s0, UInt s1) {
+        q0 = (q0 == s0 ? s1 : (q0 == s1 ? s0 : q0));
+        q1 = (q1 == s0 ? s1 : (q1 == s1 ? s0 : q1));
+        return grid.Distance(q0, q1);
+    };
+
+    Real bestcost = 0.0;
+    r0 = UNDEFINED_QUBIT;
+    r1 = UNDEFINED_QUBIT;
+    for (auto &fg : front) {
+        for (UInt s0 : { fg.first, fg.second }) {
+            for (UInt s1 : grid.nbs.at(s0)) {
+                UInt frontsum = 0;
+                for (auto &g : front) {
+                    frontsum += distance(g.first, g.second, s0, s1);
+                }
+                UInt extsum = 0;
+                for (auto &g : ext) {
+                    extsum += distance(g.first, g.second, s0, s1);
+                }
+                Real cost = Real(frontsum) / front.size();
+                if (!ext.empty()) {
+                    cost += SABRE_EXTENDED_SET_WEIGHT * extsum / ext.size();
+                }
+                cost *= std::max(decay[s0], decay[s1]);
+                if (
+                    r0 == UNDEFINED_QUBIT
+                    || cost < bestcost
+                    || (cost == bestcost && past != nullptr && past->IsFirstSwapEarliest(s0, s1, r0, r1))
+                ) {
+                    bestcost = cost;
+                    r0 = s0;
+                    r1 = s1;
+                }
+            }
+        }
+    }
+    QL_ASSERT(r0 != UNDEFINED_QUBIT);
+}
+
+// sabre: route the two-qubit gates, given as pairs of virtual qubits, in order or in reverse order,
+// starting from mapping loc (loc[virtual qubit] is real qubit), by the swaps selected by SabreSelectSwap,
+// without generating gates; loc is left as the final mapping; returns the number of swaps
+UInt Mapper::SabreTrial(const Vec<Pair<UInt, UInt>> &gates, Bool reversed, Vec<UInt> &loc) const {
+    // dependences of the gates, indexed in the order of routing: each gate depends on the previous one on each operand
+    UInt ngates = gates.size();
+    auto gate = [&](UInt s) -> const Pair<UInt, UInt> & { return gates[reversed ? ngates - 1 - s : s]; };
+    Vec<UInt> npred(ngates, 0);
+    Vec<Vec<UInt>> succs(ngates);
+    Vec<UInt> last(nq, MAX);
+    for (UInt s = 0; s < ngates; s++) {
+        UInt p0 = last[gate(s).first];
+        UInt p1 = last[gate(s).second];
+        if (p0 != MAX) {
+            succs[p0].push_back(s);
+            npred[s]++;
+        }
+        if (p1 != MAX && p1 != p0) {
+            succs[p1].push_back(s);
+            npred[s]++;
+        }
+        last[gate(s).first] = s;
+        last[gate(s).second] = s;
+    }
+
+    Vec<UInt> virt(nq, UNDEFINED_QUBIT);        // virt[real qubit] is virtual qubit, the inverse of loc
+    for (UInt v = 0; v < nq; v++) {
+        if (loc[v] != UNDEFINED_QUBIT) {
+            virt[loc[v]] = v;
+        }
+    }
+    Vec<UInt> front;
+    for (UInt s = 0; s < ngates; s++) {
+        if (npred[s] == 0) {
+            front.push_back(s);
+        }
+    }
+    Vec<Real> decay(nq, 1.0);
+    UInt nswaps = 0;
+    UInt noprogress = 0;
+    while (true) {
+        // do the front gates that are NN, which makes their successors available
+        Bool progress = false;
+        Bool done = true;
+        while (done) {
+            done = false;
+            Vec<UInt> remaining;
+            for (UInt s : front) {
+                if (grid.MinHops(loc[gate(s).first], loc[gate(s).second]) == 1) {
+                    for (UInt succ : succs[s]) {
+                        if (--npred[succ] == 0) {
+                            remaining.push_back(succ);
+                        }
+                    }
+                    done = true;
+                    progress = true;
+                } else {
+                    remaining.push_back(s);
+                }
+            }
+            front.swap(remaining);
+        }
+        if (front.empty()) {
+            break;
+        }
+        if (progress) {
+            decay.assign(nq, 1.0);
+            noprogress = 0;
+        }
+
+        UInt r0;
+        UInt r1;
+        if (noprogress >= nq) {
+            // route the first front gate one hop along a shortest path
+            r0 = loc[gate(front[0]).first];
+            r1 = grid.NextHop(r0, loc[gate(front[0]).second], 0);
+        } else {
+            Vec<Pair<UInt, UInt>> frontops;
+            for (UInt s : front) {
+                frontops.push_back(Pair<UInt, UInt>(loc[gate(s).first], loc[gate(s).second]));
+            }
+            // extended set: the gates that become available after the front ones, breadth first
+            Vec<Pair<UInt, UInt>> extops;
+            utils::Map<UInt, UInt> left;
+            Vec<UInt> visit = front;
+            for (UInt i = 0; i < visit.size() && extops.size() < SABRE_EXTENDED_SET_SIZE; i++) {
+                for (UInt succ : succs[visit[i]]) {
+                    auto it = left.find(succ);
+                    UInt count = (it == left.end() ? npred[succ] : it->second) - 1;
+                    left.set(succ) = count;
+                    if (count == 0) {
+                        extops.push_back(Pair<UInt, UInt>(loc[gate(succ).first], loc[gate(succ).second]));
+                        visit.push_back(succ);
+                    }
+                }
+            }
+            SabreSelectSwap(frontops, extops, decay, nullptr, r0, r1);
+        }
+
+        UInt v0 = virt[r0];
+        UInt v1 = virt[r1];
+        if (v0 != UNDEFINED_QUBIT) {
+            loc[v0] = r1;
+        }
+        if (v1 != UNDEFINED_QUBIT) {
+            loc[v1] = r0;
+        }
+        virt[r0] = v1;
+        virt[r1] = v0;
+        nswaps++;
+        noprogress++;
+        decay[r0] += SABRE_DECAY_DELTA;
+        decay[r1] += SABRE_DECAY_DELTA;
+        if (nswaps % SABRE_DECAY_RESET == 0) {
+            decay.assign(nq, 1.0);
+        }
+    }
+    return nswaps;
+}
+
+// sabre: refine initial mapping v2r for the circuit by forward and backward trial passes over its two-qubit gates
+void Mapper::SabreRefine(const circuit &circ, Virt2Real &v2r) const {
+    Vec<Pair<UInt, UInt>> gates;
+    for (auto gp : circ) {
+        if (gp->type() != __classical_gate__ && gp->type() != __wait_gate__ && gp->operands.size() == 2) {
+            gates.push_back(Pair<UInt, UInt>(gp->operands[0], gp->operands[1]));
+        }
+    }
+    if (gates.empty() || mapoptions.mapsabrepasses == 0) {
+        return;
+    }
+    if (grid.ncores > 1) {
+        QL_DOUT("SabreRefine: multi-core grids are not supported, initial mapping is not refined");
+        return;
+    }
+    Vec<UInt> loc(nq);
+    for (UInt v = 0; v < nq; v++) {
+        loc[v] = v2r[v];
+    }
+    for (auto &g : gates) {
+        if (loc[g.first] == UNDEFINED_QUBIT || loc[g.second] == UNDEFINED_QUBIT) {
+            QL_DOUT("SabreRefine: not all qubits have been mapped initially, initial mapping is not refined");
+            return;
+        }
+    }
+    for (UInt pass = 0; pass < mapoptions.mapsabrepasses; pass++) {
+        UInt forwardswaps = SabreTrial(gates, false, loc);
+        UInt backwardswaps = SabreTrial(gates, true, loc);
+        QL_DOUT("SabreRefine: pass " << pass << ": swaps forward=" << forwardswaps << " backward=" << backwardswaps);
+    }
+    for (UInt v = 0; v < nq; v++) {
+        v2r[v] = loc[v];
+    }
+    v2r.DPRINT("After SabreRefine");
+}
+
+// sabre: as MapGates but routing by the swaps selected by SabreSelectSwap
+void Mapper::MapGatesSabre(Future &future, Past &past) {
+    List<gate*> lg;                 // front layer: the non-NN two-qubit gates in avlist
+    List<gate*> prevlg;             // front layer before the last swap
+    Vec<Real> decay(nq, 1.0);
+    UInt nswaps = 0;
+    UInt noprogress = 0;
+    while (MapMappableGates(future, past, lg, true)) {
+        if (lg != prevlg) {
+            decay.assign(nq, 1.0);
+            noprogress = 0;
+        }
+        if (noprogress >= nq) {
+            // route the most critical front gate along a shortest path, as mapper=base does
+            gate *gp = future.MostCriticalIn(lg);
+            QL_ASSERT(gp != NULL);
+            List<Alter> la;
+            GenAltersGate(gp, la, past);
+            Alter resa = la.front();
+            CommitAlter(resa, future, past);
+            noprogress = 0;
+            prevlg.clear();
+            continue;
+        }
+
+        Vec<Pair<UInt, UInt>> frontops;
+        for (auto gp : lg) {
+            frontops.push_back(Pair<UInt, UInt>(past.MapQubit(gp->operands[0]), past.MapQubit(gp->operands[1])));
+        }
+        Vec<gate*> extlg;
+        future.GetExtendedSet(SABRE_EXTENDED_SET_SIZE, extlg);
+        Vec<Pair<UInt, UInt>> extops;
+        for (auto gp : extlg) {
+            UInt q0 = past.GetReal(gp->operands[0]);
+            UInt q1 = past.GetReal(gp->operands[1]);
+            if (q0 != UNDEFINED_QUBIT && q1 != UNDEFINED_QUBIT) {
+                extops.push_back(Pair<UInt, UInt>(q0, q1));
+            }
+        }
+        UInt r0;
+        UInt r1;
+        SabreSelectSwap(frontops, extops, decay, &past, r0, r1);
+        QL_DOUT("MapGatesSabre: swap(" << r0 << "," << r1 << ") for " << lg.size() << " front gates");
+        past.AddSwap(r0, r1);
+        past.Schedule();
+
+        nswaps++;
+        noprogress++;
+        decay[r0] += SABRE_DECAY_DELTA;
+        decay[r1] += SABRE_DECAY_DELTA;
+        if (nswaps % SABRE_DECAY_RESET == 0) {
+            decay.assign(nq, 1.0);
+        }
+        prevlg = lg;
+    }
+}
+
 // Map the circuit's gates in the provided context (v2r maps), updating circuit and v2r maps
 void Mapper::MapCircuit(quantum_kernel &kernel, Virt2Real &v2r) {
     Future  future;         // future window, presents input in avlist
     Past    mainPast;       // past window, contains output schedule, storing all gates until taken out
     Scheduler sched;        // new scheduler instance (from src/scheduler.h) used for its dependence graph
 
-    future.Init(platformp);
+    future.Init(platformp, &mapoptions);
     future.SetCircuit(kernel, sched, nq, nc, nb); // constructs depgraph, initializes avlist, ready for producing gates
     kernel.c.clear();       // future has copied kernel.c to private data; kernel.c ready for use by new_gate
     kernelp = &kernel;      // keep kernel to call kernelp->gate() inside Past.new_gate(), to create new gates
 
-    mainPast.Init(platformp, kernelp, &grid);  // mainPast and Past clones inside Alters ready for generating output schedules into
+    // the threads evaluating alternatives each create their gates in a copy of the kernel (then with empty circuit)
+    workerkernels.clear();
+    workerpasts.clear();
+    if (pool.has_value()) {
+        for (UInt worker = 0; worker < pool->size(); worker++) {
+            workerkernels.push_back(kernel);
+        }
+        workerpasts.resize(pool->size());
+    }
+
+    mainPast.Init(platformp, &mapoptions, kernelp, &grid);  // mainPast ready for generating output schedules into
     mainPast.ImportV2r(v2r);    // give it the current mapping/state
     // mainPast.DPRINT("start mapping");
 
-    MapGates(future, mainPast, mainPast);
+    if (mapoptions.mapper == mk_sabre) {
+        MapGatesSabre(future, mainPast);
+    } else {
+        MapGates(future, mainPast);
+    }
     mainPast.FlushAll();                // all output to mainPast.outlg, the output window of mainPast
 
     // mainPast.DPRINT("end mapping");
@@ -2918,7 +3887,7 @@ void Mapper::MakePrimitives(quantum_kernel &kernel) {
     kernel.c.clear();                           // kernel.c ready for use by new_gate
 
     Past            mainPast;                   // output window in which gates are scheduled
-    mainPast.Init(platformp, kernelp, &grid);
+    mainPast.Init(platformp, &mapoptions, kernelp, &grid);
 
     for (auto & gp : input_gatepv) {
         circuit tmpCirc;
@@ -2958,25 +3927,43 @@ void Mapper::Map(quantum_kernel& kernel) {
     v2r.Export(v2r_in);  // from v2r to caller for reporting
     v2r.Export(rs_in);   // from v2r to caller for reporting
 
+    ipresult = "";
+    ipcost = 0;
+    iptimetaken = 0.0;
     Str initialplaceopt = options::get("initialplace");
     if (initialplaceopt != "no") {
-#ifdef INITIALPLACE
         Str initialplace2qhorizonopt = options::get("initialplace2qhorizon");
         QL_DOUT("InitialPlace: kernel=" << kernel.name << " initialplace=" << initialplaceopt << " initialplace2qhorizon=" << initialplace2qhorizonopt << " [START]");
         InitialPlace    ip;             // initial placer facility
         ipr_t           ipok;           // one of several ip result possibilities
-        Real          iptimetaken;      // time solving the initial placement took, in seconds
 
         ip.Init(&grid, platformp);
-        ip.Place(kernel.c, v2r, ipok, iptimetaken, initialplaceopt); // compute mapping (in v2r) using ip model, may fail
-        QL_DOUT("InitialPlace: kernel=" << kernel.name << " initialplace=" << initialplaceopt << " initialplace2qhorizon=" << initialplace2qhorizonopt << " result=" << ip.ipr2string(ipok) << " iptimetaken=" << iptimetaken << " seconds [DONE]");
+        if (initialplaceopt == "heuristic") {
+            ip.PlaceHeuristic(kernel.c, v2r, ipok, iptimetaken, gen(), pool.has_value() ? &*pool : nullptr);
+        } else {
+#ifdef INITIALPLACE
+            // the MIP solver is not known to be reentrant, so kernels mapped in parallel take turns placing
+            static std::mutex ipmutex;
+            std::lock_guard<std::mutex> iplock(ipmutex);
+            ip.Place(kernel.c, v2r, ipok, iptimetaken, initialplaceopt); // compute mapping (in v2r) using ip model, may fail
 #else // ifdef INITIALPLACE
-        QL_DOUT("InitialPlace support disabled during OpenQL build [DONE]");
-        QL_WOUT("InitialPlace support disabled during OpenQL build [DONE]");
+            QL_DOUT("InitialPlace support disabled during OpenQL build [DONE]");
+            QL_WOUT("InitialPlace support disabled during OpenQL build [DONE]");
+            ipok = ipr_failed;
+            iptimetaken = 0.0;
 #endif // ifdef INITIALPLACE
+        }
+        ipresult = ip.ipr2string(ipok);
+        ipcost = (ipok == ipr_failed || ipok == ipr_timedout) ? 0 : ip.cost;
+        QL_DOUT("InitialPlace: kernel=" << kernel.name << " initialplace=" << initialplaceopt << " initialplace2qhorizon=" << initialplace2qhorizonopt << " result=" << ipresult << " cost=" << ipcost << " iptimetaken=" << iptimetaken << " seconds [DONE]");
     }
     v2r.DPRINT("After InitialPlace");
 
+    // the sabre refinement of the initial mapping is part of initial placement, also in the report
+    if (mapoptions.mapper == mk_sabre) {
+        SabreRefine(kernel.c, v2r);
+    }
+
     v2r.Export(v2r_ip);  // from v2r to caller for reporting
     v2r.Export(rs_ip);   // from v2r to caller for reporting
 
@@ -3006,7 +3993,11 @@ void Mapper::Init(const quantum_platform *p) {
     nq = p->qubit_number;
     // nc = p->creg_number;  // nc should come from platform, but doesn't; is taken from kernel in Map
     // nb = p->breg_number;  // nb should come from platform, but doesn't; is taken from kernel in Map
+    mapoptions.Init();
     RandomInit();
+    if (mapoptions.mapthreads > 1) {
+        pool.emplace(mapoptions.mapthreads);
+    }
     // DOUT("... platform/real number of qubits=" << nq << ");
     cycle_time = p->cycle_time;
 
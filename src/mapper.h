@@ -8,11 +8,15 @@
 #include <chrono>
 #include <ctime>
 #include <ratio>
+#include <memory>
 #include "utils/map.h"
 #include "utils/vec.h"
 #include "utils/list.h"
 #include "utils/str.h"
 #include "utils/num.h"
+#include "utils/undo.h"
+#include "utils/opt.h"
+#include "utils/thread_pool.h"
 #include "platform.h"
 #include "kernel.h"
 #include "resource_manager.h"
@@ -37,6 +41,78 @@ namespace mapper {
 
 
 
+// =========================================================================================
+// MapperOptions: the mapper options, parsed from the global options once in Mapper::Init;
+// the FreeCycle, Past, Alter and Future objects get a pointer to it in their Init
+// so that the mapping loops test enum/integer values instead of looking up and comparing option strings.
+// Init is fatal on an unknown option value, like the option checks in the mapping loops were before.
+typedef enum MapperKinds {
+    mk_base,            // "base"
+    mk_baserc,          // "baserc"
+    mk_minextend,       // "minextend"
+    mk_minextendrc,     // "minextendrc"
+    mk_maxfidelity,     // "maxfidelity"
+    mk_sabre            // "sabre"
+} mapperkind_t;
+
+typedef enum MapLookAheads {
+    ml_no,              // "no"
+    ml_1qfirst,         // "1qfirst"
+    ml_noroutingfirst,  // "noroutingfirst"
+    ml_all              // "all"
+} maplookahead_t;
+
+typedef enum MapPathSelects {
+    mp_all,             // "all"
+    mp_borders          // "borders"
+} mappathselect_t;
+
+typedef enum MapSelectSwaps {
+    ms_one,             // "one"
+    ms_all,             // "all"
+    ms_earliest         // "earliest"
+} mapselectswaps_t;
+
+typedef enum MapSelectMaxWidths {
+    mw_min,             // "min"
+    mw_minplusone,      // "minplusone"
+    mw_minplushalfmin,  // "minplushalfmin"
+    mw_minplusmin,      // "minplusmin"
+    mw_all              // "all"
+} mapselectmaxwidth_t;
+
+typedef enum MapTieBreaks {
+    mt_first,           // "first"
+    mt_last,            // "last"
+    mt_random,          // "random"
+    mt_critical         // "critical"
+} maptiebreak_t;
+
+class MapperOptions {
+public:
+    mapperkind_t        mapper;
+    utils::Bool         mapper_rc;          // mapper is baserc or minextendrc: schedule with resource constraints
+    maplookahead_t      maplookahead;
+    mappathselect_t     mappathselect;
+    mapselectswaps_t    mapselectswaps;
+    mapselectmaxwidth_t mapselectmaxwidth;
+    utils::Int          mapselectmaxlevel;  // "inf" is MAX_CYCLE
+    maptiebreak_t       maptiebreak;
+    utils::Bool         mapseeded;          // mapseed is not "none"
+    utils::UInt         mapseed;            // seed of the random generator when mapseeded
+    utils::UInt         mapthreads;         // number of threads evaluating alternatives; "max" is one per hardware thread
+    utils::Bool         maprecNN2q;
+    utils::Bool         mapreverseswap;
+    utils::Bool         mapprepinitsstate;
+    utils::Bool         mapusemoves;        // mapusemoves is not "no"
+    utils::Int          mapusemoves_threshold;  // "yes" is 0, else the number given
+    utils::UInt         mapsabrepasses;     // number of forward/backward passes of sabre refining the initial mapping
+
+    void Init();
+};
+
+
+
 // =========================================================================================
 // Grid: definition and access functions to the grid of qubits that supports the real qubits.
 // Maintain several maps to ease navigating in the grid; these are constant after initialization.
@@ -55,7 +131,9 @@ namespace mapper {
 // Grid public members (apart from nq):
 //  form:               how relation between neighbors is specified
 //  Distance(qi,qj):    distance in physical connection hops from real qubit qi to real qubit qj;
-//                      - computing it relies on nbs (and Floyd-Warshall) (gf_xy and gf_irregular)
+//                      - computing it relies on nbs (and breadth-first search) (gf_xy and gf_irregular)
+//  NextHop(qi,qj,i):   i-th neighbor of real qubit qi that starts a shortest path to real qubit qj;
+//                      these neighbors are in nbs order and normalized as by Normalize
 //  nbs[qi]:            list of neighbor real qubits of real qubit qi
 //                      - nbs can be derived from topology.edges (gf_xy and gf_irregular)
 //  Normalize(qi, neighborlist):    rotate neighborlist such that largest angle diff around qi is behind last element
@@ -102,7 +180,16 @@ public:
     utils::Map<utils::UInt,neighbors_t> nbs;       // nbs[i] is list of neighbor qubits of qubit i
     utils::Map<utils::UInt,utils::Int> x;          // x[i] is x coordinate of qubit i
     utils::Map<utils::UInt,utils::Int> y;          // y[i] is y coordinate of qubit i
-    utils::Vec<utils::Vec<utils::UInt>> dist;      // dist[i][j] is computed distance between qubits i and j;
+
+    // shortest path tables, computed once per topology and shared by all grids with that topology;
+    // the index of the pair of qubits i and j is i*nq+j
+    class Paths {
+    public:
+        utils::Vec<utils::UInt> dist;       // dist[i*nq+j] is computed distance between qubits i and j
+        utils::Vec<utils::UInt> hopsbegin;  // hops[hopsbegin[i*nq+j] .. hopsbegin[i*nq+j+1]-1] are next hops from i to j
+        utils::Vec<utils::UInt> hops;       // concatenated next hop lists of all pairs
+    };
+    std::shared_ptr<const Paths> paths;
 
     // Grid initializer
     // initialize mapper internal grid maps from configuration
@@ -120,9 +207,16 @@ public:
     // formulae for convex (hole free) topologies with underlying grid and with bidirectional edges:
     //      gf_cross:   max( abs( x[to_realqi] - x[from_realqi] ), abs( y[to_realqi] - y[from_realqi] ))
     //      gf_plus:    abs( x[to_realqi] - x[from_realqi] ) + abs( y[to_realqi] - y[from_realqi] )
-    // when the neighbor relation is defined (topology.edges in config file), Floyd-Warshall is used, which currently is always
+    // when the neighbor relation is defined (topology.edges in config file), breadth-first search is used, which currently is always
     utils::UInt Distance(utils::UInt from_realqi, utils::UInt to_realqi) const;
 
+    // number of neighbors of from_realqi that start a shortest path to to_realqi,
+    // i.e. that have distance Distance(from_realqi, to_realqi)-1 to to_realqi
+    utils::UInt NextHopCount(utils::UInt from_realqi, utils::UInt to_realqi) const;
+
+    // i-th of those neighbors, in the order of nbs[from_realqi] after Normalize
+    utils::UInt NextHop(utils::UInt from_realqi, utils::UInt to_realqi, utils::UInt i) const;
+
     // coredistance between two qubits
     // when multi-core assumes full and uniform core connectivity
     utils::UInt CoreDistance(utils::UInt from_realqi, utils::UInt to_realqi) const;
@@ -148,8 +242,9 @@ public:
     // and this can only be computed when there is an underlying x/y grid (so not for form==gf_irregular)
     void Normalize(utils::UInt src, neighbors_t &nbl) const;
 
-    // Floyd-Warshall dist[i][j] = shortest distances between all nq qubits i and j
-    void ComputeDist();
+    // compute the shortest path tables of this topology, or take them from the cache
+    // when another grid already computed them
+    void ComputePaths();
 
     void DPRINTGrid() const;
     void PrintGrid() const;
@@ -226,6 +321,7 @@ private:
     utils::UInt             nq;     // size of the map; after initialization, will always be the same
     utils::Vec<utils::UInt> v2rMap; // v2rMap[virtual qubit index] -> real qubit index | UNDEFINED_QUBIT
     utils::Vec<realstate_t> rs;     // rs[real qubit index] -> {nostate|wasinited|hasstate}
+    utils::UndoLog          undo;   // changes by AllocQubit, SetRs and Swap while a checkpoint is open
 
 public:
 
@@ -263,6 +359,11 @@ public:
     // update v2r accordingly
     void Swap(utils::UInt r0, utils::UInt r1);
 
+    // open a checkpoint; the changes by AllocQubit, SetRs and Swap after it are undone by Rollback
+    // (assignments through operator[] are not, these are only done while initializing the map)
+    void Checkpoint();
+    void Rollback();
+
     void DPRINTReal(utils::UInt r) const;
     void PrintReal(utils::UInt r) const;
     void PrintVirt(utils::UInt v) const;
@@ -298,11 +399,13 @@ class FreeCycle {
 private:
 
     const quantum_platform   *platformp;  // platform description
+    const MapperOptions      *optionsp;   // mapper options
     utils::UInt              nq;          // map is (nq+nb) long; after initialization, will always be the same
     utils::UInt              nb;          // bregs are in map (behind qubits) to track dependences around conditions
     utils::UInt              ct;          // multiplication factor from cycles to nano-seconds (unit of duration)
     utils::Vec<utils::UInt>  fcv;         // fcv[real qubit index i]: qubit i is free from this cycle on
     arch::resource_manager_t rm;          // actual resources occupied by scheduled gates
+    utils::UndoLog           undo;        // changes to fcv while a checkpoint is open
 
 
     // access free cycle value of qubit q[i] or breg b[i-nq]
@@ -316,7 +419,7 @@ public:
     // default constructor was deleted because it cannot construct resource_manager_t without parameters
     FreeCycle();
 
-    void Init(const quantum_platform *p, const utils::UInt breg_count);
+    void Init(const quantum_platform *p, const MapperOptions *o, const utils::UInt breg_count);
 
     // depth of the FreeCycle map
     // equals the max of all entries minus the min of all entries
@@ -364,6 +467,11 @@ public:
     // startcycle must be the result of an earlier StartCycle call (with rc!)
     void Add(gate *g, utils::UInt startCycle);
 
+    // open a checkpoint; the changes by Add and AddNoRc after it (to both the FreeCycle map and the resource map)
+    // are undone by Rollback, which closes the checkpoint; checkpoints nest
+    void Checkpoint();
+    void Rollback();
+
 };
 
 // =========================================================================================
@@ -371,21 +479,21 @@ public:
 //
 // there is a Past attached to the output stream, that is a kind of window with a list of gates in it,
 // to which gates are added after mapping; this is called the 'main' Past.
-// while mapping, several alternatives are evaluated, each of which also has a Past attached,
-// and each of which for most of the parts starts off as a copy of the 'main' Past;
-// but it is in fact a temporary extension of this main Past
+// while mapping, several alternatives are evaluated, each of which is a temporary extension of this main Past,
+// made in place under a checkpoint and undone by a rollback (see Checkpoint)
 //
 // Past contains gates of which the schedule might influence a future path selected for mapping binary gates
 // It maintains for each qubit from which cycle on it is free, so that swap insertion
 // can exploit this to hide its overall circuit latency overhead by increasing ILP.
 // Also it maintains the 1 to 1 (reversible) virtual to real qubit map: all gates in past
 // and beyond are mapped and have real qubits as operands.
-// While experimenting with path alternatives, a clone is made of the main past,
-// to insert swaps and evaluate the latency effects; note that inserting swaps changes the mapping.
+// While experimenting with path alternatives, the main past is checkpointed,
+// swaps are inserted to evaluate the latency effects, and the past is rolled back;
+// note that inserting swaps changes the mapping.
 //
 // On arrival of a quantum gate(s):
 // - [isempty(waitinglg)]
-// - if 2q nonNN clone mult. pasts, in each clone Add swap/move gates, Schedule, evaluate clones, select, Add swaps to mainPast
+// - if 2q nonNN for each alternative Checkpoint, Add swap/move gates, Schedule, evaluate, Rollback; select, Add swaps to mainPast
 // - Add, Add, ...: add quantum gates to waitinglg, waiting to be scheduled in [!isempty(waitinglg)]
 // - Schedule: schedules all quantum gates of waitinglg into lg [isempty(waitinglg) && !isempty(lg)]
 // On arrival of a classical gate:
@@ -403,6 +511,7 @@ private:
     utils::UInt                 nb;         // extends FreeCycle next to qubits with bregs
     utils::UInt                 ct;         // cycle time, multiplier from cycles to nano-seconds
     const quantum_platform      *platformp; // platform describing resources for scheduling
+    const MapperOptions         *optionsp;  // mapper options
     quantum_kernel              *kernelp;   // current kernel for creating gates
     Grid                        *gridp;     // pointer to grid to know which hops are inter-core
 
@@ -411,20 +520,38 @@ private:
     typedef gate *      gate_p;
     utils::List<gate_p>         waitinglg;  // . . .  list of q gates in this Past, topological order, waiting to be scheduled in
     //        waitinglg only contains gates from Add and final Schedule call
-    //        when evaluating alternatives, it is empty when Past is cloned; so no state
+    //        when evaluating alternatives, it is empty at a checkpoint; so no state
 public:
     utils::List<gate_p>         lg;         // state: list of q gates in this Past, scheduled by their (start) cycle values
     //        so this is the result list of this Past, to compare with other Alters
 private:
     utils::List<gate_p>         outlg;      // . . .  list of gates flushed out of this Past, not yet put in outCirc
-    //        when evaluating alternatives, outlg stays constant; so no state
+    //        when evaluating alternatives, only extended by flushes and bypasses, which Rollback undoes
     utils::Map<gate_p,utils::UInt> cycle;      // state: gate to cycle map, startCycle value of each past gatecycle[gp]
     //        cycle[gp] can be different for each gp for each past
     //        gp->cycle is not used by MapGates
-    //        although updated by set_cycle called from MakeAvailable/TakeAvailable
+    //        although updated by set_cycle called from MakeAvailable/TakeAvailable of the main future
     utils::UInt                  nswapsadded;// number of swaps (including moves) added to this past
     utils::UInt                  nmovesadded;// number of moves added to this past
 
+    // undo information of the state changes made while a checkpoint is open, see Checkpoint;
+    // v2r and fc keep their own, undo keeps the counters above, and changes logs the changes to the gate lists
+    typedef enum {
+        pc_schedule,                        // gate was scheduled: inserted in lg at position, and in cycle
+        pc_flush,                           // count gates were flushed from lg to the end of outlg
+        pc_bypass                           // gate was added to the end of outlg
+    } pastchangekind_t;
+    class PastChange {
+    public:
+        pastchangekind_t            kind;
+        gate_p                      gp;
+        utils::List<gate_p>::iterator position;
+        utils::UInt                 count;
+    };
+    utils::UndoLog              undo;
+    utils::Vec<PastChange>      changes;
+    utils::Vec<utils::UInt>     changemarks;    // size of changes at each open checkpoint
+
 public:
 
     // explicit Past constructor
@@ -432,7 +559,12 @@ public:
     Past();
 
     // past initializer
-    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g);
+    void Init(const quantum_platform *p, const MapperOptions *o, quantum_kernel *k, Grid *g);
+
+    // initialize this past as a stand-in for the given past, to evaluate alternatives on in another thread;
+    // it gets copies of the state that the evaluation depends on, i.e. the mapping, the free cycle map and the counters,
+    // but starts with empty gate lists; its gates are created in kernel k
+    void InitFrom(const Past &past, quantum_kernel *k);
 
     // import Past's v2r from v2r_value
     void ImportV2r(const Virt2Real &v2r_value);
@@ -457,6 +589,15 @@ public:
     // means adding it to the current past's waiting list, waiting for it to be scheduled later
     void Add(gate_p gp);
 
+    // open a checkpoint on the state of this Past;
+    // Rollback undoes all changes done after it (new swaps, mapped and scheduled gates, flushes, v2r changes)
+    // and closes the checkpoint again; checkpoints nest;
+    // the cost of this is proportional to the number of changes, not to the size of the device or of the past;
+    // this is used to evaluate alternatives in place instead of on a copy of the past;
+    // the waiting list must be empty at both
+    void Checkpoint();
+    void Rollback();
+
     // create a new gate with given name and qubits
     // return whether this was successful
     // return the created gate(s) in circ (which is supposed to be empty on entry)
@@ -515,6 +656,9 @@ public:
     // if not yet mapped, allocate a new real qubit index and map to it
     utils::UInt MapQubit(utils::UInt v);
 
+    // find real qubit index implementing virtual qubit index, UNDEFINED_QUBIT when not yet mapped
+    utils::UInt GetReal(utils::UInt v) const;
+
     static void stripname(utils::Str &name);
 
     // MakeReal gp
@@ -579,7 +723,7 @@ public:
 // Actually, the Alter goes through several stages:
 // - first, for the given 2-qubit gate that is stored in targetgp,
 //   while finding a path from its source to its target, the current path is kept in total;
-//   fromSource, fromTarget, past and score are not used; past is a clone of the main past
+//   fromSource, fromTarget and score are not used
 // - paths are found starting from the source node, and aiming to reach the target node,
 //   each time adding one additional hop to the path
 //   fromSource, fromTarget, and score are still empty and not used
@@ -593,10 +737,10 @@ public:
 //   of these the two partial paths are stored in fromSource and fromTarget;
 //   a partial path stores its starting and end nodes (so contains 1 hop less than its length);
 //   the partial path of the target operand is reversed, so starts at the target qubit
-// - then we add swaps to past following the recipee in fromSource and fromTarget; this extends past;
-//   also we compute score as the latency extension caused by these swaps
+// - then we add swaps to the past following the recipee in fromSource and fromTarget; this extends past;
+//   also we compute score as the latency extension caused by these swaps, and undo the extension again
 //
-// At the end, we have a list of Alters, each with a private Past, and a private latency extension.
+// At the end, we have a list of Alters, each with a private latency extension.
 // The partial paths represent lists of swaps to be inserted.
 // The initial two-qubit gate gets the qubits at the ends of the partial paths as operands.
 // The main selection criterium from the Alters is to select the one with the minimum latency extension.
@@ -604,6 +748,7 @@ public:
 class Alter {
 public:
     const quantum_platform  *platformp;  // descriptions of resources for scheduling
+    const MapperOptions     *optionsp;   // mapper options
     quantum_kernel          *kernelp;    // kernel pointer to allow calling kernel private methods
     Grid                    *gridp;      // grid pointer to know which hops are inter-core
     utils::UInt             nq;          // width of Past and Virt2Real map is number of real qubits
@@ -614,7 +759,6 @@ public:
     utils::Vec<utils::UInt> fromSource;  // partial path after split, starting at source
     utils::Vec<utils::UInt> fromTarget;  // partial path after split, starting at target, backward
 
-    Past                    past;        // cloned main past, extended with swaps from this path
     utils::Real           score;       // e.g. latency extension caused by the path
     utils::Bool             didscore;    // initially false, true after assignment to score
 
@@ -624,7 +768,7 @@ public:
 
     // Alter initializer
     // This should only be called after a virgin construction and not after cloning a path.
-    void Init(const quantum_platform *p, quantum_kernel *k, Grid *g);
+    void Init(const quantum_platform *p, const MapperOptions *o, quantum_kernel *k, Grid *g);
 
     // printing facilities of Paths
     // print path as hd followed by [0->1->2]
@@ -640,27 +784,23 @@ public:
     static void DPRINT(const utils::Str &s, const utils::List<Alter> &la);
     static void Print(const utils::Str &s, const utils::List<Alter> &la);
 
-    // add a node to the path in front, extending its length with one
-    void Add2Front(utils::UInt q);
-
     // add to a max of maxnumbertoadd swap gates for the current path to the given past
     // this past can be a path-local one or the main past
     // after having added them, schedule the result into that past
-    void AddSwaps(Past &past, const utils::Str &mapselectswapsopt) const;
+    void AddSwaps(Past &past, mapselectswaps_t mapselectswapsopt) const;
 
-    // compute cycle extension of the current alternative in prevPast relative to the given base past
+    // compute cycle extension of the current alternative in currPast relative to the given base past
     //
     // Extend can be called in a deep exploration where pasts have been extended
     // each one on top of a previous one, starting from the base past;
     // the currPast here is the last extended one, i.e. on top of which this extension should be done;
-    // the basePast is the ultimate base past relative to which the total extension is to be computed.
+    // baseFreeCycle is the max free cycle of the ultimate base past relative to which the total extension is to be computed.
     //
-    // Do this by adding the swaps described by this alternative
-    // to an alternative-local copy of the current past;
-    // keep this resulting past in the current alternative (for later use);
+    // Do this by adding the swaps described by this alternative to the current past under a checkpoint;
     // compute the total extension of all pasts relative to the base past
-    // and store this extension in the alternative's score for later use
-    void Extend(const Past &currPast, const Past &basePast);
+    // and store this extension in the alternative's score for later use;
+    // then roll the current past back, so that it is unchanged on return
+    void Extend(Past &currPast, utils::UInt baseFreeCycle);
 
     // split the path
     // starting from the representation in the total attribute,
@@ -708,21 +848,24 @@ public:
 // than taking a non-critical gate as first one to map.
 // Later implementations may become more sophisticated.
 //
-// With option maplookaheadopt=="no", the future window's dependence graph (scheduled and avlist) are not used.
+// With option maplookaheadopt=="no", the future window's dependence graph (pending and avlist) are not used.
 // Instead a copy of the input circuit (input_gatepv) is created and iterated over (input_gatepp).
 
 class Future {
 public:
     const quantum_platform            *platformp;
+    const MapperOptions               *optionsp;
     Scheduler                       *schedp;        // a pointer, since dependence graph doesn't change
     circuit                     input_gatepv;   // input circuit when not using scheduler based avlist
 
-    utils::Map<gate*,utils::Bool>        scheduled;      // state: has gate been scheduled, here: done from future?
-    utils::List<lemon::ListDigraph::Node> avlist;         // state: which nodes/gates are available for mapping now?
+    utils::Vec<utils::UInt>     pending;        // state: per node, number of its predecessors not done from future yet
+    AvailableList               avlist;         // state: which nodes/gates are available for mapping now?
     circuit::iterator           input_gatepp;   // state: alternative iterator in input_gatepv
+    utils::Bool                 setcycles;      // whether DoneGate updates the cycle attribute of the gates made available;
+                                                // copies evaluating alternatives don't, so they don't write to the shared gates
 
     // just program wide initialization
-    void Init(const quantum_platform *p);
+    void Init(const quantum_platform *p, const MapperOptions *o);
 
     // Set/switch input to the provided circuit
     // nq, nc and nb are parameters because nc/nb may not be provided by platform but by kernel
@@ -742,6 +885,11 @@ public:
     // and its successors can be made available
     void DoneGate(gate *gp);
 
+    // Get into ext the first maxsize two-qubit gates that become available
+    // when the gates currently in avlist and the gates that become available after them are done,
+    // breadth first; this is the extended set of sabre's lookahead
+    void GetExtendedSet(utils::UInt maxsize, utils::Vec<gate*> &ext) const;
+
     // Return gp in lag that is most critical (provided lookahead is enabled)
     // This is used in tiebreak, when every other option has failed to make a distinction.
     gate *MostCriticalIn(utils::List<gate*> &lag) const;
@@ -829,10 +977,17 @@ private:
     utils::UInt             cycle_time;     // length in ns of a single cycle of the platform
                                             // is divisor of duration in ns to convert it to cycles
     Grid                    grid;           // current grid
+    MapperOptions           mapoptions;     // mapper options, shared by pointer with Past, Alter and Future
 
                                             // Initialized by Mapper.Map
     std::mt19937            gen;            // Standard mersenne_twister_engine, not yet seeded
 
+                                            // Only when mapthreads > 1, initialized by Mapper::Init
+    utils::Opt<utils::ThreadPool> pool;     // threads evaluating the alternatives at level 0 of SelectAlter
+                                            // Initialized by Mapper::MapCircuit
+    utils::Vec<quantum_kernel> workerkernels;   // per worker of pool, a copy of the kernel to create gates in
+    utils::Vec<Past>        workerpasts;    // per worker of pool, a stand-in for the past to evaluate alternatives on
+
 public:
                                             // Passed back by Mapper::Map to caller for reporting
     utils::UInt             nswapsadded;    // number of swaps added (including moves)
@@ -841,6 +996,9 @@ public:
     utils::Vec<utils::Int>  rs_in;          // rs[real qubit index] -> {nostate|wasinited|hasstate}
     utils::Vec<utils::UInt> v2r_ip;         // v2r[virtual qubit index] -> real qubit index | UNDEFINED_QUBIT
     utils::Vec<utils::Int>  rs_ip;          // rs[real qubit index] -> {nostate|wasinited|hasstate}
+    utils::Str              ipresult;       // result of initial placement, empty when it wasn't run
+    utils::UInt             ipcost;         // sum over two-qubit gates of the distance between their operands after it
+    utils::Real             iptimetaken;    // time initial placement took, in seconds
     utils::Vec<utils::UInt> v2r_out;        // v2r[virtual qubit index] -> real qubit index | UNDEFINED_QUBIT
     utils::Vec<utils::Int>  rs_out;         // rs[real qubit index] -> {nostate|wasinited|hasstate}
 
@@ -864,7 +1022,9 @@ private:
     // Find shortest paths between src and tgt in the grid, bounded by a particular strategy (which);
     // budget is the maximum number of hops allowed in the path from src and is at least distance to tgt;
     // it can be higher when not all hops qualify for doing a two-qubit gate or to find more than just the shortest paths.
-    void GenShortestPaths(gate *gp, utils::UInt src, utils::UInt tgt, utils::UInt budget, utils::List<Alter> &resla, whichpaths_t which);
+    // path holds the hops from the original source up to but not including src; for each path found
+    // a copy of proto with that path as total is appended to resla.
+    void GenShortestPaths(const Alter &proto, utils::Vec<utils::UInt> &path, utils::UInt src, utils::UInt tgt, utils::UInt budget, utils::List<Alter> &resla, whichpaths_t which);
 
     // Generate shortest paths in the grid for making gate gp NN, from qubit src to qubit tgt, with an alternative for each one
     // - compute budget; usually it is distance but it can be higher such as for multi-core
@@ -887,15 +1047,15 @@ private:
     // Depending on maplookahead only take first (most critical) gate or take all gates.
     void GenAlters(utils::List<gate*> lg, utils::List<Alter> &la, Past &past);
 
-    // start the random generator with a seed
-    // that is unique to the microsecond
+    // start the random generator with the seed given by the mapseed option,
+    // or otherwise with a seed that is unique to the microsecond
     void RandomInit();
 
     // if the maptiebreak option indicates so,
-    // generate a random utils::Int number in range 0..count-1 and use
+    // generate a random utils::Int number in range 0..count-1 using gen and use
     // that to index in list of alternatives and to return that one,
     // otherwise return a fixed one (front, back or first most critical one
-    Alter ChooseAlter(utils::List<Alter> &la, Future &future);
+    Alter ChooseAlter(utils::List<Alter> &la, Future &future, std::mt19937 &gen);
 
     // Map the gate/operands of a gate that has been routed or doesn't require routing
     void MapRoutedGate(gate *gp, Past &past);
@@ -932,16 +1092,50 @@ private:
     //   when several remain with equal minimum extension, recurse to reduce this set of remaining ones
     //   - level: level of recursion at which SelectAlter is called: 0 is base, 1 is 1st, etc.
     //   - option mapselectmaxlevel: max level of recursion to use, where inf indicates no maximum
-    // - maptiebreak option indicates which one to take when several (still) remain
+    //   - baseFreeCycle: max free cycle of the base past (bottom of recursion stack) to compute extensions against
+    //   past is the last past (top of recursion stack); it is extended in place to evaluate the alternatives
+    //   and rolled back each time, so on return it is unchanged
+    // - maptiebreak option indicates which one to take when several (still) remain, drawing from gen when random
+    // - at level 0, with option mapthreads > 1, the alternatives are evaluated in parallel, with the same result
     // result is returned in resa
-    void SelectAlter(utils::List<Alter> &la, Alter &resa, Future &future, Past &past, Past &basePast, utils::Int level);
+    void SelectAlter(utils::List<Alter> &la, Alter &resa, Future &future, Past &past, utils::UInt baseFreeCycle, utils::Int level, std::mt19937 &gen);
+
+    // evaluate alternative a, number index of the alternatives at this level, by committing it to a copy of future and to past,
+    // mapping what then can be mapped, and recursing to select the best of the resulting alternatives;
+    // the resulting extension relative to baseFreeCycle is stored in a.score; past is rolled back, so on return it is unchanged;
+    // the recursion draws from its own random generator seeded by seed and index, so the result doesn't depend on
+    // the order in which the alternatives are evaluated
+    void EvaluateAlter(Alter &a, utils::UInt index, utils::UInt seed, const Future &future, Past &past, utils::UInt baseFreeCycle, utils::Int level);
 
     // Given the states of past and future
     // map all mappable gates and find the non-mappable ones
-    // for those evaluate what to do next and do it;
-    // during recursion, comparison is done with the base past (bottom of recursion stack),
-    // and past is the last past (top of recursion stack) relative to which the mapping is done.
-    void MapGates(Future &future, Past &past, Past &basePast);
+    // for those evaluate what to do next and do it.
+    void MapGates(Future &future, Past &past);
+
+    // sabre: select the swap that by sabre's cost function brings the two-qubit gates closest together;
+    // front and ext are the operands (real qubits) of the gates of the front layer and of the extended set;
+    // the candidates are the swaps of an operand of a front gate with one of its neighbors;
+    // decay[r] penalizes swapping real qubit r again; when past is given, a tie is broken
+    // in favor of the swap that starts earliest in it; the selected swap is returned in r0 and r1
+    void SabreSelectSwap(
+        const utils::Vec<utils::Pair<utils::UInt, utils::UInt>> &front,
+        const utils::Vec<utils::Pair<utils::UInt, utils::UInt>> &ext,
+        const utils::Vec<utils::Real> &decay,
+        const Past *past,
+        utils::UInt &r0,
+        utils::UInt &r1
+    ) const;
+
+    // sabre: route the two-qubit gates, given as pairs of virtual qubits, in order or in reverse order,
+    // starting from mapping loc (loc[virtual qubit] is real qubit), by the swaps selected by SabreSelectSwap,
+    // without generating gates; loc is left as the final mapping; returns the number of swaps
+    utils::UInt SabreTrial(const utils::Vec<utils::Pair<utils::UInt, utils::UInt>> &gates, utils::Bool reversed, utils::Vec<utils::UInt> &loc) const;
+
+    // sabre: refine initial mapping v2r for the circuit by forward and backward trial passes over its two-qubit gates
+    void SabreRefine(const circuit &circ, Virt2Real &v2r) const;
+
+    // sabre: as MapGates but routing by the swaps selected by SabreSelectSwap
+    void MapGatesSabre(Future &future, Past &past);
 
     // Map the circuit's gates in the provided context (v2r maps), updating circuit and v2r maps
     void MapCircuit(quantum_kernel& kernel, Virt2Real& v2r);
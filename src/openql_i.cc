@@ -4,6 +4,8 @@
 
 #include "openql_i.h"
 
+#include <type_traits>
+
 #include "version.h"
 
 static bool initialized = false;
@@ -318,6 +320,49 @@ void Kernel::gate(
     kernel->gate(name, {qubits.begin(), qubits.end()}, {(destination.creg)->id} );
 }
 
+/**
+ * The given array as array of UInt; it is only copied (to copy) when size_t
+ * and UInt are different types.
+ */
+static const ql::utils::UInt *as_uint_array(
+    const size_t *data,
+    size_t size,
+    ql::utils::Vec<ql::utils::UInt> &copy
+) {
+    if (std::is_same<size_t, ql::utils::UInt>::value) {
+        return reinterpret_cast<const ql::utils::UInt *>(data);
+    }
+    copy.assign(data, data + size);
+    return copy.data();
+}
+
+void Kernel::gates(
+    const std::vector<std::string> &names,
+    const size_t *ids, size_t ids_size,
+    const size_t *qubit_counts, size_t qubit_counts_size,
+    const size_t *qubits, size_t qubits_size,
+    const double *angles, size_t angles_size
+) {
+    QL_DOUT("Python k.gates(" << names.size() << " names, " << ids_size << " gates)");
+    if (qubit_counts_size != ids_size || (angles_size != 0 && angles_size != ids_size)) {
+        QL_FATAL(
+            "Numbers of gate name indices (" << ids_size
+            << "), qubit counts (" << qubit_counts_size
+            << ") and angles (" << angles_size << ") of gates differ"
+        );
+    }
+    ql::utils::Vec<ql::utils::UInt> ids_copy, qubit_counts_copy, qubits_copy;
+    kernel->gates(
+        {names.begin(), names.end()},
+        as_uint_array(ids, ids_size, ids_copy),
+        as_uint_array(qubit_counts, qubit_counts_size, qubit_counts_copy),
+        ids_size,
+        as_uint_array(qubits, qubits_size, qubits_copy),
+        qubits_size,
+        angles_size == 0 ? nullptr : angles
+    );
+}
+
 void Kernel::gate_preset_condition(
     const std::string &condstring,
     const std::vector<size_t> &condregs
@@ -140,6 +140,13 @@ public:
         const std::string &condstring,
         const std::vector<size_t> &condregs
     );
+    void gates(
+        const std::vector<std::string> &names,
+        const size_t *ids, size_t ids_size,
+        const size_t *qubit_counts, size_t qubit_counts_size,
+        const size_t *qubits, size_t qubits_size,
+        const double *angles, size_t angles_size
+    );
     void gate(const Unitary &u, const std::vector<size_t> &qubits);
     void classical(const CReg &destination, const Operation &operation);
     void classical(const std::string &operation);
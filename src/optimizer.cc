@@ -4,11 +4,15 @@
 
 #include "optimizer.h"
 
+#include <array>
+#include <cmath>
 #include "utils/vec.h"
+#include "utils/map.h"
 #include "utils/num.h"
 #include "circuit.h"
 #include "kernel.h"
 #include "options.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
@@ -24,169 +28,209 @@ public:
 
 /**
  * rotation fuser
+ *
+ * Removes runs of single-qubit gates that together amount to the identity, in
+ * a single pass over the circuit. For each qubit, the gates since the last
+ * barrier on that qubit are kept on a stack, together with the product of
+ * their matrices up to and including that gate (the prefix). When the prefix
+ * after a new gate equals (up to global phase) a prefix on the stack, the gates
+ * in between multiply to the identity and are removed, popping the stack back
+ * to that prefix. The prefixes are indexed by a phase-normalized, rounded key,
+ * so finding a match costs a lookup instead of a scan.
+ *
+ * A gate is a barrier on its qubits when it cannot be fused: when it has more
+ * than one qubit operand, classical operands or a condition, when it is not a
+ * unitary gate (e.g. measure, prepz, wait) or when its matrix is not unitary
+ * (e.g. a custom gate without a proper matrix in the configuration file).
+ * Gates without qubit operands are barriers on all qubits.
  */
 class rotations_merging : public optimizer {
 public:
 
-    circuit optimize(circuit &ic /*, bool verbose=false */) override {
-        circuit c = ic;
-        // if (verbose) COUT("optimizing circuit...");
-        for (size_t i = c.size(); i > 1; i--) {
-            // println("window size : " << i);
-            c = optimize_sliding_window(c,i);
-            if (c.size() < i) {
-                break;
+    circuit optimize(circuit &ic) override {
+        UInt nq = 0;
+        for (auto gp : ic) {
+            for (auto q : gp->operands) {
+                nq = std::max(nq, q + 1);
             }
         }
-
-        if (c.size() > 1) {
-            c = optimize_sliding_window(c,2);
+        Vec<Run> runs(nq);
+        for (auto &run : runs) {
+            run.clear();
         }
 
-        // if (verbose) COUT("optimization done.");
+        Vec<Bool> removed(ic.size(), false);
+        for (UInt i = 0; i < ic.size(); i++) {
+            gate *gp = ic[i];
+            if (!is_fusable(gp)) {
+                if (gp->operands.empty()) {
+                    for (auto &run : runs) {
+                        run.clear();
+                    }
+                } else {
+                    for (auto q : gp->operands) {
+                        runs[q].clear();
+                    }
+                }
+                continue;
+            }
 
-        return c;
+            Run &run = runs[gp->operands[0]];
+            cmat_t prefix = fuse(gp->mat(), run.prefixes.back());
+            Key key = make_key(prefix);
+            auto it = run.index.find(key);
+            // a match with the top of the stack would only remove this gate itself;
+            // a single gate is not a run, so then it is pushed like any other gate
+            if (it != run.index.end() && it->second + 1 < run.prefixes.size()) {
+                UInt depth = it->second;
+                removed[i] = true;
+                while (run.prefixes.size() > depth + 1) {
+                    removed[run.gates.back()] = true;
+                    run.pop();
+                }
+            } else {
+                run.push(i, prefix, key);
+            }
+        }
+
+        circuit oc;
+        for (UInt i = 0; i < ic.size(); i++) {
+            if (!removed[i]) {
+                oc.push_back(ic[i]);
+            }
+        }
+        return oc;
     }
 
 protected:
 
+    /**
+     * Phase-normalized and rounded matrix, to index prefixes by.
+     */
+    typedef std::array<Int, 8> Key;
+
+    /**
+     * The fusable gates since the last barrier on a qubit with their prefixes;
+     * prefixes[0] is the identity and prefixes[d] belongs to gates[d-1].
+     */
+    struct Run {
+        Vec<UInt> gates;
+        Vec<cmat_t> prefixes;
+        Vec<Key> keys;
+        Map<Key, UInt> index;    // key to the lowest depth with that key
+
+        void clear() {
+            gates.clear();
+            prefixes.clear();
+            keys.clear();
+            index.clear();
+            cmat_t id;
+            id.m[0] = id.m[3] = 1.0;
+            prefixes.push_back(id);
+            keys.push_back(make_key(id));
+            index.set(keys.back()) = 0;
+        }
+
+        void push(UInt gate_index, const cmat_t &prefix, const Key &key) {
+            gates.push_back(gate_index);
+            prefixes.push_back(prefix);
+            keys.push_back(key);
+            if (index.find(key) == index.end()) {
+                index.set(key) = prefixes.size() - 1;
+            }
+        }
+
+        void pop() {
+            auto it = index.find(keys.back());
+            if (it != index.end() && it->second == prefixes.size() - 1) {
+                index.erase(it);
+            }
+            gates.pop_back();
+            prefixes.pop_back();
+            keys.pop_back();
+        }
+    };
+
     static cmat_t fuse(const cmat_t &m1, const cmat_t &m2) {
         cmat_t res;
         const Complex *x = m1.m;
         const Complex *y = m2.m;
         Complex *r = res.m;
 
-        // m1.dump();
-        // m2.dump();
-
         r[0] = x[0]*y[0] + x[1]*y[2];
         r[1] = x[0]*y[1] + x[1]*y[3];
         r[2] = x[2]*y[0] + x[3]*y[2];
         r[3] = x[2]*y[1] + x[3]*y[3];
 
-        // res.dump();
-
         return res;
     }
 
 #define __epsilon__ (1e-4)
 
-    static bool is_id(const cmat_t &mat) {
-        // mat.dump();
+    static Bool is_unitary(const cmat_t &mat) {
         const Complex *m = mat.m;
-        if ((abs(abs(m[0].real())-1.0))>__epsilon__) return false;
-        if ((abs(m[0].imag())  )>__epsilon__) return false;
-        if ((abs(m[1].real())  )>__epsilon__) return false;
-        if ((abs(m[1].imag())  )>__epsilon__) return false;
-        if ((abs(m[2].real())  )>__epsilon__) return false;
-        if ((abs(m[2].imag())  )>__epsilon__) return false;
-        if ((abs(abs(m[3].real())-1.0))>__epsilon__) return false;
-        if ((abs(m[3].imag())  )>__epsilon__) return false;
+        if (std::abs(std::norm(m[0]) + std::norm(m[1]) - 1.0) > __epsilon__) return false;
+        if (std::abs(std::norm(m[2]) + std::norm(m[3]) - 1.0) > __epsilon__) return false;
+        if (std::abs(m[0]*std::conj(m[2]) + m[1]*std::conj(m[3])) > __epsilon__) return false;
         return true;
     }
 
-    static bool is_identity(const circuit &c) {
-        if (c.size() == 1) {
-            return false;
-        }
-        cmat_t m = c[0]->mat();
-        for (size_t i = 1; i < c.size(); ++i) {
-            cmat_t m2 = c[i]->mat();
-            m = fuse(m,m2);
+    static Bool is_fusable(const gate *gp) {
+        switch (gp->type()) {
+            case __measure_gate__:
+            case __prepz_gate__:
+            case __display__:
+            case __nop_gate__:
+            case __dummy_gate__:
+            case __classical_gate__:
+            case __wait_gate__:
+                return false;
+            default:
+                break;
         }
-        return is_id(m);
+        return gp->operands.size() == 1
+            && gp->creg_operands.empty()
+            && gp->breg_operands.empty()
+            && !gp->is_conditional()
+            && is_unitary(gp->mat());
     }
 
-    static circuit optimize_sliding_window(circuit &c, size_t window_size) {
-        circuit oc;
-        Vec<int> id_pos;
-        for (size_t i = 0; i < c.size() - window_size + 1; ++i) {
-            circuit w;
-            w.insert(w.begin(),c.begin()+i,c.begin()+i+window_size);
-            if (is_identity(w)) {
-                id_pos.push_back(i);
-            }
-        }
-        if (id_pos.empty()) {
-            return circuit(c);
-        }
-        // println("id pos:");
-        // for (size_t i=0; i<id_pos.size(); i++)
-        // println(id_pos[i]);
-
-        if (id_pos.size() == 1) {
-            // COUT("rotations cancelling...");
-            size_t pos = id_pos[0];
-            size_t i=0;
-            while (i < c.size()) {
-                if (i == pos) {
-                    i += window_size;
-                } else {
-                    oc.push_back(c[i]);
-                    i++;
-                }
-            }
-            return oc;
+    /**
+     * Computes the key of a unitary matrix: the matrix divided by the phase of
+     * its first entry of some magnitude, so that matrices that only differ in
+     * global phase get the same key, rounded to well within __epsilon__.
+     */
+    static Key make_key(const cmat_t &mat) {
+        const Complex *m = mat.m;
+        UInt k = 0;
+        while (k < 3 && std::abs(m[k]) < 0.3) {
+            k++;
         }
-
-        // COUT("removing overlapping windows...");
-        Vec<int> pid;
-        // int prev = id_pos[0];
-        // COUT("rotation cancelling...");
-        size_t pos = id_pos[0];
-        size_t ip = 0;
-        size_t i = 0;
-        while (i < c.size()) {
-            if (i == pos) {
-                i += window_size;
-                ip++;
-                if (ip < id_pos.size()) {
-                    pos = id_pos[ip];
-                }
-            } else {
-                oc.push_back(c[i]);
-                i++;
-            }
+        Complex phase = std::conj(m[k]) / std::abs(m[k]);
+        Key key;
+        for (UInt i = 0; i < 4; i++) {
+            Complex v = m[i] * phase;
+            key[2*i] = std::llround(v.real() * 1e6);
+            key[2*i+1] = std::llround(v.imag() * 1e6);
         }
-
-        return oc;
+        return key;
     }
 
 };
 
 inline void rotation_optimize_kernel(quantum_kernel &kernel, const quantum_platform &platform) {
     QL_DOUT("kernel " << kernel.name << " optimize_kernel(): circuit before optimizing: ");
-    print(kernel.c);
+    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+        print(kernel.c);
+    }
     QL_DOUT("... end circuit");
     rotations_merging rm;
-    if (contains_measurements(kernel.c)) {
-        QL_DOUT("kernel contains measurements ...");
-        // decompose the circuit
-        Vec<circuit*> cs = split_circuit(kernel.c);
-        Vec<circuit> cs_opt;
-        for (auto c : cs)
-        {
-            if (!contains_measurements(*c)) {
-                circuit opt = rm.optimize(*c);
-                cs_opt.push_back(opt);
-            } else {
-                cs_opt.push_back(*c);
-            }
-        }
-        // for (int i=0; i<cs_opt.size(); ++i)
-        // print(cs_opt[i]);
-        kernel.c.clear( );
-        for (size_t i = 0; i < cs_opt.size(); ++i) {
-            for (size_t j = 0; j < cs_opt[i].size(); j++) {
-                kernel.c.push_back(cs_opt[i][j]);
-            }
-        }
-    } else {
-        kernel.c = rm.optimize(kernel.c);
-    }
+    kernel.c = rm.optimize(kernel.c);
     kernel.cycles_valid = false;
     QL_DOUT("kernel " << kernel.name << " rotation_optimize(): circuit after optimizing: ");
-    print(kernel.c);
+    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+        print(kernel.c);
+    }
     QL_DOUT("... end circuit");
 }
 
@@ -198,9 +242,9 @@ void rotation_optimize(
 ) {
     if (options::get("optimize") == "yes") {
         QL_IOUT("optimizing quantum kernels...");
-        for (size_t k=0; k<programp->kernels.size(); ++k) {
-            rotation_optimize_kernel(programp->kernels[k], platform);
-        }
+        for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
+            rotation_optimize_kernel(kernel, platform);
+        });
     }
 }
 
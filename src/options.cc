@@ -4,11 +4,14 @@
 
 #include "options.h"
 
+#include <mutex>
+#include "compile_context.h"
 #include "utils/exception.h"
 #include "utils/logger.h"
 #include "utils/filesystem.h"
 #include "utils/map.h"
 #include "utils/vec.h"
+#include "utils/thread_pool.h"
 #include <CLI/CLI.hpp>
 
 namespace ql {
@@ -28,12 +31,15 @@ private:
         opt_name2opt_val.set("unique_output") = "no";
         opt_name2opt_val.set("write_qasm_files") = "no";
         opt_name2opt_val.set("write_report_files") = "no";
+        opt_name2opt_val.set("compile_threads") = "1";
 
         opt_name2opt_val.set("optimize") = "no";
         opt_name2opt_val.set("use_default_gates") = "yes";
         opt_name2opt_val.set("decompose_toffoli") = "no";
         opt_name2opt_val.set("quantumsim") = "no";
         opt_name2opt_val.set("issue_skip_319") = "no";
+        opt_name2opt_val.set("unitary_cache_file") = "";
+        opt_name2opt_val.set("unitary_threads") = "1";
 
         opt_name2opt_val.set("scheduler") = "ALAP";
         opt_name2opt_val.set("scheduler_uniform") = "no";
@@ -59,6 +65,7 @@ private:
         opt_name2opt_val.set("mapprepinitsstate") = "no";
         opt_name2opt_val.set("initialplace") = "no";
         opt_name2opt_val.set("initialplace2qhorizon") = "0";
+        opt_name2opt_val.set("initialplacestarts") = "8";
         opt_name2opt_val.set("maplookahead") = "noroutingfirst";
         opt_name2opt_val.set("mappathselect") = "all";
         opt_name2opt_val.set("maprecNN2q") = "no";
@@ -66,14 +73,18 @@ private:
         opt_name2opt_val.set("mapselectmaxwidth") = "min";
         opt_name2opt_val.set("mapselectswaps") = "all";
         opt_name2opt_val.set("maptiebreak") = "random";
+        opt_name2opt_val.set("mapseed") = "none";
+        opt_name2opt_val.set("mapthreads") = "1";
         opt_name2opt_val.set("mapusemoves") = "yes";
         opt_name2opt_val.set("mapreverseswap") = "yes";
+        opt_name2opt_val.set("mapsabrepasses") = "2";
 
         // add options with default values and list of possible values
         app->add_set_ignore_case("--log_level", opt_name2opt_val.at("log_level"),
                                  {"LOG_NOTHING", "LOG_CRITICAL", "LOG_ERROR", "LOG_WARNING", "LOG_INFO", "LOG_DEBUG"}, "Log levels", true);
         app->add_option("--output_dir", opt_name2opt_val.at("output_dir"), "Name of output directory", true);
         app->add_set_ignore_case("--unique_output", opt_name2opt_val.at("unique_output"), {"no", "yes"}, "Make output files unique", true);
+        app->add_option("--compile_threads", opt_name2opt_val.at("compile_threads"), "Number of threads compiling kernels in parallel in kernel-local passes, or max for one per hardware thread", true);
         app->add_set_ignore_case("--prescheduler", opt_name2opt_val.at("prescheduler"), {"no", "yes"}, "Run qasm (first) scheduler?", true);
         app->add_set_ignore_case("--scheduler_post179", opt_name2opt_val.at("scheduler_post179"), {"no", "yes"}, "Issue 179 solution included", true);
         app->add_set_ignore_case("--print_dot_graphs", opt_name2opt_val.at("print_dot_graphs"), {"no", "yes"}, "Print (un-)scheduled graphs in DOT format", true);
@@ -88,18 +99,21 @@ private:
         app->add_set_ignore_case("--clifford_postmapper", opt_name2opt_val.at("clifford_postmapper"), {"yes", "no"}, "clifford optimize after mapping yes or not", true);
         app->add_set_ignore_case("--decompose_toffoli", opt_name2opt_val.at("decompose_toffoli"), {"no", "NC", "AM"}, "Type of decomposition used for toffoli", true);
         app->add_set_ignore_case("--quantumsim", opt_name2opt_val.at("quantumsim"), {"no", "yes", "qsoverlay"}, "Produce quantumsim output, and of which kind", true);
+        app->add_option("--unitary_cache_file", opt_name2opt_val.at("unitary_cache_file"), "Name of file to persist unitary decompositions in across runs, or empty to only cache them in memory", true);
+        app->add_option("--unitary_threads", opt_name2opt_val.at("unitary_threads"), "Number of threads decomposing the independent halves of a unitary in parallel, or max for one per hardware thread", true);
         app->add_set_ignore_case("--issue_skip_319", opt_name2opt_val.at("issue_skip_319"), {"no", "yes"}, "Issue skip instead of wait in bundles", true);
         app->add_option("--backend_cc_map_input_file", opt_name2opt_val.at("backend_cc_map_input_file"), "Name of CC input map file", true);
         app->add_set_ignore_case("--backend_cc_verbose", opt_name2opt_val.at("backend_cc_verbose"), {"yes", "no"}, "Add verbose comments to generated .vq1asm file", true);
         app->add_set_ignore_case("--backend_cc_run_once", opt_name2opt_val.at("backend_cc_run_once"), {"yes", "no"}, "Create a .vq1asm program that runs once instead of repeating indefinitely", true);
         app->add_set_ignore_case("--cz_mode", opt_name2opt_val.at("cz_mode"), {"manual", "auto"}, "CZ mode", true);
 
-        app->add_set_ignore_case("--mapper", opt_name2opt_val.at("mapper"), {"no", "base", "baserc", "minextend", "minextendrc", "maxfidelity"}, "Mapper heuristic", true);
+        app->add_set_ignore_case("--mapper", opt_name2opt_val.at("mapper"), {"no", "base", "baserc", "minextend", "minextendrc", "maxfidelity", "sabre"}, "Mapper heuristic", true);
         app->add_set_ignore_case("--mapinitone2one", opt_name2opt_val.at("mapinitone2one"), {"no", "yes"}, "Initialize mapping of virtual qubits one to one to real qubits", true);
         app->add_set_ignore_case("--mapprepinitsstate", opt_name2opt_val.at("mapprepinitsstate"), {"no", "yes"}, "Prep gate leaves qubit in zero state", true);
         app->add_set_ignore_case("--mapassumezeroinitstate", opt_name2opt_val.at("mapassumezeroinitstate"), {"no", "yes"}, "Assume that qubits are initialized to zero state", true);
-        app->add_set_ignore_case("--initialplace", opt_name2opt_val.at("initialplace"), {"no","yes","1s","10s","1m","10m","1h","1sx","10sx","1mx","10mx","1hx"}, "Initialplace qubits before mapping", true);
+        app->add_set_ignore_case("--initialplace", opt_name2opt_val.at("initialplace"), {"no","heuristic","yes","1s","10s","1m","10m","1h","1sx","10sx","1mx","10mx","1hx"}, "Initialplace qubits before mapping", true);
         app->add_set_ignore_case("--initialplace2qhorizon", opt_name2opt_val.at("initialplace2qhorizon"), {"0","1","2","3","4","5","6","7","8","9", "10","11","12","13","14","15","16","17","18","19","20","30","40","50","60","70","80","90","100"}, "Initialplace considers only this number of initial two-qubit gates", true);
+        app->add_option("--initialplacestarts", opt_name2opt_val.at("initialplacestarts"), "Number of starts of the heuristic initial placement", true);
         app->add_set_ignore_case("--maplookahead", opt_name2opt_val.at("maplookahead"), {"no", "1qfirst", "noroutingfirst", "all"}, "Strategy wrt selecting next gate(s) to map", true);
         app->add_set_ignore_case("--mappathselect", opt_name2opt_val.at("mappathselect"), {"all", "borders"}, "Which paths: all or borders", true);
         app->add_set_ignore_case("--mapselectswaps", opt_name2opt_val.at("mapselectswaps"), {"one", "all", "earliest"}, "Select only one swap, or earliest, or all swaps for one alternative", true);
@@ -107,8 +121,11 @@ private:
         app->add_set_ignore_case("--mapselectmaxlevel", opt_name2opt_val.at("mapselectmaxlevel"), {"0","1","2","3","4","5","6","7","8","9","10","inf"}, "Maximum recursion in selecting alternatives on minimum extension", true);
         app->add_set_ignore_case("--mapselectmaxwidth", opt_name2opt_val.at("mapselectmaxwidth"), {"min","minplusone","minplushalfmin","minplusmin","all"}, "Maximum width number of alternatives to enter recursion with", true);
         app->add_set_ignore_case("--maptiebreak", opt_name2opt_val.at("maptiebreak"), {"first", "last", "random", "critical"}, "Tie break method", true);
+        app->add_option("--mapseed", opt_name2opt_val.at("mapseed"), "Seed of random tie break, or none to seed from the clock", true);
+        app->add_option("--mapthreads", opt_name2opt_val.at("mapthreads"), "Number of threads evaluating alternatives, or max for one per hardware thread", true);
         app->add_set_ignore_case("--mapusemoves", opt_name2opt_val.at("mapusemoves"), {"no", "yes", "0","1","2","3","4","5","6","7","8","9","10","11","12","13","14","15","16","17","18","19","20"}, "Use unused qubit to move thru", true);
         app->add_set_ignore_case("--mapreverseswap", opt_name2opt_val.at("mapreverseswap"), {"no", "yes"}, "Reverse swap operands when better", true);
+        app->add_option("--mapsabrepasses", opt_name2opt_val.at("mapsabrepasses"), "Number of forward and backward passes of mapper sabre refining the initial mapping", true);
 
         app->add_set_ignore_case("--write_qasm_files", opt_name2opt_val.at("write_qasm_files"), {"yes", "no"}, "write (un-)scheduled (with and without resource-constraint) qasm files", true);
         app->add_set_ignore_case("--write_report_files", opt_name2opt_val.at("write_report_files"), {"yes", "no"}, "write report files on circuit characteristics and pass results", true);
@@ -120,10 +137,23 @@ public:
         set_defaults();
     }
 
+    Options(const Options &other) : Options() {
+        for (const auto &kv : other.opt_name2opt_val) {
+            opt_name2opt_val.set(kv.first) = kv.second;
+        }
+    }
+
+    Options &operator=(const Options &other) = delete;
+
+    ~Options() {
+        delete app;
+    }
+
     void print_current_values() {
         std::cout << "log_level: " << opt_name2opt_val.at("log_level") << std::endl
                   << "output_dir: " << opt_name2opt_val.at("output_dir") << std::endl
                   << "unique_output: " << opt_name2opt_val.at("unique_output") << std::endl
+                  << "compile_threads: " << opt_name2opt_val.at("compile_threads") << std::endl
                   << "optimize: " << opt_name2opt_val.at("optimize") << std::endl
                   << "use_default_gates: " << opt_name2opt_val.at("use_default_gates") << std::endl
                   << "decompose_toffoli: " << opt_name2opt_val.at("decompose_toffoli") << std::endl
@@ -139,12 +169,16 @@ public:
                   << "mapinitone2one: "   << opt_name2opt_val.at("mapinitone2one") << std::endl
                   << "initialplace: "     << opt_name2opt_val.at("initialplace") << std::endl
                   << "initialplace2qhorizon: "<< opt_name2opt_val.at("initialplace2qhorizon") << std::endl
+                  << "initialplacestarts: "<< opt_name2opt_val.at("initialplacestarts") << std::endl
                   << "maplookahead: "     << opt_name2opt_val.at("maplookahead") << std::endl
                   << "mappathselect: "    << opt_name2opt_val.at("mappathselect") << std::endl
                   << "maptiebreak: "      << opt_name2opt_val.at("maptiebreak") << std::endl
+                  << "mapseed: "          << opt_name2opt_val.at("mapseed") << std::endl
+                  << "mapthreads: "       << opt_name2opt_val.at("mapthreads") << std::endl
                   << "mapusemoves: "      << opt_name2opt_val.at("mapusemoves") << std::endl
                   << "mapreverseswap: "   << opt_name2opt_val.at("mapreverseswap") << std::endl
                   << "mapselectswaps: "   << opt_name2opt_val.at("mapselectswaps") << std::endl
+                  << "mapsabrepasses: "   << opt_name2opt_val.at("mapsabrepasses") << std::endl
                   << "clifford_postmapper: " << opt_name2opt_val.at("clifford_postmapper") << std::endl
                   << "scheduler_post179: " << opt_name2opt_val.at("scheduler_post179") << std::endl
                   << "scheduler_commute: " << opt_name2opt_val.at("scheduler_commute") << std::endl
@@ -156,6 +190,7 @@ public:
     }
 
     void reset_options() {
+        delete app;
         app = new CLI::App("testApp");
         set_defaults();
     }
@@ -190,16 +225,39 @@ public:
 
 QL_GLOBAL Options ql_options("OpenQL Options");
 
+// protects ql_options, which is shared by all threads
+static std::mutex ql_options_mutex;
+
+/**
+ * Calls f with the options that the calling thread operates on: those of its
+ * current compilation context, or else the global ones, locked.
+ */
+template <class F>
+static auto with_current(F f) -> decltype(f(ql_options)) {
+    auto context = CompileContext::current();
+    if (context) {
+        return f(*context->option_table);
+    }
+    std::lock_guard<std::mutex> lock(ql_options_mutex);
+    return f(ql_options);
+}
+
+std::shared_ptr<Options> snapshot() {
+    return with_current([](Options &options) {
+        return std::make_shared<Options>(options);
+    });
+}
+
 void print() {
-    ql_options.help();
+    with_current([](Options &options) { options.help(); });
 }
 
 void print_current_values() {
-    ql_options.print_current_values();
+    with_current([](Options &options) { options.print_current_values(); });
 }
 
 void set(const Str &opt_name, const Str &opt_value) {
-    ql_options.set(opt_name, opt_value);
+    with_current([&](Options &options) { options.set(opt_name, opt_value); });
 
     if (opt_name == "log_level") {
         logger::set_log_level(opt_value);
@@ -209,11 +267,23 @@ void set(const Str &opt_name, const Str &opt_value) {
 }
 
 Str get(const Str &opt_name) {
-    return ql_options.get(opt_name);
+    return with_current([&](Options &options) { return options.get(opt_name); });
 }
 
 void reset_options() {
-    ql_options.reset_options();
+    with_current([](Options &options) { options.reset_options(); });
+}
+
+UInt get_threads(const Str &opt_name) {
+    Str opt = get(opt_name);
+    if (opt == "max") {
+        return ThreadPool::hardware_workers();
+    }
+    Int n = parse_int(opt);
+    if (n <= 0) {
+        QL_FATAL("Value of " << opt_name << " option must be a positive number or max, not " << opt);
+    }
+    return n;
 }
 
 } // namespace options
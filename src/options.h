@@ -4,16 +4,36 @@
 
 #pragma once
 
+#include <memory>
+#include "utils/num.h"
 #include "utils/str.h"
 
 namespace ql {
 namespace options {
 
+/**
+ * A table of option values. There is one global table, and each compilation
+ * works on its own copy of it (see ql::CompileContext).
+ */
+class Options;
+
+/**
+ * Returns a copy of the options that get() and set() operate on from the
+ * calling thread.
+ */
+std::shared_ptr<Options> snapshot();
+
 void print();
 void print_current_values();
 void set(const utils::Str &opt_name, const utils::Str &opt_value);
 utils::Str get(const utils::Str &opt_name);
 void reset_options();
 
+/**
+ * Returns the number of threads given by the named option, which is a
+ * positive number, or max for one per hardware thread.
+ */
+utils::UInt get_threads(const utils::Str &opt_name);
+
 } // namespace options
 } // namespace ql
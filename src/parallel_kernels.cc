@@ -0,0 +1,69 @@
+/** \file
+ * Runs the kernel-local part of a pass over the kernels of a program, in
+ * parallel when the compile_threads option asks for it.
+ */
+
+#include "parallel_kernels.h"
+
+#include "utils/str.h"
+#include "utils/logger.h"
+#include "options.h"
+#include "compile_context.h"
+
+namespace ql {
+
+using namespace utils;
+
+/**
+ * Opens a scope; when it is the outermost one of the current compilation and
+ * compile_threads > 1, this starts the pool.
+ */
+ParallelKernelsScope::ParallelKernelsScope() : context(CompileContext::current()) {
+    if (context != nullptr && context->kernel_pool == nullptr) {
+        UInt workers = options::get_threads("compile_threads");
+        if (workers > 1) {
+            QL_DOUT("compiling kernels on " << workers << " workers");
+            pool.emplace(workers);
+            context->kernel_pool = &*pool;
+        }
+    }
+}
+
+/**
+ * Closes the scope, stopping the pool if this scope created it.
+ */
+ParallelKernelsScope::~ParallelKernelsScope() {
+    if (pool.has_value()) {
+        context->kernel_pool = nullptr;
+    }
+}
+
+/**
+ * Calls task(kernel, index) for each kernel of the program, distributing the
+ * kernels over the pool of the open scope if there is one. The workers run
+ * the task in the compilation context of the caller.
+ */
+void for_each_kernel(quantum_program *programp, const KernelTask &task) {
+    auto &kernels = programp->kernels;
+    auto context = CompileContext::current();
+    if (context == nullptr || context->kernel_pool == nullptr || context->distributing_kernels) {
+        for (UInt k = 0; k < kernels.size(); k++) {
+            task(kernels[k], k);
+        }
+        return;
+    }
+
+    context->distributing_kernels = true;
+    try {
+        context->kernel_pool->parallel_for(kernels.size(), [&](UInt k, UInt) {
+            CompileContext::Scope scope(context);
+            task(kernels[k], k);
+        });
+    } catch (...) {
+        context->distributing_kernels = false;
+        throw;
+    }
+    context->distributing_kernels = false;
+}
+
+} // namespace ql
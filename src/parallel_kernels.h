@@ -0,0 +1,60 @@
+/** \file
+ * Runs the kernel-local part of a pass over the kernels of a program, in
+ * parallel when the compile_threads option asks for it.
+ *
+ * \see parallel_kernels.cc
+ */
+
+#pragma once
+
+#include <functional>
+#include "utils/num.h"
+#include "utils/opt.h"
+#include "utils/thread_pool.h"
+#include "program.h"
+
+namespace ql {
+
+class CompileContext;
+
+/**
+ * While an object of this class exists, for_each_kernel() distributes the
+ * kernels over a pool of as many workers as the compile_threads option
+ * specifies. Scopes nest: only the outermost one creates the pool, so the
+ * threads are started once per compilation and not once per pass. Scopes must
+ * only be opened by the thread that drives the compilation; the pool belongs
+ * to its current CompileContext, and outside of one, kernels are processed
+ * serially.
+ */
+class ParallelKernelsScope {
+public:
+    ParallelKernelsScope();
+    ~ParallelKernelsScope();
+
+    ParallelKernelsScope(const ParallelKernelsScope &) = delete;
+    ParallelKernelsScope &operator=(const ParallelKernelsScope &) = delete;
+
+private:
+    CompileContext *context;
+    utils::Opt<utils::ThreadPool> pool;
+};
+
+/**
+ * The per-kernel body of a kernel-local pass, called with the kernel and its
+ * index in the program.
+ */
+typedef std::function<void(quantum_kernel &kernel, utils::UInt index)> KernelTask;
+
+/**
+ * Calls task(kernel, index) for each kernel of the program. Within a
+ * ParallelKernelsScope with compile_threads > 1 the kernels are processed in
+ * parallel, otherwise they are processed one after the other in program order.
+ *
+ * The task must therefore only modify its own kernel, and must not set
+ * options. Output that must appear in kernel order, such as report lines, is
+ * to be collected per kernel index and written by the caller after
+ * for_each_kernel() returns, which keeps it identical to serial compilation.
+ */
+void for_each_kernel(quantum_program *programp, const KernelTask &task);
+
+} // namespace ql
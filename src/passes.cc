@@ -35,6 +35,16 @@ AbstractPass::AbstractPass(const Str &name) {
     createPassOptions();
 }
 
+/**
+ * @brief   Queries whether the pass is kernel-local, i.e. transforms each kernel
+ *          independently of the others, so that the kernels can be processed in
+ *          parallel when the compile_threads option is larger than 1
+ * @return  Bool representing whether the pass is kernel-local
+ */
+Bool AbstractPass::isKernelLocal() const {
+    return false;
+}
+
 /**
  * @brief   Gets the name of the pass
  * @return  Name of the compiler pass
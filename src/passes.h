@@ -19,6 +19,7 @@ class PassOptions;
 class AbstractPass {
 public:
     virtual void runOnProgram(quantum_program *program) = 0;
+    virtual utils::Bool isKernelLocal() const;
 
     explicit AbstractPass(const utils::Str &name);
     utils::Str getPassName() const;
@@ -77,6 +78,7 @@ public:
      */
     explicit RotationOptimizerPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -90,6 +92,7 @@ public:
      */
     explicit DecomposeToffoliPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -103,6 +106,7 @@ public:
      */
     explicit SchedulerPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -168,6 +172,7 @@ public:
      */
     explicit CCLDecomposePreSchedule(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -181,6 +186,7 @@ public:
      */
     explicit MapPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -194,6 +200,7 @@ public:
      */
     explicit CliffordOptimizePass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -207,6 +214,7 @@ public:
      */
     explicit RCSchedulePass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -220,6 +228,7 @@ public:
      */
     explicit LatencyCompensationPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -233,6 +242,7 @@ public:
      */
     explicit InsertBufferDelaysPass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
@@ -246,6 +256,7 @@ public:
      */
     explicit CCLDecomposePostSchedulePass(const utils::Str &name);
     void runOnProgram(quantum_program *program) override;
+    utils::Bool isKernelLocal() const override { return true; }
 };
 
 /**
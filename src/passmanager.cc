@@ -3,8 +3,10 @@
  */
 
 #include "utils/num.h"
+#include "utils/opt.h"
 #include "passmanager.h"
 #include "write_sweep_points.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
@@ -24,6 +26,17 @@ PassManager::PassManager(const Str &name) : name(name) {
 void PassManager::compile(quantum_program *program) const {
 
     QL_DOUT("In PassManager::compile ... ");
+
+    // kernel-local passes run on the kernels in parallel when compile_threads > 1;
+    // open the scope for the whole compilation when there are any, to start the threads only once
+    Opt<ParallelKernelsScope> parallel_kernels;
+    for (auto pass : passes) {
+        if (!pass->getSkip() && pass->isKernelLocal()) {
+            parallel_kernels.emplace();
+            break;
+        }
+    }
+
     for (auto pass : passes) {
         ///@todo-rn: implement option to check if following options are actually needed for a pass
         ///@note-rn: currently(0.8.1.dev), all passes require platform as API parameter, and some passes depend on the nqubits internally. Therefore, these are passed through by setting the program with these fields here. However, this should change in the future since compiling for a simulator might not require a platform, and the number of qubits could be optional.
@@ -36,7 +49,7 @@ void PassManager::compile(quantum_program *program) const {
         //If the old interface is used, platform is already set, so it is not needed to look for platform option and configure the platform from there
         if (!program->platformInitialized) {
             Str hwconfig = pass->getPassOptions()->getOption("hwconfig");
-            program->platform = *(new quantum_platform("testPlatform",hwconfig));
+            program->platform = quantum_platform("testPlatform", hwconfig);
         }
 
         if (!pass->getSkip()) {
@@ -4,12 +4,77 @@
 
 #include "platform.h"
 
+#include <fstream>
+#include <functional>
+#include <mutex>
+
 namespace ql {
 
 using namespace utils;
 
+/**
+ * The parsed contents of a hardware configuration file.
+ */
+struct loaded_configuration {
+    Str eqasm_compiler_name;
+    std::shared_ptr<const instruction_map_t> instruction_map;
+    Json instruction_settings;
+    Json hardware_settings;
+    Json resources;
+    Json topology;
+    Json aliases;
+};
+
+/**
+ * Loads the given hardware configuration file, or returns the configuration
+ * loaded before from the same file with the same contents.
+ *
+ * Parsing the JSON and building the custom gates of the instruction map
+ * dominates the construction of a platform, while programs are typically
+ * created over and over for the same few files. Loaded configurations are
+ * therefore cached for the lifetime of the process, keyed by the file name
+ * and a hash of the file contents, so that an edited file is loaded anew.
+ * The cached configurations are never modified; in particular, the
+ * instruction map and its gates are shared by all platforms created from the
+ * same file, and by their kernels.
+ */
+static std::shared_ptr<const loaded_configuration> load_configuration(const Str &configuration_file_name) {
+    std::ifstream fs(configuration_file_name);
+    StrStrm contents;
+    contents << fs.rdbuf();
+    Str key = configuration_file_name + ":" + to_string(std::hash<Str>()(contents.str()));
+
+    static std::mutex mutex;
+    static Map<Str, std::shared_ptr<const loaded_configuration>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        QL_DOUT("using cached hardware configuration " << configuration_file_name);
+        return it->second;
+    }
+
+    auto config = std::make_shared<loaded_configuration>();
+    auto instruction_map = std::make_shared<instruction_map_t>();
+    hardware_configuration hwc(configuration_file_name);
+    hwc.load(
+        *instruction_map,
+        config->instruction_settings,
+        config->hardware_settings,
+        config->resources,
+        config->topology,
+        config->aliases
+    );
+    config->eqasm_compiler_name = hwc.eqasm_compiler_name;
+    config->instruction_map = instruction_map;
+    cache.set(key) = config;
+    return config;
+}
+
 // FIXME: constructed object is not usable
-quantum_platform::quantum_platform() : name("default") {
+quantum_platform::quantum_platform() :
+    name("default"),
+    instruction_map(std::make_shared<const instruction_map_t>())
+{
 }
 
 quantum_platform::quantum_platform(
@@ -19,9 +84,14 @@ quantum_platform::quantum_platform(
     name(name),
     configuration_file_name(configuration_file_name)
 {
-    hardware_configuration hwc(configuration_file_name);
-    hwc.load(instruction_map, instruction_settings, hardware_settings, resources, topology, aliases);
-    eqasm_compiler_name = hwc.eqasm_compiler_name;
+    auto config = load_configuration(configuration_file_name);
+    eqasm_compiler_name = config->eqasm_compiler_name;
+    instruction_map = config->instruction_map;
+    instruction_settings = config->instruction_settings;
+    hardware_settings = config->hardware_settings;
+    resources = config->resources;
+    topology = config->topology;
+    aliases = config->aliases;
     QL_DOUT("eqasm_compiler_name= " << eqasm_compiler_name);
 
     if (hardware_settings.count("qubit_number") <= 0) {
@@ -48,7 +118,7 @@ void quantum_platform::print_info() const {
     QL_PRINTLN("[+] eqasm compiler     : " << eqasm_compiler_name);
     QL_PRINTLN("[+] configuration file : " << configuration_file_name);
     QL_PRINTLN("[+] supported instructions:");
-    for (const auto &i : instruction_map) {
+    for (const auto &i : *instruction_map) {
         QL_PRINTLN("  |-- " << i.first);
     }
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/json.h"
@@ -18,7 +19,7 @@ public:
     utils::UInt             qubit_number;             // number of qubits
     utils::UInt             cycle_time;               // in [ns]
     utils::Str              configuration_file_name;  // configuration file name
-    instruction_map_t       instruction_map;          // supported operations
+    std::shared_ptr<const instruction_map_t> instruction_map; // supported operations (shared, see load_configuration)
     utils::Json             instruction_settings;     // instruction settings (to use by the eqasm backend)
     utils::Json             hardware_settings;        // additional hardware settings (to use by the eqasm backend)
 
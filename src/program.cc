@@ -7,6 +7,7 @@
 #include "utils/filesystem.h"
 #include "compiler.h"
 #include "options.h"
+#include "compile_context.h"
 #include "interactionMatrix.h"
 #include "scheduler.h"
 #include "optimizer.h"
@@ -317,6 +318,10 @@ void quantum_program::compile() {
         QL_FATAL("compiling a program with no kernels !");
     }
 
+    // the passes work on this compilation's own copy of the options
+    CompileContext context;
+    CompileContext::Scope scope(&context);
+
     // from here on front-end passes
 
     // writer pass of the initial qasm file (program.qasm)
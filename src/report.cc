@@ -35,8 +35,10 @@
 
 #include "report.h"
 
+#include <mutex>
 #include "utils/num.h"
 #include "utils/str.h"
+#include "utils/sink.h"
 #include "options.h"
 #include "ir.h"
 
@@ -188,7 +190,8 @@ static void report_write_qasm(
     const quantum_platform &platform
 ) {
     // DOUT("... reporting report_write_qasm");
-    StrStrm out_qasm;
+    FileSink sink(fname);
+    std::ostream &out_qasm = sink.stream();
     out_qasm << "version 1.0\n";
     out_qasm << "# this file has been automatically generated by the OpenQL compiler please do not modify it manually.\n";
     out_qasm << "qubits " << programp->qubit_count << "\n";
@@ -199,17 +202,17 @@ static void report_write_qasm(
     }
     // DOUT("... reporting do_bundles=" << do_bundles);
 
+    // the kernels are written straight to file, bundle by bundle or gate by gate
     for (auto &kernel : programp->kernels) {
         if (do_bundles) {
             out_qasm << kernel.get_prologue();
-            ir::bundles_t bundles = ir::bundler(kernel.c, platform.cycle_time);
-            out_qasm << ir::qasm(bundles);
+            ir::write_qasm(out_qasm, kernel.c, platform.cycle_time);
             out_qasm << kernel.get_epilogue();
         } else {
-            out_qasm << kernel.qasm();
+            kernel.write_qasm(out_qasm);
         }
     }
-    OutFile(fname).write(out_qasm.str());
+    sink.close();
     // DOUT("... reporting report_write_qasm [done]");
 }
 
@@ -493,6 +496,10 @@ void report_statistics(
 static UInt report_bump_unique_file_version(const quantum_program *programp) {
     Str version_file = QL_SS2S(options::get("output_dir") << "/" << programp->name << ".unique");
 
+    // programs may be created concurrently; the file is read and rewritten as a whole
+    static std::mutex version_mutex;
+    std::lock_guard<std::mutex> lock(version_mutex);
+
     // Retrieve old version number, if one exists.
     UInt vers = 0;
     if (is_file(version_file)) {
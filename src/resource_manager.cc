@@ -22,6 +22,14 @@ resource_t::resource_t(
     QL_DOUT("constructing resource: " << n << " for direction (0:fwd,1:bwd): " << dir);
 }
 
+UInt resource_t::next_available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    return op_start_cycle;
+}
+
 void resource_t::Print(const Str &s) {
     QL_DOUT(s);
     QL_DOUT("resource name=" << name << "; count=" << count);
@@ -97,6 +105,33 @@ void platform_resource_manager_t::reserve(
     // DOUT("all resources reserved for: " << ins->qasm());
 }
 
+// all resources must be available, so the first cycle at which they all may be available
+// is the furthest one in the scheduling direction of those of the individual resources
+UInt platform_resource_manager_t::next_available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    UInt cycle = op_start_cycle;
+    for (auto rptr : resource_ptrs) {
+        UInt rcycle = rptr->next_available(op_start_cycle, ins, platform);
+        cycle = (forward_scheduling == rptr->direction ? max(cycle, rcycle) : min(cycle, rcycle));
+    }
+    return cycle;
+}
+
+void platform_resource_manager_t::checkpoint() {
+    for (auto rptr : resource_ptrs) {
+        rptr->undo_log.checkpoint();
+    }
+}
+
+void platform_resource_manager_t::rollback() {
+    for (auto rptr : resource_ptrs) {
+        rptr->undo_log.rollback();
+    }
+}
+
 // destructor destroying deep resource_t's
 // runs before shallow destruction which is done by synthesized platform_resource_manager_t destructor
 platform_resource_manager_t::~platform_resource_manager_t() {
@@ -172,6 +207,22 @@ void resource_manager_t::reserve(
     platform_resource_manager_ptr->reserve(op_start_cycle, ins, platform);
 }
 
+UInt resource_manager_t::next_available(
+    UInt op_start_cycle,
+    gate *ins,
+    const quantum_platform &platform
+) {
+    return platform_resource_manager_ptr->next_available(op_start_cycle, ins, platform);
+}
+
+void resource_manager_t::checkpoint() {
+    platform_resource_manager_ptr->checkpoint();
+}
+
+void resource_manager_t::rollback() {
+    platform_resource_manager_ptr->rollback();
+}
+
 // destructor destroying deep platform_resource_managert_t
 // runs before shallow destruction which is done by synthesized resource_manager_t destructor
 resource_manager_t::~resource_manager_t() {
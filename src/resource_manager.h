@@ -7,6 +7,7 @@
 #include "utils/num.h"
 #include "utils/str.h"
 #include "utils/vec.h"
+#include "utils/undo.h"
 #include "platform.h"
 
 namespace ql {
@@ -30,10 +31,22 @@ public:
     virtual utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) = 0;
     virtual void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform) = 0;
 
+    // first cycle from op_start_cycle on in the scheduling direction (i.e. >= op_start_cycle when forward,
+    // <= op_start_cycle when backward) at which the resource may be available for the gate;
+    // it is not available at any cycle in between, so a scheduler waiting for it can skip those;
+    // the default of op_start_cycle itself doesn't skip any cycle
+    virtual utils::UInt next_available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+
     virtual resource_t *clone() const & = 0;
     virtual resource_t *clone() && = 0;
 
     void Print(const utils::Str &s);
+
+protected:
+    // implementations of reserve save each state entry here before changing it, see resource_manager_t::checkpoint
+    utils::UndoLog undo_log;
+
+    friend class platform_resource_manager_t;
 };
 
 class platform_resource_manager_t {
@@ -62,8 +75,14 @@ public:
     // follow pattern to use tmp copy to allow self-assignment and to be exception safe
     platform_resource_manager_t &operator=(const platform_resource_manager_t &rhs);
 
-    utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
-    void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+    // by default, these ask each resource in turn; platforms can override them to share work between their resources
+    virtual utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+    virtual void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+    virtual utils::UInt next_available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+
+    // checkpoint/rollback of the state of all resources, see resource_manager_t::checkpoint
+    void checkpoint();
+    void rollback();
 
     // destructor destroying deep resource_t's
     // runs before shallow destruction which is done by synthesized platform_resource_manager_t destructor
@@ -93,6 +112,17 @@ public:
     utils::Bool available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
     void reserve(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
 
+    // first cycle from op_start_cycle on in the scheduling direction at which all resources may be available
+    // for the gate (see resource_t::next_available); this allows the scheduler to jump over cycles
+    // in which it would have to wait anyhow, instead of trying them one by one
+    utils::UInt next_available(utils::UInt op_start_cycle, gate *ins, const quantum_platform &platform);
+
+    // open a checkpoint on the resource state; reservations done after it are undone by rollback,
+    // which closes the checkpoint again; checkpoints nest;
+    // this allows trying reservations (e.g. by the mapper when evaluating alternatives) without copying the resource manager
+    void checkpoint();
+    void rollback();
+
     // destructor destroying deep platform_resource_managert_t
     // runs before shallow destruction which is done by synthesized resource_manager_t destructor
     virtual ~resource_manager_t();
@@ -76,20 +76,121 @@
 
 #include "utils/vec.h"
 #include "utils/filesystem.h"
+#include "parallel_kernels.h"
 
 namespace ql {
 
 using namespace utils;
-using ListDigraph = lemon::ListDigraph;
-using ListDigraphPath = lemon::Path<ListDigraph>;
-
-Scheduler::Scheduler() :
-    instruction(graph),
-    name(graph),
-    weight(graph),
-    cause(graph),
-    depType(graph)
-{
+using Node = DepGraph::Node;
+using Arc = DepGraph::Arc;
+
+DepGraph::Node DepGraph::add_node(gate *gp) {
+    instructions.push_back(gp);
+    return instructions.size() - 1;
+}
+
+DepGraph::Arc DepGraph::add_arc(Node from, Node to, Int weight, Int cause, DepTypes deptype) {
+    arc_sources.push_back(from);
+    arc_targets.push_back(to);
+    arc_weights.push_back(weight);
+    arc_causes.push_back(cause);
+    arc_dep_types.push_back(deptype);
+    return arc_sources.size() - 1;
+}
+
+// freeze the graph: build the CSR adjacency and the gate to node index
+void DepGraph::finalize() {
+    UInt nn = node_count();
+    UInt na = arc_count();
+
+    // count the arcs of each node, then turn the counts into start offsets
+    out_index.assign(nn+1, 0);
+    in_index.assign(nn+1, 0);
+    for (Arc a = 0; a < na; a++) {
+        out_index[arc_sources[a]+1]++;
+        in_index[arc_targets[a]+1]++;
+    }
+    for (Node n = 0; n < nn; n++) {
+        out_index[n+1] += out_index[n];
+        in_index[n+1] += in_index[n];
+    }
+
+    // fill the adjacency lists scanning the arcs backward,
+    // so that each list has the most recently added arc first
+    Vec<UInt> out_pos(nn);
+    Vec<UInt> in_pos(nn);
+    for (Node n = 0; n < nn; n++) {
+        out_pos[n] = out_index[n];
+        in_pos[n] = in_index[n];
+    }
+    out_list.resize(na);
+    in_list.resize(na);
+    for (Arc a = na; a-- > 0; ) {
+        out_list[out_pos[arc_sources[a]]++] = a;
+        in_list[in_pos[arc_targets[a]]++] = a;
+    }
+
+    gate_nodes.clear();
+    gate_nodes.reserve(nn);
+    for (Node n = 0; n < nn; n++) {
+        gate_nodes.push_back({instructions[n], n});
+    }
+    std::sort(gate_nodes.begin(), gate_nodes.end());
+}
+
+void DepGraph::clear() {
+    instructions.clear();
+    arc_sources.clear();
+    arc_targets.clear();
+    arc_weights.clear();
+    arc_causes.clear();
+    arc_dep_types.clear();
+    out_index.clear();
+    out_list.clear();
+    in_index.clear();
+    in_list.clear();
+    gate_nodes.clear();
+}
+
+Str DepGraph::name(Node n) const {
+    return instructions[n]->qasm();
+}
+
+DepGraph::Node DepGraph::node_of(const gate *gp) const {
+    auto it = std::lower_bound(
+        gate_nodes.begin(), gate_nodes.end(), gp,
+        [](const Pair<const gate*, Node> &gn, const gate *key) { return gn.first < key; }
+    );
+    if (it == gate_nodes.end() || it->first != gp) {
+        throw Exception("gate " + gp->qasm() + " is not a node of the dependence graph", false);
+    }
+    return it->second;
+}
+
+void AvailableList::clear() {
+    nodes.clear();
+    keys.clear();
+    insertions = 0;
+}
+
+Bool AvailableList::insert(DepGraph::Node n, UInt rank) {
+    if (contains(n)) {
+        return false;
+    }
+    Key key(rank, insertions++);
+    nodes.set(key) = n;
+    keys.set(n) = key;
+    return true;
+}
+
+void AvailableList::remove(DepGraph::Node n) {
+    auto it = keys.find(n);
+    QL_ASSERT(it != keys.end());
+    nodes.erase(it->second);
+    keys.erase(it);
+}
+
+Scheduler::Scheduler() : s(0), t(0), cycle_time(0), qubit_count(0), creg_count(0), breg_count(0), circp(nullptr) {
 }
 
 // ins->name may contain parameters, so must be stripped first before checking it for gate's name
@@ -106,15 +207,11 @@ void Scheduler::stripname(Str &name) {
 // - 0 <= combo < qubit_count:                        combo is a qubit index
 // - 0 <= combo-qubit_count < creg_count:             combo-qubit_count is a classical register index
 // - 0 <= combo-qubit_count-creg_count < breg_count:  combo-qubit_count-creg_count is a bit register index
-void Scheduler::add_dep(Int fromID, Int toID, enum DepTypes deptype, UInt comboperand) {
+void Scheduler::add_dep(Node fromID, Node toID, enum DepTypes deptype, UInt comboperand) {
     QL_DOUT(".. adddep ... from fromID " << fromID << " to toID " << toID << "   opnd=" << comboperand << ", dep=" << DepTypesNames[deptype]);
-    auto fromNode = graph.nodeFromId(fromID);
-    auto toNode = graph.nodeFromId(toID);
-    auto arc = graph.addArc(fromNode, toNode);
-    weight[arc] = Int(ceil(static_cast<Real>(instruction[fromNode]->duration) / cycle_time));
-    cause[arc] = comboperand;
+    Int weight = Int(ceil(static_cast<Real>(graph.instruction(fromID)->duration) / cycle_time));
+    auto arc = graph.add_arc(fromID, toID, weight, comboperand, deptype);
     UInt operand;
-    depType[arc] = deptype;
     Str s;
     if (comboperand < qubit_count) {
         s = "q";
@@ -126,7 +223,7 @@ void Scheduler::add_dep(Int fromID, Int toID, enum DepTypes deptype, UInt combop
         operand = comboperand - (qubit_count + creg_count);
         s = "b";
     }
-    QL_DOUT("... dep " << name[fromNode] << " -> " << name[toNode] << " (opnd=" << s << "[" << operand << "], dep=" << DepTypesNames[deptype] << ", wght=" << weight[arc] << ")");
+    QL_DOUT("... dep " << graph.name(fromID) << " -> " << graph.name(toID) << " (opnd=" << s << "[" << operand << "], dep=" << DepTypesNames[deptype] << ", wght=" << graph.weight(arc) << ")");
 }
 
 // fill the dependency graph ('graph') with nodes from the circuit and adding arcs for their dependencies
@@ -147,6 +244,7 @@ void Scheduler::init(
     QL_DOUT("Scheduler.init: qubit_count=" << qubit_count << ", creg_count=" << creg_count << ", breg_count=" << breg_count << ", total=" << total_reg_count);
     cycle_time = platform.cycle_time;
     circp = &ckt;
+    Bool commute = (options::get("scheduler_commute") != "no");  // read once, the loop below tests it per operand
 
     // dependencies are created with a current gate as target
     // and with those previous gates as source that have an operand match with the current gate:
@@ -155,7 +253,7 @@ void Scheduler::init(
     // - the previous gate that Wrote operand r in LastWriter[r]; this can only be one because writing never commutes
     // operands can be a qubit, a classical register or a bit register
     // the indices in LastReaders, LastDs and LastWriter are operand indices in the combined index space (see add_dep)
-    typedef Vec<Int> ReadersListType;
+    typedef Vec<Node> ReadersListType;
 
     Vec<ReadersListType> LastReaders;
     LastReaders.resize(total_reg_count);
@@ -164,16 +262,14 @@ void Scheduler::init(
     LastDs.resize(total_reg_count);
 
     // start filling the dependency graph by creating the s node, the top of the graph
+    graph.clear();
     {
         // add dummy source node
-        auto srcNode = graph.addNode();
-        instruction[srcNode] = new SOURCE();    // so SOURCE is defined as instruction[s], not unique in itself
-        node.set(instruction[srcNode]) = srcNode;
-        name[srcNode] = instruction[srcNode]->qasm();
-        s = srcNode;
+        source_gate = std::make_shared<SOURCE>();
+        s = graph.add_node(source_gate.get());    // so SOURCE is defined as instruction(s), not unique in itself
     }
-    Int srcID = graph.id(s);
-    Vec<Int> LastWriter(total_reg_count, srcID);     // it implicitly writes to all qubits/cregs/bregs
+    Node srcID = s;
+    Vec<Node> LastWriter(total_reg_count, srcID);     // it implicitly writes to all qubits/cregs/bregs
 
     // for each gate pointer ins in the circuit, add a node and add dependencies on previous gates to it
     for (auto ins : ckt) {
@@ -195,12 +291,9 @@ void Scheduler::init(
         auto iname = ins->name; // copy!!!!
         stripname(iname);
 
-        // Add node
-        ListDigraph::Node currNode = graph.addNode();
-        int currID = graph.id(currNode);
-        instruction[currNode] = ins;
-        node.set(ins) = currNode;
-        name[currNode] = ins->qasm();   // and this includes any condition!
+        // Add node; its name (the qasm string, including any condition) is only computed when needed
+        Node currNode = graph.add_node(ins);
+        Node currID = currNode;
 
         // Add edges (arcs)
         // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
@@ -273,7 +366,7 @@ void Scheduler::init(
 
         // each type of gate has a different 'signature' of events; switch out to each one
         if (iname == "measure") {
-            QL_DOUT(". considering " << name[currNode] << " as measure");
+            QL_DOUT(". considering " << graph.name(currNode) << " as measure");
             // Read+Write each qubit operand + Write each classical operand + Write each bit operand
             for (auto operand : ins->operands) {
                 QL_DOUT(".. Operand: " << operand);
@@ -325,7 +418,7 @@ void Scheduler::init(
             }
             QL_DOUT(". measure done");
         } else if (iname == "display") {
-            QL_DOUT(". considering " << name[currNode] << " as display");
+            QL_DOUT(". considering " << graph.name(currNode) << " as display");
             // no operands, display all qubits and cregs
             // Read+Write each operand
             Vec<UInt> qubits(total_reg_count);
@@ -348,7 +441,7 @@ void Scheduler::init(
                 LastDs[operand].clear();
             }
         } else if (ins->type() == gate_type_t::__classical_gate__) {
-            QL_DOUT(". considering " << name[currNode] << " as classical gate");
+            QL_DOUT(". considering " << graph.name(currNode) << " as classical gate");
             // Read+Write each classical operand
             for (auto coperand : ins->creg_operands) {
                 QL_DOUT("... Classical operand: " << coperand);
@@ -364,14 +457,14 @@ void Scheduler::init(
                 LastReaders[creg_base+coperand].clear();
             }
         } else if (iname == "cnot") {
-            QL_DOUT(". considering " << name[currNode] << " as cnot");
+            QL_DOUT(". considering " << graph.name(currNode) << " as cnot");
             // CNOTs Read the first operands, and Ds the second operand
             UInt operandNo = 0;
             for (auto operand : ins->operands) {
                 QL_DOUT(".. Operand: " << operand);
                 if (operandNo == 0) {
                     add_dep(LastWriter[operand], currID, RAW, operand);
-                    if (options::get("scheduler_commute") == "no") {
+                    if (!commute) {
                         for (auto &readerID : LastReaders[operand]) {
                             add_dep(readerID, currID, RAR, operand);
                         }
@@ -381,7 +474,7 @@ void Scheduler::init(
                     }
                 } else {
                     add_dep(LastWriter[operand], currID, DAW, operand);
-                    if (options::get("scheduler_commute") == "no") {
+                    if (!commute) {
                         for (auto &readerID : LastDs[operand]) {
                             add_dep(readerID, currID, DAD, operand);
                         }
@@ -407,12 +500,12 @@ void Scheduler::init(
                 operandNo++;
             }
         } else if (iname == "cz" || iname == "cphase") {
-            QL_DOUT(". considering " << name[currNode] << " as cz");
+            QL_DOUT(". considering " << graph.name(currNode) << " as cz");
             // CZs Read all operands
             UInt operandNo = 0;
             for (auto operand : ins->operands) {
                 QL_DOUT(".. Operand: " << operand);
-                if (options::get("scheduler_commute") == "no") {
+                if (!commute) {
                     for (auto &readerID : LastReaders[operand]) {
                         add_dep(readerID, currID, RAR, operand);
                     }
@@ -437,14 +530,14 @@ void Scheduler::init(
             // Read on all operands, Write on last operand
             // before implementing it, check whether all commutativity on Reads above hold for this Control Unitary
         ) {
-            QL_DOUT(". considering " << name[currNode] << " as Control Unitary");
+            QL_DOUT(". considering " << graph.name(currNode) << " as Control Unitary");
             // Control Unitaries Read all operands, and Write the last operand
             UInt operandNo=0;
             UInt op_count = ins->operands.size();
             for (auto operand : ins->operands) {
                 DOUT(".. Operand: " << operand);
                 add_dep(LastWriter[operand], currID, RAW, operand);
-                if (options::get("scheduler_commute") == "no") {
+                if (!commute) {
                     for (auto &readerID : LastReaders[operand]) {
                         add_dep(readerID, currID, RAR, operand);
                     }
@@ -473,7 +566,7 @@ void Scheduler::init(
             } // end of operand for
 #endif  // HAVEGENERALCONTROLUNITARIES
         } else {
-            QL_DOUT(". considering " << name[currNode] << " as no special gate (catch-all, generic rules)");
+            QL_DOUT(". considering " << graph.name(currNode) << " as no special gate (catch-all, generic rules)");
             // Read+Write on each quantum operand
             // Read+Write on each classical operand
             // Read+Write on each bit operand
@@ -523,11 +616,9 @@ void Scheduler::init(
     // finish filling the dependency graph by creating the t node, the bottom of the graph
     {
         // add dummy target node
-        ListDigraph::Node currNode = graph.addNode();
-        int currID = graph.id(currNode);
-        instruction[currNode] = new SINK();    // so SINK is defined as instruction[t], not unique in itself
-        node.set(instruction[currNode]) = currNode;
-        name[currNode] = instruction[currNode]->qasm();
+        sink_gate = std::make_shared<SINK>();
+        Node currNode = graph.add_node(sink_gate.get());    // so SINK is defined as instruction(t), not unique in itself
+        Node currID = currNode;
         t = currNode;
 
         // add deps to the dummy target node to close the dependency chains
@@ -563,27 +654,39 @@ void Scheduler::init(
         }
     }
 
-    // useless as well because by construction, there cannot be cycles
+    graph.finalize();
+
+    // useless as well because by construction, there cannot be cycles:
+    // each arc goes from a node to a node with a higher index, i.e. from an earlier to a later gate;
     // but when afterwards dependencies are added, cycles may be created,
     // and after doing so (a copy of) this test should certainly be done because
     // a cyclic dependency graph cannot be scheduled;
     // this test here is a kind of debugging aid whether dependency creation was done well
-    if (!dag(graph)) {
-        QL_FATAL("The dependency graph is not a DAG.");
+    for (Arc arc = 0; arc < graph.arc_count(); arc++) {
+        if (graph.source(arc) >= graph.target(arc)) {
+            QL_FATAL("The dependency graph is not a DAG.");
+        }
     }
     QL_DOUT("dependency graph creation Done.");
 }
 
 void Scheduler::print() const {
     QL_COUT("Printing dependency Graph ");
-    digraphWriter(graph).
-        nodeMap("name", name).
-        arcMap("cause", cause).
-        arcMap("weight", weight).
-        // arcMap("depType", depType).
-        node("source", s).
-        node("target", t).
-        run();
+    std::cout << "@nodes" << std::endl;
+    std::cout << "label\tname\t" << std::endl;
+    for (Node n = graph.node_count(); n-- > 0; ) {
+        std::cout << n << "\t\"" << graph.name(n) << "\"\t" << std::endl;
+    }
+    std::cout << "@arcs" << std::endl;
+    std::cout << "\t\tcause\tweight\t" << std::endl;
+    for (Node n = graph.node_count(); n-- > 0; ) {
+        for (auto arc : graph.out_arcs(n)) {
+            std::cout << graph.source(arc) << "\t" << graph.target(arc) << "\t" << graph.cause(arc) << "\t" << graph.weight(arc) << "\t" << std::endl;
+        }
+    }
+    std::cout << "@attributes" << std::endl;
+    std::cout << "source\t" << s << std::endl;
+    std::cout << "target\t" << t << std::endl;
 }
 
 void Scheduler::write_dependence_matrix() const {
@@ -591,16 +694,12 @@ void Scheduler::write_dependence_matrix() const {
     Str datfname( options::get("output_dir") + "/dependenceMatrix.dat");
     OutFile fout(datfname);
 
-    UInt totalInstructions = countNodes(graph);
+    UInt totalInstructions = graph.node_count();
     Vec<Vec<Bool> > Matrix(totalInstructions, Vec<Bool>(totalInstructions));
 
     // now print the edges
-    for (ListDigraph::ArcIt arc(graph); arc != lemon::INVALID; ++arc) {
-        auto srcNode = graph.source(arc);
-        auto dstNode = graph.target(arc);
-        UInt srcID = graph.id( srcNode );
-        UInt dstID = graph.id( dstNode );
-        Matrix[srcID][dstID] = true;
+    for (Arc arc = 0; arc < graph.arc_count(); arc++) {
+        Matrix[graph.source(arc)][graph.target(arc)] = true;
     }
 
     for (UInt i = 1; i < totalInstructions - 1; i++) {
@@ -613,81 +712,82 @@ void Scheduler::write_dependence_matrix() const {
 
 // cycle assignment without RC depending on direction: forward:ASAP, backward:ALAP;
 // without RC, this is all there is to schedule, apart from forming the bundles in ir::bundler()
-// set_cycle iterates over the circuit's gates and set_cycle_gate over the dependencies of each gate
-// please note that set_cycle_gate expects a caller like set_cycle which iterates gp forward through the circuit
-void Scheduler::set_cycle_gate(gate *gp, scheduling_direction_t dir) {
-    ListDigraph::Node currNode = node.at(gp);
+// set_cycle iterates over the graph's nodes and set_cycle_gate over the dependencies of each node
+// please note that set_cycle_gate expects a caller like set_cycle which iterates n forward (backward) over the nodes
+void Scheduler::set_cycle_gate(Node currNode, scheduling_direction_t dir) {
     UInt  currCycle;
     if (forward_scheduling == dir) {
         currCycle = 0;
-        for (ListDigraph::InArcIt arc(graph,currNode); arc != lemon::INVALID; ++arc) {
-            currCycle = max<UInt>(currCycle, instruction[graph.source(arc)]->cycle + weight[arc]);
+        for (auto arc : graph.in_arcs(currNode)) {
+            currCycle = max<UInt>(currCycle, graph.instruction(graph.source(arc))->cycle + graph.weight(arc));
         }
     } else {
         currCycle = MAX_CYCLE;
-        for (ListDigraph::OutArcIt arc(graph,currNode); arc != lemon::INVALID; ++arc) {
-            currCycle = min<UInt>(currCycle, instruction[graph.target(arc)]->cycle - weight[arc]);
+        for (auto arc : graph.out_arcs(currNode)) {
+            currCycle = min<UInt>(currCycle, graph.instruction(graph.target(arc))->cycle - graph.weight(arc));
         }
     }
-    gp->cycle = currCycle;
+    graph.instruction(currNode)->cycle = currCycle;
 }
 
+// set_cycle computes the cycles in a vector indexed by node, as set_remaining does for remaining,
+// and assigns them to the gates at the end; the dependences then don't need to visit the gates
 void Scheduler::set_cycle(scheduling_direction_t dir) {
+    // the node numbering is by definition a topological order of the dependency graph,
+    // with s the first and t the last node
+    Vec<UInt> cycle(graph.node_count(), 0);
     if (forward_scheduling == dir) {
-        instruction[s]->cycle = 0;
-        QL_DOUT("... set_cycle of " << instruction[s]->qasm() << " cycles " << instruction[s]->cycle);
-        // *circp is by definition in a topological order of the dependency graph
-        for (auto gpit = circp->begin(); gpit != circp->end(); gpit++) {
-            set_cycle_gate(*gpit, dir);
-            QL_DOUT("... set_cycle of " << (*gpit)->qasm() << " cycles " << (*gpit)->cycle);
+        for (Node n = s + 1; n <= t; n++) {
+            UInt currCycle = 0;
+            for (auto arc : graph.in_arcs(n)) {
+                currCycle = max<UInt>(currCycle, cycle[graph.source(arc)] + graph.weight(arc));
+            }
+            cycle[n] = currCycle;
         }
-        set_cycle_gate(instruction[t], dir);
-        QL_DOUT("... set_cycle of " << instruction[t]->qasm() << " cycles " << instruction[t]->cycle);
     } else {
-        instruction[t]->cycle = ALAP_SINK_CYCLE;
-        // *circp is by definition in a topological order of the dependency graph
-        for (auto gpit = circp->rbegin(); gpit != circp->rend(); gpit++) {
-            set_cycle_gate(*gpit, dir);
-        }
-        set_cycle_gate(instruction[s], dir);
-
-        // readjust cycle values of gates so that SOURCE is at 0
-        UInt  SOURCECycle = instruction[s]->cycle;
-        QL_DOUT("... readjusting cycle values by -" << SOURCECycle);
-
-        instruction[t]->cycle -= SOURCECycle;
-        QL_DOUT("... set_cycle of " << instruction[t]->qasm() << " cycles " << instruction[t]->cycle);
-        for (auto &gp : *circp) {
-            gp->cycle -= SOURCECycle;
-            QL_DOUT("... set_cycle of " << gp->qasm() << " cycles " << gp->cycle);
+        cycle[t] = ALAP_SINK_CYCLE;
+        for (Node n = t; n-- > s; ) {
+            UInt currCycle = MAX_CYCLE;
+            for (auto arc : graph.out_arcs(n)) {
+                currCycle = min<UInt>(currCycle, cycle[graph.target(arc)] - graph.weight(arc));
+            }
+            cycle[n] = currCycle;
         }
-        instruction[s]->cycle -= SOURCECycle;   // i.e. becomes 0
-        QL_DOUT("... set_cycle of " << instruction[s]->qasm() << " cycles " << instruction[s]->cycle);
+        QL_DOUT("... readjusting cycle values by -" << cycle[s]);
     }
-}
 
-static Bool cycle_lessthan(gate *gp1, gate *gp2) {
-    return gp1->cycle < gp2->cycle;
+    // readjust cycle values of gates so that SOURCE is at 0 (only needed when backward)
+    UInt SOURCECycle = cycle[s];
+    for (Node n = s; n <= t; n++) {
+        graph.instruction(n)->cycle = cycle[n] - SOURCECycle;
+        QL_DOUT("... set_cycle of " << graph.name(n) << " cycles " << graph.instruction(n)->cycle);
+    }
 }
 
 // sort circuit by the gates' cycle attribute in non-decreasing order
+//
+// the sort must be stable, i.e. keep the original order of gates with equal cycle values;
+// instead of std::stable_sort on the gates, (cycle, position) keys are sorted,
+// which are unique and contiguous, so that the comparisons don't need to visit the gates
 void Scheduler::sort_by_cycle(circuit *cp) {
     QL_DOUT("... before sorting on cycle value");
-    // for ( circuit::iterator gpit = cp->begin(); gpit != cp->end(); gpit++)
-    // {
-    //     gate*           gp = *gpit;
-    //     DOUT("...... (@" << gp->cycle << ") " << gp->qasm());
-    // }
 
-    // std::sort doesn't preserve the original order of elements that have equal values but std::stable_sort does
-    std::stable_sort(cp->begin(), cp->end(), cycle_lessthan);
+    UInt n = cp->size();
+    Vec<Pair<UInt, UInt>> keys(n);
+    Bool sorted = true;
+    for (UInt i = 0; i < n; i++) {
+        keys[i] = {(*cp)[i]->cycle, i};
+        sorted = sorted && (i == 0 || keys[i-1].first <= keys[i].first);
+    }
+    if (!sorted) {
+        std::sort(keys.begin(), keys.end());
+        circuit unsorted(*cp);
+        for (UInt i = 0; i < n; i++) {
+            (*cp)[i] = unsorted[keys[i].second];
+        }
+    }
 
     QL_DOUT("... after sorting on cycle value");
-    // for ( circuit::iterator gpit = cp->begin(); gpit != cp->end(); gpit++)
-    // {
-    //     gate*           gp = *gpit;
-    //     DOUT("...... (@" << gp->cycle << ") " << gp->qasm());
-    // }
 }
 
 // ASAP scheduler without RC, setting gate cycle values and sorting the resulting circuit
@@ -720,57 +820,47 @@ void Scheduler::schedule_alap(Str &sched_dot) {
     QL_DOUT("Scheduling ALAP [DONE]");
 }
 
-// Note that set_remaining_gate expects a caller like set_remaining that iterates gp backward over the circuit
-void Scheduler::set_remaining_gate(gate* gp, scheduling_direction_t dir) {
-    auto currNode = node.at(gp);
+// Note that set_remaining_gate expects a caller like set_remaining that iterates n backward (forward) over the nodes
+void Scheduler::set_remaining_gate(Node currNode, scheduling_direction_t dir) {
     UInt currRemain = 0;
     if (forward_scheduling == dir) {
-        for (ListDigraph::OutArcIt arc(graph,currNode); arc != lemon::INVALID; ++arc) {
-            currRemain = max<UInt>(currRemain, remaining.at(graph.target(arc)) + weight[arc]);
+        for (auto arc : graph.out_arcs(currNode)) {
+            currRemain = max<UInt>(currRemain, remaining[graph.target(arc)] + graph.weight(arc));
         }
     } else {
-        for (ListDigraph::InArcIt arc(graph,currNode); arc != lemon::INVALID; ++arc) {
-            currRemain = max<UInt>(currRemain, remaining.at(graph.source(arc)) + weight[arc]);
+        for (auto arc : graph.in_arcs(currNode)) {
+            currRemain = max<UInt>(currRemain, remaining[graph.source(arc)] + graph.weight(arc));
         }
     }
-    remaining.set(currNode) = currRemain;
+    remaining[currNode] = currRemain;
 }
 
 void Scheduler::set_remaining(scheduling_direction_t dir) {
-    gate *gp;
-    remaining.clear();
+    remaining.assign(graph.node_count(), 0);
+    // the node numbering is by definition a topological order of the dependency graph
     if (forward_scheduling == dir) {
         // remaining until SINK (i.e. the SINK.cycle-ALAP value)
-        remaining.set(t) = 0;
-        // *circp is by definition in a topological order of the dependency graph
-        for (auto gpit = circp->rbegin(); gpit != circp->rend(); gpit++) {
-            gate *gp2 = *gpit;
-            set_remaining_gate(gp2, dir);
-            QL_DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining.dbg(node.at(gp2)));
+        remaining[t] = 0;
+        for (Node n = t; n-- > s; ) {
+            set_remaining_gate(n, dir);
+            QL_DOUT("... remaining at " << graph.name(n) << " cycles " << remaining[n]);
         }
-        gp = instruction[s];
-        set_remaining_gate(gp, dir);
-        QL_DOUT("... remaining at " << gp->qasm() << " cycles " << remaining.dbg(s));
     } else {
         // remaining until SOURCE (i.e. the ASAP value)
-        remaining.set(s) = 0;
-        // *circp is by definition in a topological order of the dependency graph
-        for (auto gpit = circp->begin(); gpit != circp->end(); gpit++) {
-            gate*   gp2 = *gpit;
-            set_remaining_gate(gp2, dir);
-            QL_DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining.dbg(node.at(gp2)));
+        remaining[s] = 0;
+        for (Node n = s + 1; n <= t; n++) {
+            set_remaining_gate(n, dir);
+            QL_DOUT("... remaining at " << graph.name(n) << " cycles " << remaining[n]);
         }
-        gp = instruction[t];
-        set_remaining_gate(gp, dir);
-        QL_DOUT("... remaining at " << gp->qasm() << " cycles " << remaining.dbg(t));
     }
+    set_criticality(dir);
 }
 
 gate *Scheduler::find_mostcritical(List<gate*> &lg) {
     UInt maxRemain = 0;
     gate *mostCriticalGate = nullptr;
     for (auto gp : lg) {
-        UInt gr = remaining.at(node.at(gp));
+        UInt gr = remaining[graph.node_of(gp)];
         if (gr > maxRemain) {
             mostCriticalGate = gp;
             maxRemain = gr;
@@ -783,19 +873,36 @@ gate *Scheduler::find_mostcritical(List<gate*> &lg) {
 // Set the curr_cycle of the scheduling algorithm to start at the appropriate end as well;
 // note that the cycle attributes will be shifted down to start at 1 after backward scheduling.
 void Scheduler::init_available(
-    List<ListDigraph::Node> &avlist,
+    AvailableList &avlist,
     scheduling_direction_t dir,
     UInt &curr_cycle
 ) {
     avlist.clear();
     if (forward_scheduling == dir) {
         curr_cycle = 0;
-        instruction[s]->cycle = curr_cycle;
-        avlist.push_back(s);
+        graph.instruction(s)->cycle = curr_cycle;
+        avlist.insert(s, criticality[s]);
     } else {
         curr_cycle = ALAP_SINK_CYCLE;
-        instruction[t]->cycle = curr_cycle;
-        avlist.push_back(t);
+        graph.instruction(t)->cycle = curr_cycle;
+        avlist.insert(t, criticality[t]);
+    }
+}
+
+// Initialize pending[n] for all nodes n to the number of dependences that block n from becoming available:
+// the number of in-arcs when forward scheduling, the number of out-arcs when backward scheduling
+void Scheduler::init_pending(
+    scheduling_direction_t dir,
+    Vec<UInt> &pending
+) {
+    UInt nn = graph.node_count();
+    pending.assign(nn, 0);
+    for (Node n = 0; n < nn; n++) {
+        if (forward_scheduling == dir) {
+            pending[n] = graph.in_arcs(n).size();
+        } else {
+            pending[n] = graph.out_arcs(n).size();
+        }
     }
 }
 
@@ -804,18 +911,18 @@ void Scheduler::init_available(
 // dependencies that are duplicates from the perspective of the scheduler
 // may be present in the dependency graph because the scheduler ignores dependency type and cause
 void Scheduler::get_depending_nodes(
-    ListDigraph::Node n,
+    Node n,
     scheduling_direction_t dir,
-    List<ListDigraph::Node> &ln
+    List<Node> &ln
 ) {
     if (forward_scheduling == dir) {
-        for (ListDigraph::OutArcIt succArc(graph,n); succArc != lemon::INVALID; ++succArc) {
+        for (auto succArc : graph.out_arcs(n)) {
             auto succNode = graph.target(succArc);
-            // DOUT("...... succ of " << instruction[n]->qasm() << " : " << instruction[succNode]->qasm());
+            // DOUT("...... succ of " << graph.name(n) << " : " << graph.name(succNode));
             Bool found = false;             // filter out duplicates
             for (auto anySuccNode : ln) {
                 if (succNode == anySuccNode) {
-                    // DOUT("...... duplicate: " << instruction[succNode]->qasm());
+                    // DOUT("...... duplicate: " << graph.name(succNode));
                     found = true;           // duplicate found
                 }
             }
@@ -825,13 +932,13 @@ void Scheduler::get_depending_nodes(
         }
         // ln contains depending nodes of n without duplicates
     } else {
-        for (ListDigraph::InArcIt predArc(graph,n); predArc != lemon::INVALID; ++predArc) {
-            ListDigraph::Node predNode = graph.source(predArc);
-            // DOUT("...... pred of " << instruction[n]->qasm() << " : " << instruction[predNode]->qasm());
+        for (auto predArc : graph.in_arcs(n)) {
+            auto predNode = graph.source(predArc);
+            // DOUT("...... pred of " << graph.name(n) << " : " << graph.name(predNode));
             Bool found = false;             // filter out duplicates
             for (auto anyPredNode : ln) {
                 if (predNode == anyPredNode) {
-                    // DOUT("...... duplicate: " << instruction[predNode]->qasm());
+                    // DOUT("...... duplicate: " << graph.name(predNode));
                     found = true;           // duplicate found
                 }
             }
@@ -846,49 +953,115 @@ void Scheduler::get_depending_nodes(
 // Compute of two nodes whether the first one is less deep-critical than the second, for the given scheduling direction;
 // criticality of a node is given by its remaining[node] value which is precomputed;
 // deep-criticality takes into account the criticality of depending nodes (in the right direction!);
-// this function is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
+// this defines the order of the avlist, from highest deep-criticality to lowest deep-criticality;
 // it is the core of the heuristics of the critical path list scheduler.
-Bool Scheduler::criticality_lessthan(
-    ListDigraph::Node n1,
-    ListDigraph::Node n2,
-    scheduling_direction_t dir
-) {
-    if (n1 == n2) return false;             // because not <
-
-    if (remaining.at(n1) < remaining.at(n2)) return true;
-    if (remaining.at(n1) > remaining.at(n2)) return false;
-    // so: remaining[n1] == remaining[n2]
-
-    List<ListDigraph::Node> ln1;
-    List<ListDigraph::Node> ln2;
-
-    get_depending_nodes(n1, dir, ln1);
-    get_depending_nodes(n2, dir, ln2);
-    if (ln2.empty()) return false;          // strictly < only when ln1.empty and ln2.not_empty
-    if (ln1.empty()) return true;           // so when both empty, it is equal, so not strictly <, so false
-    // so: ln1.non_empty && ln2.non_empty
-
-    ln1.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining.at(d1) < remaining.at(d2); });
-    ln2.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining.at(d1) < remaining.at(d2); });
+// Deep-criticality is precomputed by set_remaining as a rank per node, so this is a comparison of ranks.
+Bool Scheduler::criticality_lessthan(Node n1, Node n2) const {
+    return criticality[n1] < criticality[n2];
+}
 
-    UInt crit_dep_n1 = remaining.at(ln1.back());    // the last of the list is the one with the largest remaining value
-    UInt crit_dep_n2 = remaining.at(ln2.back());
+// Compute criticality[n] for all nodes n, for the given scheduling direction, such that
+// n1 is less deep-critical than n2 iff criticality[n1] < criticality[n2].
+//
+// Deep-criticality compares, in order:
+// - remaining[n1] and remaining[n2]
+// - whether n1 and n2 have depending nodes; having none is least critical
+// - the highest remaining value crit_dep of the depending nodes of n1 and of n2
+// - the number of depending nodes with remaining value crit_dep of n1 and of n2
+// - the deep-criticality of the most deep-critical of those depending nodes of n1 and of n2
+// The latter makes the definition recursive along a chain of most deep-critical depending nodes;
+// following these chains on each comparison is costly, so the nodes are ranked once here instead.
+//
+// Since the remaining value of a depending node is at most that of the node itself, nodes are ranked
+// in groups of equal remaining value, from low to high remaining. When ranking a group,
+// nodes of lower groups have their rank already, so comparing two nodes of the group follows their chains
+// only while these stay in the group, i.e. along depending nodes at distance 0.
+// The nodes of a group are visited in reverse topological order for the direction,
+// so that the most deep-critical depending node of a node is known before the node is visited itself.
+void Scheduler::set_criticality(scheduling_direction_t dir) {
+    UInt node_count = graph.node_count();
+    Vec<UInt> crit_dep_count(node_count, 0);   // number of depending nodes with the highest remaining; 0 when none
+    Vec<Node> crit_dep_node(node_count, 0);    // the most deep-critical of those
+    Vec<Bool> ranked(node_count, false);       // whether criticality[n] has been computed yet
+    criticality.assign(node_count, 0);
+
+    // n1 less deep-critical than n2, for n1 and n2 of the current or an earlier ranked group
+    auto lessthan = [&](Node n1, Node n2) {
+        while (n1 != n2) {
+            if (ranked[n1] && ranked[n2]) {
+                return criticality[n1] < criticality[n2];
+            }
+            if (remaining[n1] != remaining[n2]) {
+                return remaining[n1] < remaining[n2];
+            }
+            if (crit_dep_count[n2] == 0) return false;  // strictly < only when n1 has none and n2 has
+            if (crit_dep_count[n1] == 0) return true;
+            Node d1 = crit_dep_node[n1];
+            Node d2 = crit_dep_node[n2];
+            if (remaining[d1] != remaining[d2]) {
+                return remaining[d1] < remaining[d2];
+            }
+            if (crit_dep_count[n1] != crit_dep_count[n2]) {
+                return crit_dep_count[n1] < crit_dep_count[n2];
+            }
+            n1 = d1;
+            n2 = d2;
+        }
+        return false;
+    };
 
-    if (crit_dep_n1 < crit_dep_n2) return true;
-    if (crit_dep_n1 > crit_dep_n2) return false;
-    // so: crit_dep_n1 == crit_dep_n2, call this crit_dep
+    // all nodes in reverse topological order for dir, then stably grouped on remaining
+    Vec<Node> order;
+    order.reserve(node_count);
+    if (forward_scheduling == dir) {
+        for (Node n = t + 1; n-- > s; ) {
+            order.push_back(n);
+        }
+    } else {
+        for (Node n = s; n <= t; n++) {
+            order.push_back(n);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](Node n1, Node n2) { return remaining[n1] < remaining[n2]; });
 
-    ln1.remove_if([this,crit_dep_n1](ListDigraph::Node n) { return remaining.at(n) < crit_dep_n1; });
-    ln2.remove_if([this,crit_dep_n2](ListDigraph::Node n) { return remaining.at(n) < crit_dep_n2; });
-    // because both contain element with remaining == crit_dep: ln1.non_empty && ln2.non_empty
+    UInt rank = 0;
+    for (UInt group_begin = 0, group_end; group_begin < node_count; group_begin = group_end) {
+        group_end = group_begin + 1;
+        while (group_end < node_count && remaining[order[group_end]] == remaining[order[group_begin]]) {
+            group_end++;
+        }
 
-    if (ln1.size() < ln2.size()) return true;
-    if (ln1.size() > ln2.size()) return false;
-    // so: ln1.size() == ln2.size() >= 1
+        // find the most deep-critical depending node of each node of the group
+        for (UInt i = group_begin; i < group_end; i++) {
+            Node n = order[i];
+            List<Node> ln;
+            get_depending_nodes(n, dir, ln);
+            for (auto d : ln) {
+                if (crit_dep_count[n] == 0 || remaining[d] > remaining[crit_dep_node[n]]) {
+                    crit_dep_node[n] = d;
+                    crit_dep_count[n] = 1;
+                } else if (remaining[d] == remaining[crit_dep_node[n]]) {
+                    if (lessthan(crit_dep_node[n], d)) {
+                        crit_dep_node[n] = d;
+                    }
+                    crit_dep_count[n]++;
+                }
+            }
+        }
 
-    ln1.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
-    ln2.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
-    return criticality_lessthan(ln1.back(), ln2.back(), dir);
+        // rank the group, giving nodes that are equally deep-critical the same rank
+        std::stable_sort(order.begin() + group_begin, order.begin() + group_end, lessthan);
+        for (UInt i = group_begin; i < group_end; i++) {
+            if (i > group_begin && lessthan(order[i - 1], order[i])) {
+                rank++;
+            }
+            criticality[order[i]] = rank;
+        }
+        for (UInt i = group_begin; i < group_end; i++) {
+            ranked[order[i]] = true;
+        }
+        rank++;
+    }
 }
 
 // Make node n available
@@ -897,105 +1070,78 @@ Bool Scheduler::criticality_lessthan(
 //  all its successors were scheduled (backward scheduling)
 // update its cycle attribute to reflect these dependencies;
 // avlist is initialized with s or t as first element by init_available
-// avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first)
+// avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first);
+// with set_cycle false, the cycle attribute is left alone, so that the gates are not written to at all
 void Scheduler::MakeAvailable(
-    ListDigraph::Node n,
-    List<ListDigraph::Node> &avlist,
-    scheduling_direction_t dir
+    Node n,
+    AvailableList &avlist,
+    scheduling_direction_t dir,
+    Bool set_cycle
 ) {
-    Bool already_in_avlist = false;  // check whether n is already in avlist
-    // originates from having multiple arcs between pair of nodes
-    List<ListDigraph::Node>::iterator first_lower_criticality_inp; // for keeping avlist ordered
-    Bool first_lower_criticality_found = false;                          // for keeping avlist ordered
-
-    QL_DOUT(".... making available node " << name[n] << " remaining: " << remaining.dbg(n));
-    for (auto inp = avlist.begin(); inp != avlist.end(); inp++) {
-        if (*inp == n) {
-            already_in_avlist = true;
-            QL_DOUT("...... duplicate when making available: " << name[n]);
-        } else {
-            // scanning avlist from front to back (avlist is ordered from high to low criticality)
-            // when encountering first node *inp with less criticality,
-            // that is where new node n should be inserted just before,
-            // to keep avlist in desired order
-            //
-            // consequence is that
-            // when a node has same criticality as n, new node n is put after it, as last one of set of same criticality,
-            // so order of calling MakeAvailable (and probably original circuit, and running other scheduler first) matters,
-            // also when all dependency sets (and so remaining values) are identical!
-            if (criticality_lessthan(*inp, n, dir) && !first_lower_criticality_found) {
-                first_lower_criticality_inp = inp;
-                first_lower_criticality_found = true;
-            }
-        }
+    QL_DOUT(".... making available node " << graph.name(n) << " remaining: " << remaining[n]);
+    // n may already be in avlist when there are multiple arcs between a pair of nodes;
+    // when a node has same criticality as n, new node n is put after it, as last one of set of same criticality,
+    // so order of calling MakeAvailable (and probably original circuit, and running other scheduler first) matters,
+    // also when all dependency sets (and so remaining values) are identical!
+    if (avlist.contains(n)) {
+        QL_DOUT("...... duplicate when making available: " << graph.name(n));
+        return;
     }
-    if (!already_in_avlist) {
-        set_cycle_gate(instruction[n], dir);        // for the schedulers to inspect whether gate has completed
-        if (first_lower_criticality_found) {
-            // add n to avlist just before the first with lower criticality
-            avlist.insert(first_lower_criticality_inp, n);
-        } else {
-            // add n to end of avlist, if none found with less criticality
-            avlist.push_back(n);
-        }
-        QL_DOUT("...... made available node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining.dbg(n));
+    if (set_cycle) {
+        set_cycle_gate(n, dir);    // for the schedulers to inspect whether gate has completed
     }
+    avlist.insert(n, criticality[n]);
+    QL_DOUT("...... made available node(@" << graph.instruction(n)->cycle << "): " << graph.name(n) << " remaining: " << remaining[n]);
 }
 
 // take node n out of avlist because it has been scheduled;
-// reflect that the node has been scheduled in the scheduled vector;
 // having scheduled it means that its depending nodes might become available:
 // such a depending node becomes available when all its dependent nodes have been scheduled now
 //
 // i.e. when forward scheduling:
 //   this makes its successor nodes available provided all their predecessors were scheduled;
-//   a successor node which has a predecessor which hasn't been scheduled,
-//   will be checked here at least when that predecessor is scheduled
 // i.e. when backward scheduling:
 //   this makes its predecessor nodes available provided all their successors were scheduled;
-//   a predecessor node which has a successor which hasn't been scheduled,
-//   will be checked here at least when that successor is scheduled
+// pending (see init_pending) counts per node the arcs from/to nodes that haven't been scheduled yet;
+// it is decremented for each arc of n, and a depending node becomes available when its count drops to 0
+//
+// the nodes are made available in the order of their first arc from/to n, also when there are multiple arcs
+// between n and a depending node; since nodes of equal criticality are ordered in avlist by the order
+// in which they were made available, this order is kept by first decrementing for all arcs
+// and only then making the depending nodes available
 //
 // update (through MakeAvailable) the cycle attribute of the nodes made available
 // because from then on that value is compared to the curr_cycle to check
-// whether a node has completed execution and thus is available for scheduling in curr_cycle
+// whether a node has completed execution and thus is available for scheduling in curr_cycle;
+// with set_cycle false, this update is skipped, which allows several threads to walk the same graph
+// with their own avlist and pending vector (see the mapper evaluating alternatives)
 void Scheduler::TakeAvailable(
-    ListDigraph::Node n,
-    List<ListDigraph::Node> &avlist,
-    Map<gate*,Bool> &scheduled,
-    scheduling_direction_t dir
+    Node n,
+    AvailableList &avlist,
+    Vec<UInt> &pending,
+    scheduling_direction_t dir,
+    Bool set_cycle
 ) {
-    scheduled.set(instruction[n]) = true;
     avlist.remove(n);
 
     if (forward_scheduling == dir) {
-        for (ListDigraph::OutArcIt succArc(graph,n); succArc != lemon::INVALID; ++succArc) {
+        for (auto succArc : graph.out_arcs(n)) {
+            pending[graph.target(succArc)]--;
+        }
+        for (auto succArc : graph.out_arcs(n)) {
             auto succNode = graph.target(succArc);
-            Bool schedulable = true;
-            for (ListDigraph::InArcIt predArc(graph,succNode); predArc != lemon::INVALID; ++predArc) {
-                ListDigraph::Node predNode = graph.source(predArc);
-                if (!scheduled.at(instruction[predNode])) {
-                    schedulable = false;
-                    break;
-                }
-            }
-            if (schedulable) {
-                MakeAvailable(succNode, avlist, dir);
+            if (pending[succNode] == 0) {
+                MakeAvailable(succNode, avlist, dir, set_cycle);
             }
         }
     } else {
-        for (ListDigraph::InArcIt predArc(graph,n); predArc != lemon::INVALID; ++predArc) {
+        for (auto predArc : graph.in_arcs(n)) {
+            pending[graph.source(predArc)]--;
+        }
+        for (auto predArc : graph.in_arcs(n)) {
             auto predNode = graph.source(predArc);
-            Bool schedulable = true;
-            for (ListDigraph::OutArcIt succArc(graph,predNode); succArc != lemon::INVALID; ++succArc) {
-                auto succNode = graph.target(succArc);
-                if (!scheduled.at(instruction[succNode])) {
-                    schedulable = false;
-                    break;
-                }
-            }
-            if (schedulable) {
-                MakeAvailable(predNode, avlist, dir);
+            if (pending[predNode] == 0) {
+                MakeAvailable(predNode, avlist, dir, set_cycle);
             }
         }
     }
@@ -1014,19 +1160,59 @@ void Scheduler::AdvanceCurrCycle(scheduling_direction_t dir, UInt &curr_cycle) {
     }
 }
 
+// advance curr_cycle to the first cycle at which a node of the avlist may be schedulable:
+// its dependent gates have completed (its cycle attribute) and its resources may be available;
+// all cycles before it (in the scheduling direction) would be tried in vain and are skipped
+void Scheduler::SkipIdleCycles(
+    const AvailableList &avlist,
+    scheduling_direction_t dir,
+    UInt &curr_cycle,
+    const quantum_platform &platform,
+    arch::resource_manager_t &rm
+) {
+    Bool forward = (forward_scheduling == dir);
+    UInt first_cycle = (forward ? curr_cycle + 1 : curr_cycle - 1);   // the earliest we can advance to
+    UInt next_cycle = (forward ? MAX_CYCLE : 0);
+    for (auto n : avlist) {
+        gate *gp = graph.instruction(n);
+        UInt cycle = (forward ? max(first_cycle, gp->cycle) : min(first_cycle, gp->cycle));
+        if (forward ? cycle >= next_cycle : cycle <= next_cycle) {
+            continue;       // the resources can only make it later
+        }
+        if (uses_resources(n)) {
+            cycle = rm.next_available(cycle, gp, platform);
+        }
+        next_cycle = (forward ? min(next_cycle, cycle) : max(next_cycle, cycle));
+        if (next_cycle == first_cycle) {
+            break;          // cannot get any earlier
+        }
+    }
+    QL_DOUT("... skipping from cycle " << curr_cycle << " to cycle " << next_cycle);
+    curr_cycle = next_cycle;
+}
+
+Bool Scheduler::uses_resources(Node n) const {
+    gate *gp = graph.instruction(n);
+    return n != s
+        && n != t
+        && gp->type() != gate_type_t::__dummy_gate__
+        && gp->type() != gate_type_t::__classical_gate__
+        && gp->type() != gate_type_t::__wait_gate__;
+}
+
 // a gate must wait until all its operand are available, i.e. the gates having computed them have completed,
 // and must wait until all resources required for the gate's execution are available;
 // return true when immediately schedulable
 // when returning false, isres indicates whether resource occupation was the reason or operand completion (for debugging)
 Bool Scheduler::immediately_schedulable(
-    ListDigraph::Node n,
+    Node n,
     scheduling_direction_t dir,
     const UInt curr_cycle,
     const quantum_platform& platform,
     arch::resource_manager_t &rm,
     Bool &isres
 ) {
-    gate *gp = instruction[n];
+    gate *gp = graph.instruction(n);
     isres = true;
     // have dependent gates completed at curr_cycle?
     if (
@@ -1034,12 +1220,7 @@ Bool Scheduler::immediately_schedulable(
         || (backward_scheduling == dir && curr_cycle <= gp->cycle)
         ) {
         // are resources available?
-        if (
-            n == s || n == t
-            || gp->type() == gate_type_t::__dummy_gate__
-            || gp->type() == gate_type_t::__classical_gate__
-            || gp->type() == gate_type_t::__wait_gate__
-            ) {
+        if (!uses_resources(n)) {
             return true;
         }
         if (rm.available(curr_cycle, gp, platform)) {
@@ -1055,8 +1236,8 @@ Bool Scheduler::immediately_schedulable(
 
 // select a node from the avlist
 // the avlist is deep-ordered from high to low criticality (see criticality_lessthan above)
-ListDigraph::Node Scheduler::SelectAvailable(
-    List<ListDigraph::Node> &avlist,
+Node Scheduler::SelectAvailable(
+    AvailableList &avlist,
     scheduling_direction_t dir,
     const UInt curr_cycle,
     const quantum_platform &platform,
@@ -1067,7 +1248,7 @@ ListDigraph::Node Scheduler::SelectAvailable(
 
     QL_DOUT("avlist(@" << curr_cycle << "):");
     for (auto n : avlist) {
-        QL_DOUT("...... node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining.dbg(n));
+        QL_DOUT("...... node(@" << graph.instruction(n)->cycle << "): " << graph.name(n) << " remaining: " << remaining[n]);
     }
 
     // select the first immediately schedulable, if any
@@ -1075,11 +1256,11 @@ ListDigraph::Node Scheduler::SelectAvailable(
     for (auto n : avlist) {
         Bool isres;
         if (immediately_schedulable(n, dir, curr_cycle, platform, rm, isres)) {
-            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " immediately schedulable, remaining=" << remaining.dbg(n) << ", selected");
+            QL_DOUT("... node (@" << graph.instruction(n)->cycle << "): " << graph.name(n) << " immediately schedulable, remaining=" << remaining[n] << ", selected");
             success = true;
             return n;
         } else {
-            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " remaining=" << remaining.dbg(n) << ", waiting for " << (isres ? "resource" : "dependent completion"));
+            QL_DOUT("... node (@" << graph.instruction(n)->cycle << "): " << graph.name(n) << " remaining=" << remaining[n] << ", waiting for " << (isres ? "resource" : "dependent completion"));
         }
     }
 
@@ -1104,48 +1285,48 @@ void Scheduler::schedule(
 ) {
     QL_DOUT("Scheduling " << (forward_scheduling == dir ? "ASAP" : "ALAP") << " with RC ...");
 
-    // scheduled[gp] :=: whether gate *gp has been scheduled, init all false
-    Map<gate*, Bool> scheduled;
+    // pending[n] :=: number of dependences of node n on nodes that haven't been scheduled yet, see init_pending
+    // note that dependency graph is not modified by a scheduler, so it can be reused
+    QL_DOUT("... initialization");
+    Vec<UInt> pending;
+    init_pending(dir, pending);
     // avlist :=: list of schedulable nodes, initially (see below) just s or t
-    List<ListDigraph::Node> avlist;
+    AvailableList avlist;
 
     // initializations for this scheduler
-    // note that dependency graph is not modified by a scheduler, so it can be reused
-    QL_DOUT("... initialization");
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        scheduled.set(instruction[n]) = false;   // none were scheduled, including SOURCE/SINK
-    }
     UInt  curr_cycle;         // current cycle for which instructions are sought
+    UInt  failed_cycles = 0;  // number of consecutive cycles in which no instruction was found
+    set_remaining(dir);         // for each gate, number of cycles until end of schedule, and criticality
     init_available(avlist, dir, curr_cycle);     // first node (SOURCE/SINK) is made available and curr_cycle set
-    set_remaining(dir);         // for each gate, number of cycles until end of schedule
 
     QL_DOUT("... loop over avlist until it is empty");
     while (!avlist.empty()) {
         Bool success;
-        ListDigraph::Node selected_node;
+        Node selected_node;
 
         selected_node = SelectAvailable(avlist, dir, curr_cycle, platform, rm, success);
         if (!success) {
-            // i.e. none from avlist was found suitable to schedule in this cycle
-            AdvanceCurrCycle(dir, curr_cycle);
+            // i.e. none from avlist was found suitable to schedule in this cycle;
+            // usually one will be in the next cycle, but when also not then,
+            // the scheduler is waiting for a long-duration gate and skips ahead
+            if (failed_cycles++ == 0) {
+                AdvanceCurrCycle(dir, curr_cycle);
+            } else {
+                SkipIdleCycles(avlist, dir, curr_cycle, platform, rm);
+            }
             // so try again; eventually instrs complete and machine is empty
             continue;
         }
+        failed_cycles = 0;
 
         // commit selected_node to the schedule
-        gate* gp = instruction[selected_node];
+        gate* gp = graph.instruction(selected_node);
         QL_DOUT("... selected " << gp->qasm() << " in cycle " << curr_cycle);
         gp->cycle = curr_cycle;                     // scheduler result, including s and t
-        if (
-            selected_node != s
-            && selected_node != t
-            && gp->type() != gate_type_t::__dummy_gate__
-            && gp->type() != gate_type_t::__classical_gate__
-            && gp->type() != gate_type_t::__wait_gate__
-            ) {
+        if (uses_resources(selected_node)) {
             rm.reserve(curr_cycle, gp, platform);
         }
-        TakeAvailable(selected_node, avlist, scheduled, dir);   // update avlist/scheduled/cycle
+        TakeAvailable(selected_node, avlist, pending, dir);     // update avlist/pending/cycle
         // more nodes that could be scheduled in this cycle, will be found in an other round of the loop
     }
 
@@ -1154,14 +1335,14 @@ void Scheduler::schedule(
 
     if (dir == backward_scheduling) {
         // readjust cycle values of gates so that SOURCE is at 0
-        UInt SOURCECycle = instruction[s]->cycle;
+        UInt SOURCECycle = graph.instruction(s)->cycle;
         QL_DOUT("... readjusting cycle values by -" << SOURCECycle);
 
-        instruction[t]->cycle -= SOURCECycle;
+        graph.instruction(t)->cycle -= SOURCECycle;
         for (auto & gp : *circp) {
             gp->cycle -= SOURCECycle;
         }
-        instruction[s]->cycle -= SOURCECycle;   // i.e. becomes 0
+        graph.instruction(s)->cycle -= SOURCECycle;   // i.e. becomes 0
     }
     // FIXME HvS cycles_valid now
 
@@ -1227,7 +1408,7 @@ void Scheduler::schedule_alap_uniform() {
     // SOURCE (node s) is at cycle 0 and the first circuit's gates are at cycle 1.
     // SINK (node t) is at the earliest cycle that all gates/operations have completed.
     set_cycle(forward_scheduling);
-    UInt cycle_count = instruction[t]->cycle - 1;
+    UInt cycle_count = graph.instruction(t)->cycle - 1;
     // so SOURCE at cycle 0, then all circuit's gates at cycles 1 to cycle_count, and finally SINK at cycle cycle_count+1
 
     // compute remaining which is the opposite of the alap cycle value (remaining[node] :=: SINK->cycle - alapcycle[node])
@@ -1304,15 +1485,15 @@ void Scheduler::schedule_alap_uniform() {
             QL_DOUT("pred_cycle=" << pred_cycle);
             QL_DOUT("gates_per_cycle[curr_cycle].size()=" << gates_per_cycle.get(curr_cycle).size());
             UInt min_remaining_cycle = MAX_CYCLE;
-            gate *best_predgp;
+            gate *best_predgp = nullptr;
             Bool best_predgp_found = false;
 
             // scan bundle at pred_cycle to find suitable candidate to move forward to curr_cycle
             for (auto predgp : gates_per_cycle.get(pred_cycle)) {
                 Bool forward_predgp = true;
                 UInt predgp_completion_cycle;
-                ListDigraph::Node pred_node = node.at(predgp);
-                QL_DOUT("... considering: " << predgp->qasm() << " @cycle=" << predgp->cycle << " remaining=" << remaining.dbg(pred_node));
+                Node pred_node = graph.node_of(predgp);
+                QL_DOUT("... considering: " << predgp->qasm() << " @cycle=" << predgp->cycle << " remaining=" << remaining[pred_node]);
 
                 // candidate's result, when moved, must be ready before end-of-circuit and before used
                 predgp_completion_cycle = curr_cycle + UInt(ceil(static_cast<Real>(predgp->duration)/cycle_time));
@@ -1321,8 +1502,8 @@ void Scheduler::schedule_alap_uniform() {
                     forward_predgp = false;
                     QL_DOUT("... ... rejected (after circuit): " << predgp->qasm() << " would complete @" << predgp_completion_cycle << " SINK @" << cycle_count + 1);
                 } else {
-                    for (ListDigraph::OutArcIt arc(graph,pred_node); arc != lemon::INVALID; ++arc) {
-                        gate *target_gp = instruction[graph.target(arc)];
+                    for (auto arc : graph.out_arcs(pred_node)) {
+                        gate *target_gp = graph.instruction(graph.target(arc));
                         UInt target_cycle = target_gp->cycle;
                         if (predgp_completion_cycle > target_cycle) {
                             forward_predgp = false;
@@ -1333,8 +1514,8 @@ void Scheduler::schedule_alap_uniform() {
 
                 // when multiple nodes in bundle qualify, take the one with lowest remaining
                 // because that is the most critical one and thus deserves a cycle as high as possible (ALAP)
-                if (forward_predgp && remaining.at(pred_node) < min_remaining_cycle) {
-                    min_remaining_cycle = remaining.at(pred_node);
+                if (forward_predgp && remaining[pred_node] < min_remaining_cycle) {
+                    min_remaining_cycle = remaining[pred_node];
                     best_predgp_found = true;
                     best_predgp = predgp;
                 }
@@ -1361,7 +1542,7 @@ void Scheduler::schedule_alap_uniform() {
                 if (non_empty_bundle_count == 0) break;     // nothing to do
                 avg_gates_per_cycle = Real(gate_count)/curr_cycle;
                 avg_gates_per_non_empty_cycle = Real(gate_count)/non_empty_bundle_count;
-                QL_DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining.dbg(node.at(best_predgp))
+                QL_DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining[graph.node_of(best_predgp)]
                                      << " from cycle=" << pred_cycle << " to cycle=" << curr_cycle
                                      << "; new avg_gates_per_cycle=" << avg_gates_per_cycle
                                      << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
@@ -1419,33 +1600,19 @@ void Scheduler::get_dot(
     std::ostream &dotout
 ) {
     QL_DOUT("Get_dot");
-    ListDigraphPath p;
-    ListDigraph::ArcMap<Bool> isInCritical{graph};
-    if (WithCritical) {
-        for (ListDigraph::ArcIt a(graph); a != lemon::INVALID; ++a) {
-            isInCritical[a] = false;
-            for (ListDigraphPath::ArcIt ap(p); ap != lemon::INVALID; ++ap) {
-                if (a == ap) {
-                    isInCritical[a] = true;
-                    break;
-                }
-            }
-        }
-    }
-
+    // no critical path is computed (yet), so with or without WithCritical all edges get the same style
+    (void)WithCritical;
     Str NodeStyle(" fontcolor=black, style=filled, fontsize=16");
-    Str EdgeStyle1(" color=black");
-    Str EdgeStyle2(" color=red");
-    Str EdgeStyle = EdgeStyle1;
+    Str EdgeStyle(" color=black");
 
     dotout << "digraph {\ngraph [ rankdir=TD; ]; // or rankdir=LR"
            << "\nedge [fontsize=16, arrowhead=vee, arrowsize=0.5];"
            << std::endl;
 
-    // first print the nodes
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        dotout  << "\"" << graph.id(n) << "\""
-                << " [label=\" " << name[n] <<" \""
+    // first print the nodes, most recently created first
+    for (Node n = graph.node_count(); n-- > 0; ) {
+        dotout  << "\"" << n << "\""
+                << " [label=\" " << graph.name(n) <<" \""
                 << NodeStyle
                 << "];" << std::endl;
     }
@@ -1469,36 +1636,29 @@ void Scheduler::get_dot(
         dotout << ";\n}\n";
 
         // Now print ranks, as shown below
-        dotout << "{ rank=same; Cycle" << instruction[s]->cycle <<"; " << graph.id(s) << "; }\n";
+        dotout << "{ rank=same; Cycle" << graph.instruction(s)->cycle <<"; " << s << "; }\n";
         for (auto gp : *circp) {
-            dotout << "{ rank=same; Cycle" << gp->cycle <<"; " << graph.id(node.at(gp)) << "; }\n";
+            dotout << "{ rank=same; Cycle" << gp->cycle <<"; " << graph.node_of(gp) << "; }\n";
         }
-        dotout << "{ rank=same; Cycle" << instruction[t]->cycle <<"; " << graph.id(t) << "; }\n";
+        dotout << "{ rank=same; Cycle" << graph.instruction(t)->cycle <<"; " << t << "; }\n";
     }
 
-    // now print the edges
-    for (ListDigraph::ArcIt arc(graph); arc != lemon::INVALID; ++arc) {
-        auto srcNode = graph.source(arc);
-        auto dstNode = graph.target(arc);
-        Int srcID = graph.id( srcNode );
-        Int dstID = graph.id( dstNode );
-
-        if (WithCritical) {
-            EdgeStyle = (isInCritical[arc] == true) ? EdgeStyle2 : EdgeStyle1;
+    // now print the edges, per source node in the order the nodes were printed
+    for (Node srcNode = graph.node_count(); srcNode-- > 0; ) {
+        for (auto arc : graph.out_arcs(srcNode)) {
+            dotout << std::dec
+                   << "\"" << srcNode << "\""
+                   << "->"
+                   << "\"" << graph.target(arc) << "\""
+                   << "[ label=\""
+                   << "q" << graph.cause(arc)
+                   << " , " << graph.weight(arc)
+                   << " , " << DepTypesNames[ graph.dep_type(arc) ]
+                   <<"\""
+                   << " " << EdgeStyle << " "
+                   << "]"
+                   << std::endl;
         }
-
-        dotout << std::dec
-               << "\"" << srcID << "\""
-               << "->"
-               << "\"" << dstID << "\""
-               << "[ label=\""
-               << "q" << cause[arc]
-               << " , " << weight[arc]
-               << " , " << DepTypesNames[ depType[arc] ]
-               <<"\""
-               << " " << EdgeStyle << " "
-               << "]"
-               << std::endl;
     }
 
     dotout << "}" << std::endl;
@@ -1559,7 +1719,7 @@ void schedule(
         report_qasm(programp, platform, "in", passname);
 
         QL_IOUT("scheduling the quantum program");
-        for (auto &k : programp->kernels) {
+        for_each_kernel(programp, [&](quantum_kernel &k, UInt) {
             Str dot;
             Str kernel_sched_dot;
             schedule_kernel(k, platform, dot, kernel_sched_dot);
@@ -1575,7 +1735,7 @@ void schedule(
                 QL_IOUT("writing scheduled dot to '" << fname << "' ...");
                 OutFile(fname).write(kernel_sched_dot);
             }
-        }
+        });
 
         report_statistics(programp, platform, "out", passname, "# ");
         report_qasm(programp, platform, "out", passname);
@@ -1623,7 +1783,7 @@ void rcschedule(
     report_statistics(programp, platform, "in", passname, "# ");
     report_qasm(programp, platform, "in", passname);
 
-    for (auto &kernel : programp->kernels) {
+    for_each_kernel(programp, [&](quantum_kernel &kernel, UInt) {
         QL_IOUT("Scheduling kernel: " << kernel.name);
         if (!kernel.c.empty()) {
             auto num_creg = kernel.creg_count;
@@ -1640,7 +1800,7 @@ void rcschedule(
                 OutFile(fname.str()).write(sched_dot);
             }
         }
-    }
+    });
 
     report_statistics(programp, platform, "out", passname, "# ");
     report_qasm(programp, platform, "out", passname);
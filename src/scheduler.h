@@ -12,11 +12,8 @@
 #include "utils/list.h"
 #include "utils/map.h"
 
-#include <lemon/list_graph.h>
-#include <lemon/lgf_reader.h>
-#include <lemon/lgf_writer.h>
-#include <lemon/dijkstra.h>
-#include <lemon/connectivity.h>
+#include "utils/vec.h"
+#include "utils/pair.h"
 
 #include "options.h"
 #include "gate.h"
@@ -32,24 +29,163 @@ namespace ql {
 enum DepTypes {RAW, WAW, WAR, RAR, RAD, DAR, DAD, WAD, DAW};
 const utils::Str DepTypesNames[] = {"RAW", "WAW", "WAR", "RAR", "RAD", "DAR", "DAD", "WAD", "DAW"};
 
+/**
+ * Compact, immutable dependence graph.
+ *
+ * Nodes are dense indices in circuit order: node 0 is the SOURCE, then follow
+ * the gates of the circuit in the order they had when the graph was built, and
+ * the last node is the SINK. Because the circuit is in a topological order of
+ * the graph, so is this node numbering. Arcs are stored in insertion order in
+ * flat arrays, and the forward and reverse adjacency of the nodes is kept in
+ * CSR (compressed sparse row) form.
+ *
+ * Within the adjacency of a node, arcs are listed from most to least recently
+ * added. This is the order in which the lemon::ListDigraph that was used
+ * before enumerated them; the list schedulers break ties in the order in which
+ * nodes become available, so their results depend on it.
+ *
+ * The graph is built with add_node() and add_arc() and then frozen by
+ * finalize(); the adjacency and node lookup queries are only valid after that.
+ */
+class DepGraph {
+public:
+    typedef utils::UInt Node;
+    typedef utils::UInt Arc;
+
+    // range of arcs in the adjacency of a node, for use in range-based for
+    class ArcRange {
+    public:
+        class const_iterator {
+        public:
+            const_iterator(const utils::Vec<Arc> &arcs, utils::UInt index) : arcs(&arcs), index(index) {}
+            Arc operator*() const { return (*arcs)[index]; }
+            const_iterator &operator++() { index++; return *this; }
+            utils::Bool operator!=(const const_iterator &other) const { return index != other.index; }
+        private:
+            const utils::Vec<Arc> *arcs;
+            utils::UInt index;
+        };
+
+        ArcRange(const utils::Vec<Arc> &arcs, utils::UInt first, utils::UInt last) : arcs(arcs), first(first), last(last) {}
+        const_iterator begin() const { return const_iterator(arcs, first); }
+        const_iterator end() const { return const_iterator(arcs, last); }
+        utils::UInt size() const { return last - first; }
+        utils::Bool empty() const { return first == last; }
+
+    private:
+        const utils::Vec<Arc> &arcs;
+        utils::UInt first;
+        utils::UInt last;
+    };
+
+    // construction; node and arc indices are handed out consecutively from 0
+    Node add_node(gate *gp);
+    Arc add_arc(Node from, Node to, utils::Int weight, utils::Int cause, DepTypes deptype);
+    void finalize();
+    void clear();
+
+    utils::UInt node_count() const { return instructions.size(); }
+    utils::UInt arc_count() const { return arc_sources.size(); }
+
+    // node attributes
+    gate *instruction(Node n) const { return instructions[n]; }
+    utils::Str name(Node n) const;      // qasm string of the node's gate, computed on demand
+    Node node_of(const gate *gp) const; // node of a gate of the circuit, by binary search
+
+    // arc attributes
+    Node source(Arc a) const { return arc_sources[a]; }
+    Node target(Arc a) const { return arc_targets[a]; }
+    utils::Int weight(Arc a) const { return arc_weights[a]; }      // number of cycles of dependence
+    utils::Int cause(Arc a) const { return arc_causes[a]; }        // qubit/creg/breg index of dependence
+    DepTypes dep_type(Arc a) const { return arc_dep_types[a]; }    // RAW, WAW, ...
+
+    // adjacency
+    ArcRange out_arcs(Node n) const { return ArcRange(out_list, out_index[n], out_index[n+1]); }
+    ArcRange in_arcs(Node n) const { return ArcRange(in_list, in_index[n], in_index[n+1]); }
+
+private:
+    utils::Vec<gate*> instructions;             // instructions[n] == gate*
+
+    utils::Vec<Node> arc_sources;
+    utils::Vec<Node> arc_targets;
+    utils::Vec<utils::Int> arc_weights;
+    utils::Vec<utils::Int> arc_causes;
+    utils::Vec<DepTypes> arc_dep_types;
+
+    // CSR adjacency: the out-arcs of node n are out_list[out_index[n]] .. out_list[out_index[n+1]-1]
+    utils::Vec<utils::UInt> out_index;
+    utils::Vec<Arc> out_list;
+    utils::Vec<utils::UInt> in_index;
+    utils::Vec<Arc> in_list;
+
+    // (gate*, node) pairs sorted on gate*, for node_of
+    utils::Vec<utils::Pair<const gate*, Node>> gate_nodes;
+};
+
+/**
+ * Available list (avlist) of the list schedulers: the nodes that are available
+ * for scheduling, ordered on criticality rank from high to low and, among nodes
+ * of equal rank, in the order in which they were made available.
+ *
+ * The position of a node follows from its precomputed rank (see
+ * Scheduler::set_criticality), so insertion and removal take logarithmic time
+ * and need no comparisons of the nodes' dependences.
+ */
+class AvailableList {
+private:
+    // key of a node: its rank and the number of nodes inserted before it
+    typedef utils::Pair<utils::UInt, utils::UInt> Key;
+
+    // orders keys on rank non-increasing, then on insertion non-decreasing
+    struct KeyOrder {
+        utils::Bool operator()(const Key &k1, const Key &k2) const {
+            return k1.first > k2.first || (k1.first == k2.first && k1.second < k2.second);
+        }
+    };
+
+    utils::Map<Key, DepGraph::Node, KeyOrder> nodes; // the available nodes, in avlist order
+    utils::Map<DepGraph::Node, Key> keys;           // the key of each available node
+    utils::UInt insertions = 0;                     // number of insertions so far
+
+public:
+    // iterates over the available nodes in avlist order
+    class const_iterator {
+    public:
+        typedef utils::Map<Key, DepGraph::Node, KeyOrder>::const_iterator Iter;
+        explicit const_iterator(Iter it) : it(it) {}
+        DepGraph::Node operator*() const { return it->second; }
+        const_iterator &operator++() { ++it; return *this; }
+        utils::Bool operator==(const const_iterator &other) const { return it == other.it; }
+        utils::Bool operator!=(const const_iterator &other) const { return it != other.it; }
+    private:
+        Iter it;
+    };
+
+    const_iterator begin() const { return const_iterator(nodes.begin()); }
+    const_iterator end() const { return const_iterator(nodes.end()); }
+    utils::Bool empty() const { return nodes.empty(); }
+    utils::UInt size() const { return nodes.size(); }
+    utils::Bool contains(DepGraph::Node n) const { return keys.find(n) != keys.end(); }
+
+    void clear();
+
+    // add n with the given rank after all available nodes of the same or higher rank;
+    // returns false and does nothing when n is already available
+    utils::Bool insert(DepGraph::Node n, utils::UInt rank);
+
+    // take n out; it must be available
+    void remove(DepGraph::Node n);
+};
+
 class Scheduler {
 public:
     // dependence graph is constructed (see Init) once from the sequence of gates in a kernel's circuit
     // it can be reused as often as needed as long as no gates are added/deleted; it doesn't modify those gates
-    lemon::ListDigraph graph;
-
-    // conversion between gate* (pointer to the gate in the circuit) and node (of the dependence graph)
-    lemon::ListDigraph::NodeMap<gate*> instruction;// instruction[n] == gate*
-    utils::Map<gate*, lemon::ListDigraph::Node>  node;// node[gate*] == n
-
-    // attributes
-    lemon::ListDigraph::NodeMap<utils::Str> name;     // name[n] == qasm string
-    lemon::ListDigraph::ArcMap<utils::Int> weight;    // number of cycles of dependence
-    lemon::ListDigraph::ArcMap<utils::Int> cause;     // qubit/creg/breg index of dependence
-    lemon::ListDigraph::ArcMap<utils::Int> depType;   // RAW, WAW, ...
+    DepGraph graph;
 
     // s and t nodes are the top and bottom of the dependence graph
-    lemon::ListDigraph::Node s, t;                     // instruction[s]==SOURCE, instruction[t]==SINK
+    DepGraph::Node s, t;                     // graph.instruction(s)==SOURCE, graph.instruction(t)==SINK
+    std::shared_ptr<gate> source_gate, sink_gate;   // own the SOURCE and SINK gates; shared by copies of the scheduler
 
     // parameters of dependence graph construction
     utils::UInt cycle_time;     // to convert durations to cycles as weight of dependence
@@ -59,7 +195,8 @@ public:
     circuit *circp;             // current and result circuit, passed from Init to each scheduler
 
     // scheduler support
-    utils::Map<lemon::ListDigraph::Node, utils::UInt>  remaining;  // remaining[node] == cycles until end; critical path representation
+    utils::Vec<utils::UInt> remaining;  // remaining[node] == cycles until end; critical path representation
+    utils::Vec<utils::UInt> criticality; // criticality[node] == rank of node in deep-criticality; see set_criticality
 
 public:
     Scheduler();
@@ -69,7 +206,7 @@ public:
 
     // factored out code from Init to add a dependence between two nodes
     // operand is in qubit_creg_breg combined index space with size qcount+ccount+bcount
-    void add_dep(utils::Int fromID, utils::Int toID, enum DepTypes deptype, utils::UInt comboperand);
+    void add_dep(DepGraph::Node fromID, DepGraph::Node toID, enum DepTypes deptype, utils::UInt comboperand);
 
     // fill the dependence graph ('graph') with nodes from the circuit and adding arcs for their dependences
     void init(
@@ -124,9 +261,9 @@ public:
 
     // cycle assignment without RC depending on direction: forward:ASAP, backward:ALAP;
     // without RC, this is all there is to schedule, apart from forming the bundles in ir::bundler()
-    // set_cycle iterates over the circuit's gates and set_cycle_gate over the dependences of each gate
-    // please note that set_cycle_gate expects a caller like set_cycle which iterates gp forward through the circuit
-    void set_cycle_gate(gate *gp, scheduling_direction_t dir);
+    // set_cycle iterates over the graph's nodes and set_cycle_gate over the dependences of each node
+    // please note that set_cycle_gate expects a caller like set_cycle which iterates n forward (backward) over the nodes
+    void set_cycle_gate(DepGraph::Node n, scheduling_direction_t dir);
     void set_cycle(scheduling_direction_t dir);
 
     // sort circuit by the gates' cycle attribute in non-decreasing order
@@ -162,8 +299,9 @@ public:
     // This means that criticality has become independent of the direction of scheduling
     // which is easier in the core of the scheduler.
 
-    // Note that set_remaining_gate expects a caller like set_remaining that iterates gp backward over the circuit
-    void set_remaining_gate(gate* gp, scheduling_direction_t dir);
+    // Note that set_remaining_gate expects a caller like set_remaining that iterates n backward (forward) over the nodes
+    // set_remaining also computes the criticality ranks for the same direction (see set_criticality)
+    void set_remaining_gate(DepGraph::Node n, scheduling_direction_t dir);
     void set_remaining(scheduling_direction_t dir);
     gate* find_mostcritical(utils::List<gate*>& lg);
 
@@ -186,32 +324,58 @@ public:
 
     // Set the curr_cycle of the scheduling algorithm to start at the appropriate end as well;
     // note that the cycle attributes will be shifted down to start at 1 after backward scheduling.
+    // set_remaining must have been called for the direction before, to provide the criticality ranks.
     void init_available(
-        utils::List<lemon::ListDigraph::Node> &avlist,
+        AvailableList &avlist,
         scheduling_direction_t dir,
         utils::UInt &curr_cycle
     );
 
+    // Initialize pending[n] for all nodes n to the number of dependences that block n from becoming available:
+    // when forward scheduling:
+    //  the number of in-arcs of n, i.e. one for each arc from a predecessor
+    // when backward scheduling:
+    //  the number of out-arcs of n, i.e. one for each arc to a successor
+    // TakeAvailable decrements these counters and makes a node available when its counter drops to 0.
+    void init_pending(
+        scheduling_direction_t dir,
+        utils::Vec<utils::UInt> &pending
+    );
+
     // collect the list of directly depending nodes
     // (i.e. those necessarily scheduled after the given node) without duplicates;
     // dependences that are duplicates from the perspective of the scheduler
     // may be present in the dependence graph because the scheduler ignores dependence type and cause
     void get_depending_nodes(
-        lemon::ListDigraph::Node n,
+        DepGraph::Node n,
         scheduling_direction_t dir,
-        utils::List<lemon::ListDigraph::Node> &ln
+        utils::List<DepGraph::Node> &ln
     );
 
     // Compute of two nodes whether the first one is less deep-critical than the second, for the given scheduling direction;
     // criticality of a node is given by its remaining[node] value which is precomputed;
     // deep-criticality takes into account the criticality of depending nodes (in the right direction!);
-    // this function is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
+    // this defines the order of the avlist, from highest deep-criticality to lowest deep-criticality;
     // it is the core of the heuristics of the critical path list scheduler.
+    // Deep-criticality is precomputed by set_remaining as a rank per node, so this is a comparison of ranks.
     utils::Bool criticality_lessthan(
-        lemon::ListDigraph::Node n1,
-        lemon::ListDigraph::Node n2,
-        scheduling_direction_t dir
-    );
+        DepGraph::Node n1,
+        DepGraph::Node n2
+    ) const;
+
+    // Compute criticality[n] for all nodes n, for the given scheduling direction, such that
+    // n1 is less deep-critical than n2 iff criticality[n1] < criticality[n2].
+    //
+    // n1 is less deep-critical than n2 when remaining[n1] < remaining[n2];
+    // when equal, when n1 has no depending nodes and n2 has;
+    // when both have, when the highest remaining of n1's depending nodes is less than that of n2's;
+    // when equal, when fewer depending nodes of n1 have that highest remaining value than of n2's;
+    // when equal, when the most deep-critical of those of n1 is less deep-critical than the one of n2.
+    // So deep-criticality of a node is given by the sequence of these values along a chain of most
+    // deep-critical depending nodes. The ranks are assigned in order of increasing remaining value;
+    // within a group of equal remaining, the chains are compared until they reach nodes with a lower
+    // remaining value, which have been ranked already.
+    void set_criticality(scheduling_direction_t dir);
 
     // Make node n available
     // add it to the avlist because the condition for that is fulfilled:
@@ -219,35 +383,39 @@ public:
     //  all its successors were scheduled (backward scheduling)
     // update its cycle attribute to reflect these dependences;
     // avlist is initialized with s or t as first element by init_available
-    // avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first)
+    // avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first);
+    // a node with the same deep-criticality as nodes already in avlist is put after those
+    // with set_cycle false, the cycle attribute is left alone, so that the gates are not written to at all
     void MakeAvailable(
-        lemon::ListDigraph::Node n,
-        utils::List<lemon::ListDigraph::Node> &avlist,
-        scheduling_direction_t dir
+        DepGraph::Node n,
+        AvailableList &avlist,
+        scheduling_direction_t dir,
+        utils::Bool set_cycle = true
     );
 
     // take node n out of avlist because it has been scheduled;
-    // reflect that the node has been scheduled in the scheduled vector;
     // having scheduled it means that its depending nodes might become available:
     // such a depending node becomes available when all its dependent nodes have been scheduled now
     //
     // i.e. when forward scheduling:
     //   this makes its successor nodes available provided all their predecessors were scheduled;
-    //   a successor node which has a predecessor which hasn't been scheduled,
-    //   will be checked here at least when that predecessor is scheduled
     // i.e. when backward scheduling:
     //   this makes its predecessor nodes available provided all their successors were scheduled;
-    //   a predecessor node which has a successor which hasn't been scheduled,
-    //   will be checked here at least when that successor is scheduled
+    // pending (see init_pending) counts per node the arcs from/to nodes that haven't been scheduled yet;
+    // it is decremented for each arc of n, and a depending node becomes available when its count drops to 0,
+    // so readiness is found in constant time per arc instead of by rescanning the arcs of the depending node
     //
     // update (through MakeAvailable) the cycle attribute of the nodes made available
     // because from then on that value is compared to the curr_cycle to check
-    // whether a node has completed execution and thus is available for scheduling in curr_cycle
+    // whether a node has completed execution and thus is available for scheduling in curr_cycle;
+    // with set_cycle false, this update is skipped, which allows several threads to walk the same graph
+    // with their own avlist and pending vector (see the mapper evaluating alternatives)
     void TakeAvailable(
-        lemon::ListDigraph::Node n,
-        utils::List<lemon::ListDigraph::Node> &avlist,
-        utils::Map<gate*,utils::Bool> &scheduled,
-        scheduling_direction_t dir
+        DepGraph::Node n,
+        AvailableList &avlist,
+        utils::Vec<utils::UInt> &pending,
+        scheduling_direction_t dir,
+        utils::Bool set_cycle = true
     );
 
     // advance curr_cycle
@@ -257,12 +425,30 @@ public:
     // so it contributes to proceeding and to finally have an empty avlist
     static void AdvanceCurrCycle(scheduling_direction_t dir, utils::UInt &curr_cycle);
 
+    // advance curr_cycle over the cycles in which no node of the avlist can become schedulable,
+    // i.e. to the first cycle at which a node may have its dependent gates completed
+    // and its resources available (see resource_manager_t::next_available);
+    // with long-duration gates, this avoids trying all the cycles in which the scheduler would only be waiting;
+    // since no node is skipped that would have been schedulable in one of the skipped cycles,
+    // the resulting schedule is the same as when advancing one cycle at a time
+    void SkipIdleCycles(
+        const AvailableList &avlist,
+        scheduling_direction_t dir,
+        utils::UInt &curr_cycle,
+        const quantum_platform &platform,
+        arch::resource_manager_t &rm
+    );
+
+    // whether node n needs resources to execute, i.e. is a real instruction and not s, t, a dummy,
+    // classical or wait gate; only such nodes are checked against and reserve resources
+    utils::Bool uses_resources(DepGraph::Node n) const;
+
     // a gate must wait until all its operand are available, i.e. the gates having computed them have completed,
     // and must wait until all resources required for the gate's execution are available;
     // return true when immediately schedulable
     // when returning false, isres indicates whether resource occupation was the reason or operand completion (for debugging)
     utils::Bool immediately_schedulable(
-        lemon::ListDigraph::Node n,
+        DepGraph::Node n,
         scheduling_direction_t dir,
         const utils::UInt curr_cycle,
         const quantum_platform& platform,
@@ -272,8 +458,8 @@ public:
 
     // select a node from the avlist
     // the avlist is deep-ordered from high to low criticality (see criticality_lessthan above)
-    lemon::ListDigraph::Node SelectAvailable(
-        utils::List<lemon::ListDigraph::Node> &avlist,
+    DepGraph::Node SelectAvailable(
+        AvailableList &avlist,
         scheduling_direction_t dir,
         const utils::UInt curr_cycle,
         const quantum_platform &platform,
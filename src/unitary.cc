@@ -5,6 +5,9 @@
 #include "unitary.h"
 
 #include "utils/exception.h"
+#include "utils/map.h"
+#include "utils/thread_pool.h"
+#include "options.h"
 
 #ifndef WITHOUT_UNITARY_DECOMPOSITION
 #include <Eigen/MatrixFunctions>
@@ -15,6 +18,14 @@
 #endif
 
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 namespace ql {
 
@@ -113,7 +124,7 @@ public:
         return _matrix;
     }
 
-    void decompose() {
+    void decompose(UInt num_workers = 1) {
         QL_DOUT("decomposing Unitary: " << name);
 
         getMatrix();
@@ -131,10 +142,17 @@ public:
 
             throw utils::Exception("Error: Unitary '"+ name+"' is not a unitary matrix. Cannot be decomposed!" + to_string(matmatadjoint), false);
         }
-        // initialize the general M^k lookuptable
-        genMk();
+        //needed because the matrix is read in columnmajor
+        if (num_workers > 1) {
+            decomp_parallel(_matrix, numberofbits, num_workers);
+        } else {
+            decomp_function(_matrix, numberofbits, instructionlist, nullptr);
+        }
 
-        decomp_function(_matrix, numberofbits); //needed because the matrix is read in columnmajor
+        // the angles of the last zyz decomposition are the last instructions
+        gamma = -instructionlist[instructionlist.size()-3];
+        beta = -instructionlist[instructionlist.size()-2];
+        alpha = -instructionlist[instructionlist.size()-1];
 
         QL_DOUT("Done decomposing");
         is_decomposed = true;
@@ -157,10 +175,25 @@ public:
     // std::chrono::duration<Real> multiplexing_time;
     // std::chrono::duration<Real> demultiplexing_time;
 
-    void decomp_function(const Eigen::Ref<const complex_matrix>& matrix, Int numberofbits) {
+    // A subproblem of the decomposition: a matrix that is decomposed separately,
+    // and whose instructions are then inserted into those of its parent at the
+    // given position.
+    struct Subproblem {
+        complex_matrix matrix;
+        Int numberofbits;
+        UInt position;
+        Vec<Real> instructions;
+        Vec<Subproblem> subproblems;
+    };
+
+    // Decomposes the matrix, appending the instructions to out. When
+    // subproblems is nullptr, the two halves produced by demultiplexing are
+    // decomposed recursively in place. Otherwise they are only added to
+    // subproblems, to be decomposed later and independently of each other.
+    void decomp_function(const Eigen::Ref<const complex_matrix>& matrix, Int numberofbits, Vec<Real> &out, Vec<Subproblem> *subproblems) {
         QL_DOUT("decomp_function: \n" << to_string(matrix));
         if(numberofbits == 1) {
-            zyz_decomp(matrix);
+            zyz_decomp(matrix, out);
         } else {
             Int n = matrix.rows()/2;
 
@@ -170,17 +203,17 @@ public:
             // if q2 is zero, the whole thing is a demultiplexing problem instead of full CSD
             if (matrix.bottomLeftCorner(n,n).isZero(10e-14) && matrix.topRightCorner(n,n).isZero(10e-14)) {
                 QL_DOUT("Optimization: q2 is zero, only demultiplexing will be performed.");
-                instructionlist.push_back(200.0);
+                out.push_back(200.0);
                 if (matrix.topLeftCorner(n, n).isApprox(matrix.bottomRightCorner(n,n),10e-4)) {
                     QL_DOUT("Optimization: Unitaries are equal, skip one step in the recursion for unitaries of size: " << n << " They are both: " << matrix.topLeftCorner(n, n));
-                    instructionlist.push_back(300.0);
-                    decomp_function(matrix.topLeftCorner(n, n), numberofbits-1);
+                    out.push_back(300.0);
+                    decomp_function(matrix.topLeftCorner(n, n), numberofbits-1, out, subproblems);
                 } else {
                     demultiplexing(matrix.topLeftCorner(n, n), matrix.bottomRightCorner(n,n), V, D, W, numberofbits-1);
 
-                    decomp_function(W, numberofbits-1);
-                    multicontrolledZ(D, D.rows());
-                    decomp_function(V, numberofbits-1);
+                    decomp_half(W, numberofbits-1, out, subproblems);
+                    multicontrolledZ(D, D.rows(), out);
+                    decomp_half(V, numberofbits-1, out, subproblems);
                 }
             } else if (
                 // Check to see if it the kronecker product of a bigger matrix and the identity matrix.
@@ -193,8 +226,8 @@ public:
             ) {
                 QL_DOUT("Optimization: last qubit is not affected, skip one step in the recursion.");
                 // Code for last qubit not affected
-                instructionlist.push_back(100.0);
-                decomp_function(matrix(Eigen::seqN(0, n, 2), Eigen::seqN(0, n, 2)), numberofbits-1);
+                out.push_back(100.0);
+                decomp_function(matrix(Eigen::seqN(0, n, 2), Eigen::seqN(0, n, 2)), numberofbits-1, out, subproblems);
             } else {
                 complex_matrix ss(n,n);
                 complex_matrix L0(n,n);
@@ -205,20 +238,73 @@ public:
                 CSD(matrix, L0, L1, R0, R1, ss);
                 // CSD_time += (std::chrono::steady_clock::now() - start);
                 demultiplexing(R0, R1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+                decomp_half(W, numberofbits-1, out, subproblems);
+                multicontrolledZ(D, D.rows(), out);
+                decomp_half(V, numberofbits-1, out, subproblems);
 
-                multicontrolledY(ss.diagonal(), n);
+                multicontrolledY(ss.diagonal(), n, out);
 
                 demultiplexing(L0, L1, V, D, W, numberofbits-1);
-                decomp_function(W, numberofbits-1);
-                multicontrolledZ(D, D.rows());
-                decomp_function(V, numberofbits-1);
+                decomp_half(W, numberofbits-1, out, subproblems);
+                multicontrolledZ(D, D.rows(), out);
+                decomp_half(V, numberofbits-1, out, subproblems);
             }
         }
     }
 
+    // Decomposes one of the halves produced by demultiplexing, now or later.
+    void decomp_half(const complex_matrix &matrix, Int numberofbits, Vec<Real> &out, Vec<Subproblem> *subproblems) {
+        if (subproblems == nullptr) {
+            decomp_function(matrix, numberofbits, out, nullptr);
+        } else {
+            subproblems->push_back({matrix, numberofbits, out.size(), {}, {}});
+        }
+    }
+
+    // Decomposes the matrix on a pool of the given number of workers.
+    //
+    // The halves produced by demultiplexing are independent, so the recursion
+    // is unrolled breadth-first: each level of subproblems is decomposed in
+    // parallel, deferring their own halves to the next level, until there are
+    // enough subproblems to keep all workers busy; the subproblems of that
+    // level are then decomposed completely. Every subproblem performs exactly
+    // the same computations as in the serial recursion, and its instructions
+    // are stitched into its parent's at the position where the serial
+    // recursion would have appended them, so the result is identical.
+    void decomp_parallel(const Eigen::Ref<const complex_matrix>& matrix, Int numberofbits, UInt num_workers) {
+        ThreadPool pool(num_workers);
+        Subproblem root{matrix, numberofbits, 0, {}, {}};
+        Vec<Subproblem*> level{&root};
+        while (!level.empty()) {
+            Bool last = level.size() >= 2 * num_workers;
+            pool.parallel_for(level.size(), [&](UInt i, UInt) {
+                Subproblem &sub = *level[i];
+                decomp_function(sub.matrix, sub.numberofbits, sub.instructions, last ? nullptr : &sub.subproblems);
+                sub.matrix.resize(0, 0);
+            });
+            Vec<Subproblem*> next;
+            for (auto sub : level) {
+                for (auto &half : sub->subproblems) {
+                    next.push_back(&half);
+                }
+            }
+            level.swap(next);
+        }
+        stitch(root, instructionlist);
+    }
+
+    // Appends the instructions of the subproblem to out, with those of its
+    // own subproblems inserted at their positions.
+    static void stitch(const Subproblem &sub, Vec<Real> &out) {
+        UInt done = 0;
+        for (const auto &half : sub.subproblems) {
+            out.insert(out.end(), sub.instructions.begin() + done, sub.instructions.begin() + half.position);
+            stitch(half, out);
+            done = half.position;
+        }
+        out.insert(out.end(), sub.instructions.begin() + done, sub.instructions.end());
+    }
+
     void CSD(
         const Eigen::Ref<const complex_matrix> &U,
         Eigen::Ref<complex_matrix> u1,
@@ -354,7 +440,7 @@ public:
 
     }
 
-    void zyz_decomp(const Eigen::Ref<const complex_matrix> &matrix) {
+    void zyz_decomp(const Eigen::Ref<const complex_matrix> &matrix, Vec<Real> &out) {
         // auto start = std::chrono::steady_clock::now();
 
         Complex det = matrix.determinant();// matrix(0,0)*matrix(1,1)-matrix(1,0)*matrix(0,1);
@@ -376,12 +462,12 @@ public:
 
         Real t1 = atan2(A.imag(),A.real());
         Real t2 = atan2(B.imag(), B.real());
-        alpha = t1+t2;
-        gamma = t1-t2;
-        beta = 2*atan2(sw*sqrt(pow((Real) wx,2)+pow((Real) wy,2)),sqrt(pow((Real) A.real(),2)+pow((wz*sw),2)));
-        instructionlist.push_back(-gamma);
-        instructionlist.push_back(-beta);
-        instructionlist.push_back(-alpha);
+        Real alpha = t1+t2;
+        Real gamma = t1-t2;
+        Real beta = 2*atan2(sw*sqrt(pow((Real) wx,2)+pow((Real) wy,2)),sqrt(pow((Real) A.real(),2)+pow((wz*sw),2)));
+        out.push_back(-gamma);
+        out.push_back(-beta);
+        out.push_back(-alpha);
         // zyz_time += (std::chrono::steady_clock::now() - start);
     }
 
@@ -437,23 +523,49 @@ public:
 
     }
 
-    Vec<Eigen::MatrixXd> genMk_lookuptable;
-
-    // returns M^k = (-1)^(b_(i-1)*g_(i-1)), where * is bitwise inner product, g = binary gray code, b = binary code.
-    void genMk() {
-        Int numberqubits = uint64_log2(_matrix.rows());
-        for (Int n = 1; n <= numberqubits; n++) {
-            Int size=1<<n;
-            Eigen::MatrixXd Mk(size,size);
-            for (Int i = 0; i < size; i++) {
-                for (Int j = 0; j < size ;j++) {
-                    Mk(i,j) = pow(-1, bitParity(i&(j^(j>>1))));
+    // The angles of a multiplexed (uniformly controlled) rotation over k control qubits follow from
+    // the (half) rotation angles per control value by solving M^k * angles = values, where
+    // M^k = (-1)^(b_(i-1)*g_(i-1)), where * is bitwise inner product, g = binary gray code, b = binary code.
+    // M^k is the (natural order) Walsh-Hadamard matrix H of size 2^k with its columns permuted to gray code order,
+    // and H*H = 2^k*I, so the solution is angles[j] = (H*values)[g(j)]/2^k. H*values is computed in place
+    // by the fast Walsh-Hadamard transform in O(k*2^k), instead of by a dense solve with M^k.
+
+    // in-place fast Walsh-Hadamard transform: v = H*v
+    static void walsh_hadamard(Eigen::Ref<Eigen::VectorXd> v) {
+        Int size = v.size();
+        for (Int h = 1; h < size; h <<= 1) {
+            for (Int i = 0; i < size; i += 2*h) {
+                for (Int j = i; j < i + h; j++) {
+                    Real a = v[j];
+                    Real b = v[j+h];
+                    v[j] = a + b;
+                    v[j+h] = a - b;
                 }
             }
-            genMk_lookuptable.push_back(Mk);
         }
+    }
+
+    // returns the solution of M^k * angles = values
+    static Eigen::VectorXd solve_Mk(const Eigen::VectorXd &values) {
+        Int size = values.size();
+        Eigen::VectorXd transformed = values;
+        walsh_hadamard(transformed);
+        Eigen::VectorXd angles(size);
+        for (Int j = 0; j < size; j++) {
+            angles[j] = transformed[j^(j>>1)]/size;
+        }
+        return angles;
+    }
 
-        // return genMk_lookuptable[numberqubits-1];
+    // returns M^k * angles, to check a solution
+    static Eigen::VectorXd multiply_Mk(const Eigen::VectorXd &angles) {
+        Int size = angles.size();
+        Eigen::VectorXd values(size);
+        for (Int j = 0; j < size; j++) {
+            values[j^(j>>1)] = angles[j];
+        }
+        walsh_hadamard(values);
+        return values;
     }
 
     // source: https://stackoverflow.com/questions/994593/how-to-do-an-integer-log2-in-c user Todd Lehman
@@ -463,47 +575,32 @@ public:
 #undef S
     }
 
-    Int bitParity(Int i) {
-        if (i < 2 << 16) {
-            i = (i >> 16) ^ i;
-            i = (i >> 8) ^ i;
-            i = (i >> 4) ^ i;
-            i = (i >> 2) ^ i;
-            i = (i >> 1) ^ i;
-            return i % 2;
-        } else {
-            throw utils::Exception("Bit parity number too big!", false);
-        }
-    }
-
-    void multicontrolledY(const Eigen::Ref<const Eigen::VectorXcd> &ss, Int halfthesizeofthematrix) {
+    void multicontrolledY(const Eigen::Ref<const Eigen::VectorXcd> &ss, Int halfthesizeofthematrix, Vec<Real> &out) {
         // auto start = std::chrono::steady_clock::now();
         Eigen::VectorXd temp =  2*Eigen::asin(ss.array()).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        Eigen::VectorXd tr = solve_Mk(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(multiply_Mk(tr), 10e-2)) {
             QL_EOUT("Multicontrolled Y not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix ss: \n"  + to_string(ss), false);
         }
 
-        instructionlist.insert(instructionlist.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        out.insert(out.end(), &tr[0], &tr[halfthesizeofthematrix]);
         // multiplexing_time += std::chrono::steady_clock::now() - start;
     }
 
-    void multicontrolledZ(const Eigen::Ref<const Eigen::VectorXcd> &D, Int halfthesizeofthematrix) {
+    void multicontrolledZ(const Eigen::Ref<const Eigen::VectorXcd> &D, Int halfthesizeofthematrix, Vec<Real> &out) {
         // auto start = std::chrono::steady_clock::now();
 
         Eigen::VectorXd temp =  (Complex(0,-2)*Eigen::log(D.array())).real();
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> dec(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]);
-        Eigen::VectorXd tr = dec.solve(temp);
+        Eigen::VectorXd tr = solve_Mk(temp);
         // Check is very approximate to account for low-precision input matrices
-        if (!temp.isApprox(genMk_lookuptable[uint64_log2(halfthesizeofthematrix)-1]*tr, 10e-2)) {
+        if (!temp.isApprox(multiply_Mk(tr), 10e-2)) {
             QL_EOUT("Multicontrolled Z not correct!");
             throw utils::Exception("Demultiplexing of unitary '"+ name+"' not correct! Failed at demultiplexing of matrix D: \n"+ to_string(D), false);
         }
 
-        instructionlist.insert(instructionlist.end(), &tr[0], &tr[halfthesizeofthematrix]);
+        out.insert(out.end(), &tr[0], &tr[halfthesizeofthematrix]);
         // multiplexing_time += std::chrono::steady_clock::now() - start;
 
     }
@@ -514,15 +611,288 @@ public:
     }
 };
 
+/**
+ * The result of decomposing a unitary, as cached by unitary::decompose().
+ */
+struct cached_decomposition {
+    Vec<Int> key;
+    Vec<Complex> SU;
+    Real alpha;
+    Real beta;
+    Real gamma;
+    Vec<Real> instructionlist;
+};
+
+/**
+ * Resolution of the canonicalized matrix elements used as cache key: 2^-32,
+ * or about 2e-10. Matrices whose elements round to the same multiple of this
+ * are considered equal, so rounding noise from building the same unitary
+ * along different paths does not normally defeat the cache; an element that
+ * happens to lie right at a rounding boundary merely costs a cache miss. The
+ * decomposition of a matrix that differs by less than this is still accurate
+ * to well within the tolerance of the decomposition itself.
+ */
+static const Int CANONICAL_RESOLUTION_BITS = 32;
+
+/**
+ * Returns the canonical form of the given matrix: the real and imaginary
+ * parts of all elements, rounded to multiples of the canonical resolution.
+ * Rounding to integers also folds -0.0 into 0.0.
+ */
+static Vec<Int> canonicalize(const Vec<Complex> &array) {
+    Vec<Int> key;
+    key.reserve(2 * array.size());
+    for (const auto &element : array) {
+        key.push_back(std::llround(std::ldexp(element.real(), CANONICAL_RESOLUTION_BITS)));
+        key.push_back(std::llround(std::ldexp(element.imag(), CANONICAL_RESOLUTION_BITS)));
+    }
+    return key;
+}
+
+/**
+ * Returns the hash of a canonicalized matrix.
+ */
+static UInt hash_key(const Vec<Int> &key) {
+    UInt hash = key.size();
+    for (auto value : key) {
+        hash ^= std::hash<Int>()(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+/**
+ * Formats a real number without loss of precision, as a hexadecimal
+ * floating-point literal.
+ */
+static Str format_real(Real value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%a", value);
+    return buffer;
+}
+
+/**
+ * Reads a real number written by format_real() from the given stream.
+ */
+static Bool parse_real(std::istream &stream, Real &value) {
+    Str token;
+    if (!(stream >> token)) {
+        return false;
+    }
+    char *end;
+    value = std::strtod(token.c_str(), &end);
+    return *end == '\0';
+}
+
+/**
+ * Serializes a cached decomposition to a single line of the cache file:
+ * the canonicalized matrix, SU, alpha, beta, gamma and the instruction list,
+ * each list preceded by its length.
+ */
+static Str serialize(const cached_decomposition &entry) {
+    StrStrm line;
+    line << "unitary " << entry.key.size();
+    for (auto value : entry.key) {
+        line << " " << value;
+    }
+    line << " " << entry.SU.size();
+    for (const auto &value : entry.SU) {
+        line << " " << format_real(value.real()) << " " << format_real(value.imag());
+    }
+    line << " " << format_real(entry.alpha);
+    line << " " << format_real(entry.beta);
+    line << " " << format_real(entry.gamma);
+    line << " " << entry.instructionlist.size();
+    for (auto value : entry.instructionlist) {
+        line << " " << format_real(value);
+    }
+    line << "\n";
+    return line.str();
+}
+
+/**
+ * Parses a line of the cache file written by serialize(). Returns false if
+ * the line is malformed, for instance because another process was still
+ * writing it.
+ */
+static Bool deserialize(const Str &line, cached_decomposition &entry) {
+    std::istringstream stream(line);
+    Str tag;
+    UInt count;
+    if (!(stream >> tag) || tag != "unitary" || !(stream >> count)) {
+        return false;
+    }
+    entry.key.resize(count);
+    for (auto &value : entry.key) {
+        if (!(stream >> value)) {
+            return false;
+        }
+    }
+    if (!(stream >> count)) {
+        return false;
+    }
+    entry.SU.resize(count);
+    for (auto &value : entry.SU) {
+        Real re, im;
+        if (!parse_real(stream, re) || !parse_real(stream, im)) {
+            return false;
+        }
+        value = Complex(re, im);
+    }
+    if (
+        !parse_real(stream, entry.alpha) ||
+        !parse_real(stream, entry.beta) ||
+        !parse_real(stream, entry.gamma) ||
+        !(stream >> count)
+    ) {
+        return false;
+    }
+    entry.instructionlist.resize(count);
+    for (auto &value : entry.instructionlist) {
+        if (!parse_real(stream, value)) {
+            return false;
+        }
+    }
+    return !(stream >> tag);
+}
+
+/**
+ * Process-wide cache of unitary decompositions, keyed by the hash of the
+ * canonicalized matrix, and optionally backed by a file.
+ *
+ * Programs commonly decompose the same unitaries over and over, for instance
+ * when the same circuit is compiled for several platforms or repeatedly in a
+ * parameter sweep, and the decomposition of a unitary on more than a few
+ * qubits takes far longer than the rest of compiling it. The
+ * decomposition only depends on the matrix, so its results are cached for the
+ * lifetime of the process. When option unitary_cache_file names a file, the
+ * decompositions in it are loaded on first use, and new decompositions are
+ * appended to it, so that the cache also survives across processes.
+ */
+class decomposition_cache {
+private:
+    std::mutex mutex;
+    Map<UInt, Vec<std::shared_ptr<const cached_decomposition>>> entries;
+    Map<Str, Bool> loaded_files;
+
+    /**
+     * Adds the given entry, unless the same matrix is already present.
+     * Must be called with the mutex held.
+     */
+    void add(const std::shared_ptr<const cached_decomposition> &entry) {
+        auto &bucket = entries.set(hash_key(entry->key));
+        for (const auto &existing : bucket) {
+            if (existing->key == entry->key) {
+                return;
+            }
+        }
+        bucket.push_back(entry);
+    }
+
+    /**
+     * Loads the given cache file if that was not done before. Must be called
+     * with the mutex held.
+     */
+    void load(const Str &file_name) {
+        if (file_name.empty() || loaded_files.count(file_name)) {
+            return;
+        }
+        loaded_files.set(file_name) = true;
+        std::ifstream file(file_name);
+        if (!file.is_open()) {
+            QL_DOUT("unitary decomposition cache file " << file_name << " does not exist yet");
+            return;
+        }
+        UInt count = 0;
+        Str line;
+        while (std::getline(file, line)) {
+            auto entry = std::make_shared<cached_decomposition>();
+            if (deserialize(line, *entry)) {
+                add(entry);
+                count++;
+            } else if (!line.empty()) {
+                QL_WOUT("ignoring malformed line in unitary decomposition cache file " << file_name);
+            }
+        }
+        QL_DOUT("loaded " << count << " decompositions from unitary decomposition cache file " << file_name);
+    }
+
+public:
+
+    /**
+     * Returns the cached decomposition of the matrix with the given canonical
+     * form, or nullptr if it was not decomposed before.
+     */
+    std::shared_ptr<const cached_decomposition> find(const Vec<Int> &key, const Str &file_name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        load(file_name);
+        auto it = entries.find(hash_key(key));
+        if (it != entries.end()) {
+            for (const auto &entry : it->second) {
+                if (entry->key == key) {
+                    return entry;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Adds a new decomposition to the cache, and appends it to the cache
+     * file, if any. Every entry is appended with a single write, so processes
+     * sharing a cache file at worst write a decomposition twice.
+     */
+    void insert(const std::shared_ptr<const cached_decomposition> &entry, const Str &file_name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        add(entry);
+        if (!file_name.empty()) {
+            std::ofstream file(file_name, std::ios::app);
+            if (!file.is_open()) {
+                QL_WOUT("cannot write unitary decomposition cache file " << file_name);
+                return;
+            }
+            file << serialize(*entry) << std::flush;
+        }
+    }
+
+    /**
+     * Returns the process-wide cache.
+     */
+    static decomposition_cache &get() {
+        static decomposition_cache cache;
+        return cache;
+    }
+
+};
+
+/**
+ * Decomposes the unitary, or takes the results from the decomposition cache
+ * when the same matrix was decomposed before.
+ */
 void unitary::decompose() {
-    UnitaryDecomposer decomposer(name, array);
-    decomposer.decompose();
-    SU = decomposer.SU;
-    alpha = decomposer.alpha;
-    beta = decomposer.beta;
-    gamma = decomposer.gamma;
-    is_decomposed = decomposer.is_decomposed;
-    instructionlist = decomposer.instructionlist;
+    Str file_name = options::get("unitary_cache_file");
+    Vec<Int> key = canonicalize(array);
+    auto cached = decomposition_cache::get().find(key, file_name);
+    if (!cached) {
+        UnitaryDecomposer decomposer(name, array);
+        decomposer.decompose(options::get_threads("unitary_threads"));
+        auto entry = std::make_shared<cached_decomposition>();
+        entry->key = std::move(key);
+        entry->SU = decomposer.SU;
+        entry->alpha = decomposer.alpha;
+        entry->beta = decomposer.beta;
+        entry->gamma = decomposer.gamma;
+        entry->instructionlist = decomposer.instructionlist;
+        decomposition_cache::get().insert(entry, file_name);
+        cached = entry;
+    } else {
+        QL_DOUT("using cached decomposition for unitary: " << name);
+    }
+    SU = cached->SU;
+    alpha = cached->alpha;
+    beta = cached->beta;
+    gamma = cached->gamma;
+    is_decomposed = true;
+    instructionlist = cached->instructionlist;
 }
 
 Bool unitary::is_decompose_support_enabled() {
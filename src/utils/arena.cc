@@ -0,0 +1,74 @@
+/** \file
+ * Provides an arena (region) allocator for objects that all live until their
+ * owner is destroyed.
+ */
+
+#include "utils/arena.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Largest size of a block; the block sizes double up to this size.
+ */
+static const UInt MAX_BLOCK_SIZE = 1024 * 1024;
+
+/**
+ * Creates an empty arena.
+ */
+Arena::Arena(UInt first_block_size) : block_size(first_block_size) {
+}
+
+/**
+ * Destroys all objects in reverse order of construction, and releases the
+ * memory.
+ */
+Arena::~Arena() {
+    for (auto it = objects.rbegin(); it != objects.rend(); ++it) {
+        it->destroy(it->address);
+    }
+}
+
+/**
+ * Returns memory for an object of the given size and alignment, taking it from
+ * the last block when it fits, and otherwise from a new block.
+ */
+void *Arena::allocate(UInt size, UInt align) {
+    UInt padding = (align - reinterpret_cast<UInt>(next) % align) % align;
+    if (next == nullptr || padding + size > static_cast<UInt>(end - next)) {
+        // objects that are larger than a block get a block of their own
+        UInt new_block_size = block_size;
+        while (new_block_size < size + align) {
+            new_block_size *= 2;
+        }
+        blocks.emplace_back(new char[new_block_size]);
+        next = blocks.back().get();
+        end = next + new_block_size;
+        capacity += new_block_size;
+        if (block_size < MAX_BLOCK_SIZE) {
+            block_size *= 2;
+        }
+        padding = (align - reinterpret_cast<UInt>(next) % align) % align;
+    }
+    void *address = next + padding;
+    next += padding + size;
+    return address;
+}
+
+/**
+ * Returns the number of objects made in this arena.
+ */
+UInt Arena::size() const {
+    return objects.size();
+}
+
+/**
+ * Returns the number of bytes of memory allocated by this arena for its
+ * objects.
+ */
+UInt Arena::bytes() const {
+    return capacity;
+}
+
+} // namespace utils
+} // namespace ql
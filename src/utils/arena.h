@@ -0,0 +1,135 @@
+/** \file
+ * Provides an arena (region) allocator for objects that all live until their
+ * owner is destroyed.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "utils/num.h"
+#include "utils/vec.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Arena of objects that are destroyed together with the arena.
+ *
+ * make() constructs an object in the current block of the arena by bumping a
+ * pointer, so objects that are made one after the other are contiguous in
+ * memory, and allocation needs no call to the heap for most objects. The
+ * blocks start small and grow geometrically, so small arenas stay small and
+ * large ones consist of few blocks.
+ *
+ * Objects cannot be freed individually. On destruction, the arena runs the
+ * destructors of all objects it made in reverse order of construction, and
+ * then releases its blocks in bulk. This fits objects such as gates, which are
+ * referenced from several places (circuits, copies of a kernel, schedules) but
+ * never outlive the thing that owns them.
+ *
+ * make() may be called from multiple threads at the same time.
+ */
+class Arena {
+private:
+
+    /**
+     * A made object: its address and the function that destroys it.
+     */
+    struct Object {
+        void *address;
+        void (*destroy)(void *);
+    };
+
+    /**
+     * Allocated blocks, in order of allocation.
+     */
+    Vec<std::unique_ptr<char[]>> blocks;
+
+    /**
+     * Free space in the last block: the next free byte and the end.
+     */
+    char *next = nullptr;
+    char *end = nullptr;
+
+    /**
+     * Size of the next block to allocate.
+     */
+    UInt block_size;
+
+    /**
+     * Total number of bytes in the blocks.
+     */
+    UInt capacity = 0;
+
+    /**
+     * The objects made so far, in order of construction.
+     */
+    Vec<Object> objects;
+
+    /**
+     * Serializes make().
+     */
+    std::mutex mutex;
+
+    /**
+     * Returns memory for an object of the given size and alignment.
+     */
+    void *allocate(UInt size, UInt align);
+
+    /**
+     * Destroys the object of type T at the given address.
+     */
+    template <class T>
+    static void destroy(void *address) {
+        static_cast<T*>(address)->~T();
+    }
+
+public:
+
+    /**
+     * Creates an empty arena. No memory is allocated until the first object
+     * is made; the first block will have the given size in bytes.
+     */
+    explicit Arena(UInt first_block_size = 4096);
+
+    /**
+     * Destroys all objects in reverse order of construction, and releases the
+     * memory.
+     */
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * Constructs an object of type T in the arena, passing the arguments to
+     * its constructor, and returns a pointer to it. The object lives until the
+     * arena is destroyed.
+     */
+    template <class T, class... Args>
+    T *make(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mutex);
+        void *address = allocate(sizeof(T), alignof(T));
+        T *object = new (address) T(std::forward<Args>(args)...);
+        objects.push_back({address, &destroy<T>});
+        return object;
+    }
+
+    /**
+     * Returns the number of objects made in this arena.
+     */
+    UInt size() const;
+
+    /**
+     * Returns the number of bytes of memory allocated by this arena for its
+     * objects.
+     */
+    UInt bytes() const;
+
+};
+
+} // namespace utils
+} // namespace ql
@@ -10,9 +10,10 @@ namespace utils {
 namespace logger {
 
 /**
- * The current log level (verbosity).
+ * The current log level (verbosity). It is shared by all threads and
+ * compilations, like the streams the log is written to.
  */
-LogLevel log_level;
+std::atomic<LogLevel> log_level{LogLevel::LOG_NOTHING};
 
 /**
  * Converts the string representation of a log level to a LogLevel enum variant.
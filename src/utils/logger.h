@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include "utils/compat.h"
 #include "utils/str.h"
@@ -79,7 +80,7 @@ enum LogLevel {
     LOG_DEBUG
 };
 
-QL_GLOBAL extern LogLevel log_level;
+QL_GLOBAL extern std::atomic<LogLevel> log_level;
 
 LogLevel log_level_from_string(const Str &level);
 void set_log_level(const Str &level);
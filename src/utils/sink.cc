@@ -0,0 +1,93 @@
+/** \file
+ * Provides output sinks: destinations for generated text that is written
+ * incrementally.
+ */
+
+#include "utils/sink.h"
+
+#include "utils/filesystem.h"
+#include "utils/exception.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Tries to create a file (if it doesn't already exist) and opens it for
+ * writing through a buffer of the given size. If the directory that path is
+ * contained by does not exists, it is first created.
+ */
+FileSink::FileSink(const Str &path, UInt buffer_size) :
+    buffer(new char[buffer_size]), ofs(), path(path)
+{
+
+    // If the parent path does not exist yet, recursively try to create a
+    // directory for it.
+    auto parent = dir_name(path);
+    if (parent != path && !path_exists(parent)) {
+        make_dirs(parent);
+    }
+
+    // Install the buffer and open the file. The buffer must be installed
+    // before any I/O is performed on the stream.
+    ofs.rdbuf()->pubsetbuf(buffer.get(), buffer_size);
+    ofs.open(path);
+    if (ofs.fail()) {
+        throw Exception("failed to open file \"" + path + "\" for writing", true);
+    }
+
+}
+
+/**
+ * Returns the stream to write to.
+ */
+std::ostream &FileSink::stream() {
+    return ofs;
+}
+
+/**
+ * Flushes the buffer and closes the file, throwing an exception if anything
+ * failed while writing.
+ */
+void FileSink::close() {
+    ofs.close();
+    if (ofs.fail()) {
+        throw Exception("failed to write file \"" + path + "\"", true);
+    }
+}
+
+/**
+ * Returns the name of the file.
+ */
+Str FileSink::describe() const {
+    return "file \"" + path + "\"";
+}
+
+/**
+ * Returns the stream to write to.
+ */
+std::ostream &StrSink::stream() {
+    return ss;
+}
+
+/**
+ * Nothing to do for in-memory output.
+ */
+void StrSink::close() {
+}
+
+/**
+ * Describes the sink.
+ */
+Str StrSink::describe() const {
+    return "memory";
+}
+
+/**
+ * Returns the output written so far.
+ */
+Str StrSink::str() const {
+    return ss.str();
+}
+
+} // namespace utils
+} // namespace ql
@@ -0,0 +1,79 @@
+/** \file
+ * Provides output sinks: destinations for generated text that is written
+ * incrementally, such that large outputs need not be built up in memory before
+ * they are written.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <fstream>
+#include <memory>
+#include "utils/num.h"
+#include "utils/str.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Base class for output sinks. Generators write their output to stream() as
+ * they go, and whoever owns the sink calls close() when the output is
+ * complete.
+ */
+class OutSink {
+public:
+    virtual ~OutSink() = default;
+
+    /**
+     * Returns the stream to write to.
+     */
+    virtual std::ostream &stream() = 0;
+
+    /**
+     * Completes the output, throwing an exception if anything went wrong
+     * while writing.
+     */
+    virtual void close() = 0;
+
+    /**
+     * Returns a description of where the output goes, for use in messages.
+     */
+    virtual Str describe() const = 0;
+
+};
+
+/**
+ * Output sink that writes to a file. Output is collected in a large buffer
+ * and written to the file in large chunks. Like OutFile, the directory of the
+ * file is created if it does not exist yet. Write errors are reported by
+ * close(); if close() is not called, the destructor closes the file without
+ * reporting them.
+ */
+class FileSink : public OutSink {
+private:
+    std::unique_ptr<char[]> buffer;
+    std::ofstream ofs;
+    Str path;
+public:
+    static const UInt DEFAULT_BUFFER_SIZE = 1024 * 1024;
+    explicit FileSink(const Str &path, UInt buffer_size = DEFAULT_BUFFER_SIZE);
+    std::ostream &stream() override;
+    void close() override;
+    Str describe() const override;
+};
+
+/**
+ * Output sink that keeps the output in memory, mostly useful for testing.
+ */
+class StrSink : public OutSink {
+private:
+    StrStrm ss;
+public:
+    std::ostream &stream() override;
+    void close() override;
+    Str describe() const override;
+    Str str() const;
+};
+
+} // namespace utils
+} // namespace ql
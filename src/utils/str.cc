@@ -7,11 +7,38 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
 #include "utils/exception.h"
 
 namespace ql {
 namespace utils {
 
+void append_uint(Str &str, UInt value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    str.append(p, end);
+}
+
+void append_int(Str &str, Int value) {
+    if (value < 0) {
+        str += '-';
+        append_uint(str, -(UInt)value);
+    } else {
+        append_uint(str, (UInt)value);
+    }
+}
+
+void append_real(Str &str, Real value) {
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%g", value);
+    str.append(buf, len);
+}
+
 UInt parse_uint(const Str &str) {
     try {
         return std::stoull(str);
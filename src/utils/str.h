@@ -63,6 +63,20 @@ Str to_string(T arg) {
     return ss.str();
 }
 
+/**
+ * Append the decimal representation of the given integer to str, the same as
+ * to_string() would produce, without creating a temporary string.
+ */
+void append_uint(Str &str, UInt value);
+void append_int(Str &str, Int value);
+
+/**
+ * Append the given real number to str in the same format as to_string()
+ * (i.e. the default stream format, %g with 6 significant digits), without
+ * creating a temporary string.
+ */
+void append_real(Str &str, Real value);
+
 UInt parse_uint(const Str &str);
 Int parse_int(const Str &str);
 Real parse_real(const Str &str);
@@ -0,0 +1,142 @@
+/** \file
+ * Provides a simple pool of worker threads to run the iterations of a loop in
+ * parallel.
+ */
+
+#include "utils/thread_pool.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Constructs a pool with the given total number of workers, including the
+ * calling thread. 0 is treated as 1.
+ */
+ThreadPool::ThreadPool(UInt num_workers) :
+    task(nullptr),
+    count(0),
+    next(0),
+    generation(0),
+    busy(0),
+    stopping(false)
+{
+    for (UInt worker = 1; worker < num_workers; worker++) {
+        threads.emplace_back(&ThreadPool::run_thread, this, worker);
+    }
+}
+
+/**
+ * Stops and joins the threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Returns the total number of workers, including the calling thread.
+ */
+UInt ThreadPool::size() const {
+    return threads.size() + 1;
+}
+
+/**
+ * Calls task(index, worker) for each index in 0..count-1, distributed over the
+ * workers, and returns when all calls have completed. When a call throws, no
+ * new iterations are started and the first exception is rethrown here.
+ */
+void ThreadPool::parallel_for(UInt count, const Task &task) {
+    if (threads.empty() || count <= 1) {
+        for (UInt index = 0; index < count; index++) {
+            task(index, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->count = count;
+        next = 0;
+        error = nullptr;
+        busy = threads.size();
+        generation++;
+    }
+    start_cv.notify_all();
+
+    run_iterations(0);
+
+    std::exception_ptr first_error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [this] { return busy == 0; });
+        this->task = nullptr;
+        first_error = error;
+        error = nullptr;
+    }
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
+
+/**
+ * Returns the number of threads the hardware can run concurrently, or 1 when
+ * that is not known.
+ */
+UInt ThreadPool::hardware_workers() {
+    UInt n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/**
+ * Main loop of the threads: wait for a new generation of work, take part in
+ * it, and report back when done.
+ */
+void ThreadPool::run_thread(UInt worker) {
+    UInt seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        start_cv.wait(lock, [this, seen_generation] { return stopping || generation != seen_generation; });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+        lock.unlock();
+        run_iterations(worker);
+        lock.lock();
+        if (--busy == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+/**
+ * Takes iterations of the current parallel_for and executes them until none
+ * are left.
+ */
+void ThreadPool::run_iterations(UInt worker) {
+    while (true) {
+        UInt index = next.fetch_add(1);
+        if (index >= count) {
+            return;
+        }
+        try {
+            (*task)(index, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = count;
+        }
+    }
+}
+
+} // namespace utils
+} // namespace ql
@@ -0,0 +1,101 @@
+/** \file
+ * Provides a simple pool of worker threads to run the iterations of a loop in
+ * parallel.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "utils/num.h"
+#include "utils/vec.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Pool of worker threads that execute the iterations of parallel_for().
+ *
+ * The calling thread takes part in the work as worker 0, so a pool of size N
+ * starts N-1 threads, and a pool of size 1 runs everything inline without any
+ * synchronization. The threads are started once on construction and wait for
+ * work in between calls, so a parallel_for() only costs a wake-up and not a
+ * thread creation.
+ *
+ * The iterations are handed out dynamically, so the worker that executes a
+ * particular iteration is not deterministic; results that must not depend on
+ * the number of threads should only be derived from the iteration index. The
+ * worker index can be used to select per-worker scratch state, since no two
+ * iterations run on the same worker at the same time.
+ *
+ * A pool is not reentrant: parallel_for() must not be called from within an
+ * iteration, nor from multiple threads at the same time.
+ */
+class ThreadPool {
+public:
+
+    /**
+     * The body of a parallel loop, called with the iteration index and the
+     * index of the worker executing it.
+     */
+    typedef std::function<void(UInt index, UInt worker)> Task;
+
+    /**
+     * Constructs a pool with the given total number of workers, including
+     * the calling thread. 0 is treated as 1.
+     */
+    explicit ThreadPool(UInt num_workers);
+
+    /**
+     * Stops and joins the threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Returns the total number of workers, including the calling thread.
+     */
+    UInt size() const;
+
+    /**
+     * Calls task(index, worker) for each index in 0..count-1, distributed
+     * over the workers, and returns when all calls have completed. When a call
+     * throws, no new iterations are started and the first exception is
+     * rethrown here.
+     */
+    void parallel_for(UInt count, const Task &task);
+
+    /**
+     * Returns the number of threads the hardware can run concurrently, or 1
+     * when that is not known.
+     */
+    static UInt hardware_workers();
+
+private:
+
+    void run_thread(UInt worker);
+    void run_iterations(UInt worker);
+
+    Vec<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;   // signals a new generation of work, or stopping
+    std::condition_variable done_cv;    // signals that all threads finished the current generation
+
+    // state of the current parallel_for, protected by mutex except for next
+    const Task *task;
+    UInt count;
+    std::atomic<UInt> next;             // next iteration index to hand out
+    UInt generation;                    // incremented for each parallel_for
+    UInt busy;                          // number of threads still working on the current generation
+    Bool stopping;
+    std::exception_ptr error;
+};
+
+} // namespace utils
+} // namespace ql
@@ -0,0 +1,117 @@
+/** \file
+ * Provides an undo log for plain state entries, to cheaply checkpoint and
+ * roll back the state of an object without copying it.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include "utils/num.h"
+#include "utils/vec.h"
+#include "utils/exception.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Undo log (journal) of changes to plain state entries of the object that owns
+ * the log.
+ *
+ * The owner calls save() with an entry just before changing it. While a
+ * checkpoint is open, this records the address and old value of the entry;
+ * otherwise save() does nothing. rollback() restores all entries saved since
+ * the most recent checkpoint in reverse order and closes that checkpoint.
+ * Checkpoints nest like a stack, so the cost of a rollback is proportional to
+ * the number of changes made since the checkpoint, not to the size of the
+ * state.
+ *
+ * The log refers to the entries of the object that owns it, so copying a log
+ * yields an empty log without open checkpoints. Entries must not be
+ * reallocated (e.g. by resizing their vector) while a checkpoint is open.
+ */
+class UndoLog {
+private:
+
+    /**
+     * A saved entry: its address, size, and old value.
+     */
+    struct Entry {
+        void *address;
+        UInt size;
+        UInt value;
+    };
+
+    /**
+     * The saved entries, oldest first.
+     */
+    Vec<Entry> entries;
+
+    /**
+     * For each open checkpoint, the number of entries at the time it was
+     * opened.
+     */
+    Vec<UInt> marks;
+
+public:
+
+    UndoLog() = default;
+    UndoLog(const UndoLog &) {}
+    UndoLog &operator=(const UndoLog &) {
+        entries.clear();
+        marks.clear();
+        return *this;
+    }
+
+    /**
+     * Returns whether a checkpoint is open, i.e. whether changes are logged.
+     */
+    Bool is_logging() const {
+        return !marks.empty();
+    }
+
+    /**
+     * Logs the current value of the given entry, which is about to be changed.
+     * The entry must be trivially copyable and not larger than UInt.
+     */
+    template <typename T>
+    void save(T &entry) {
+        static_assert(std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(UInt), "unsupported undo log entry");
+        if (!marks.empty()) {
+            Entry e;
+            e.address = &entry;
+            e.size = sizeof(T);
+            e.value = 0;
+            std::memcpy(&e.value, &entry, sizeof(T));
+            entries.push_back(e);
+        }
+    }
+
+    /**
+     * Opens a checkpoint.
+     */
+    void checkpoint() {
+        marks.push_back(entries.size());
+    }
+
+    /**
+     * Restores all entries saved since the most recent checkpoint and closes
+     * it.
+     */
+    void rollback() {
+        if (marks.empty()) {
+            throw Exception("UndoLog rollback without checkpoint", false);
+        }
+        UInt mark = marks.back();
+        marks.pop_back();
+        while (entries.size() > mark) {
+            const Entry &e = entries.back();
+            std::memcpy(e.address, &e.value, e.size);
+            entries.pop_back();
+        }
+    }
+
+};
+
+} // namespace utils
+} // namespace ql
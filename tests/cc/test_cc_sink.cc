@@ -0,0 +1,147 @@
+/*
+    file:       test_cc_sink.cc
+    notes:      check that the CC code generator produces the same program
+                when streamed to a file sink as when kept in memory; when
+                given a number of bundles as argument, e.g. 1000000, it also
+                benchmarks time and peak memory of both on a synthetic program
+                of that many bundles
+*/
+
+#include "openql.h"
+#include "arch/cc/codegen_cc.h"
+#include "utils/sink.h"
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#define CFG_FILE_JSON   "cc_s5_direct_iq.json"
+
+// peak resident set size of this process in bytes, from /proc/self/status;
+// returns 0 where that is not available
+size_t
+peak_bytes()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+// drive the code generator directly with a program of the given number of
+// bundles, each containing single qubit gates on some of the qubits, and
+// return the time it took in seconds
+double
+generate(const ql::quantum_platform &s5, size_t bundles, ql::utils::OutSink &sink)
+{
+    const char *gates[] = {"rx180", "ry90", "ry180", "rx90"};
+    auto start = std::chrono::steady_clock::now();
+
+    ql::codegen_cc codegen;
+    codegen.init(s5, sink);
+    codegen.programStart("test_cc_sink");
+    codegen.kernelStart("kernel");
+    for (size_t b = 0; b < bundles; b++) {
+        size_t cycle = 1 + 2*b;
+        codegen.bundleStart("# bundle " + std::to_string(b));
+        for (ql::utils::UInt q = 0; q < 5; q++) {
+            if ((b + q) % 3 != 0) {
+                codegen.customGate(gates[(b + q) % 4], {q}, {}, {}, ql::cond_always, {}, 0.0, cycle, 1);
+            }
+        }
+        codegen.bundleFinish(cycle, 1, b == bundles - 1);
+    }
+    codegen.kernelFinish("kernel", 2*bundles);
+    codegen.programFinish("test_cc_sink");
+    sink.close();
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// generate the program into the given sink and report time and peak memory;
+// on Linux, this is done in a child process, such that the peak memory of
+// the generation is not obscured by that of earlier generations
+size_t
+measure(const ql::quantum_platform &s5, size_t bundles, ql::utils::OutSink &sink, const std::string &name)
+{
+#ifdef __linux__
+    int fds[2];
+    if (pipe(fds) == 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            size_t before = peak_bytes();
+            double time = generate(s5, bundles, sink);
+            size_t peak[2] = {peak_bytes() - before, 0};
+            std::memcpy(&peak[1], &time, sizeof(double));
+            ssize_t written = write(fds[1], peak, sizeof(peak));
+            _exit(written == sizeof(peak) ? 0 : 1);
+        }
+        close(fds[1]);
+        size_t peak[2] = {0, 0};
+        ssize_t got = read(fds[0], peak, sizeof(peak));
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (got == sizeof(peak) && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            double time;
+            std::memcpy(&time, &peak[1], sizeof(double));
+            std::cout << name << ": " << time << " s, peak memory growth " << peak[0] << " bytes" << std::endl;
+            return peak[0];
+        }
+    }
+#endif
+    double time = generate(s5, bundles, sink);
+    std::cout << name << ": " << time << " s" << std::endl;
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("output_dir", "test_output");
+    ql::options::set("backend_cc_verbose", "no");
+    ql::quantum_platform s5("s5", CFG_FILE_JSON);
+    std::string file_name = "test_output/test_cc_sink.vq1asm";
+
+    // both sinks must receive exactly the same program
+    ql::utils::StrSink check_sink;
+    generate(s5, 1000, check_sink);
+    ql::utils::FileSink check_file_sink(file_name);
+    generate(s5, 1000, check_file_sink);
+    std::ifstream file(file_name);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    if (contents.str() != check_sink.str()) {
+        std::cout << "program written to file differs from program kept in memory" << std::endl;
+        return 1;
+    }
+
+    // on request, peak memory of streaming the program to file versus keeping it in memory
+    if (argc > 1) {
+        size_t bundles = std::stoull(argv[1]);
+        std::cout << bundles << " bundles" << std::endl;
+        ql::utils::FileSink file_sink(file_name);
+        size_t file_peak = measure(s5, bundles, file_sink, "file sink  ");
+        ql::utils::StrSink memory_sink;
+        size_t memory_peak = measure(s5, bundles, memory_sink, "memory sink");
+        if (file_peak != 0 && memory_peak != 0 && file_peak >= memory_peak) {
+            std::cout << "streaming to file does not reduce peak memory" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 import os
+import array
 import unittest
 from openql import openql as ql
 
@@ -112,6 +113,41 @@ class Test_kernel(unittest.TestCase):
 
         p.compile()
 
+    def test_gates(self):
+        nqubits = 3
+        names = ['x', 'Y', 'cnot', 'rx90', 'measure']
+        ids = [0, 1, 2, 3, 4, 2, 0, 4]
+        qubit_counts = [1, 1, 2, 1, 1, 2, 1, 1]
+        qubits = [0, 1, 0, 1, 1, 2, 1, 2, 0, 1]
+
+        # the batch interface must create the same gates as gate() one by one,
+        # given lists or buffers of 64-bit integers
+        qasm = []
+        for batch in [None, 'list', 'buffer']:
+            name = 'test_gates_' + str(batch)
+            p = ql.Program(name, platf, nqubits)
+            k = ql.Kernel('aKernel', platf, nqubits)
+            if batch is None:
+                offset = 0
+                for i, count in zip(ids, qubit_counts):
+                    k.gate(names[i], qubits[offset:offset + count])
+                    offset += count
+            elif batch == 'list':
+                k.gates(names, ids, qubit_counts, qubits, [])
+            else:
+                k.gates(names, array.array('Q', ids), array.array('Q', qubit_counts), array.array('Q', qubits), None)
+            p.add_kernel(k)
+            p.compile()
+            with open(os.path.join(output_dir, name + '.qasm')) as f:
+                qasm.append(f.read())
+        self.assertEqual(qasm[0], qasm[1])
+        self.assertEqual(qasm[0], qasm[2])
+
+        # buffers of signed integers are copied, so a negative number is an error instead of a huge size_t
+        k = ql.Kernel('aKernel', platf, nqubits)
+        with self.assertRaises(OverflowError):
+            k.gates(names, [0, 2], array.array('q', [-1, 2]), [0], None)
+
     def test_duplicate_kernel_name(self):
         nqubits = 3
 
@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <random>
+
+#include <openql.h>
+
+// a gate of the test circuit
+struct gate_t {
+    size_t id;
+    std::vector<size_t> qubits;
+    double angle;
+};
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("use_default_gates", "yes");
+
+    // custom, uppercase, parameterized composite, specialized, implicit breg (also in mixed case, which gate() doesn't add),
+    // default, and wait/barrier gates
+    ql::utils::Vec<ql::utils::Str> names = {
+        "x", "Y", "cz", "cnot", "rx180", "prepx", "measure", "Measure", "rx", "wait", "barrier"
+    };
+    std::vector<size_t> arity = { 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 2 };
+
+    int n = 7;
+    ql::quantum_platform starmon("starmon", "hardware_config_cc_light.json");
+    std::mt19937 rng(25);
+    std::vector<gate_t> circuit;
+    for (int i = 0; i < 1000; i++) {
+        gate_t g;
+        g.id = rng() % names.size();
+        size_t q0 = rng() % n;
+        g.qubits.push_back(q0);
+        if (arity[g.id] == 2) {
+            g.qubits.push_back((q0 + 1 + rng() % (n - 1)) % n);
+        }
+        g.angle = (rng() % 100) / 100.0;
+        circuit.push_back(g);
+    }
+
+    ql::utils::Vec<ql::utils::UInt> ids;
+    ql::utils::Vec<ql::utils::UInt> nqubits;
+    ql::utils::Vec<ql::utils::UInt> qubits;
+    ql::utils::Vec<ql::utils::Real> angles;
+    for (auto &g : circuit) {
+        ids.push_back(g.id);
+        nqubits.push_back(g.qubits.size());
+        qubits.insert(qubits.end(), g.qubits.begin(), g.qubits.end());
+        angles.push_back(g.angle);
+    }
+
+    // without and with a preset condition, the batch must create the same gates as gate() one by one
+    for (bool conditional : { false, true }) {
+        ql::quantum_kernel single("single", starmon, n, 0, n);
+        ql::quantum_kernel batch("batch", starmon, n, 0, n);
+        if (conditional) {
+            single.gate_preset_condition(ql::cond_unary, {1});
+            batch.gate_preset_condition(ql::cond_unary, {1});
+        }
+        for (auto &g : circuit) {
+            single.gate(names[g.id], {g.qubits.begin(), g.qubits.end()}, {}, 0, g.angle);
+        }
+        batch.gates(names, ids, nqubits, qubits, angles);
+
+        if (single.c.size() != batch.c.size()) {
+            std::cout << "gates created by gates() differ from those created by gate()" << (conditional ? " with preset condition" : "") << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < single.c.size(); i++) {
+            auto gs = single.c[i];
+            auto gb = batch.c[i];
+            if (gs->qasm() != gb->qasm() || gs->name != gb->name || gs->operands != gb->operands || gs->breg_operands != gb->breg_operands
+                || gs->duration != gb->duration || gs->angle != gb->angle
+                || gs->condition != gb->condition || gs->cond_operands != gb->cond_operands) {
+                std::cout << "gate " << i << " '" << gb->qasm() << "' created by gates() differs from '" << gs->qasm() << "' created by gate()" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // numbers of qubits that don't add up to the qubit operands are rejected before any gate is added,
+    // also when their sum wraps around
+    for (auto bad : { ql::utils::Vec<ql::utils::UInt>{ 1, 2 }, ql::utils::Vec<ql::utils::UInt>{ (ql::utils::UInt)-1, 2 } }) {
+        ql::quantum_kernel batch("bad", starmon, n, 0, n);
+        try {
+            batch.gates(names, { 0, 2 }, bad, { 0 }, {});
+            std::cout << "gates() accepted " << bad[0] << " and " << bad[1] << " qubits for 1 qubit operand" << std::endl;
+            return 1;
+        } catch (ql::utils::Exception &e) {
+        }
+        if (!batch.c.empty()) {
+            std::cout << "gates() added gates before rejecting the numbers of qubits" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
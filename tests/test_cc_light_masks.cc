@@ -0,0 +1,220 @@
+/*
+    file:       test_cc_light_masks.cc
+    notes:      compile random layers of single-qubit gates, and of cz gates,
+                that need many more distinct masks than there are s and t
+                registers; replay the smis and smit instructions of the qisa
+                to check that every bundle reads a register that was (re)loaded
+                with the right mask, and check that the reloads add no bundles
+                and no cycles to the schedule
+*/
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+
+#include <openql.h>
+#include "test_helpers.h"
+
+// instruction and its qubit operands -> number of times it is applied
+typedef std::map<std::pair<std::string, std::vector<int>>, int> gate_count_t;
+
+// the bundles of a kernel in the qisa
+struct kernel_bundles_t {
+    int bundles = 0;
+    int last_cycle = 0;     // start cycle of the last bundle
+};
+
+// parse "{1, 4, 5}" or "{(2, 0), (0, 3)}" into the list of operands of each
+// gate, of the given number of qubits, to which the mask applies
+std::vector<std::vector<int>>
+parse_mask(const std::string &text, size_t nqubits)
+{
+    std::vector<std::vector<int>> operands;
+    std::vector<int> qubits;
+    std::string digits;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            digits += c;
+        } else if (!digits.empty()) {
+            qubits.push_back(std::stoi(digits));
+            digits.clear();
+            if (qubits.size() == nqubits) {
+                operands.push_back(qubits);
+                qubits.clear();
+            }
+        }
+    }
+    return operands;
+}
+
+// replay the qisa: track the contents of the s and t registers as set by the
+// smis and smit instructions, wherever they are, count the gates that the
+// bundles apply to each qubit and the reloads (after the prologue) per
+// register file, and the bundles and cycles of each kernel; returns false if
+// a bundle reads a register that wasn't set
+bool
+replay_qisa(const std::string &fname, gate_count_t &applied, std::map<char, int> &reloads, std::map<std::string, kernel_bundles_t> &kernels)
+{
+    std::ifstream qisa(fname);
+    std::map<std::string, std::vector<std::vector<int>>> regs;
+    std::string line;
+    std::string kernel;
+    int cycle = 0;
+    bool in_prologue = true;
+    while (std::getline(qisa, line)) {
+        std::istringstream ss(line);
+        std::string first;
+        if (!(ss >> first)) {
+            continue;
+        }
+        if (first == "smis" || first == "smit") {
+            std::string reg, rest;
+            ss >> reg;
+            std::getline(ss, rest);
+            reg = reg.substr(0, reg.size() - 1);    // drop the comma
+            regs[reg] = parse_mask(rest, first == "smis" ? 1 : 2);
+            if (!in_prologue) {
+                reloads[reg[0]]++;
+            }
+            continue;
+        }
+        if (first.back() == ':') {
+            in_prologue = false;
+            kernel = first.substr(0, first.size() - 1);
+            cycle = 0;
+            continue;
+        }
+        if (first == "qwait") {
+            int wait;
+            ss >> wait;
+            cycle += wait;
+            continue;
+        }
+        if (first.find_first_not_of("0123456789") != std::string::npos) {
+            continue;   // not a bundle
+        }
+        cycle += std::stoi(first);
+        kernels[kernel].bundles++;
+        kernels[kernel].last_cycle = cycle;
+        std::string instr, reg, bar;
+        while (ss >> instr >> reg) {
+            if (reg[0] == 's' || reg[0] == 't') {
+                int r = std::stoi(reg.substr(1));
+                if (r >= (reg[0] == 's' ? 32 : 64) || regs.find(reg) == regs.end()) {
+                    std::cout << "bundle uses undefined register " << reg << ": " << line << std::endl;
+                    return false;
+                }
+                for (auto &operands : regs[reg]) {
+                    applied[std::make_pair(instr, operands)]++;
+                }
+            }
+            ss >> bar;
+        }
+    }
+    return true;
+}
+
+// compiles the program, and checks its qisa against the gates of the program and
+// against its schedule; register is the register file ('s' or 't') that must be reloaded
+bool
+check(ql::quantum_program &prog, const gate_count_t &expected, char reg)
+{
+    prog.compile();
+
+    gate_count_t applied;
+    std::map<char, int> reloads;
+    std::map<std::string, kernel_bundles_t> bundles;
+    if (!replay_qisa("test_output/" + prog.unique_name + ".qisa", applied, reloads, bundles)) {
+        return false;
+    }
+    std::cout << prog.name << ": smis reloads: " << reloads['s'] << ", smit reloads: " << reloads['t'] << std::endl;
+    if (reloads[reg] == 0) {
+        std::cout << "expected the program to need more masks than there are " << reg << " registers" << std::endl;
+        return false;
+    }
+    if (applied != expected) {
+        std::cout << "the gates applied by the qisa differ from those of the program" << std::endl;
+        return false;
+    }
+
+    // a reload is not a bundle, so each kernel has a bundle per cycle in which gates start,
+    // ending in the cycle in which its last gates start
+    for (auto &k : prog.kernels) {
+        std::set<size_t> cycles;
+        for (auto gp : k.c) {
+            cycles.insert(gp->cycle);
+        }
+        auto &kb = bundles[k.name];
+        if (kb.bundles != (int)cycles.size() || kb.last_cycle != (int)*cycles.rbegin()) {
+            std::cout << k.name << ": " << kb.bundles << " bundles up to cycle " << kb.last_cycle << " in the qisa, but "
+                      << cycles.size() << " up to cycle " << *cycles.rbegin() << " in the schedule" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("write_qasm_files", "no");
+    ql::options::set("write_report_files", "no");
+    ql::options::set("scheduler", "ASAP");
+
+    int n = 17;
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    std::mt19937 rng(1);
+
+    // random single-qubit gates on all qubits give many more distinct
+    // qubit sets than there are s registers
+    ql::quantum_program prog1q("test_cc_light_masks", starmon, n, 0);
+    std::vector<std::string> names = {
+        "x", "y", "z", "h", "s", "sdag", "t", "tdag", "x90", "xm90", "y90", "ym90"
+    };
+    gate_count_t expected1q;
+    for (int kernel = 0; kernel < 2; kernel++) {
+        ql::quantum_kernel k("kernel" + std::to_string(kernel), starmon, n, 0);
+        for (int layer = 0; layer < 100; layer++) {
+            for (int q = 0; q < n; q++) {
+                std::string name = names[rng() % names.size()];
+                k.gate(name, q);
+                expected1q[std::make_pair(name, std::vector<int>{q})]++;
+            }
+        }
+        prog1q.add(k);
+    }
+    if (!check(prog1q, expected1q, 's')) {
+        return 1;
+    }
+
+    // cz gates on random sets of disjoint edges give many more distinct
+    // qubit pair sets than there are t registers
+    auto edges = topology_edges(starmon);
+    ql::quantum_program prog2q("test_cc_light_masks_2q", starmon, n, 0);
+    gate_count_t expected2q;
+    for (int kernel = 0; kernel < 2; kernel++) {
+        ql::quantum_kernel k("kernel" + std::to_string(kernel), starmon, n, 0);
+        for (int layer = 0; layer < 100; layer++) {
+            std::vector<bool> used(n, false);
+            for (int i = 0; i < 6; i++) {
+                auto edge = edges[rng() % edges.size()];
+                if (!used[edge.first] && !used[edge.second]) {
+                    used[edge.first] = used[edge.second] = true;
+                    k.gate("cz", edge.first, edge.second);
+                    expected2q[std::make_pair(std::string("cz"), std::vector<int>{edge.first, edge.second})]++;
+                }
+            }
+        }
+        prog2q.add(k);
+    }
+    if (!check(prog2q, expected2q, 't')) {
+        return 1;
+    }
+
+    return 0;
+}
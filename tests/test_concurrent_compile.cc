@@ -0,0 +1,105 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <thread>
+#include <random>
+
+#include <openql.h>
+#include <compile_context.h>
+#include <utils/filesystem.h>
+
+// a program with its own option values
+struct job_t {
+    std::string name;
+    std::string scheduler;
+    std::string mapper;
+    std::string threads;
+};
+
+// build and compile the program of a job, with output to the given directory;
+// the options are set in a context of this thread only
+void
+compile_job(const job_t &job, const std::string &output_dir)
+{
+    ql::CompileContext context;
+    ql::CompileContext::Scope scope(&context);
+    ql::options::set("output_dir", output_dir);
+    ql::options::set("scheduler", job.scheduler);
+    ql::options::set("mapper", job.mapper);
+    ql::options::set("maptiebreak", "first");
+    ql::options::set("compile_threads", job.threads);
+    ql::options::set("mapthreads", job.threads);
+
+    int n = 7;
+    ql::quantum_platform starmon("starmon", "test_mapper_s7.json");
+    ql::quantum_program prog(job.name, starmon, n, 0);
+
+    std::mt19937 rng(std::hash<std::string>()(job.name));
+    for (int kernel = 0; kernel < 3; kernel++) {
+        ql::quantum_kernel k(job.name + "_" + std::to_string(kernel), starmon, n, 0);
+        for (int i = 0; i < 100; i++) {
+            int q0 = rng() % n;
+            int q1 = (q0 + 1 + rng() % (n - 1)) % n;
+            if (rng() % 3 == 0) {
+                k.gate("cnot", q0, q1);
+            } else {
+                k.gate(rng() % 2 ? "x" : "h", q0);
+            }
+        }
+        prog.add(k);
+    }
+    prog.compile();
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("write_qasm_files", "yes");
+    ql::options::set("write_report_files", "no");
+    ql::options::set("scheduler", "ALAP");
+
+    std::vector<job_t> jobs = {
+        {"test_concurrent_compile_0", "ASAP", "minextend", "1"},
+        {"test_concurrent_compile_1", "ALAP", "base", "2"},
+        {"test_concurrent_compile_2", "ALAP", "minextend", "2"},
+        {"test_concurrent_compile_3", "ASAP", "baserc", "1"},
+    };
+
+    // reference outputs of serial compilations
+    for (const auto &job : jobs) {
+        compile_job(job, "test_output/serial");
+    }
+
+    // the same compilations, all at the same time, a few times over
+    for (int round = 0; round < 3; round++) {
+        std::vector<std::thread> threads;
+        for (const auto &job : jobs) {
+            threads.emplace_back(compile_job, job, "test_output/parallel");
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        std::vector<std::string> suffixes = {
+            ".qasm", "_scheduled.qasm", "_mapper_out.qasm", "_rcscheduler_out.qasm", ".qisa"
+        };
+        for (const auto &job : jobs) {
+            for (const auto &suffix : suffixes) {
+                std::string serial = ql::utils::InFile("test_output/serial/" + job.name + suffix).read();
+                std::string parallel = ql::utils::InFile("test_output/parallel/" + job.name + suffix).read();
+                if (serial.empty() || serial != parallel) {
+                    std::cout << "output " << job.name << suffix << " of parallel compilation differs from serial one" << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // the options set by the jobs must not have leaked into the global ones
+    if (ql::options::get("scheduler") != "ALAP" || ql::options::get("output_dir") != "test_output") {
+        std::cout << "options of a compilation changed the global options" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
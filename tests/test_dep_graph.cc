@@ -0,0 +1,204 @@
+/*
+    file:       test_dep_graph.cc
+    notes:      check that the scheduler's dependence graph lists the arcs of
+                each node in the order of the lemon::ListDigraph it replaced
+                (most recently added first), on which the schedules depend;
+                when given a number of gates as argument, e.g. 100000, it also
+                benchmarks building and traversing the graph against an
+                equivalent lemon graph, and RC scheduling, on a random circuit
+                of that many gates
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <chrono>
+#include <random>
+
+#include <lemon/list_graph.h>
+
+#include <openql.h>
+#include "scheduler.h"
+#include "test_helpers.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+double
+since(clock_type::time_point start)
+{
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// the dependence graph as it was represented with lemon
+struct lemon_graph {
+    lemon::ListDigraph graph;
+    lemon::ListDigraph::NodeMap<ql::gate*> instruction;
+    lemon::ListDigraph::ArcMap<ql::utils::Int> weight;
+    lemon::ListDigraph::ArcMap<ql::utils::Int> cause;
+    lemon::ListDigraph::ArcMap<ql::DepTypes> dep_type;
+    lemon::ListDigraph::ArcMap<ql::DepGraph::Arc> index;    // the corresponding arc of the DepGraph
+    std::map<ql::gate*, lemon::ListDigraph::Node> node;
+    std::vector<lemon::ListDigraph::Node> nodes;            // in the order of the DepGraph
+
+    explicit lemon_graph(const ql::DepGraph &dg)
+        : instruction(graph), weight(graph), cause(graph), dep_type(graph), index(graph)
+    {
+        for (ql::DepGraph::Node n = 0; n < dg.node_count(); n++) {
+            auto ln = graph.addNode();
+            instruction[ln] = dg.instruction(n);
+            node[dg.instruction(n)] = ln;
+            nodes.push_back(ln);
+        }
+        for (ql::DepGraph::Arc a = 0; a < dg.arc_count(); a++) {
+            auto la = graph.addArc(nodes[dg.source(a)], nodes[dg.target(a)]);
+            weight[la] = dg.weight(a);
+            cause[la] = dg.cause(a);
+            dep_type[la] = dg.dep_type(a);
+            index[la] = a;
+        }
+    }
+};
+
+// a random circuit on the surface-17 topology of test_mapper_s17.json
+void
+random_circuit(ql::quantum_kernel &k, const ql::quantum_platform &platform, size_t ngates)
+{
+    auto edges = topology_edges(platform);
+    std::vector<std::string> names = {"x", "y", "h", "x90", "y90", "xm90", "ym90"};
+    size_t n = platform.qubit_number;
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < ngates; i++) {
+        size_t r = rng() % 10;
+        if (r < 3) {
+            auto edge = edges[rng() % edges.size()];
+            k.gate("cz", edge.first, edge.second);
+        } else if (r == 3) {
+            k.gate("measure", rng() % n);
+        } else {
+            k.gate(names[rng() % names.size()], rng() % n);
+        }
+    }
+}
+
+// the remaining cycles from each node to the SINK, as computed by Scheduler::set_remaining
+std::vector<ql::utils::UInt>
+remaining(const ql::DepGraph &dg)
+{
+    std::vector<ql::utils::UInt> r(dg.node_count(), 0);
+    for (auto n = dg.node_count() - 1; n-- > 0; ) {
+        for (auto arc : dg.out_arcs(n)) {
+            r[n] = std::max<ql::utils::UInt>(r[n], r[dg.target(arc)] + dg.weight(arc));
+        }
+    }
+    return r;
+}
+
+std::vector<ql::utils::UInt>
+remaining(const lemon_graph &lg)
+{
+    std::vector<ql::utils::UInt> r(lg.nodes.size(), 0);
+    for (auto n = lg.nodes.size() - 1; n-- > 0; ) {
+        for (lemon::ListDigraph::OutArcIt arc(lg.graph, lg.nodes[n]); arc != lemon::INVALID; ++arc) {
+            auto target = lg.graph.id(lg.graph.target(arc));
+            r[n] = std::max<ql::utils::UInt>(r[n], r[target] + lg.weight[arc]);
+        }
+    }
+    return r;
+}
+
+bool
+benchmark(size_t ngates)
+{
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    ql::quantum_kernel k("benchmark", starmon, starmon.qubit_number, 0);
+    random_circuit(k, starmon, ngates);
+
+    auto start = clock_type::now();
+    ql::Scheduler sched;
+    sched.init(k.c, starmon, starmon.qubit_number, 0, 0);
+    double init = since(start);
+
+    start = clock_type::now();
+    ql::DepGraph dg;
+    for (ql::DepGraph::Node n = 0; n < sched.graph.node_count(); n++) {
+        dg.add_node(sched.graph.instruction(n));
+    }
+    for (ql::DepGraph::Arc a = 0; a < sched.graph.arc_count(); a++) {
+        dg.add_arc(sched.graph.source(a), sched.graph.target(a), sched.graph.weight(a), sched.graph.cause(a), sched.graph.dep_type(a));
+    }
+    dg.finalize();
+    double build = since(start);
+
+    start = clock_type::now();
+    lemon_graph lg(sched.graph);
+    double lemon_build = since(start);
+
+    start = clock_type::now();
+    auto r = remaining(dg);
+    double traverse = since(start);
+
+    start = clock_type::now();
+    auto lemon_r = remaining(lg);
+    double lemon_traverse = since(start);
+
+    start = clock_type::now();
+    ql::utils::Str dot;
+    ql::arch::resource_manager_t rm(starmon, ql::forward_scheduling);
+    sched.schedule_asap(rm, starmon, dot);
+    double schedule = since(start);
+
+    std::cout << ngates << " gates, " << sched.graph.arc_count() << " arcs" << std::endl;
+    std::cout << "graph construction including dependence analysis: " << init << " s" << std::endl;
+    std::cout << "building the graph from its arcs: " << build << " s, with lemon " << lemon_build << " s" << std::endl;
+    std::cout << "critical path traversal: " << traverse << " s, with lemon " << lemon_traverse << " s" << std::endl;
+    std::cout << "RC ASAP scheduling: " << schedule << " s" << std::endl;
+    return r == lemon_r;
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+
+    if (argc > 1) {
+        return benchmark(std::stoull(argv[1])) ? 0 : 1;
+    }
+
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    ql::quantum_kernel k("dep_graph", starmon, starmon.qubit_number, 0);
+    random_circuit(k, starmon, 1000);
+    ql::Scheduler sched;
+    sched.init(k.c, starmon, starmon.qubit_number, 0, 0);
+    const ql::DepGraph &dg = sched.graph;
+    lemon_graph lg(dg);
+
+    for (ql::DepGraph::Node n = 0; n < dg.node_count(); n++) {
+        std::vector<ql::DepGraph::Arc> out_arcs, in_arcs, lemon_out_arcs, lemon_in_arcs;
+        for (auto arc : dg.out_arcs(n)) {
+            out_arcs.push_back(arc);
+        }
+        for (auto arc : dg.in_arcs(n)) {
+            in_arcs.push_back(arc);
+        }
+        for (lemon::ListDigraph::OutArcIt arc(lg.graph, lg.nodes[n]); arc != lemon::INVALID; ++arc) {
+            lemon_out_arcs.push_back(lg.index[arc]);
+        }
+        for (lemon::ListDigraph::InArcIt arc(lg.graph, lg.nodes[n]); arc != lemon::INVALID; ++arc) {
+            lemon_in_arcs.push_back(lg.index[arc]);
+        }
+        if (out_arcs != lemon_out_arcs || in_arcs != lemon_in_arcs) {
+            std::cout << "arcs of node " << n << " (" << dg.name(n) << ") are not in lemon's order" << std::endl;
+            return 1;
+        }
+        if (n > 0 && n + 1 < dg.node_count() && (dg.instruction(n) != k.c[n - 1] || dg.node_of(k.c[n - 1]) != n)) {
+            std::cout << "node " << n << " is not gate " << n - 1 << " of the circuit" << std::endl;
+            return 1;
+        }
+    }
+    if (remaining(dg) != remaining(lg)) {
+        std::cout << "critical paths differ from lemon's" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
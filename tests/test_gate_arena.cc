@@ -0,0 +1,81 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <cassert>
+
+#include <openql.h>
+
+// resident set size of this process in bytes, from /proc/self/statm;
+// returns 0 where that is not available
+size_t
+resident_bytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0, resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return resident * 4096;
+}
+
+// compile a program with a mapped, scheduled and decomposed kernel;
+// all gates created during compilation are owned by the kernel's arena
+// and must be released when program and kernel go out of scope
+void
+compile_once(ql::quantum_platform &starmon, int iteration)
+{
+    int n = 7;
+    std::string prog_name = "test_gate_arena";
+    std::string kernel_name = "test_gate_arena_" + std::to_string(iteration % 2);
+
+    ql::quantum_program prog(prog_name, starmon, n, 0);
+    ql::quantum_kernel k(kernel_name, starmon, n, 0);
+
+    for (int i = 0; i < 20; i++) {
+        for (int j = 0; j < n; j++) { k.gate("x", j); }
+        k.gate("cnot", 0, 4);
+        k.gate("cnot", 6, 1);
+        k.gate("toffoli", {0, 3, 5});
+        k.gate("cnot", 2, 6);
+    }
+    for (int j = 0; j < n; j++) { k.gate("measure", j); }
+
+    prog.add(k);
+    prog.compile();
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("write_qasm_files", "no");
+    ql::options::set("write_report_files", "no");
+    ql::options::set("decompose_toffoli", "NC");
+    ql::options::set("mapper", "minextend");
+    ql::options::set("scheduler", "ALAP");
+
+    ql::quantum_platform starmon("starmon", "test_mapper_s7.json");
+
+    // warm up: let caches and the allocator reach their steady state
+    for (int i = 0; i < 20; i++) {
+        compile_once(starmon, i);
+    }
+    size_t before = resident_bytes();
+
+    for (int i = 0; i < 200; i++) {
+        compile_once(starmon, i);
+    }
+    size_t after = resident_bytes();
+
+    std::cout << "resident set size before: " << before << " after: " << after << std::endl;
+
+    // leaking the gates of each compilation adds more than a megabyte per compilation
+    if (after > before + 2*1024*1024) {
+        std::cout << "resident set size grows with repeated compilations" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*
+    file:       test_helpers.h
+    notes:      helpers shared by the tests
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <random>
+
+#include <openql.h>
+#include "utils/filesystem.h"
+
+// the edges of the topology of the platform, as (src, dst) pairs
+inline std::vector<std::pair<int, int>>
+topology_edges(const ql::quantum_platform &platform)
+{
+    std::vector<std::pair<int, int>> edges;
+    for (auto &edge : platform.topology["edges"]) {
+        edges.push_back({edge["src"], edge["dst"]});
+    }
+    return edges;
+}
+
+// the contents of the report of the mapper for the program of the given name
+inline std::string
+mapper_report(const std::string &name)
+{
+    return ql::utils::InFile("test_output/" + name + "_mapper_out.report").read();
+}
+
+// the value of the report line starting with the given text, or "" when there is none
+inline std::string
+report_value(const std::string &report, const std::string &key)
+{
+    auto pos = report.find(key);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += key.size();
+    return report.substr(pos, report.find('\n', pos) - pos);
+}
+
+typedef std::complex<double> complex_t;
+
+// random unitary on the given number of qubits: Gram-Schmidt
+// orthonormalization of a matrix with normally distributed elements,
+// returned row-major like the unitary constructor expects
+inline std::vector<complex_t>
+random_unitary(int qubits, std::mt19937_64 &rng)
+{
+    size_t n = 1ull << qubits;
+    std::normal_distribution<double> normal;
+    std::vector<std::vector<complex_t>> rows(n, std::vector<complex_t>(n));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            rows[i][j] = complex_t(normal(rng), normal(rng));
+        }
+        for (size_t k = 0; k < i; k++) {
+            complex_t dot = 0;
+            for (size_t j = 0; j < n; j++) { dot += std::conj(rows[k][j]) * rows[i][j]; }
+            for (size_t j = 0; j < n; j++) { rows[i][j] -= dot * rows[k][j]; }
+        }
+        double norm = 0;
+        for (size_t j = 0; j < n; j++) { norm += std::norm(rows[i][j]); }
+        norm = std::sqrt(norm);
+        for (size_t j = 0; j < n; j++) { rows[i][j] /= norm; }
+    }
+    std::vector<complex_t> matrix;
+    for (auto &row : rows) {
+        matrix.insert(matrix.end(), row.begin(), row.end());
+    }
+    return matrix;
+}
@@ -0,0 +1,80 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include <openql.h>
+#include "test_helpers.h"
+
+// compile a circuit of which the two-qubit gates can all be made NN by an initial placement:
+// they are the edges of the topology, with the qubits renamed by a random permutation;
+// returns the contents of the report of the mapper
+std::string
+compile_placed(const std::string &name, const std::string &initialplace, const std::string &threads)
+{
+    ql::options::set("initialplace", initialplace);
+    ql::options::set("mapthreads", threads);
+
+    int n = 17;
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    ql::quantum_program prog(name, starmon, n, 0);
+    ql::quantum_kernel k(name, starmon, n, 0);
+
+    std::mt19937 rng(17);
+    std::vector<int> perm(n);
+    for (int q = 0; q < n; q++) {
+        perm[q] = q;
+    }
+    std::shuffle(perm.begin(), perm.end(), rng);
+    auto edges = topology_edges(starmon);
+    for (int i = 0; i < 200; i++) {
+        auto &edge = edges[rng() % edges.size()];
+        k.gate("cnot", perm[edge.first], perm[edge.second]);
+    }
+    prog.add(k);
+    prog.compile();
+
+    return mapper_report(name);
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("write_qasm_files", "yes");
+    ql::options::set("write_report_files", "yes");
+    ql::options::set("scheduler", "ALAP");
+    ql::options::set("mapper", "minextend");
+    ql::options::set("mapinitone2one", "yes");
+    ql::options::set("maptiebreak", "random");
+    ql::options::set("mapseed", "42");
+    ql::options::set("initialplacestarts", "8");
+
+    std::string trivial = compile_placed("test_initial_place_no", "no", "1");
+    std::string serial = compile_placed("test_initial_place_1", "heuristic", "1");
+    std::string parallel = compile_placed("test_initial_place_4", "heuristic", "4");
+
+    std::cout << "swaps without initial placement: " << report_value(trivial, "# Total no. of swaps: ") << std::endl;
+    std::cout << "initial placement: " << report_value(serial, "# ----- initial placement: ") << std::endl;
+    if (report_value(trivial, "# Total no. of swaps: ") == "0") {
+        std::cout << "expected the circuit to need swaps without initial placement" << std::endl;
+        return 1;
+    }
+    if (report_value(serial, "# ----- initial placement: ").find("newmap with cost 200,") != 0) {
+        std::cout << "expected the heuristic to find the placement that makes all 200 two-qubit gates NN" << std::endl;
+        return 1;
+    }
+    if (report_value(serial, "# Total no. of swaps: ") != "0") {
+        std::cout << "expected no swaps after initial placement" << std::endl;
+        return 1;
+    }
+
+    // for a given seed, the placement doesn't depend on the number of threads
+    if (report_value(serial, "# ----- virt2real map after initial placement:")
+        != report_value(parallel, "# ----- virt2real map after initial placement:")) {
+        std::cout << "placement with 4 threads differs from that with 1 thread" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+    file:       test_list_scheduler.cc
+    notes:      check that the ASAP and ALAP schedules, with and without
+                resource constraints, of a random and of a regular circuit
+                respect all dependences and are sorted on cycle; when given a
+                number of gates as argument, e.g. 200000, it also times
+                scheduling these circuits of that many gates
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <random>
+
+#include <openql.h>
+#include "scheduler.h"
+#include "test_helpers.h"
+
+typedef std::chrono::steady_clock clock_type;
+
+// a random circuit, or surface-code-like rounds of the same layers on all qubits,
+// on the surface-17 topology of test_mapper_s17.json
+void
+fill(ql::quantum_kernel &k, const ql::quantum_platform &platform, size_t ngates, bool regular)
+{
+    auto edges = topology_edges(platform);
+    std::vector<std::string> names = {"x", "y", "h", "x90", "y90", "xm90", "ym90"};
+    size_t n = platform.qubit_number;
+    std::mt19937 rng(12);
+    while (k.c.size() < ngates) {
+        if (regular) {
+            for (size_t q = 0; q < n; q++) {
+                k.gate("ym90", q);
+            }
+            for (auto &edge : edges) {
+                k.gate("cz", edge.first, edge.second);
+            }
+            for (size_t q = 0; q < n; q++) {
+                k.gate("y90", q);
+            }
+            for (size_t q = 0; q < n; q++) {
+                k.gate("measure", q);
+            }
+        } else {
+            size_t r = rng() % 10;
+            if (r < 3) {
+                auto edge = edges[rng() % edges.size()];
+                k.gate("cz", edge.first, edge.second);
+            } else if (r == 3) {
+                k.gate("measure", rng() % n);
+            } else {
+                k.gate(names[rng() % names.size()], rng() % n);
+            }
+        }
+    }
+}
+
+// schedules a circuit as the scheduler passes do; returns the time taken by the scheduler itself
+double
+schedule(ql::Scheduler &sched, const ql::quantum_platform &platform, bool forward, bool rc)
+{
+    ql::utils::Str dot;
+    auto start = clock_type::now();
+    if (rc) {
+        ql::arch::resource_manager_t rm(platform, forward ? ql::forward_scheduling : ql::backward_scheduling);
+        start = clock_type::now();
+        if (forward) {
+            sched.schedule_asap(rm, platform, dot);
+        } else {
+            sched.schedule_alap(rm, platform, dot);
+        }
+    } else if (forward) {
+        sched.schedule_asap(dot);
+    } else {
+        sched.schedule_alap(dot);
+    }
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+// checks that the scheduled circuit is sorted on cycle and that each gate starts
+// after the gates it depends on by at least the weight of the dependence
+bool
+check(const ql::Scheduler &sched, const ql::circuit &c, const std::string &name)
+{
+    for (size_t i = 1; i < c.size(); i++) {
+        if (c[i - 1]->cycle > c[i]->cycle) {
+            std::cout << name << ": circuit is not sorted on cycle at gate " << i << std::endl;
+            return false;
+        }
+    }
+    const ql::DepGraph &dg = sched.graph;
+    for (ql::DepGraph::Arc a = 0; a < dg.arc_count(); a++) {
+        auto source = dg.instruction(dg.source(a));
+        auto target = dg.instruction(dg.target(a));
+        if (target->cycle < source->cycle + dg.weight(a)) {
+            std::cout << name << ": " << target->qasm() << " at cycle " << target->cycle << " starts before "
+                      << source->qasm() << " at cycle " << source->cycle << " plus " << dg.weight(a) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+
+    size_t ngates = argc > 1 ? std::stoull(argv[1]) : 2000;
+    bool ok = true;
+
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    for (bool regular : { false, true }) {
+        for (bool rc : { false, true }) {
+            for (bool forward : { true, false }) {
+                std::string name = std::string(regular ? "regular" : "random") + (forward ? " ASAP" : " ALAP") + (rc ? " rc" : " norc");
+                ql::options::set("scheduler", forward ? "ASAP" : "ALAP");
+                ql::quantum_kernel k("list_scheduler", starmon, starmon.qubit_number, 0);
+                fill(k, starmon, ngates, regular);
+
+                ql::Scheduler sched;
+                sched.init(k.c, starmon, starmon.qubit_number, 0, 0);
+                double seconds = schedule(sched, starmon, forward, rc);
+                ok &= check(sched, k.c, name);
+                if (argc > 1) {
+                    std::cout << name << ": " << k.c.size() << " gates in " << k.c.back()->cycle << " cycles, scheduled in " << seconds << " s" << std::endl;
+                }
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
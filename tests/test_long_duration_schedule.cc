@@ -0,0 +1,113 @@
+/*
+    file:       test_long_duration_schedule.cc
+    notes:      check that the resource-constrained ASAP and ALAP schedules of
+                a circuit with long-duration gates (the 40000-cycle prepz of
+                test_cfg_CCL_long_duration.json) equal the golden schedules,
+                which were made before the scheduler skipped idle cycles;
+                when given a number of rounds as argument, e.g. 1000, it
+                instead times scheduling a circuit of that many rounds
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+
+#include <openql.h>
+#include "scheduler.h"
+#include "utils/filesystem.h"
+
+#define CFG_FILE_JSON   "test_cfg_CCL_long_duration.json"
+#define GOLDEN_FILE     "golden/test_long_duration_schedule.txt"
+#define OUTPUT_FILE     "test_output/test_long_duration_schedule.txt"
+
+// rounds of prepz on some qubits, random single-qubit rotations and cz, and measurements
+void
+fill(ql::quantum_kernel &k, size_t rounds)
+{
+    size_t n = 7;
+    size_t cz[][2] = {{2, 0}, {0, 3}, {3, 1}, {1, 4}, {2, 5}, {5, 3}, {3, 6}, {6, 4}};
+    const char *names[] = {"rx180", "ry180", "i"};
+    std::mt19937 rng(13);
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t q = 0; q < n; q++) {
+            if (rng() % 3) {
+                k.gate("prepz", q);
+            }
+        }
+        for (size_t i = 0; i < 10; i++) {
+            if (rng() % 3 == 0) {
+                auto edge = cz[rng() % 8];
+                k.gate("cz", edge[0], edge[1]);
+            } else {
+                k.gate(names[rng() % 3], rng() % n);
+            }
+        }
+        for (size_t q = 0; q < n; q++) {
+            if (rng() % 2) {
+                k.gate("measure", q);
+            }
+        }
+    }
+}
+
+// schedules the circuit with resource constraints; appends the schedule to out,
+// and returns the time taken
+double
+schedule(const ql::quantum_platform &platform, size_t rounds, bool forward, std::ostream &out)
+{
+    ql::options::set("scheduler", forward ? "ASAP" : "ALAP");
+    ql::quantum_kernel k("long_duration", platform, 7, 0);
+    fill(k, rounds);
+
+    auto start = std::chrono::steady_clock::now();
+    ql::Scheduler sched;
+    sched.init(k.c, platform, 7, 0, 0);
+    ql::utils::Str dot;
+    ql::arch::resource_manager_t rm(platform, forward ? ql::forward_scheduling : ql::backward_scheduling);
+    if (forward) {
+        sched.schedule_asap(rm, platform, dot);
+    } else {
+        sched.schedule_alap(rm, platform, dot);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    out << (forward ? "ASAP" : "ALAP") << " " << k.c.size() << " gates" << std::endl;
+    for (auto gp : k.c) {
+        out << gp->cycle << " " << gp->qasm() << std::endl;
+    }
+    return seconds;
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::quantum_platform platform("seven_qubits_chip", CFG_FILE_JSON);
+
+    if (argc > 1) {
+        size_t rounds = std::stoull(argv[1]);
+        for (bool forward : { true, false }) {
+            std::stringstream out;
+            double seconds = schedule(platform, rounds, forward, out);
+            std::cout << (forward ? "ASAP" : "ALAP") << " rc, " << rounds << " rounds: scheduled in " << seconds << " s" << std::endl;
+        }
+        return 0;
+    }
+
+    std::stringstream out;
+    schedule(platform, 30, true, out);
+    schedule(platform, 30, false, out);
+
+    std::ifstream golden_file(GOLDEN_FILE);
+    std::stringstream golden;
+    golden << golden_file.rdbuf();
+    if (out.str() != golden.str()) {
+        ql::utils::OutFile(OUTPUT_FILE).write(out.str());
+        std::cout << "the schedules in " << OUTPUT_FILE << " differ from those in " << GOLDEN_FILE << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
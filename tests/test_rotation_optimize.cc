@@ -0,0 +1,262 @@
+/*
+    file:       test_rotation_optimize.cc
+    notes:      check the rotation optimizer: runs of single-qubit gates that
+                amount to the identity are removed, also across gates on other
+                qubits; multi-qubit, conditional and measure gates are barriers;
+                runs equal to Z are kept; and the optimized circuit has the same
+                unitary as the input up to global phase; when given a number of
+                gates as argument, e.g. 100000, it also times the optimizer on
+                a randomized benchmarking sequence of that many gates
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <random>
+#include <complex>
+#include <chrono>
+#include <functional>
+
+#include <openql.h>
+
+typedef std::complex<double> complex_t;
+typedef std::vector<complex_t> matrix_t;
+
+int nqubits = 3;
+
+// runs the rotation optimizer on a kernel filled by the given function, and
+// checks the input and optimized gates while the program still owns them
+bool
+optimize(
+    const std::string &name,
+    const std::function<void(ql::quantum_kernel &)> &fill,
+    const std::function<bool(const ql::circuit &, const ql::circuit &)> &check
+) {
+    ql::quantum_platform platform("none", "test_cfg_none_simple.json");
+    ql::quantum_program prog(name, platform, nqubits, 0, 1);
+    ql::quantum_kernel k(name, platform, nqubits, 0, 1);
+    fill(k);
+    prog.add(k);
+    ql::rotation_optimize(&prog, platform, "rotation_optimize");
+    return check(k.c, prog.kernels[0].c);
+}
+
+std::string
+to_string(const ql::circuit &c)
+{
+    std::string s;
+    for (auto gp : c) {
+        s += (s.empty() ? "" : "; ") + gp->qasm();
+    }
+    return s;
+}
+
+// checks that the kernel filled by the given function optimizes to the given gates
+bool
+expect(const std::string &name, const std::function<void(ql::quantum_kernel &)> &fill, const std::string &expected)
+{
+    return optimize(name, fill, [&](const ql::circuit &input, const ql::circuit &output) {
+        std::string actual = to_string(output);
+        if (actual != expected) {
+            std::cout << name << ": got '" << actual << "', expected '" << expected << "'" << std::endl;
+            return false;
+        }
+        return true;
+    });
+}
+
+// the unitary of a circuit of single-qubit gates, cnot and cz, as a row-major
+// matrix over the basis states, with qubit q the q-th bit of the state index
+matrix_t
+unitary(const ql::circuit &c)
+{
+    int dim = 1 << nqubits;
+    matrix_t u(dim * dim);
+    for (int i = 0; i < dim; i++) {
+        u[i * dim + i] = 1.0;
+    }
+    for (auto gp : c) {
+        // apply the gate to each column of u
+        for (int col = 0; col < dim; col++) {
+            std::vector<complex_t> v(dim);
+            for (int i = 0; i < dim; i++) {
+                v[i] = u[i * dim + col];
+            }
+            std::vector<complex_t> w(v);
+            if (gp->name == "cnot" || gp->name == "cz") {
+                int ctrl = 1 << gp->operands[0];
+                int tgt = 1 << gp->operands[1];
+                for (int i = 0; i < dim; i++) {
+                    if ((i & ctrl) != 0) {
+                        w[i] = gp->name == "cnot" ? v[i ^ tgt] : ((i & tgt) != 0 ? -v[i] : v[i]);
+                    }
+                }
+            } else {
+                const complex_t *m = gp->mat().m;
+                int bit = 1 << gp->operands[0];
+                for (int i = 0; i < dim; i++) {
+                    int i0 = i & ~bit;
+                    int i1 = i | bit;
+                    w[i] = (i & bit) == 0 ? m[0] * v[i0] + m[1] * v[i1] : m[2] * v[i0] + m[3] * v[i1];
+                }
+            }
+            for (int i = 0; i < dim; i++) {
+                u[i * dim + col] = w[i];
+            }
+        }
+    }
+    return u;
+}
+
+// checks that two unitaries are equal up to global phase
+bool
+equal_up_to_phase(const matrix_t &a, const matrix_t &b)
+{
+    size_t k = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i]) > std::abs(a[k])) {
+            k = i;
+        }
+    }
+    complex_t phase = b[k] / a[k];
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i] * phase - b[i]) > 1e-6) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the single-qubit gates of the random circuits, each followed by its inverse
+std::vector<std::pair<std::string, std::string>> inverses = {
+    {"x", "x"}, {"y", "y"}, {"z", "z"}, {"h", "h"}, {"s", "sdag"}, {"sdag", "s"}, {"t", "tdag"}, {"tdag", "t"},
+    {"rx90", "mrx90"}, {"mrx90", "rx90"}, {"ry90", "mry90"}, {"mry90", "ry90"}, {"rx180", "rx180"}, {"ry180", "ry180"}
+};
+
+// times the optimizer on a randomized benchmarking sequence on one qubit:
+// n/2 random gates followed by their inverses in reverse order, which all cancel
+bool
+benchmark(size_t n)
+{
+    std::mt19937 rng(7);
+    std::vector<size_t> sequence;
+    for (size_t i = 0; i < n / 2; i++) {
+        sequence.push_back(rng() % inverses.size());
+    }
+    ql::quantum_platform platform("none", "test_cfg_none_simple.json");
+    ql::quantum_program prog("rb", platform, 1, 0);
+    ql::quantum_kernel k("rb", platform, 1, 0);
+    for (auto g : sequence) {
+        k.gate(inverses[g].first, 0);
+    }
+    for (auto it = sequence.rbegin(); it != sequence.rend(); ++it) {
+        k.gate(inverses[*it].second, 0);
+    }
+    prog.add(k);
+
+    auto start = std::chrono::steady_clock::now();
+    ql::rotation_optimize(&prog, platform, "rotation_optimize");
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "rb: " << k.c.size() << " gates optimized to " << prog.kernels[0].c.size() << " in " << seconds << " s" << std::endl;
+    return prog.kernels[0].c.empty();
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("use_default_gates", "yes");
+    ql::options::set("optimize", "yes");
+
+    if (argc > 1) {
+        return benchmark(std::stoull(argv[1])) ? 0 : 1;
+    }
+
+    bool ok = true;
+
+    ok &= expect("identity_run", [](ql::quantum_kernel &k) {
+        k.gate("x", 0);
+        k.gate("h", 0);
+        k.gate("s", 0);
+        k.gate("sdag", 0);
+        k.gate("h", 0);
+        k.gate("x", 0);
+        k.gate("y", 0);
+    }, "y q[0]");
+
+    ok &= expect("interleaved", [](ql::quantum_kernel &k) {
+        k.gate("rx90", 0);
+        k.gate("h", 1);
+        k.gate("cz", 1, 2);
+        k.gate("t", 0);
+        k.gate("tdag", 0);
+        k.gate("mrx90", 0);
+    }, "h q[1]; cz q[1],q[2]");
+
+    ok &= expect("lone_identity", [](ql::quantum_kernel &k) {
+        k.gate("i", 0);
+    }, "i q[0]");
+
+    ok &= expect("two_qubit_barrier", [](ql::quantum_kernel &k) {
+        k.gate("x", 0);
+        k.gate("cnot", 0, 1);
+        k.gate("x", 0);
+    }, "x q[0]; cnot q[0],q[1]; x q[0]");
+
+    ok &= expect("conditional_barrier", [](ql::quantum_kernel &k) {
+        k.gate("x", 0);
+        k.gate("x", {0}, {}, 0, 0.0, {}, ql::cond_unary, {0});
+        k.gate("x", 0);
+    }, "x q[0]; cond(b[0]) x q[0]; x q[0]");
+
+    ok &= expect("measure_barrier", [](ql::quantum_kernel &k) {
+        k.gate("h", 0);
+        k.gate("measure", 0);
+        k.gate("h", 0);
+    }, "h q[0]; measure q[0]; h q[0]");
+
+    ok &= expect("z_run", [](ql::quantum_kernel &k) {
+        k.gate("s", 0);
+        k.gate("s", 0);
+        k.gate("x", 1);
+        k.gate("y", 1);
+        k.gate("t", 2);
+        k.gate("t", 2);
+        k.gate("s", 2);
+    }, "s q[0]; s q[0]; x q[1]; y q[1]; t q[2]; t q[2]; s q[2]");
+
+    // random circuits in which inverse pairs are likely, so that the optimizer has work to do
+    std::mt19937 rng(7);
+    size_t removed = 0;
+    for (int n = 0; n < 1000 && ok; n++) {
+        std::vector<std::pair<std::string, std::vector<size_t>>> gates;
+        size_t length = 1 + rng() % 40;
+        for (size_t i = 0; i < length; i++) {
+            size_t q0 = rng() % nqubits;
+            size_t r = rng() % (inverses.size() + 2);
+            if (r < inverses.size()) {
+                gates.push_back({rng() % 2 ? inverses[r].first : inverses[r].second, {q0}});
+            } else {
+                gates.push_back({r == inverses.size() ? "cnot" : "cz", {q0, (q0 + 1 + rng() % (nqubits - 1)) % nqubits}});
+            }
+        }
+        ok &= optimize("random_" + std::to_string(n), [&](ql::quantum_kernel &k) {
+            for (auto &g : gates) {
+                k.gate(g.first, {g.second.begin(), g.second.end()});
+            }
+        }, [&](const ql::circuit &input, const ql::circuit &output) {
+            removed += input.size() - output.size();
+            if (!equal_up_to_phase(unitary(input), unitary(output))) {
+                std::cout << "random circuit " << n << ": '" << to_string(input) << "' optimized to '" << to_string(output) << "' with a different unitary" << std::endl;
+                return false;
+            }
+            return true;
+        });
+    }
+    if (ok && removed == 0) {
+        std::cout << "random circuits: no gates removed" << std::endl;
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
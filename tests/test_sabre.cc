@@ -0,0 +1,144 @@
+/*
+    file:       test_sabre.cc
+    notes:      check that the sabre mapper makes all two-qubit gates of a
+                random circuit on surface-17 NN, refines the reported initial
+                mapping, and needs no more swaps than minextend; when given a
+                configuration file and a number of gates as arguments, e.g.
+                test_mapper_grid10x10.json 3000, it instead benchmarks mapping
+                a random circuit of that many gates, a third of them two-qubit
+                gates, with the mappers that follow (by default sabre)
+*/
+
+#include <string>
+#include <vector>
+#include <set>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <regex>
+
+#include <openql.h>
+#include "test_helpers.h"
+
+// map the same random circuit with the given mapper and number of sabre passes;
+// returns the number of swaps, or -1 when a two-qubit gate in the output isn't NN
+int
+map_random(const std::string &name, const std::string &mapper, const std::string &passes)
+{
+    ql::options::set("mapper", mapper);
+    ql::options::set("mapsabrepasses", passes);
+
+    int n = 17;
+    ql::quantum_platform starmon("starmon", "test_mapper_s17.json");
+    ql::quantum_program prog(name, starmon, n, 0);
+    ql::quantum_kernel k(name, starmon, n, 0);
+
+    std::mt19937 rng(17);
+    for (int i = 0; i < 300; i++) {
+        int q0 = rng() % n;
+        int q1 = (q0 + 1 + rng() % (n - 1)) % n;
+        if (rng() % 2 == 0) {
+            k.gate("cnot", q0, q1);
+        } else {
+            k.gate(rng() % 2 ? "x" : "h", q0);
+        }
+    }
+    prog.add(k);
+    prog.compile();
+
+    std::set<std::pair<int, int>> nn;
+    for (auto &edge : topology_edges(starmon)) {
+        nn.insert(edge);
+        nn.insert({edge.second, edge.first});
+    }
+    std::string qasm = ql::utils::InFile("test_output/" + name + "_mapper_out.qasm").read();
+    std::regex twoq("q\\[(\\d+)\\],q\\[(\\d+)\\]");
+    for (std::sregex_iterator it(qasm.begin(), qasm.end(), twoq), end; it != end; ++it) {
+        if (nn.count({std::stoi((*it)[1]), std::stoi((*it)[2])}) == 0) {
+            std::cout << name << ": two-qubit gate on " << it->str() << " is not NN" << std::endl;
+            return -1;
+        }
+    }
+
+    std::string swaps = report_value(mapper_report(name), "# Total no. of swaps: ");
+    if (swaps.empty()) {
+        std::cout << name << ": no number of swaps in report" << std::endl;
+        return -1;
+    }
+    return std::stoi(swaps);
+}
+
+// map a random circuit of the given number of gates on the platform of the given
+// configuration file with each of the given mappers, and print the swaps and times
+void
+benchmark(const std::string &config, size_t ngates, const std::vector<std::string> &mappers)
+{
+    ql::quantum_platform platform("benchmark", config);
+    size_t n = platform.qubit_number;
+    for (auto &mapper : mappers) {
+        std::string name = "test_sabre_benchmark_" + mapper;
+        ql::options::set("mapper", mapper);
+        ql::quantum_program prog(name, platform, n, 0);
+        ql::quantum_kernel k(name, platform, n, 0);
+        std::mt19937 rng(24);
+        for (size_t i = 0; i < ngates; i++) {
+            size_t q0 = rng() % n;
+            if (rng() % 3 == 0) {
+                k.gate("cz", q0, (q0 + 1 + rng() % (n - 1)) % n);
+            } else {
+                k.gate("x", q0);
+            }
+        }
+        prog.add(k);
+
+        auto start = std::chrono::steady_clock::now();
+        prog.compile();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << config << ", " << ngates << " gates, " << mapper << ": "
+                  << report_value(mapper_report(name), "# Total no. of swaps: ") << " swaps, compiled in " << seconds << " s" << std::endl;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("write_qasm_files", "yes");
+    ql::options::set("write_report_files", "yes");
+    ql::options::set("scheduler", "ALAP");
+    ql::options::set("mapinitone2one", "yes");
+    ql::options::set("maptiebreak", "first");
+
+    if (argc > 2) {
+        ql::options::set("write_qasm_files", "no");
+        std::vector<std::string> mappers(argv + 3, argv + argc);
+        if (mappers.empty()) {
+            mappers.push_back("sabre");
+        }
+        benchmark(argv[1], std::stoull(argv[2]), mappers);
+        return 0;
+    }
+
+    int minextend = map_random("test_sabre_minextend", "minextend", "0");
+    int unrefined = map_random("test_sabre_0", "sabre", "0");
+    int refined = map_random("test_sabre_2", "sabre", "2");
+    std::cout << "swaps: minextend " << minextend << ", sabre " << unrefined << ", sabre with 2 passes " << refined << std::endl;
+    if (minextend < 0 || unrefined < 0 || refined < 0) {
+        return 1;
+    }
+
+    // the refined initial mapping is reported as the mapping after initial placement
+    std::string key = "# ----- virt2real map after initial placement:";
+    std::string unrefined_map = report_value(mapper_report("test_sabre_0"), key);
+    std::string refined_map = report_value(mapper_report("test_sabre_2"), key);
+    if (unrefined_map.empty() || refined_map.empty() || unrefined_map == refined_map) {
+        std::cout << "expected the report to show the refined initial mapping" << std::endl;
+        return 1;
+    }
+
+    if (refined > minextend) {
+        std::cout << "expected sabre with refined initial mapping to need no more swaps than minextend" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
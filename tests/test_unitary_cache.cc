@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <openql_i.h>
+#include <utils/filesystem.h>
+#include "test_helpers.h"
+
+// decompose the matrix and return the time it took in seconds
+double
+time_decompose(ql::unitary &u)
+{
+    auto start = std::chrono::steady_clock::now();
+    u.decompose();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char ** argv)
+{
+    if (!ql::unitary::is_decompose_support_enabled()) {
+        std::cout << "unitary decomposition is disabled in this build" << std::endl;
+        return 0;
+    }
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::utils::make_dirs("test_output");
+    std::string cache_file = "test_output/test_unitary_cache.txt";
+    std::remove(cache_file.c_str());
+
+    std::mt19937_64 rng(1);
+    for (int qubits = 3; qubits <= 8; qubits++) {
+        std::vector<complex_t> matrix = random_unitary(qubits, rng);
+
+        // the first decomposition is computed and written to the cache file,
+        // the second one is found in the process-wide cache
+        ql::options::set("unitary_cache_file", cache_file);
+        ql::unitary cold("cold", matrix);
+        double cold_time = time_decompose(cold);
+        ql::unitary warm("warm", matrix);
+        double warm_time = time_decompose(warm);
+
+        // a matrix that differs only by rounding noise maps to the same entry
+        std::vector<complex_t> noisy = matrix;
+        for (auto &element : noisy) { element *= 1.0 + 1e-15; }
+        ql::unitary close("close", noisy);
+        time_decompose(close);
+
+        std::cout << qubits << " qubits: cold " << cold_time << " s, warm " << warm_time << " s" << std::endl;
+        if (warm.instructionlist != cold.instructionlist || close.instructionlist != cold.instructionlist) {
+            std::cout << "cached decomposition differs from the computed one" << std::endl;
+            return 1;
+        }
+    }
+
+    // every distinct matrix must have been appended to the cache file once
+    std::ifstream file(cache_file);
+    std::string line;
+    int lines = 0;
+    while (std::getline(file, line)) { lines++; }
+    if (lines != 6) {
+        std::cout << "expected 6 decompositions in the cache file, found " << lines << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
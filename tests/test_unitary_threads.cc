@@ -0,0 +1,90 @@
+/*
+    file:       test_unitary_threads.cc
+    notes:      check that decomposing random 3 to 5 qubit unitaries with
+                unitary_threads > 1 gives bit-identical gate lists to the
+                serial decomposition; as decompositions are cached by matrix
+                for the lifetime of the process, each number of threads is
+                run in a child process (this program, given the number of
+                threads and the output file as arguments)
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <openql.h>
+#include "utils/filesystem.h"
+#include "test_helpers.h"
+
+// decomposes the unitaries with the given number of threads, and writes the gates
+// they are decomposed into, with their angles in hexadecimal to compare all bits
+void
+decompose(const std::string &threads, const std::string &file_name)
+{
+    ql::options::set("unitary_threads", threads);
+    ql::quantum_platform platform("platform_none", "test_cfg_none_simple.json");
+    std::mt19937_64 rng(16);
+    std::stringstream out;
+    for (int qubits = 3; qubits <= 5; qubits++) {
+        for (int i = 0; i < 3; i++) {
+            ql::unitary u("u" + std::to_string(qubits) + "_" + std::to_string(i), random_unitary(qubits, rng));
+            u.decompose();
+            ql::quantum_kernel k("unitary_threads", platform, qubits, 0);
+            std::vector<size_t> operands;
+            for (int q = 0; q < qubits; q++) {
+                operands.push_back(q);
+            }
+            k.gate(u, {operands.begin(), operands.end()});
+            out << u.name << ": " << k.c.size() << " gates" << std::endl;
+            for (auto gp : k.c) {
+                char angle[32];
+                std::snprintf(angle, sizeof(angle), "%a", gp->angle);
+                out << gp->qasm() << " " << angle << std::endl;
+            }
+        }
+    }
+    ql::utils::OutFile(file_name).write(out.str());
+}
+
+int main(int argc, char ** argv)
+{
+    if (!ql::unitary::is_decompose_support_enabled()) {
+        std::cout << "unitary decomposition is disabled in this build" << std::endl;
+        return 0;
+    }
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+
+    if (argc > 2) {
+        decompose(argv[1], argv[2]);
+        return 0;
+    }
+
+    ql::utils::make_dirs("test_output");
+    std::string serial;
+    for (std::string threads : { "1", "2", "4" }) {
+        std::string file_name = "test_output/test_unitary_threads_" + threads + ".txt";
+        std::remove(file_name.c_str());
+        std::string command = std::string("\"") + argv[0] + "\" " + threads + " " + file_name;
+        if (std::system(command.c_str()) != 0) {
+            std::cout << "decomposing with " << threads << " threads failed" << std::endl;
+            return 1;
+        }
+        std::string gates = ql::utils::InFile(file_name).read();
+        if (gates.empty()) {
+            std::cout << "decomposing with " << threads << " threads produced no gates" << std::endl;
+            return 1;
+        }
+        if (threads == "1") {
+            serial = gates;
+        } else if (gates != serial) {
+            std::cout << "decomposition with " << threads << " threads differs from the serial one, see " << file_name << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}